@@ -313,6 +313,8 @@ static int Lua_vsi_fire_signal ( lua_State* L )
     result.name       = NULL;
     result.data       = (char*)&userData;
     result.dataLength = 8;
+    result.timestamp  = 0;
+    result.sequence   = 0;
     result.status     = 0;
 
     //
@@ -364,11 +366,13 @@ static int Lua_vsi_fire_signal ( lua_State* L )
 
     Lua Interface:
 
-      status, value, name = Lua_vsi_get_oldest_signal ( domain, signal )
+      status, value, name, timestamp, sequence =
+          Lua_vsi_get_oldest_signal ( domain, signal )
 
     or:
 
-      status, value, name = Lua_vsi_get_oldest_signal ( name )
+      status, value, name, timestamp, sequence =
+          Lua_vsi_get_oldest_signal ( name )
 
         Input arguments:
             domain - An integer domain ID.
@@ -381,6 +385,9 @@ static int Lua_vsi_fire_signal ( lua_State* L )
             status - The integer completion status of the function.
             value  - An integer data value for this signal.
             name  - The signal name string.
+            timestamp - The CLOCK_MONOTONIC capture time of the value in
+                        nanoseconds.
+            sequence - The sequence number of the value.
 
     This function will find the oldest entry in the core database for the
     specified signal domain and ID and return the data associated with that
@@ -448,6 +455,8 @@ static int Lua_vsi_get_oldest_signal ( lua_State* L )
     result.name       = NULL;
     result.data       = (char*)&userData;
     result.dataLength = 8;
+    result.timestamp  = 0;
+    result.sequence   = 0;
     result.status     = 0;
 
     //
@@ -484,8 +493,10 @@ static int Lua_vsi_get_oldest_signal ( lua_State* L )
     lua_pushinteger ( L, status );
     lua_pushinteger ( L, userData );
     lua_pushstring ( L, result.name );
+    lua_pushinteger ( L, result.timestamp );
+    lua_pushinteger ( L, result.sequence );
 
-    return 3;
+    return 5;
 }
 
 
@@ -497,11 +508,13 @@ static int Lua_vsi_get_oldest_signal ( lua_State* L )
 
     Lua Interface:
 
-      status, value, name = Lua_vsi_get_newest_signal ( domain, signal )
+      status, value, name, timestamp, sequence =
+          Lua_vsi_get_newest_signal ( domain, signal )
 
     or:
 
-      status, value, name = Lua_vsi_get_newest_signal ( name )
+      status, value, name, timestamp, sequence =
+          Lua_vsi_get_newest_signal ( name )
 
         Input arguments:
             domain - An integer domain ID.
@@ -514,6 +527,9 @@ static int Lua_vsi_get_oldest_signal ( lua_State* L )
             status - The integer completion status of the function.
             value  - An integer data value for this signal.
             name  - The signal name string.
+            timestamp - The CLOCK_MONOTONIC capture time of the value in
+                        nanoseconds.
+            sequence - The sequence number of the value.
 
     These functions will retrieve the latest signal of the specified domain
     and ID from the core database.  If no signal of the specified type is
@@ -566,6 +582,8 @@ static int Lua_vsi_get_newest_signal ( lua_State* L )
     result.name       = NULL;
     result.data       = (char*)&userData;
     result.dataLength = 8;
+    result.timestamp  = 0;
+    result.sequence   = 0;
     result.status     = 0;
 
     //
@@ -602,8 +620,10 @@ static int Lua_vsi_get_newest_signal ( lua_State* L )
     lua_pushinteger ( L, status );
     lua_pushinteger ( L, userData );
     lua_pushstring ( L, result.name );
+    lua_pushinteger ( L, result.timestamp );
+    lua_pushinteger ( L, result.sequence );
 
-    return 3;
+    return 5;
 }
 
 
@@ -23,11 +23,20 @@
 #include <lauxlib.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sharedMemory.h"
+#include "signals.h"
 #include "utils.h"
 #include "vsi_core_api.h"
 
+//
+//  The length of a table is obtained with lua_rawlen in Lua 5.2 and later.
+//
+#if LUA_VERSION_NUM >= 502
+#   define lua_objlen lua_rawlen
+#endif
+
 
 /*! @{ */
 
@@ -186,8 +195,15 @@ static int Lua_vsiCoreClose ( lua_State* L )
         domain - a number indicating what type of data this is (e.g. CAN, etc.).
         key - a number identifying a specific signal in the domain.
         value - the numeric (8 byte) value to be stored.
+        timestamp - (optional) the CLOCK_MONOTONIC capture time of the value
+                    in nanoseconds.  The current time is used if omitted.
 
-      Return values:  None
+      Return values:
+        status - the completion status of the operation (0 == successful).
+        timestamp - the capture time that was stored with the message (only
+                    if the message was stored).
+        sequence - the sequence number that was assigned to the message (only
+                   if the message was stored).
 
     This function will insert a new message into the VSI core data store with
     the given domain and key values.  If there is no space left in the data
@@ -214,22 +230,144 @@ static int Lua_vsiCoreClose ( lua_State* L )
 ------------------------------------------------------------------------*/
 static int Lua_vsiCoreInsert ( lua_State* L )
 {
+    signal_stamp stamp;
+
     //
-    //  Get the 3 input arguments from the stack.
+    //  Get the input arguments from the stack.
     //
     unsigned int  domain = luaL_checkinteger ( L, 1 );
     unsigned int  key    = luaL_checkinteger ( L, 2 );
     unsigned long value  = luaL_checkinteger ( L, 3 );
 
+    stamp.timestamp = luaL_optinteger ( L, 4, 0 );
+
     //
     //  Go insert the requested signal into the VSI core data store.
     //
-    vsi_core_insert ( domain, key, 8, &value );
+    int status = sm_insert ( domain, key, 8, &value, &stamp );
 
     //
-    //  Don't return anything to the caller.
+    //  Return the status and, if the message was stored, the stamp of the
+    //  new message to the caller.
     //
-    return 0;
+    lua_pushinteger ( L, status );
+
+    if ( status != 0 )
+    {
+        return 1;
+    }
+    lua_pushinteger ( L, stamp.timestamp );
+    lua_pushinteger ( L, stamp.sequence );
+
+    return 3;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    L u a _ v s i C o r e I n s e r t B a t c h
+
+    @brief Insert several messages into the VSI core data store at once.
+
+    Lua Interface:
+
+      Input arguments:
+        messages - an array of { domain, key, value [, timestamp] } arrays.
+
+      Return values:
+        status - the completion status of the operation (0 == successful).
+        stamps - an array with a { status, timestamp, sequence } table for
+                 each message.  The timestamp and sequence are only present
+                 if that message was stored.
+
+    This function is equivalent to calling Lua_vsiCoreInsert for each of the
+    messages in the array but all of the messages are stored before any
+    waiting consumers are released.
+
+    VSI C Interface:
+
+        int vsi_core_insert_batch ( vsi_result* results, size_t count );
+
+    @param[in] results - The array of messages to insert.
+    @param[in] count - The number of messages in the results array.
+
+    @return 0 if successful
+            Otherwise the status of the first message that failed
+
+------------------------------------------------------------------------*/
+static int Lua_vsiCoreInsertBatch ( lua_State* L )
+{
+    luaL_checktype ( L, 1, LUA_TTABLE );
+
+    size_t count = lua_objlen ( L, 1 );
+
+    //
+    //  Get the memory for the result structures and the message values.  The
+    //  memory belongs to Lua so that it is not leaked if one of the messages
+    //  turns out to be invalid.
+    //
+    vsi_result*    results = lua_newuserdata ( L, ( count + 1 ) *
+                                               ( sizeof(vsi_result) +
+                                                 sizeof(unsigned long) ) );
+    unsigned long* values  = (unsigned long*)&results[count + 1];
+
+    memset ( results, 0, ( count + 1 ) * sizeof(vsi_result) );
+
+    //
+    //  Build a result structure for each of the messages in the array.
+    //
+    for ( size_t i = 0; i < count; ++i )
+    {
+        lua_rawgeti ( L, 1, i + 1 );
+        luaL_checktype ( L, -1, LUA_TTABLE );
+
+        lua_rawgeti ( L, -1, 1 );
+        lua_rawgeti ( L, -2, 2 );
+        lua_rawgeti ( L, -3, 3 );
+        lua_rawgeti ( L, -4, 4 );
+
+        results[i].domainId   = lua_tointeger ( L, -4 );
+        results[i].signalId   = lua_tointeger ( L, -3 );
+        values[i]             = lua_tointeger ( L, -2 );
+        results[i].timestamp  = lua_tointeger ( L, -1 );
+        results[i].data       = (char*)&values[i];
+        results[i].dataLength = sizeof(unsigned long);
+
+        lua_pop ( L, 5 );
+    }
+    //
+    //  Go insert all of the messages into the VSI core data store.
+    //
+    int status = vsi_core_insert_batch ( results, count );
+
+    lua_pushinteger ( L, status );
+
+    //
+    //  Create a new table that will be our array of stamp tables.
+    //
+    lua_newtable ( L );
+
+    for ( size_t i = 0; i < count; ++i )
+    {
+        lua_newtable ( L );
+
+        lua_pushstring ( L, "status" );
+        lua_pushinteger ( L, results[i].status );
+        lua_settable ( L, -3 );
+
+        if ( results[i].status == 0 )
+        {
+            lua_pushstring ( L, "timestamp" );
+            lua_pushinteger ( L, results[i].timestamp );
+            lua_settable ( L, -3 );
+
+            lua_pushstring ( L, "sequence" );
+            lua_pushinteger ( L, results[i].sequence );
+            lua_settable ( L, -3 );
+        }
+        lua_rawseti ( L, -2, i + 1 );
+    }
+    return 2;
 }
 
 
@@ -248,6 +386,9 @@ static int Lua_vsiCoreInsert ( lua_State* L )
       Return values:
         value - the numeric (8 byte) value fetched from the data store.
         status - the completion status of the operation (0 == successful).
+        timestamp - the CLOCK_MONOTONIC capture time of the value in
+                    nanoseconds.
+        sequence - the sequence number of the value.
 
     This function will find the oldest message with the specified domain and
     key values in the VSI data store, return the message data to the caller
@@ -275,17 +416,23 @@ static int Lua_vsiCoreInsert ( lua_State* L )
 static int Lua_vsiCoreFetch ( lua_State* L )
 {
     unsigned long value = 0;
-    unsigned long size  = 8;
+    unsigned long size  = sizeof(value);
+    signal_stamp  stamp = { 0 };
 
     unsigned int  domain = luaL_checkinteger ( L, 1 );
     unsigned int  key    = luaL_checkinteger ( L, 2 );
 
-    int status = vsi_core_fetch ( domain, key, &size, &value );
+    //
+    //  Go copy the value out of the shared memory segment.
+    //
+    int status = sm_fetch ( domain, key, &size, &value, false, NULL, &stamp );
 
     lua_pushinteger ( L, value );
     lua_pushinteger ( L, status );
+    lua_pushinteger ( L, stamp.timestamp );
+    lua_pushinteger ( L, stamp.sequence );
 
-    return 2;
+    return 4;
 }
 
 
@@ -304,6 +451,9 @@ static int Lua_vsiCoreFetch ( lua_State* L )
       Return values:
         value - the numeric (8 byte) value to be stored.
         status - the completion status of the operation (0 == successful).
+        timestamp - the CLOCK_MONOTONIC capture time of the value in
+                    nanoseconds.
+        sequence - the sequence number of the value.
 
     This function will find the message with the specified domain and key
     values in the VSI data store, return the message data to the caller and
@@ -333,17 +483,23 @@ static int Lua_vsiCoreFetch ( lua_State* L )
 static int Lua_vsiCoreFetchWait ( lua_State* L )
 {
     unsigned long value = 0;
-    unsigned long size  = 8;
+    unsigned long size  = sizeof(value);
+    signal_stamp  stamp = { 0 };
 
     unsigned int  domain = luaL_checkinteger ( L, 1 );
     unsigned int  key    = luaL_checkinteger ( L, 2 );
 
-    int status = vsi_core_fetch_wait ( domain, key, &size, &value );
+    //
+    //  Go copy the value out of the shared memory segment.
+    //
+    int status = sm_fetch ( domain, key, &size, &value, true, NULL, &stamp );
 
     lua_pushinteger ( L, value );
     lua_pushinteger ( L, status );
+    lua_pushinteger ( L, stamp.timestamp );
+    lua_pushinteger ( L, stamp.sequence );
 
-    return 2;
+    return 4;
 }
 
 
@@ -362,6 +518,9 @@ static int Lua_vsiCoreFetchWait ( lua_State* L )
       Return values:
         value - the numeric (8 byte) value to be stored.
         status - the completion status of the operation (0 == successful).
+        timestamp - the CLOCK_MONOTONIC capture time of the value in
+                    nanoseconds.
+        sequence - the sequence number of the value.
 
     This function will find the message with the specified domain and key
     This function will find the newest message with the specified domain and
@@ -390,16 +549,20 @@ static int Lua_vsiCoreFetchNewest ( lua_State* L )
 {
     unsigned long value = 0;
     unsigned long size  = 8;
+    signal_stamp  stamp = { 0 };
 
     unsigned int  domain = luaL_checkinteger ( L, 1 );
     unsigned int  key    = luaL_checkinteger ( L, 2 );
 
-    int status = vsi_core_fetch_newest ( domain, key, &size, &value );
+    int status = sm_fetch_latest ( domain, key, &size, &value, true, NULL,
+                                   &stamp );
 
     lua_pushinteger ( L, value );
     lua_pushinteger ( L, status );
+    lua_pushinteger ( L, stamp.timestamp );
+    lua_pushinteger ( L, stamp.sequence );
 
-    return 2;
+    return 4;
 }
 
 
@@ -463,6 +626,7 @@ int luaopen_liblua_vsi_core ( lua_State* L )
     lua_register ( L, "Lua_vsiCoreOpen", Lua_vsiCoreOpen );
     lua_register ( L, "Lua_vsiCoreClose", Lua_vsiCoreClose );
     lua_register ( L, "Lua_vsiCoreInsert", Lua_vsiCoreInsert );
+    lua_register ( L, "Lua_vsiCoreInsertBatch", Lua_vsiCoreInsertBatch );
     lua_register ( L, "Lua_vsiCoreFetch", Lua_vsiCoreFetch );
     lua_register ( L, "Lua_vsiCoreFetchWait", Lua_vsiCoreFetchWait );
     lua_register ( L, "Lua_vsiCoreFetchNewest", Lua_vsiCoreFetchNewest );
@@ -62,7 +62,9 @@ static PyObject* VsiError;
 //  Declare the local functions that implement the python to C wrappers.
 //
 static PyObject* vsi_insertSignalData      ( PyObject* self, PyObject* args );
+static PyObject* vsi_insertSignalDataBatch ( PyObject* self, PyObject* args );
 static PyObject* vsi_getSignalData         ( PyObject* self, PyObject* args );
+static PyObject* vsi_getSignalDataStamped  ( PyObject* self, PyObject* args );
 static PyObject* vsi_flushSignalData       ( PyObject* self, PyObject* args );
 static PyObject* vsi_createSignalGroup     ( PyObject* self, PyObject* args );
 static PyObject* vsi_deleteSignalGroup     ( PyObject* self, PyObject* args );
@@ -70,6 +72,8 @@ static PyObject* vsi_addSignalToGroup      ( PyObject* self, PyObject* args );
 static PyObject* vsi_removeSignalFromGroup ( PyObject* self, PyObject* args );
 static PyObject* vsi_getOldestInGroup      ( PyObject* self, PyObject* args );
 
+static PyObject* fetchSignalData ( PyObject* args, bool stamped );
+
 //
 //  Define the data structure that implements the Python to C function mapping.
 //
@@ -81,12 +85,24 @@ static PyMethodDef VsiMethods[] =
         METH_VARARGS,
         "Insert a VSI signal data by name."
     },
+    {
+        "insertSignalDataBatch",
+        vsi_insertSignalDataBatch,
+        METH_VARARGS,
+        "Insert a list of VSI signals at once."
+    },
     {
         "getSignalData",
         vsi_getSignalData,
         METH_VARARGS,
         "Get the VSI signal data by name."
     },
+    {
+        "getSignalDataStamped",
+        vsi_getSignalDataStamped,
+        METH_VARARGS,
+        "Get the VSI signal data by name with it's timestamp and sequence."
+    },
     {
         "flushSignalData",
         vsi_flushSignalData,
@@ -210,7 +226,7 @@ MOD_INIT ( vsi_py )
     Python usage:
 
         status = insertSignalData ( domain, signal, name, valueSize,
-                                    numericValue, strValue )
+                                    numericValue, strValue [, timestamp] )
 
     @param[in] domain - The domain of the signal.
     @param[in] signal - The integer value of the signal ID (if any).
@@ -218,6 +234,8 @@ MOD_INIT ( vsi_py )
     @param[in] valueSize - The integer length of the signal value.
     @param[in] value - The unsigned long integer value of a numeric signal (if any).
     @param[in] strValue - The length of an ASCII signal value (if any).
+    @param[in] timestamp - The CLOCK_MONOTONIC capture time of the signal in
+                           nanoseconds (optional, defaults to now).
 
     @return status - 0 = Success
                     ~0 = Errno
@@ -230,6 +248,7 @@ static PyObject* vsi_insertSignalData ( PyObject* self, PyObject* args )
     unsigned int  domain   = 1;
     unsigned int  signal   = 0;
     unsigned long value    = 0;
+    unsigned long stamp    = 0;
     int           size     = 0;
     int           status   = 0;
     vsi_result    result;
@@ -237,8 +256,8 @@ static PyObject* vsi_insertSignalData ( PyObject* self, PyObject* args )
     //
     //  Go get the input arguments from the user's function call.
     //
-    status = PyArg_ParseTuple ( args, "IIsIks", &domain, &signal, &VSSname,
-                                &size, &value, &strValue );
+    status = PyArg_ParseTuple ( args, "IIsIks|k", &domain, &signal, &VSSname,
+                                &size, &value, &strValue, &stamp );
     if ( ! status )
     {
         return PyLong_FromLong ( status );
@@ -255,6 +274,8 @@ static PyObject* vsi_insertSignalData ( PyObject* self, PyObject* args )
     result.signalId   = signal;
     result.name       = (char*)VSSname;
     result.dataLength = size;
+    result.timestamp  = stamp;
+    result.sequence   = 0;
     result.status     = 0;
 
     //
@@ -322,6 +343,109 @@ static PyObject* vsi_insertSignalData ( PyObject* self, PyObject* args )
 }
 
 
+/*!----------------------------------------------------------------------------
+
+    v s i _ i n s e r t S i g n a l D a t a B a t c h
+
+    @brief Insert a list of signals into the VSI system at once.
+
+    This function accepts a list of (domain, signal, value) tuples and
+    inserts all of them with a single call to vsi_insert_signals.  The value
+    of each signal can be either an unsigned long integer value (stored as 8
+    bytes) or an ASCII character string.  Each tuple may also have a fourth
+    item that is the CLOCK_MONOTONIC capture time of the signal in
+    nanoseconds.
+
+    Python usage:
+
+        status = insertSignalDataBatch ( [ ( domain, signal, value ), ... ] )
+
+    @param[in] signals - The list of (domain, signal, value [, timestamp])
+                         tuples.
+
+    @return status - 0 = Success
+                    ~0 = Errno of the first signal that failed
+
+-----------------------------------------------------------------------------*/
+static PyObject* vsi_insertSignalDataBatch ( PyObject* self, PyObject* args )
+{
+    PyObject*      list    = NULL;
+    vsi_result*    results = NULL;
+    unsigned long* values  = NULL;
+    Py_ssize_t     count;
+    Py_ssize_t     i;
+    int            status  = 0;
+
+    //
+    //  Go get the list of signals from the user's function call.
+    //
+    if ( ! PyArg_ParseTuple ( args, "O!", &PyList_Type, &list ) )
+    {
+        return NULL;
+    }
+    count = PyList_Size ( list );
+
+    LOG ( "Inserting a batch of %zd signals\n", count );
+
+    //
+    //  Get the memory for the result structures and the numeric values.
+    //
+    results = calloc ( count + 1, sizeof(vsi_result) );
+    values  = calloc ( count + 1, sizeof(unsigned long) );
+    if ( results == NULL || values == NULL )
+    {
+        free ( results );
+        free ( values );
+        return PyErr_NoMemory();
+    }
+    //
+    //  Build a result structure for each of the signals in the list.  If the
+    //  value is not numeric, it must be a string.
+    //
+    for ( i = 0; i < count; ++i )
+    {
+        PyObject*    item     = PyList_GetItem ( list, i );
+        unsigned int domain   = 0;
+        unsigned int signal   = 0;
+        char*        strValue = NULL;
+
+        if ( PyArg_ParseTuple ( item, "IIk|k", &domain, &signal, &values[i],
+                                &results[i].timestamp ) )
+        {
+            results[i].data       = (char*)&values[i];
+            results[i].dataLength = sizeof(unsigned long);
+        }
+        else
+        {
+            PyErr_Clear();
+            if ( ! PyArg_ParseTuple ( item, "IIs|k", &domain, &signal,
+                                      &strValue, &results[i].timestamp ) )
+            {
+                free ( results );
+                free ( values );
+                return NULL;
+            }
+            results[i].data       = strValue;
+            results[i].dataLength = strlen ( strValue );
+        }
+        results[i].domainId = domain;
+        results[i].signalId = signal;
+    }
+    //
+    //  Go insert all of the signals in the VSI subsystem.
+    //
+    status = vsi_insert_signals ( results, count );
+
+    free ( results );
+    free ( values );
+
+    //
+    //  Return the status from the above call to the Python caller.
+    //
+    return PyLong_FromLong ( status );
+}
+
+
 /*!----------------------------------------------------------------------------
 
     v s i _ g e t S i g n a l D a t a
@@ -363,11 +487,15 @@ static PyObject* vsi_insertSignalData ( PyObject* self, PyObject* args )
 
     Python usage:
 
-        status, value = getSignalData ( domain, name, wait, oldest )
+        status, length, value, strValue =
+            getSignalData ( domain, signal, name, wait, oldest )
 
-    The return value is a 2 item tuple consisting of "(status, value)".  If
-    there was a error (indicated by a non-zero, status), the contents of the
-    "value" return item is indeterminate and should not be accessed.
+    The return value is a 4 item tuple consisting of the status, the length
+    of the data and the data as a numeric value and as a string.  If there
+    was a error (indicated by a non-zero, status), the contents of the other
+    return items are indeterminate and should not be accessed.  Use
+    getSignalDataStamped to get the capture time and sequence number of the
+    signal as well.
 
     WARNING: This implementation uses an ASCII string buffer of size 1024
     which limites the size of the data stored in the VSI.  This should be
@@ -385,6 +513,41 @@ static PyObject* vsi_insertSignalData ( PyObject* self, PyObject* args )
 
 -----------------------------------------------------------------------------*/
 static PyObject* vsi_getSignalData ( PyObject* self, PyObject* args )
+{
+    return fetchSignalData ( args, false );
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    v s i _ g e t S i g n a l D a t a S t a m p e d
+
+    @brief Fetch the signal data and it's stamp from the VSI system.
+
+    This function is identical to vsi_getSignalData except that the capture
+    time and sequence number of the signal are returned as well.
+
+    Python usage:
+
+        status, length, value, strValue, timestamp, sequence =
+            getSignalDataStamped ( domain, signal, name, wait, oldest )
+
+    The "timestamp" is the CLOCK_MONOTONIC capture time of the signal in
+    nanoseconds and the "sequence" is it's sequence number in the signal
+    list.
+
+-----------------------------------------------------------------------------*/
+static PyObject* vsi_getSignalDataStamped ( PyObject* self, PyObject* args )
+{
+    return fetchSignalData ( args, true );
+}
+
+
+//
+//  Fetch the signal data for vsi_getSignalData and vsi_getSignalDataStamped
+//  and build the Python tuple that they return.
+//
+static PyObject* fetchSignalData ( PyObject* args, bool stamped )
 {
     const char*   VSSname    = NULL;
     domain_t      domain     = 0;
@@ -394,6 +557,9 @@ static PyObject* vsi_getSignalData ( PyObject* self, PyObject* args )
     unsigned char wait       = 0;
     unsigned char oldest     = 0;
     int           status     = 0;
+    char          newestData[1024] = { 0 };
+    vsi_lease     lease      = { 0 };
+    signal_stamp  stamp      = { 0 };
 
     //
     //  Go get the input arguments from the user's function call.
@@ -403,7 +569,7 @@ static PyObject* vsi_getSignalData ( PyObject* self, PyObject* args )
     if ( ! status )
     {
         LOG ( "WARNING: Unable to parse input parameters in "
-              "vsi_getSignalData: Status[%d]\n", status );
+              "fetchSignalData: Status[%d]\n", status );
 
         return PyLong_FromLong ( status );
     }
@@ -462,13 +628,36 @@ static PyObject* vsi_getSignalData ( PyObject* self, PyObject* args )
     //  Call the appropriate low level function depending on whether we are
     //  fetching the oldest or newest data value from the signal.
     //
+    //  The oldest value is read in place in the shared memory segment under a
+    //  lease so that it can't be recycled until we have built the Python
+    //  return values from it.
+    //
     if ( oldest )
     {
-        status = sm_fetch ( domain, signal, &dataLength, &data, wait );
+        lease.domainId = domain;
+        lease.signalId = signal;
+
+        status = vsi_lease_oldest_signal ( &lease, wait, NULL );
+        if ( status == 0 )
+        {
+            data            = (void*)lease.data;
+            dataLength      = lease.dataLength;
+            stamp.timestamp = lease.timestamp;
+            stamp.sequence  = lease.sequence;
+        }
     }
     else
     {
-        status = sm_fetch_newest ( domain, signal, &dataLength, &data, wait );
+        //
+        //  The newest value is copied into our local buffer (leaving room
+        //  for a terminating null byte) rather than being read in place in
+        //  the shared memory segment.
+        //
+        data       = newestData;
+        dataLength = sizeof(newestData) - 1;
+
+        status = sm_fetch_latest ( domain, signal, &dataLength, data, wait,
+                                   NULL, &stamp );
     }
     //
     //  If we are debugging, output the results of our call.
@@ -491,10 +680,37 @@ static PyObject* vsi_getSignalData ( PyObject* self, PyObject* args )
         }
     }
     //
-    //  Return the list of output data from this call to the caller.
+    //  If no data was found, return the (empty) local buffer contents.
+    //
+    if ( data == NULL )
+    {
+        data = newestData;
+    }
+    //
+    //  Build the list of output data from this call and then give up our
+    //  lease on the signal data (if we have one).
+    //
+    PyObject* output;
+
+    if ( stamped )
+    {
+        output = Py_BuildValue ( "(iiiskk)", status, dataLength,
+                                 *(unsigned long*)data, (char*)data,
+                                 stamp.timestamp, stamp.sequence );
+    }
+    else
+    {
+        output = Py_BuildValue ( "(iiis)", status, dataLength,
+                                 *(unsigned long*)data, (char*)data );
+    }
+    if ( lease.record != 0 )
+    {
+        vsi_release_lease ( &lease );
+    }
+    //
+    //  Return the list of output data to the caller.
     //
-    return Py_BuildValue ( "(iiis)", status, dataLength,
-                           *(unsigned long*)data, (char*)data );
+    return output;
 }
 
 
@@ -9,8 +9,10 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <syslog.h>
+#include <time.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <vsi.h>
@@ -21,6 +23,7 @@
 
 #define MAX_SIG_CNT (20)
 #define MAX_SIG_DATA (16)
+#define MAX_FRAME_SIG_CNT (64)
 
 extern struct CanSignal geniviDemoSignals[];
 extern uint32_t geniviDemoSignals_cnt;
@@ -51,10 +54,12 @@ static void print_usage(char* prg)
     fprintf(stderr, "Options: -F         (stay in foreground; no daemonize)\n");
     fprintf(stderr, "         -u         (update signals. Do not store signals if they haven't changed)\n");
     fprintf(stderr, "         -p pidfile (provide pidfile)\n");
+    fprintf(stderr, "         -r count   (retain at most count unread values of each signal)\n");
     fprintf(stderr, "         -h         (show this help page)\n");
     fprintf(stderr, "\nExamples:\n");
     fprintf(stderr, "vsi-socketcand vss_rel_1.0.vsi can0\n");
     fprintf(stderr, "vsi-socketcand -F vss_rel_1.0.vsi can0\n");
+    fprintf(stderr, "vsi-socketcand -r 100 vss_rel_1.0.vsi can0\n");
     fprintf(stderr, "\n");
     exit(-EXIT_FAILURE);
 }
@@ -106,6 +111,7 @@ static void child_handler(int signum)
 static int openCANSocket(const char* canName)
 {
     int s;
+    int enable = 1;
     struct ifreq ifr;
     struct sockaddr_can addr;
 
@@ -133,13 +139,52 @@ static int openCANSocket(const char* canName)
         return -EXIT_FAILURE;
     }
 
+    /* Ask the kernel for the receive time of each frame */
+    if (setsockopt(s, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable)) < 0) {
+        syslogger(LOG_WARNING, "Frame timestamps not available on %s interface", canName);
+    }
+
     return s;
 }
 
+/* Capture time of the current CAN frame in CLOCK_MONOTONIC nanoseconds, 0 if unknown */
+static unsigned long frameTimestamp = 0;
+
+/*
+ * The kernel reports SO_TIMESTAMP in CLOCK_REALTIME but signal timestamps are
+ * CLOCK_MONOTONIC, so carry the age of the frame over to the monotonic clock.
+ */
+static unsigned long monotonicFrameTime(const struct timeval* rxTime)
+{
+    struct timespec realNow;
+    struct timespec monoNow;
+    long long age;
+    long long now;
+
+    clock_gettime(CLOCK_REALTIME, &realNow);
+    clock_gettime(CLOCK_MONOTONIC, &monoNow);
+
+    age = (realNow.tv_sec - rxTime->tv_sec) * 1000000000LL +
+          realNow.tv_nsec - rxTime->tv_usec * 1000LL;
+    now = monoNow.tv_sec * 1000000000LL + monoNow.tv_nsec;
+
+    if (age < 0 || age > now)
+        return now;
+
+    return now - age;
+}
+
 static int readCAN(int canFd, struct can_frame* frame)
 {
     fd_set rfds;
     struct timeval tv = {.tv_usec = 0, .tv_sec = 1 };
+    struct iovec iov = {.iov_base = frame, .iov_len = sizeof(struct can_frame) };
+    char control[CMSG_SPACE(sizeof(struct timeval))];
+    struct msghdr msg = {.msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control,
+        .msg_controllen = sizeof(control) };
+    struct cmsghdr* cmsg;
     int retval;
 
     FD_ZERO(&rfds);
@@ -148,15 +193,65 @@ static int readCAN(int canFd, struct can_frame* frame)
     retval = select(canFd + 1, &rfds, NULL, NULL, &tv);
 
     if (retval > 0) {
-        retval = read(canFd, frame, sizeof(struct can_frame));
+        retval = recvmsg(canFd, &msg, 0);
+
+        frameTimestamp = 0;
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMP) {
+                struct timeval rxTime;
+
+                memcpy(&rxTime, CMSG_DATA(cmsg), sizeof(rxTime));
+                frameTimestamp = monotonicFrameTime(&rxTime);
+            }
+        }
     }
 
     return retval;
 }
 
+/* Signals decoded from the current CAN frame, inserted together by flushFrameSignals */
+static vsi_result frameSignals[MAX_FRAME_SIG_CNT];
+static unsigned long frameValues[MAX_FRAME_SIG_CNT];
+static size_t frameSignalCnt = 0;
+
+static void flushFrameSignals()
+{
+    size_t i;
+
+    if (frameSignalCnt == 0)
+        return;
+
+    if (vsi_insert_signals(frameSignals, frameSignalCnt)) {
+        for (i = 0; i < frameSignalCnt; ++i) {
+            if (frameSignals[i].status) {
+                syslogger(LOG_ERR, "Failed to store signal %s(%d), status: %d",
+                    frameSignals[i].name, frameSignals[i].signalId, frameSignals[i].status);
+            }
+        }
+    }
+
+    frameSignalCnt = 0;
+}
+
+static void queueSignal(const vsi_result* result)
+{
+    if (frameSignalCnt == MAX_FRAME_SIG_CNT)
+        flushFrameSignals();
+
+    frameValues[frameSignalCnt] = 0;
+    memcpy(&frameValues[frameSignalCnt], result->data, result->dataLength);
+
+    frameSignals[frameSignalCnt] = *result;
+    frameSignals[frameSignalCnt].data = (char*)&frameValues[frameSignalCnt];
+    frameSignals[frameSignalCnt].timestamp = frameTimestamp;
+    frameSignals[frameSignalCnt].sequence = 0;
+    frameSignals[frameSignalCnt].status = 0;
+
+    ++frameSignalCnt;
+}
+
 static void sigUInt8Clbk(const char* name, uint32_t id, uint8_t value)
 {
-    int status = 0;
     vsi_result result = {.signalId = id,
         .domainId = 1,
         .name = (char*)name,
@@ -173,16 +268,11 @@ static void sigUInt8Clbk(const char* name, uint32_t id, uint8_t value)
 
     syslogger(LOG_INFO, "Signal received - name: %s, id: %u, val(u8): %hhu", name, id, result.data[0]);
 
-    vsi_insert_signal (&result);
-
-    if (status) {
-        syslogger(LOG_ERR, "Failed to store signal %s(%d), val: %hhu", name, id, value);
-    }
+    queueSignal(&result);
 }
 
 static void sigUInt16Clbk(const char* name, uint32_t id, uint16_t value)
 {
-    int status = 0;
     vsi_result result = {.signalId = id,
         .domainId = 1,
         .name = (char*)name,
@@ -199,16 +289,11 @@ static void sigUInt16Clbk(const char* name, uint32_t id, uint16_t value)
 
     syslogger(LOG_INFO, "Signal received - name: %s, id: %u, val(u16): %hu", name, id, result.data);
 
-    vsi_insert_signal (&result);
-
-    if (status) {
-        syslogger(LOG_ERR, "Failed to store signal %s(%d), val: %hu", name, id, value);
-    }
+    queueSignal(&result);
 }
 
 static void sigBoolClbk(const char* name, uint32_t id, bool value)
 {
-    int status = 0;
     vsi_result result = {.signalId = id,
         .domainId = 1,
         .name = (char*)name,
@@ -225,11 +310,7 @@ static void sigBoolClbk(const char* name, uint32_t id, bool value)
 
     syslogger(LOG_INFO, "Signal received - name: %s, id: %u, val(bool): %hhu", name, id, result.data);
 
-    vsi_insert_signal (&result);
-
-    if (status) {
-        syslogger(LOG_ERR, "Failed to store signal %s(%d), val: %hhu", name, id, value);
-    }
+    queueSignal(&result);
 }
 
 int main(int argc, char** argv)
@@ -241,8 +322,9 @@ int main(int argc, char** argv)
     int canFd = -1;
     struct can_frame frame;
     int readCnt = 0;
+    vsi_retention retention = { 0 };
 
-    while ((opt = getopt(argc, argv, "u?hFp:")) != -1) {
+    while ((opt = getopt(argc, argv, "u?hFp:r:")) != -1) {
         switch (opt) {
         case 'u':
             updates_only = true;
@@ -253,6 +335,9 @@ int main(int argc, char** argv)
         case 'p':
             pidfile = strdup(optarg);
             break;
+        case 'r':
+            retention.maxCount = strtoul(optarg, NULL, 0);
+            break;
         case 'h':
         case '?':
         default:
@@ -279,6 +364,12 @@ int main(int argc, char** argv)
 
     vsi_initialize(false);
 
+    /* Keep unread signals from growing without bound if nobody consumes them */
+    if (retention.maxCount && vsi_set_domain_retention(1, &retention)) {
+        syslogger(LOG_ERR, "Failed to set the signal retention policy");
+        exit(-EXIT_FAILURE);
+    }
+
     canFd = openCANSocket(canIf);
     if (canFd < 0) {
         syslogger(LOG_ERR, "Failed to open CAN interface (%s)", canIf);
@@ -312,6 +403,7 @@ int main(int argc, char** argv)
 
         if (readCnt > 0) {
             processCanFrame(&frame);
+            flushFrameSignals();
         }
     }
 
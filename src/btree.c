@@ -44,6 +44,13 @@
 //
 #define BTREE_LOCKS_ENABLE
 
+//
+//  If the following define is changed to an "#undef", the B-tree nodes will
+//  not cache the key prefixes of their records (see prefix_types) and every
+//  key comparison will be made against the user's data records.
+//
+#define BTREE_KEY_PREFIXES
+
 
 //
 //  Define an enumerated type that we can use to specify "left" and "right".
@@ -112,10 +119,20 @@ static void btree_traverse_node ( btree_t*     btree,
                                   bt_node_t*   subtree,
                                   traverseFunc traverseFunction );
 
+static void btree_select_compare ( btree_t* btree,
+                                   btree_key_def* keyDefinition );
+
 static int btree_compare_function ( btree_t* btree,
                                     void* data1,
                                     void* data2 );
 
+static int btree_compare_fields ( btree_t* btree,
+                                  void* data1,
+                                  void* data2 );
+
+static unsigned long btree_key_prefix ( btree_t* btree,
+                                        void* data );
+
 static void btree_print_header ( btree_t* btree );
 
 static void btree_print_function ( btree_t* btree,
@@ -166,10 +183,12 @@ inline static void* cvtToAddr ( btree_t* btree,
 {
     if ( btree->type == TYPE_USER )
     {
+        sm_check_mapping();
         return (void*)( offset + (void*)smControl );
     }
     else
     {
+        sm_check_mapping_sys();
         return (void*)( offset + (void*)sysControl );
     }
 }
@@ -341,12 +360,115 @@ static offset_t* getDataRecord ( btree_t*   btree,
 }
 
 
+//
+//  Given a pointer to a node and the index of a record, return a pointer to
+//  the key prefix of that record.  This is only valid if the node caches key
+//  prefixes.
+//
+static inline unsigned long* getKeyAddress ( btree_t*   btree,
+                                             bt_node_t* node,
+                                             int        index )
+{
+    return cvtToAddr ( btree, node->keys + index * sO );
+}
+
+
+//
+//  Store the offset of a user's data structure in a node and if the node
+//  caches key prefixes, the key prefix of that structure as well.
+//
 static inline void setRecord ( btree_t*   btree,
                                bt_node_t* node,
                                int        index,
                                offset_t   value )
 {
     *(offset_t*)getDataAddress ( btree, node, index ) = value;
+
+    if ( node->keys != 0 )
+    {
+        *getKeyAddress ( btree, node, index ) =
+            btree_key_prefix ( btree, toAddress ( value ) );
+    }
+}
+
+
+//
+//  Compare a key with the record at the specified index in a node.  The
+//  prefix is the key prefix of the key (see btree_key_prefix).  If the node
+//  caches key prefixes, the prefixes are compared first and the user's data
+//  record is only compared if they are the same and don't hold the whole
+//  key.
+//
+static inline int compareRecord ( btree_t*      btree,
+                                  void*         key,
+                                  unsigned long prefix,
+                                  bt_node_t*    node,
+                                  int           index )
+{
+    if ( node->keys != 0 )
+    {
+        unsigned long recordPrefix = *getKeyAddress ( btree, node, index );
+
+        if ( prefix != recordPrefix )
+        {
+            return prefix < recordPrefix ? -1 : 1;
+        }
+        if ( btree->keyPrefix == kp_complete )
+        {
+            return 0;
+        }
+    }
+    return btree_compare_function ( btree, key,
+                                    getDataRecord ( btree, node, index ) );
+}
+
+
+//
+//  Search the records in a node for the first one that is greater than or
+//  equal to the key and return its index (or the number of records in the
+//  node if the key is larger than all of them).  The result of comparing the
+//  key with the record at that index is returned in "diff" (which will be
+//  positive if there is no such record).
+//
+//  This is a binary search that always halves the range being searched so
+//  the only data dependent choice is the selection of the next base index,
+//  which the compiler can generate as a conditional move.  The number of
+//  comparisons is the same for every key in a node of a given size.
+//
+static inline int searchNode ( btree_t*      btree,
+                               void*         key,
+                               unsigned long prefix,
+                               bt_node_t*    node,
+                               int*          diff )
+{
+    int base   = 0;
+    int length = node->keysInUse;
+    int half;
+
+    if ( length == 0 )
+    {
+        *diff = 1;
+        return 0;
+    }
+    while ( length > 1 )
+    {
+        half    = length / 2;
+        base    = compareRecord ( btree, key, prefix, node, base + half ) > 0 ?
+                  base + half : base;
+        length -= half;
+    }
+    //
+    //  We are down to a single record so compare it to decide whether the
+    //  key goes at this position or the next one.
+    //
+    *diff = compareRecord ( btree, key, prefix, node, base );
+    if ( *diff > 0 )
+    {
+        ++base;
+        *diff = base < node->keysInUse ?
+                compareRecord ( btree, key, prefix, node, base ) : 1;
+    }
+    return base;
 }
 
 
@@ -370,6 +492,13 @@ static inline void moveRecords ( btree_t*     btree,
         memmove ( cvtToAddr ( btree, dstNode->dataRecords + ( dstIndex * sO ) ),
                   cvtToAddr ( btree, srcNode->dataRecords + ( srcIndex * sO ) ),
                   count * sO );
+
+        if ( dstNode->keys != 0 )
+        {
+            memmove ( getKeyAddress ( btree, dstNode, dstIndex ),
+                      getKeyAddress ( btree, srcNode, srcIndex ),
+                      count * sO );
+        }
     }
 }
 
@@ -420,6 +549,12 @@ static inline void copyRecord ( btree_t*     btree,
 
     *(offset_t*)getDataAddress ( btree, dstNode, dstIndex ) =
         *(offset_t*)getDataAddress ( btree, srcNode, srcIndex );
+
+    if ( dstNode->keys != 0 )
+    {
+        *getKeyAddress ( btree, dstNode, dstIndex ) =
+            *getKeyAddress ( btree, srcNode, srcIndex );
+    }
 }
 
 
@@ -530,18 +665,32 @@ void btree_initialize ( btree_t*       btree,
     //  The btree algorithm here only operates correctly if the record count
     //  is odd.
     //
+    //  Nodes smaller than the minimum cannot be split and merged correctly
+    //  so those requests are raised to the minimum.
+    //
+    if ( maxRecordsPerNode < BTREE_MIN_RECORD_COUNT )
+    {
+        maxRecordsPerNode = BTREE_MIN_RECORD_COUNT;
+    }
     if ( ( maxRecordsPerNode & 1 ) == 0 )
     {
         maxRecordsPerNode++;
     }
     btree->maxRecCnt = maxRecordsPerNode;
 
+    //
+    //  Go select the comparison routine for the shape of this key and the
+    //  kind of key prefix cached in the nodes.
+    //
+    btree_select_compare ( btree, keyDefinition );
+
     //
     //  Compute the node size as the btree node header size plus the size of
-    //  the record offset area plus the link offfset area.
+    //  the record offset area plus the link offfset area plus the key prefix
+    //  area if there is one.
     //
-    btree->nodeSize = sN + ( maxRecordsPerNode * sO ) +
-                      ( ( maxRecordsPerNode + 1 ) * sO );
+    btree->nodeSize = BTREE_NODE_SIZE ( maxRecordsPerNode,
+                                        btree->keyPrefix != kp_none );
     //
     //  Compute the value of the "minimum degree" (i.e. "t") value.
     //
@@ -599,9 +748,15 @@ void btree_initialize ( btree_t*       btree,
     functions, the btree thus created cannot be used in a shared memory
     segment to exchange data with other processes or threads.
 
+    The maximum number of records per node is the fanout of the btree and can
+    be tuned to the number of records the btree is expected to hold.  Since
+    the records in each node are searched with a binary search, a large
+    fanout gives a shallower tree (and fewer nodes visited per lookup) at the
+    cost of larger nodes.  The value is rounded up to an odd number and
+    values below BTREE_MIN_RECORD_COUNT are raised to that minimum.
+
     @param[in] maxRecordsPerNode - The maximum number of records per node
-    @param[in] numberOfKeys - The number of fields in the key
-    @param[in] keyNindex - The index into the record of each key field
+    @param[in] keyDefinition - The definition of the key fields
 
     @return The pointer to an empty B-tree.
             NULL if an error occurs.
@@ -771,6 +926,12 @@ static void init_node_header ( btree_t* btree,
     //
     node->children = node->dataRecords + sD;
 
+    //
+    //  If this btree caches key prefixes, initialize the offset of the
+    //  beginning of the key prefixes in this node structure.
+    //
+    node->keys = btree->keyPrefix != kp_none ? node->children + sC : 0;
+
     //
     //  Set the tree level to zero.
     //
@@ -1061,10 +1222,8 @@ static void btree_split_child ( btree_t*     btree,
 
     This function will insert a record into a tree with a non-full root node.
 
-    TODO: We could make the node search more efficient by implementing a
-    binary search instead of the linear one.  For small tree orders, the
-    linear search is more efficient but as the tree orders get larger, the
-    binary search will win.
+    The position of the new record in each node is found with a binary
+    search of the records in the node (see searchNode).
 
     @param[in] btree - The btree to operate on
     @param[in] parent - The address of the parent node
@@ -1077,9 +1236,11 @@ static void btree_insert_nonfull ( btree_t*   btree,
                                    bt_node_t* parentNode,
                                    void*      data )
 {
-    int        i;
-    bt_node_t* child;
-    bt_node_t* node = parentNode;
+    int           i;
+    int           diff;
+    bt_node_t*    child;
+    bt_node_t*    node   = parentNode;
+    unsigned long prefix = btree_key_prefix ( btree, data );
 
     BLOG ( "In btree_insert_nonfull\n" );
 
@@ -1090,18 +1251,15 @@ static void btree_insert_nonfull ( btree_t*   btree,
 insert:
 
     //
-    //  Position us at the end of the records in this node.
-    //
-    i = node->keysInUse - 1;
-
-    //
-    //  Initialize the source and destination pointers for the following
-    //  loops...
+    //  Search the node records for the point at which the new data should go,
+    //  which is just after any records that are less than or equal to it.
     //
-    offset_t* src = getDataAddress ( btree, node, i );
-    offset_t* dst = src + 1;
-
-    BLOG ( "  Setup - i: %d, src: 0x%p, dst: 0x%p\n", i, src, dst );
+    i = searchNode ( btree, data, prefix, node, &diff );
+    if ( diff == 0 )
+    {
+        i++;
+    }
+    BLOG ( "  Setup - i: %d\n", i );
 
     //
     //  If this is a leaf node...
@@ -1109,27 +1267,13 @@ insert:
     if ( isLeaf ( node )  )
     {
         //
-        //  Move all the records in the node one position to the right
-        //  (working backwards from the end) until we get to the point where
-        //  the new data will go.
-        //
-        //  TODO: Make this a block move operation.
-        //
-        while ( i >= 0 &&
-                ( btree_compare_function ( btree, data,
-                                           toAddress ( *src ) ) < 0 ) )
-        {
-            BLOG ( "  Copying - i: %d, src: 0x%p, dst: 0x%p\n", i, src, dst );
-
-            *dst-- = *src--;
-            i--;
-        }
-        //
-        //  Put the new data into this node and increment the number of
-        //  records in the node.
+        //  Move all the records after that point one position to the right
+        //  in a single block move, put the new data into this node and
+        //  increment the number of records in the node.
         //
-        BLOG ( "  Inserting - dst: 0x%p\n", dst );
-        *dst = toOffset ( data );
+        BLOG ( "  Inserting - i: %d\n", i );
+        moveRecords ( btree, node, i, node, i + 1, node->keysInUse - i );
+        setRecord ( btree, node, i, toOffset ( data ) );
         node->keysInUse++;
     }
     //
@@ -1138,22 +1282,10 @@ insert:
     else
     {
         //
-        //  Search the node records backwards from the end until we find the
-        //  point at which the new data should go.
-        //
-        while ( i >= 0 &&
-                ( btree_compare_function ( btree, data,
-                                           cvtToAddr (btree, *src) ) < 0 ) )
-        {
-            i--;
-        }
-        //
-        //  Grab the right hand child of this position so we can check to see
-        //  if the new data goes into the current node or the right child
-        //  node.
+        //  Grab the left hand child of this position so we can check to see
+        //  if the new data goes into the current node or the child node.
         //
-        child = getRightChild ( btree, node, i );
-        i++;
+        child = getLeftChild ( btree, node, i );
 
         //
         //  If the child node is full...
@@ -1169,8 +1301,7 @@ insert:
             //  If the new data is greater than the current record then
             //  increment to the next record.
             //
-            if ( btree_compare_function ( btree, data,
-                                          getDataRecord ( btree, node, i ) ) > 0 )
+            if ( compareRecord ( btree, data, prefix, node, i ) > 0 )
             {
                 i++;
             }
@@ -1305,6 +1436,264 @@ int btree_insert ( btree_t* btree, void* data )
 }
 
 
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ l e v e l _ n o d e s
+
+    @brief Compute the number of nodes needed to hold a level of a btree.
+
+    This function will compute the number of nodes needed to hold the given
+    number of records at one level of a btree that is being bulk loaded.
+    Each node (except the last) is followed by one record that is promoted to
+    the next level up as the separator between that node and the next one, so
+    each node uses up to maxRecCnt + 1 of the records.
+
+    @param[in] btree - The btree being loaded.
+    @param[in] records - The number of records at this level.
+
+    @return The number of nodes needed at this level.
+
+-----------------------------------------------------------------------------*/
+static unsigned int btree_level_nodes ( btree_t* btree, unsigned int records )
+{
+    if ( records <= btree->maxRecCnt )
+    {
+        return 1;
+    }
+    return ( records + 1 + btree->maxRecCnt ) / ( btree->maxRecCnt + 1 );
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ b u l k _ l o a d
+
+    @brief Build a btree from an array of sorted records.
+
+    This function will build the btree from the bottom up in a single pass
+    over the records instead of inserting them one at a time.  Each level of
+    the tree is built by packing the records for that level into as few
+    nodes as possible (spreading them evenly so that every node holds at
+    least the minimum number of records) and promoting the record between
+    each pair of adjacent nodes to the next level up as their separator.  No
+    node is ever split so building a large btree this way is much faster than
+    inserting the records individually.
+
+    The btree must be empty and the records must be in strictly ascending
+    order according to the key definition of the btree (i.e. no duplicate
+    keys).  All of the nodes needed are allocated before the btree is
+    modified so if this function fails, the btree is left empty.
+
+    @param[in] btree - The btree to be loaded.
+    @param[in] records - The array of addresses of the user's data structures.
+    @param[in] count - The number of records in the array.
+
+    @return 0 if successful
+            EINVAL if the btree is not empty or the records are not sorted
+            ENOMEM if the nodes could not be allocated
+
+-----------------------------------------------------------------------------*/
+int btree_bulk_load ( btree_t* btree, void** records, unsigned int count )
+{
+    bt_node_t**  pool       = NULL;
+    bt_node_t**  nodes      = NULL;
+    void**       separators = NULL;
+    void**       items      = records;
+    bt_node_t*   node;
+    bt_node_t*   child;
+    unsigned int nodeCount  = 0;
+    unsigned int levelCount;
+    unsigned int groups;
+    unsigned int perNode;
+    unsigned int remainder;
+    unsigned int used;
+    unsigned int next       = 0;
+    unsigned int level      = 0;
+    unsigned int i;
+    unsigned int j;
+    unsigned int k;
+    unsigned int c;
+    int          status     = 0;
+
+    BLOG ( "In btree_bulk_load: btree[%p], count[%u]\n", btree, count );
+
+    //
+    //  Make sure the records are in strictly ascending order.  If they are
+    //  not, the btree we build would not be searchable.
+    //
+    for ( i = 1; i < count; ++i )
+    {
+        if ( btree_compare_function ( btree, records[i - 1], records[i] ) >= 0 )
+        {
+            printf ( "Error: btree_bulk_load records are not in ascending "
+                     "order at record %u\n", i );
+            return EINVAL;
+        }
+    }
+    //
+    //  If there is nothing to load, we're done.
+    //
+    if ( count == 0 )
+    {
+        return 0;
+    }
+    //
+    //  Compute the total number of nodes we will need for all of the levels
+    //  of the btree.  Each level above the leaves holds the separators of
+    //  the level below it.
+    //
+    for ( levelCount = count; ; levelCount = groups - 1 )
+    {
+        groups = btree_level_nodes ( btree, levelCount );
+        nodeCount += groups;
+        if ( groups == 1 )
+        {
+            break;
+        }
+    }
+    //
+    //  Allocate the working arrays we need to keep track of the nodes and
+    //  separators of the level being built.
+    //
+    pool       = malloc ( nodeCount * sizeof(bt_node_t*) );
+    nodes      = malloc ( nodeCount * sizeof(bt_node_t*) );
+    separators = malloc ( count * sizeof(void*) );
+
+    if ( pool == NULL || nodes == NULL || separators == NULL )
+    {
+        printf ( "Error: Unable to allocate btree_bulk_load work space\n" );
+        status = ENOMEM;
+        goto bulkLoadExit;
+    }
+    //
+    //  Go allocate all of the nodes we will need.  If any of them can't be
+    //  allocated, give back the ones we got and quit before the btree has
+    //  been modified.
+    //
+    for ( i = 0; i < nodeCount; ++i )
+    {
+        pool[i] = allocate_btree_node ( btree );
+        if ( pool[i] == NULL )
+        {
+            while ( i > 0 )
+            {
+                free_btree_node ( btree, pool[--i] );
+            }
+            status = ENOMEM;
+            goto bulkLoadExit;
+        }
+    }
+    //
+    //  Obtain the data lock to make sure no one else is using the btree data
+    //  structures.
+    //
+    BTREE_LOCK
+
+    //
+    //  If the btree is not empty, we can't load it.
+    //
+    if ( btree->count != 0 )
+    {
+        printf ( "Error: btree_bulk_load called with a non-empty btree\n" );
+        for ( i = 0; i < nodeCount; ++i )
+        {
+            free_btree_node ( btree, pool[i] );
+        }
+        status = EINVAL;
+    }
+    else
+    {
+        //
+        //  Build each level of the btree starting with the leaves until we
+        //  have built a level with a single node (which is the new root).
+        //
+        levelCount = count;
+        do
+        {
+            groups    = btree_level_nodes ( btree, levelCount );
+            perNode   = ( levelCount - ( groups - 1 ) ) / groups;
+            remainder = ( levelCount - ( groups - 1 ) ) % groups;
+            used = 0;
+            c         = 0;
+
+            for ( j = 0; j < groups; ++j )
+            {
+                node        = pool[next++];
+                node->level = level;
+
+                //
+                //  Copy the next set of records into this node.  The first
+                //  "remainder" nodes get one extra record so the records are
+                //  spread evenly across the level.
+                //
+                node->keysInUse = perNode + ( j < remainder ? 1 : 0 );
+                for ( k = 0; k < node->keysInUse; ++k )
+                {
+                    setRecord ( btree, node, k, toOffset ( items[used++] ) );
+                }
+                //
+                //  If this is not a leaf node, link the nodes of the level
+                //  below us that lie between these records into this node.
+                //
+                if ( level > 0 )
+                {
+                    for ( k = 0; k <= node->keysInUse; ++k )
+                    {
+                        child = nodes[c++];
+                        setChild ( btree, node, k, cvtToOffset ( btree, child ) );
+                        child->parent = cvtToOffset ( btree, node );
+                    }
+                }
+                //
+                //  Save this node for the next level up and promote the
+                //  record that follows it to be the separator between it and
+                //  the next node.  Note that both of these arrays are being
+                //  reused in place but we are always writing behind the
+                //  position we are reading from.
+                //
+                nodes[j] = node;
+                if ( j < groups - 1 )
+                {
+                    separators[j] = items[used++];
+                }
+            }
+            //
+            //  The separators we just promoted are the records of the next
+            //  level up.
+            //
+            items      = separators;
+            levelCount = groups - 1;
+            ++level;
+
+        }   while ( groups > 1 );
+
+        //
+        //  Replace the empty root node with the node we finished with and
+        //  set the number of records in the btree.
+        //
+        free_btree_node ( btree, cvtToAddr ( btree, btree->root ) );
+
+        btree->root  = cvtToOffset ( btree, nodes[0] );
+        btree->count = count;
+    }
+    //
+    //  Release the btree data structure lock.
+    //
+    BTREE_UNLOCK
+
+bulkLoadExit:
+
+    //
+    //  Go free all of the working storage we used.
+    //
+    free ( pool );
+    free ( nodes );
+    free ( separators );
+
+    return status;
+}
+
+
 /*!----------------------------------------------------------------------------
 
     g e t _ m a x _ k e y _ p o s
@@ -1487,15 +1876,10 @@ static bt_node_t* merge_siblings ( btree_t*     btree,
     //
     moveRecords ( btree, rightChild, 0, leftChild, leftChild->keysInUse,
                   rightChild->keysInUse );
-    //
-    //  Increment the keysInUse by the number of records we just moved from
-    //  the right child plus one extra for the parent node that we moved down.
-    //
-    leftChild->keysInUse += rightChild->keysInUse;
-
     //
     //  If this is not a leaf node, move the child pointers from the right
-    //  child into the left child.
+    //  child into the left child.  They go immediately after the child
+    //  pointer that is to the right of the record that came from the parent.
     //
     if ( ! isLeaf ( leftChild ) )
     {
@@ -1514,6 +1898,12 @@ static bt_node_t* merge_siblings ( btree_t*     btree,
             getChildPtr ( btree, rightChild, i )->parent = newParent;
         }
     }
+    //
+    //  Increment the keysInUse by the number of records we just moved from
+    //  the right child (the record from the parent was counted above).
+    //
+    leftChild->keysInUse += rightChild->keysInUse;
+
     //
     //  If the parent node is not empty, now that we moved the specified data
     //  record from it to the new merged node...
@@ -1530,9 +1920,11 @@ static bt_node_t* merge_siblings ( btree_t*     btree,
         //  left in the parent node to close up the gap left when we moved the
         //  data record out to the leftChild.
         //
-        moveRecords ( btree, parent, index+1, parent, index, parent->keysInUse );
+        moveRecords ( btree, parent, index+1, parent, index,
+                      parent->keysInUse - index );
 
-        moveChildren ( btree, parent, index+2, parent, index+1, parent->keysInUse );
+        moveChildren ( btree, parent, index+2, parent, index+1,
+                       parent->keysInUse - index );
     }
     //
     //  If the parent node is now empty, it must be the root node so make the
@@ -1617,6 +2009,15 @@ static void move_key ( btree_t* btree, bt_node_t* node, unsigned int index,
         //
         copyChild ( btree, rchild, 0, lchild, lchild->keysInUse + 1 );
 
+        //
+        //  Make the parent pointer in the subtree that we just moved point to
+        //  the left child now.
+        //
+        if ( ! isLeaf ( lchild ) )
+        {
+            getChildPtr ( btree, lchild, lchild->keysInUse + 1 )->parent =
+                cvtToOffset ( btree, lchild );
+        }
         //
         //  Increment the number of keys in use in the left child node.
         //
@@ -1649,10 +2050,11 @@ static void move_key ( btree_t* btree, bt_node_t* node, unsigned int index,
         //
         //  Move the data records and child pointers all one position to the
         //  right (high end) of the node to make room for a new data record at
-        //  index 0.
+        //  index 0.  Note that there is one more child pointer than there
+        //  are data records.
         //
-        moveRecords  ( btree, rchild, 0, rchild, 1, rchild->keysInUse - 1 );
-        moveChildren ( btree, rchild, 0, rchild, 1, rchild->keysInUse );
+        moveRecords  ( btree, rchild, 0, rchild, 1, rchild->keysInUse );
+        moveChildren ( btree, rchild, 0, rchild, 1, rchild->keysInUse + 1 );
 
         //
         //  Copy the data record in the parent node at the specified index
@@ -1666,6 +2068,16 @@ static void move_key ( btree_t* btree, bt_node_t* node, unsigned int index,
         //
         copyChild ( btree, lchild, lchild->keysInUse, rchild, 0 );
 
+        //
+        //  Make the parent pointer in the subtree that we just moved point to
+        //  the right child now.
+        //
+        if ( ! isLeaf ( rchild ) )
+        {
+            getChildPtr ( btree, rchild, 0 )->parent =
+                cvtToOffset ( btree, rchild );
+        }
+
         //
         //  Copy the left subtree pointers from the left child to the
         //  parent node at the specified index.
@@ -1763,6 +2175,7 @@ static int btree_delete_subtree ( btree_t* btree, bt_node_t* subtree, void* data
     bt_node_t*   parent;
     nodePosition sub_nodePosition;
     nodePosition nodePosition;
+    unsigned long prefix = btree_key_prefix ( btree, data );
 
     BLOG ( "In btree_delete_subtree\n" );
 
@@ -1795,22 +2208,7 @@ del_loop:
         //  in use in this node, i == node->keysInUse and we descend into the
         //  right child of the largest key in the node
         //
-        i = 0;
-        while ( i < node->keysInUse )
-        {
-            diff = btree_compare_function ( btree, data,
-                                            getDataRecord ( btree, node, i ) );
-            //
-            //  If we found a key that is less than (or equal to) the one we
-            //  are looking for, just break out of
-            //  the loop.
-            //
-            if ( diff <= 0 )
-            {
-                break;
-            }
-            i++;
-        }
+        i = searchNode ( btree, data, prefix, node, &diff );
         //
         //  Save the index value of this location.
         //
@@ -2039,7 +2437,7 @@ del_loop:
             //  Go delete the record that we just moved up into our node.
             //
             btree_delete_subtree ( btree, getLeftChild ( btree, node, index ),
-                                   getDataAddress ( btree, node, index) );
+                                   getDataRecord ( btree, node, index ) );
             //
             //  If the node we found is not a leaf, issue and error message.
             //  TODO: Note that this should be a more meaningful message!
@@ -2160,10 +2558,11 @@ int btree_delete ( btree_t* btree, void* data )
 */
 nodePosition get_btree_node ( btree_t* btree, void* key )
 {
-    nodePosition nodePosition = { 0, 0 };
-    bt_node_t*   node;
-    unsigned int i;
-    int          diff;
+    nodePosition  nodePosition = { 0, 0 };
+    bt_node_t*    node;
+    unsigned int  i;
+    int           diff;
+    unsigned long prefix = btree_key_prefix ( btree, key );
 
     BLOG ( "In get_btree_node\n" );
 
@@ -2178,41 +2577,20 @@ nodePosition get_btree_node ( btree_t* btree, void* key )
     while ( true )
     {
         //
-        //  Initialize our position in this node to the first record of the
-        //  node.
+        //  Search the records in this node for the first record that is
+        //  equal to or larger than the target...
         //
-        i = 0;
+        i = searchNode ( btree, key, prefix, node, &diff );
 
         //
-        //  Search the records in this node beginning from the start until
-        //  we find a record that is equal to or larger than the target...
+        //  If the record that we stopped on matches our target then return
+        //  it to the caller.
         //
-        while ( i < node->keysInUse )
+        if ( diff == 0 )
         {
-            //
-            //  Go compare the target with the current data record.
-            //
-            diff = btree_compare_function ( btree, key,
-                                            getDataRecord ( btree, node, i) );
-            //
-            //  If the comparison results in a value < 0 then we are done so
-            //  just break out of this loop.
-            //
-            if ( diff < 0 )
-            {
-                break;
-            }
-            //
-            //  If the record that we stopped on matches our target then return it
-            //  to the caller.
-            //
-            if ( diff == 0 )
-            {
-                nodePosition.node  = node;
-                nodePosition.index = i;
-                return nodePosition;
-            }
-            i++;
+            nodePosition.node  = node;
+            nodePosition.index = i;
+            return nodePosition;
         }
         //
         //  If the node is a leaf and if we did not find the target in it then
@@ -2590,9 +2968,24 @@ void btree_traverse ( btree_t* btree, traverseFunc traverseCB )
 -----------------------------------------------------------------------------*/
 
 
-/*!----------------------------------------------------------------------------
-
-    b t r e e _ i t e r a t o r _ n e w
+//
+//  Initialize the fields of an iterator (in either the caller's storage or
+//  storage that we allocated) so that it is not positioned anywhere yet.
+//
+static inline void btree_iterator_init ( btree_iter iter,
+                                         btree_t*   btree,
+                                         void*      key )
+{
+    iter->btree = btree;
+    iter->key   = key;
+    iter->node  = 0;
+    iter->index = 0;
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ i t e r a t o r _ n e w
 
     @brief Allocate and initialize a new iterator object.
 
@@ -2627,10 +3020,7 @@ static btree_iter btree_iterator_new ( btree_t* btree, void* key )
         //
         //  Initialize the fields of the iterator.
         //
-        iter->btree = btree;
-        iter->key   = key;
-        iter->node  = 0;
-        iter->index = 0;
+        btree_iterator_init ( iter, btree, key );
     }
     //
     //  Return the iterator to the caller.
@@ -2641,69 +3031,56 @@ static btree_iter btree_iterator_new ( btree_t* btree, void* key )
 
 /*!----------------------------------------------------------------------------
 
-    b t r e e _ f i n d
+    b t r e e _ f i n d _ i n t o
 
-    @brief Position an iterator at the specified key location.
+    @brief Position a caller supplied iterator at the specified key location.
 
-    The btree_find function is similar to the btree_search function except
-    that it will find the smallest key that is greater than or equal to the
-    specified value (rather than just the key that is equal to the specified
-    value).
-
-    This function is designed to be used for forward iterations using the
-    iter->next function to initialize the user's iterator to the beginning of
-    the forward range of values the user wishes to find.
+    The btree_find_into function is identical to the btree_find function
+    except that the iterator is stored in the structure supplied by the
+    caller (which will usually be a local variable) instead of one that is
+    allocated from the heap.  This allows the btree to be searched without
+    any memory allocations.
 
-    If the caller attempts to position the iterator past the end of the given
-    btree, a null iterator will be returned.
+    If the caller attempts to position the iterator past the end of the
+    given btree, the iterator will be positioned at the end (see
+    btree_iter_at_end).
 
-    The iterator returned must be disposed of when the user has finished
-    with it by calling the btree_iter_cleanup function.  If this is not done,
-    there will be a memory leak in the user's program.
+    The iterator does not need to be disposed of with btree_iter_cleanup
+    since it does not own any resources.
 
     @param[in] btree - The address of the btree object to be operated on.
     @param[in] key - The address of the user's data object to be found in the
                      tree.
+    @param[out] iter - The address of the iterator to be positioned.
 
-    @return A btree_iter object
+    @return The iterator supplied by the caller.
 
 -----------------------------------------------------------------------------*/
-btree_iter btree_find ( btree_t* btree, void* key )
+btree_iter btree_find_into ( btree_t* btree, void* key, btree_iter iter )
 {
-    btree_iter iter;
-
-    BLOG ( "In btree_find: btree[%p], key[%p]\n", btree, key );
+    BLOG ( "In btree_find_into: btree[%p], key[%p]\n", btree, key );
 
     PRINT_BTREE ( btree, NULL );
 
-    bt_node_t* node  = 0;
-    int        diff  = 0;
-    int        i     = 0;
-    int        index = 0;
+    bt_node_t*    node   = 0;
+    int           diff   = 0;
+    int           i      = 0;
+    int           index  = 0;
+    unsigned long prefix = btree_key_prefix ( btree, key );
 
     PRINT_DATA ( "  Looking up key:  ", key );
 
     //
-    //  Obtain the data lock to make sure no one else is using the btree data
-    //  structures.
-    //
-    BTREE_LOCK
-
-    //
-    //  Go allocate and initialize a new iterator object.
+    //  Initialize the caller's iterator so that it is not positioned
+    //  anywhere yet.
     //
-    iter = btree_iterator_new ( btree, key );
+    btree_iterator_init ( iter, btree, key );
 
     //
-    //  If we were not able to allocate a new iterator, report the error and
-    //  return a NULL iterator to the caller.
+    //  Obtain the data lock to make sure no one else is using the btree data
+    //  structures.
     //
-    if ( iter == NULL )
-    {
-        printf ( "Error: Unable to allocate new iterator: %d[%s]\n", errno,
-                 strerror ( errno ) );
-        goto findExit;
-    }
+    BTREE_LOCK
     //
     //  Start at the root of the tree...
     //
@@ -2714,54 +3091,24 @@ btree_iter btree_find ( btree_t* btree, void* key )
     //
     while ( true )
     {
-        //
-        //  Initialize our position in this node to the first record of the
-        //  node.  We will be searching the node from beginning to end.
-        //
-        i = 0;
-
-        PRINT_DATA ( "  Current node is: ", getDataRecord ( btree, node, i ) );
+        PRINT_DATA ( "  Current node is: ", getDataRecord ( btree, node, 0 ) );
 
         //
-        //  Search the records in this node beginning from the start until we
-        //  find a record that is less than the target...
+        //  Search the records in this node for the first record that is
+        //  greater than or equal to the target.  Note that this diff value
+        //  cannot be used as a numeric "goodness" indicator because it is
+        //  dependent on how the user has defined the comparison operator for
+        //  this btree.  The only thing that can be tested is the sign of this
+        //  value.
         //
-        while ( i < node->keysInUse )
-        {
-            //
-            //  Save this node index for later processing.  Note that we do
-            //  this because the value of "i" may or may not have been
-            //  incremented past the end of the records array at the end of
-            //  this loop depending on whether the loop terminates or we take
-            //  an early out via the break condition.
-            //
-            index = i;
-
-            //
-            //  Go compare the target with the current data record and get the
-            //  difference.  Note that this diff value cannot be used as a
-            //  numeric "goodness" indicator because it is dependent on how
-            //  the user has defined the comparison operator for this btree.
-            //  The only thing that can be tested is the sign of this value.
-            //
-            diff = btree_compare_function ( btree, key,
-                                            getDataRecord ( btree, node, i ) );
-
-            BLOG ( "  Searching node at %d, diff: %d\n", i, diff );
+        //  If every record in the node is less than the target, the position
+        //  we want is the last record in the node (whose right child is where
+        //  the search continues).
+        //
+        i = searchNode ( btree, key, prefix, node, &diff );
+        index = diff > 0 ? i - 1 : i;
 
-            //
-            //  If the record that we are looking at is less than or equal to
-            //  our target then quit looking in this node.
-            //
-            if ( diff <= 0 )
-            {
-                break;
-            }
-            //
-            //  Increment our index position and continue.
-            //
-            ++i;
-        }
+        BLOG ( "  Searching node at %d, diff: %d\n", index, diff );
         //
         //  If we found an exact match to our key, just stop and return the
         //  iterator to the caller.
@@ -2854,20 +3201,13 @@ btree_iter btree_find ( btree_t* btree, void* key )
         }
     }
     //
-    //  We have finished our search.  If nothing in the tree is less than or
-    //  equal to our target value then we need to return an "end" condition to
-    //  the caller by returning a NULL iterator.
+    //  We have finished our search.  If nothing in the tree is greater than or
+    //  equal to our target value then the iterator is left at the "end"
+    //  position (i.e. its node is NULL).
     //
     if ( iter->node == 0 )
     {
         BLOG ( "  Found iterator end()\n" );
-
-        //
-        //  Go free up the memory allocated to our iterator since we won't be
-        //  returning that value to the caller.
-        //
-        free ( iter );
-        iter = NULL;
     }
     //
     //  If we have a valid iterator...
@@ -2883,8 +3223,6 @@ btree_iter btree_find ( btree_t* btree, void* key )
         //
         iter->key = getDataRecord ( btree, iter->node, iter->index );
     }
-findExit:
-
     //
     //  Release the btree data structure lock.
     //
@@ -2899,25 +3237,26 @@ findExit:
 
 /*!----------------------------------------------------------------------------
 
-    b t r e e _ r f i n d
+    b t r e e _ f i n d
 
     @brief Position an iterator at the specified key location.
 
-    The btree_rfind function is similar to the btree_search function except
-    that it will find the largest key that is less than or equal to the
+    The btree_find function is similar to the btree_search function except
+    that it will find the smallest key that is greater than or equal to the
     specified value (rather than just the key that is equal to the specified
     value).
 
-    This function is designed to be used for reverse iterations using the
-    iter->previous function to initialize the user's iterator to the beginning
-    of the reverse range of values the user wishes to find.
+    This function is designed to be used for forward iterations using the
+    iter->next function to initialize the user's iterator to the beginning of
+    the forward range of values the user wishes to find.
 
-    If the caller attempts to position the iterator past the beginning of the
-    given btree, a null iterator will be returned.
+    If the caller attempts to position the iterator past the end of the given
+    btree, a null iterator will be returned.
 
     The iterator returned must be disposed of when the user has finished
     with it by calling the btree_iter_cleanup function.  If this is not done,
-    there will be a memory leak in the user's program.
+    there will be a memory leak in the user's program.  Callers that do not
+    want the iterator allocated from the heap should use btree_find_into.
 
     @param[in] btree - The address of the btree object to be operated on.
     @param[in] key - The address of the user's data object to be found in the
@@ -2926,44 +3265,87 @@ findExit:
     @return A btree_iter object
 
 -----------------------------------------------------------------------------*/
-btree_iter btree_rfind ( btree_t* btree, void* key )
+btree_iter btree_find ( btree_t* btree, void* key )
 {
-    btree_iter iter;
-
-    BLOG ( "In btree_rfind: btree[%p], key[%p]\n", btree, key );
-
-    bt_node_t* node  = 0;
-    int        diff  = 0;
-    int        i     = 0;
-    int        index = 0;
-
-    PRINT_DATA ( "  Looking up key:  ", key );
-
-    //
-    //  Obtain the data lock to make sure no one else is using the btree data
-    //  structures.
-    //
-    BTREE_LOCK
+    BLOG ( "In btree_find: btree[%p], key[%p]\n", btree, key );
 
     //
     //  Go allocate and initialize a new iterator object.
     //
-    iter = btree_iterator_new ( btree, key );
+    btree_iter iter = btree_iterator_new ( btree, key );
 
     //
     //  If we were not able to allocate a new iterator, report the error and
     //  return a NULL iterator to the caller.
     //
-    //  TODO: Get rid of the goto by making the body of the function the
-    //  "else" clause.
-    //
     if ( iter == NULL )
     {
-        errno = ENOMEM;
         printf ( "Error: Unable to allocate new iterator: %d[%s]\n", errno,
                  strerror ( errno ) );
-        goto rfindExit;
+        return NULL;
+    }
+    //
+    //  Go position the iterator.  If it ends up at the "end" of the btree,
+    //  free it and return a NULL iterator to the caller.
+    //
+    if ( btree_iter_at_end ( btree_find_into ( btree, key, iter ) ) )
+    {
+        free ( iter );
+        iter = NULL;
     }
+    return iter;
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ r f i n d _ i n t o
+
+    @brief Position a caller supplied iterator at the specified key location.
+
+    The btree_rfind_into function is identical to the btree_rfind function
+    except that the iterator is stored in the structure supplied by the
+    caller (which will usually be a local variable) instead of one that is
+    allocated from the heap.  This allows the btree to be searched without
+    any memory allocations.
+
+    If the caller attempts to position the iterator past the beginning of the
+    given btree, the iterator will be positioned at the end (see
+    btree_iter_at_end).
+
+    The iterator does not need to be disposed of with btree_iter_cleanup
+    since it does not own any resources.
+
+    @param[in] btree - The address of the btree object to be operated on.
+    @param[in] key - The address of the user's data object to be found in the
+                     tree.
+    @param[out] iter - The address of the iterator to be positioned.
+
+    @return The iterator supplied by the caller.
+
+-----------------------------------------------------------------------------*/
+btree_iter btree_rfind_into ( btree_t* btree, void* key, btree_iter iter )
+{
+    BLOG ( "In btree_rfind_into: btree[%p], key[%p]\n", btree, key );
+
+    bt_node_t*    node   = 0;
+    int           diff   = 0;
+    int           index  = 0;
+    unsigned long prefix = btree_key_prefix ( btree, key );
+
+    PRINT_DATA ( "  Looking up key:  ", key );
+
+    //
+    //  Initialize the caller's iterator so that it is not positioned
+    //  anywhere yet.
+    //
+    btree_iterator_init ( iter, btree, key );
+
+    //
+    //  Obtain the data lock to make sure no one else is using the btree data
+    //  structures.
+    //
+    BTREE_LOCK
     //
     //  Start at the root of the tree...
     //
@@ -2974,58 +3356,29 @@ btree_iter btree_rfind ( btree_t* btree, void* key )
     //
     while ( true )
     {
-        //
-        //  Initialize our position in this node to the last record of the
-        //  node.  We will be searching the node backward from the end to the
-        //  beginning.
-        //
-        i = node->keysInUse - 1;
-
-        PRINT_DATA ( "  Current node is: ", getDataRecord ( btree, node, i ) );
+        PRINT_DATA ( "  Current node is: ",
+                     getDataRecord ( btree, node, node->keysInUse - 1 ) );
 
         //
-        //  Search the records in this node backwards from the end until
-        //  we find a record that is less than the target...
+        //  Search the records in this node for the first record that is
+        //  greater than or equal to the target.  Note that this diff value
+        //  cannot be used as a numeric "goodness" indicator because it is
+        //  dependent on how the user has defined the comparison operator for
+        //  this btree.  The only thing that can be tested is the sign of this
+        //  value.
         //
-        while ( i >= 0 )
+        //  If that record is not an exact match, the position we want is the
+        //  record just before it, which is less than the target.  If there is
+        //  no such record, the position is the first record in the node
+        //  (whose left child is where the search continues).
+        //
+        index = searchNode ( btree, key, prefix, node, &diff );
+        if ( diff != 0 )
         {
-            //
-            //  Save this node index for later processing.  Note that we do
-            //  this because the value of "i" may or may not have been
-            //  decremented past the beginning of the records array when this
-            //  loop terminates depending on whether the loop terminates or we
-            //  take an early out via the break condition.
-            //
-            index = i;
-
-            //
-            //  Go compare the target with the current data record and get the
-            //  difference.  Note that this diff value cannot be used as a
-            //  numeric "goodness" indicator because it is dependent on how
-            //  the user has defined the comparison operator for this btree.
-            //  The only thing that can be tested is the sign of this value.
-            //
-            diff = btree_compare_function ( btree, key,
-                                            getDataRecord ( btree, node, i ) );
-
-            BLOG ( "  Searching node at %d, diff: %d\n", i, diff );
-
-            //
-            //  If the record that we are looking at is greater than or equal
-            //  to our target then quit looking in this node.
-            //
-            if ( diff >= 0 )
-            {
-                break;
-            }
-            //
-            //  Decrement our index position and continue.
-            //
-            //  TODO: Try moving this dec up before the prev. test - That
-            //  might eliminate the need for the index variable.
-            //
-            --i;
+            diff  = index > 0 ? 1 : -1;
+            index = index > 0 ? index - 1 : 0;
         }
+        BLOG ( "  Searching node at %d, diff: %d\n", index, diff );
         //
         //  If we found an exact match to our key, just stop and return the
         //  iterator to the caller.
@@ -3118,19 +3471,12 @@ btree_iter btree_rfind ( btree_t* btree, void* key )
     }
     //
     //  We have finished our search.  If nothing in the tree is less than or
-    //  equal to our target value then we need to return an "end" condition to
-    //  the caller by returning a NULL iterator.
+    //  equal to our target value then the iterator is left at the "end"
+    //  position (i.e. its node is NULL).
     //
     if ( iter->node == 0 )
     {
         BLOG ( "  Found iterator end()\n" );
-
-        //
-        //  Go free up the memory allocated to our iterator since we won't be
-        //  returning that value to the caller.
-        //
-        free ( iter );
-        iter = NULL;
     }
     //
     //  If we have a valid iterator...
@@ -3146,8 +3492,6 @@ btree_iter btree_rfind ( btree_t* btree, void* key )
         //
         iter->key = getDataRecord ( btree, iter->node, iter->index );
     }
-rfindExit:
-
     //
     //  Release the btree data structure lock.
     //
@@ -3160,6 +3504,69 @@ rfindExit:
 }
 
 
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ r f i n d
+
+    @brief Position an iterator at the specified key location.
+
+    The btree_rfind function is similar to the btree_search function except
+    that it will find the largest key that is less than or equal to the
+    specified value (rather than just the key that is equal to the specified
+    value).
+
+    This function is designed to be used for reverse iterations using the
+    iter->previous function to initialize the user's iterator to the beginning
+    of the reverse range of values the user wishes to find.
+
+    If the caller attempts to position the iterator past the beginning of the
+    given btree, a null iterator will be returned.
+
+    The iterator returned must be disposed of when the user has finished
+    with it by calling the btree_iter_cleanup function.  If this is not done,
+    there will be a memory leak in the user's program.  Callers that do not
+    want the iterator allocated from the heap should use btree_rfind_into.
+
+    @param[in] btree - The address of the btree object to be operated on.
+    @param[in] key - The address of the user's data object to be found in the
+                     tree.
+
+    @return A btree_iter object
+
+-----------------------------------------------------------------------------*/
+btree_iter btree_rfind ( btree_t* btree, void* key )
+{
+    BLOG ( "In btree_rfind: btree[%p], key[%p]\n", btree, key );
+
+    //
+    //  Go allocate and initialize a new iterator object.
+    //
+    btree_iter iter = btree_iterator_new ( btree, key );
+
+    //
+    //  If we were not able to allocate a new iterator, report the error and
+    //  return a NULL iterator to the caller.
+    //
+    if ( iter == NULL )
+    {
+        errno = ENOMEM;
+        printf ( "Error: Unable to allocate new iterator: %d[%s]\n", errno,
+                 strerror ( errno ) );
+        return NULL;
+    }
+    //
+    //  Go position the iterator.  If it ends up at the "end" of the btree,
+    //  free it and return a NULL iterator to the caller.
+    //
+    if ( btree_iter_at_end ( btree_rfind_into ( btree, key, iter ) ) )
+    {
+        free ( iter );
+        iter = NULL;
+    }
+    return iter;
+}
+
+
 /*!----------------------------------------------------------------------------
 
     b t r e e _ i t e r _ b e g i n
@@ -3358,6 +3765,7 @@ void btree_iter_next ( btree_iter iter )
     int          i     = iter->index;
     int          index = 0;
     nodePosition nodePos;
+    unsigned long prefix = btree_key_prefix ( btree, key );
 
     //
     //  Print out the target key that we are starting at.
@@ -3380,39 +3788,31 @@ void btree_iter_next ( btree_iter iter )
         //
         if ( isLeaf ( node )  )
         {
-            //
-            //  Loop through the records in this node until we reach the end
-            //  of the node...
-            //
-            i = 0;
             PRINT_DATA ( "  Current leaf node is: ",
-                         getDataRecord ( btree, node, i ) );
+                         getDataRecord ( btree, node, 0 ) );
 
-            while ( i < node->keysInUse )
+            //
+            //  Search the records in this node for the first one that is
+            //  larger than the target.
+            //
+            i = searchNode ( btree, key, prefix, node, &diff );
+            if ( diff == 0 )
             {
-                //
-                //  Compare the current record with our target.
-                //
-                index = i;
-                diff = btree_compare_function ( btree, key,
-                                                getDataRecord ( btree, node, i ) );
-
-                BLOG ( "  Searching node at %d, diff: %d\n", i, diff );
+                i++;
+            }
+            BLOG ( "  Searching node at %d, diff: %d\n", i, diff );
 
-                //
-                //  If the current record is larger than the target we have
-                //  found the "next" record in the btree so return it to the
-                //  caller.
-                //
-                if ( diff < 0 )
-                {
-                    BLOG ( "  Target record found.\n" );
-                    iter->index = i;
-                    iter->node  = node;
-                    iter->key   = getDataRecord ( btree, node, i );
-                    goto nextExit;
-                }
-                ++i;
+            //
+            //  If there is such a record, we have found the "next" record in
+            //  the btree so return it to the caller.
+            //
+            if ( i < node->keysInUse )
+            {
+                BLOG ( "  Target record found.\n" );
+                iter->index = i;
+                iter->node  = node;
+                iter->key   = getDataRecord ( btree, node, i );
+                goto nextExit;
             }
             //
             //  If none of the records in this node are larger than the
@@ -3461,8 +3861,7 @@ void btree_iter_next ( btree_iter iter )
             //  Compare the current record with the target record.
             //
             index = i;
-            diff = btree_compare_function ( btree, key,
-                                            getDataRecord ( btree, node, i ) );
+            diff = compareRecord ( btree, key, prefix, node, i );
 
             BLOG ( "  Searching node at %d, diff: %d\n", i, diff );
 
@@ -3483,7 +3882,7 @@ void btree_iter_next ( btree_iter iter )
                 //  the "next" record.
                 //
                 dataValue = getDataRecord ( btree, nodePos.node, nodePos.index );
-                diff = btree_compare_function ( btree, key, dataValue );
+                diff = compareRecord ( btree, key, prefix, nodePos.node, nodePos.index );
                 if ( diff < 0 )
                 {
                     //
@@ -3524,7 +3923,7 @@ void btree_iter_next ( btree_iter iter )
             //
             nodePos = get_max_key_pos ( btree, getLeftChild ( btree, node, i ) );
             dataValue = getDataRecord ( btree, nodePos.node, nodePos.index );
-            diff = btree_compare_function ( btree, key, dataValue );
+            diff = compareRecord ( btree, key, prefix, nodePos.node, nodePos.index );
 
             //
             //  If there are no records in the right subtree that are larger
@@ -3571,7 +3970,7 @@ void btree_iter_next ( btree_iter iter )
                 //  will return that to the caller.
                 //
                 dataValue = getDataRecord ( btree, nodePos.node, nodePos.index );
-                diff = btree_compare_function ( btree, key, dataValue );
+                diff = compareRecord ( btree, key, prefix, nodePos.node, nodePos.index );
                 if ( diff < 0 )
                 {
                     PRINT_DATA ( "    Found: ",
@@ -3653,6 +4052,7 @@ void btree_iter_previous ( btree_iter iter )
     int          diff  = 0;
     int          i     = iter->index;
     nodePosition nodePos;
+    unsigned long prefix = btree_key_prefix ( btree, key );
 
     //
     //  Print out the target key that we are starting at.
@@ -3687,8 +4087,7 @@ void btree_iter_previous ( btree_iter iter )
                 //
                 //  Compare the current record with our target.
                 //
-                diff = btree_compare_function ( btree, key,
-                                                getDataRecord ( btree, node, i ) );
+                diff = compareRecord ( btree, key, prefix, node, i );
 
                 BLOG ( "  Searching node at %d, diff: %d\n", i, diff );
 
@@ -3754,7 +4153,7 @@ void btree_iter_previous ( btree_iter iter )
             //  Compare the current record with the target record.
             //
             dataValue = getDataRecord ( btree, node, i );
-            diff = btree_compare_function ( btree, key, dataValue );
+            diff = compareRecord ( btree, key, prefix, node, i );
 
             BLOG ( "  Searching node at index %d, diff: %d\n", i, diff );
 
@@ -3774,7 +4173,7 @@ void btree_iter_previous ( btree_iter iter )
                 BLOG ( "  Found the maximum key in the right child at %p[%d].\n",
                       nodePos.node, nodePos.index );
 
-                diff = btree_compare_function ( btree, key, dataValue );
+                diff = compareRecord ( btree, key, prefix, nodePos.node, nodePos.index );
                 if ( diff > 0 )
                 {
                     //
@@ -3812,7 +4211,7 @@ void btree_iter_previous ( btree_iter iter )
         i = 0;
         nodePos = get_max_key_pos ( btree, getLeftChild ( btree, node, i ) );
         dataValue = getDataRecord ( btree, nodePos.node, nodePos.index );
-        diff = btree_compare_function ( btree, key, dataValue );
+        diff = compareRecord ( btree, key, prefix, nodePos.node, nodePos.index );
 
         //
         //  If there are no records in the left subtree that are smaller
@@ -3994,6 +4393,9 @@ void* btree_iter_data ( btree_iter iter )
 
     Note: Iterators are allocated with the system malloc function so they get
     freed with "free" rather than the shared memory deallocator.
+    Iterators that were positioned in the caller's storage with one of the
+    "_into" functions (e.g. btree_find_into) must not be passed to this
+    function.
 
     @param[in] iter - The current btree iterator.
 
@@ -4028,14 +4430,274 @@ void btree_iter_cleanup ( btree_iter iter )
 }
 
 
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ s e l e c t _ c o m p a r e
+
+    @brief Select the comparison routine for the keys of a btree.
+
+    This function will examine the key definition of the given btree and if
+    it matches one of the key shapes that has a specialized comparison
+    routine (see compare_types), store the type of that routine and the
+    offsets of the key fields in the btree.  Otherwise the generic routine
+    that interprets the key definition will be used.
+
+    @param[in] btree - The address of the btree being initialized.
+    @param[in] keyDefinition - The address of the key definition.
+
+    @return None
+
+-----------------------------------------------------------------------------*/
+static void btree_select_compare ( btree_t*       btree,
+                                   btree_key_def* keyDefinition )
+{
+    btree_field_def* fields = keyDefinition->btreeFields;
+
+    btree->keyCompare = ct_generic;
+    btree->keyOffset1 = 0;
+    btree->keyOffset2 = 0;
+
+    //
+    //  If the key consists of a single field...
+    //
+    if ( keyDefinition->fieldCount == 1 )
+    {
+        switch ( fields[0].type )
+        {
+          case ft_int:
+            btree->keyCompare = ct_int;
+            break;
+
+          case ft_ulong:
+            btree->keyCompare = ct_ulong;
+            break;
+
+          case ft_string:
+            btree->keyCompare = ct_string;
+            break;
+
+          default:
+            break;
+        }
+    }
+    //
+    //  If the key consists of two fields...
+    //
+    else if ( keyDefinition->fieldCount == 2 )
+    {
+        if ( fields[0].type == ft_int && fields[1].type == ft_int )
+        {
+            btree->keyCompare = ct_int_int;
+        }
+        else if ( fields[0].type == ft_int && fields[1].type == ft_string )
+        {
+            btree->keyCompare = ct_int_string;
+        }
+        else if ( fields[0].type == ft_ulong && fields[1].type == ft_ulong )
+        {
+            btree->keyCompare = ct_ulong_ulong;
+        }
+        btree->keyOffset2 = fields[1].offset;
+    }
+    btree->keyOffset1 = fields[0].offset;
+
+    //
+    //  Select the kind of key prefix that will be cached in the nodes.  The
+    //  integer keys fit completely in a prefix so comparing the prefixes is
+    //  the whole comparison.  The others will only be partially represented
+    //  by their prefix so equal prefixes still require a record comparison.
+    //
+    btree->keyPrefix = kp_none;
+
+#ifdef BTREE_KEY_PREFIXES
+    switch ( btree->keyCompare )
+    {
+      case ct_int:
+      case ct_int_int:
+      case ct_ulong:
+        btree->keyPrefix = kp_complete;
+        break;
+
+      case ct_int_string:
+      case ct_ulong_ulong:
+      case ct_string:
+        btree->keyPrefix = kp_partial;
+        break;
+
+      default:
+        break;
+    }
+#endif
+
+    return;
+}
+
+
+//
+//  Define the macros used by the specialized comparison routines to get a
+//  key field of a given type from a user structure and to compare two values
+//  without the overflow that a subtraction can cause.
+//
+#define KEY_FIELD( type, data, offset ) ( *(type*)( (char*)(data) + (offset) ) )
+
+#define COMPARE_VALUES( value1, value2 ) \
+    ( ( (value1) > (value2) ) - ( (value1) < (value2) ) )
+
+#define COMPARE_FIELDS( type, data1, data2, offset )  \
+    COMPARE_VALUES ( KEY_FIELD ( type, data1, offset ), \
+                     KEY_FIELD ( type, data2, offset ) )
+
+#define COMPARE_STRINGS( data1, data2, offset )                           \
+    strncmp ( toAddress ( KEY_FIELD ( offset_t, data1, offset ) ),        \
+              toAddress ( KEY_FIELD ( offset_t, data2, offset ) ), 256 )
+
+
 /*!----------------------------------------------------------------------------
 
     b t r e e _ c o m p a r e _ f u n c t i o n
 
     @brief Compare 2 user defined data structures.
 
+    This function will compare 2 user defined data structures with the
+    comparison routine that was selected for the given btree when it was
+    created (see btree_select_compare).
+
+    @param[in] btree - The address of the btree to be compared.
+    @param[in] data1 - The address of the first user structure to compare.
+    @param[in] data2 - The address of the second user structutre to compare.
+
+    @return The result of comparing the two data structures.
+
+-----------------------------------------------------------------------------*/
+static int btree_compare_function ( btree_t* btree, void* data1, void* data2 )
+{
+    int diff;
+
+    switch ( btree->keyCompare )
+    {
+      case ct_int:
+        return COMPARE_FIELDS ( int, data1, data2, btree->keyOffset1 );
+
+      case ct_int_int:
+        diff = COMPARE_FIELDS ( int, data1, data2, btree->keyOffset1 );
+        if ( diff != 0 )
+        {
+            return diff;
+        }
+        return COMPARE_FIELDS ( int, data1, data2, btree->keyOffset2 );
+
+      case ct_int_string:
+        diff = COMPARE_FIELDS ( int, data1, data2, btree->keyOffset1 );
+        if ( diff != 0 )
+        {
+            return diff;
+        }
+        return COMPARE_STRINGS ( data1, data2, btree->keyOffset2 );
+
+      case ct_ulong:
+        return COMPARE_FIELDS ( unsigned long, data1, data2,
+                                btree->keyOffset1 );
+
+      case ct_ulong_ulong:
+        diff = COMPARE_FIELDS ( unsigned long, data1, data2,
+                                btree->keyOffset1 );
+        if ( diff != 0 )
+        {
+            return diff;
+        }
+        return COMPARE_FIELDS ( unsigned long, data1, data2,
+                                btree->keyOffset2 );
+
+      case ct_string:
+        return COMPARE_STRINGS ( data1, data2, btree->keyOffset1 );
+
+      default:
+        return btree_compare_fields ( btree, data1, data2 );
+    }
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ k e y _ p r e f i x
+
+    @brief Compute the key prefix of a user defined data structure.
+
+    The key prefix is a 64 bit unsigned value that is built from the key
+    fields of the user structure in such a way that comparing the prefixes of
+    two structures gives the same ordering as the comparison function, except
+    that two different keys may have the same prefix.  The signed integers are
+    biased so they sort correctly as unsigned values and the strings
+    contribute their leading bytes in big endian order.
+
+    @param[in] btree - The address of the btree.
+    @param[in] data - The address of the user structure.
+
+    @return The key prefix of the user structure.
+
+-----------------------------------------------------------------------------*/
+#define INT_PREFIX( value ) \
+    ( (unsigned long)( (unsigned int)(value) ^ 0x80000000u ) )
+
+static unsigned long btree_key_prefix ( btree_t* btree, void* data )
+{
+    unsigned long  prefix = 0;
+    unsigned char* string = 0;
+    int            length = 0;
+    int            i;
+
+    switch ( btree->keyCompare )
+    {
+      case ct_int:
+        return INT_PREFIX ( KEY_FIELD ( int, data, btree->keyOffset1 ) );
+
+      case ct_int_int:
+        return INT_PREFIX ( KEY_FIELD ( int, data, btree->keyOffset1 ) ) << 32 |
+               INT_PREFIX ( KEY_FIELD ( int, data, btree->keyOffset2 ) );
+
+      case ct_int_string:
+        prefix = INT_PREFIX ( KEY_FIELD ( int, data, btree->keyOffset1 ) );
+        string = toAddress ( KEY_FIELD ( offset_t, data, btree->keyOffset2 ) );
+        length = 4;
+        break;
+
+      case ct_ulong:
+      case ct_ulong_ulong:
+        return KEY_FIELD ( unsigned long, data, btree->keyOffset1 );
+
+      case ct_string:
+        string = toAddress ( KEY_FIELD ( offset_t, data, btree->keyOffset1 ) );
+        length = 8;
+        break;
+
+      default:
+        return 0;
+    }
+    //
+    //  Append the leading bytes of the string to the prefix, padding it with
+    //  zeros if the string is shorter than the space available.
+    //
+    for ( i = 0; i < length; ++i )
+    {
+        prefix = ( prefix << 8 ) | *string;
+        if ( *string != 0 )
+        {
+            ++string;
+        }
+    }
+    return prefix;
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    b t r e e _ c o m p a r e _ f i e l d s
+
+    @brief Compare 2 user defined data structures.
+
     This function will compare 2 user defined data structures by using the key
-    definition data structure defined for the given btree.
+    definition data structure defined for the given btree.  It is used for
+    the keys that do not have a specialized comparison routine.
 
     TODO: I've set an arbitrary maximum string length of 256 bytes so I could
     limit the searches using "strncmp".
@@ -4047,7 +4709,7 @@ void btree_iter_cleanup ( btree_iter iter )
     @return The result of comparing the two data structures.
 
 -----------------------------------------------------------------------------*/
-static int btree_compare_function ( btree_t* btree, void* data1, void* data2 )
+static int btree_compare_fields ( btree_t* btree, void* data1, void* data2 )
 {
     int              diff     = 0;
     offset_t         offset   = 0;
@@ -4535,6 +5197,8 @@ static void btree_print_header ( btree_t* btree )
     BLOG ( "        Min Records: %u\n",  btree->min );
     BLOG ( "      Current Count: %u\n",  btree->count );
     BLOG ( "          Root Node: 0x%lx\n", btree->root );
+    BLOG ( "       Compare Type: %u\n", btree->keyCompare );
+    BLOG ( "         Key Prefix: %u\n", btree->keyPrefix );
 
     btree_key_def* keyDefinition = cvtToAddr ( btree, btree->keyDef );
 
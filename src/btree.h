@@ -157,6 +157,9 @@
 //
 //    nodeSize = nodeHeaderSize + 2N * sO + sO
 //
+//  A btree that caches key prefixes in it's nodes adds another N * sO bytes
+//  to each node for the prefixes (see BTREE_NODE_SIZE).
+//
 //  Cormen defines a value that he calls "t" in his equations and refers to it
 //  as the "minimum degree" of the btree defined as:
 //
@@ -238,6 +241,11 @@ typedef void (*printFunc)    ( char* leader, void* dataPtr );
 //  Note that the offsets of the dataRecords and children are actually
 //  calculated at runtime and stored here for easy use.
 //
+//  If the btree caches key prefixes (see prefix_types), the node also
+//  contains an array with the key prefix of each of it's data records after
+//  the children and "keys" is the offset of that array.  Otherwise "keys" is
+//  zero.
+//
 typedef struct bt_node_t
 {
     offset_t     next;        // Pointer used for linked list traversal
@@ -246,10 +254,29 @@ typedef struct bt_node_t
     unsigned int level;       // Level of this node in the btree
     offset_t     dataRecords; // Offset of the Array of data record offsets
     offset_t     children;    // Offset of the Array of link offsets to children
+    offset_t     keys;        // Offset of the Array of key prefixes or 0
 
 }   bt_node_t;
 
 
+//
+//  Define the size of a btree node given the maximum number of records in the
+//  node and whether or not the node caches the key prefixes of the records.
+//
+#define BTREE_NODE_SIZE( maxRecords, keyPrefixes ) \
+(                                                  \
+    sN + ( (maxRecords) * sO ) +                   \
+    ( ( (maxRecords) + 1 ) * sO ) +                \
+    ( (keyPrefixes) ? (maxRecords) * sO : 0 )      \
+)
+
+//
+//  Define the smallest maximum number of records per node (i.e. fanout) that
+//  a btree can be created with.  Smaller values are raised to this one.
+//
+#define BTREE_MIN_RECORD_COUNT ( 3 )
+
+
 //
 //  Define the data structures that specify the type and size of the keys of a
 //  btree.  The "keyDef" data structure consists of an array of "fieldDef"
@@ -350,6 +377,51 @@ typedef struct btree_key_def
 )
 
 
+//
+//  Define the comparison routines that a btree can use to compare it's keys.
+//  When a btree is created, the key definition is examined and if it matches
+//  one of the common key shapes below, the specialized routine for that shape
+//  is selected and it's type is stored in the btree along with the offsets of
+//  the key fields.  The specialized routines compare the key fields directly
+//  without interpreting the key definition.  All other key definitions use
+//  the generic routine that interprets the key definition on every call.
+//
+//  Note that the type is stored rather than the address of the routine
+//  since the btree is in shared memory and the address of a function can be
+//  different in every process.
+//
+typedef enum
+{
+    ct_generic = 0,     // Interpret the key definition
+    ct_int,             // A single int
+    ct_int_int,         // Two ints
+    ct_int_string,      // An int followed by a string
+    ct_ulong,           // A single unsigned long
+    ct_ulong_ulong,     // Two unsigned longs
+    ct_string           // A single string
+
+}   compare_types;
+
+
+//
+//  Define the kinds of key prefixes that a btree can cache in it's nodes.
+//  The specialized key shapes can be reduced to a 64 bit prefix that sorts
+//  the same way the keys do so a search can compare the prefixes that are
+//  stored next to the data record offsets in a node instead of touching the
+//  data records themselves.  A "complete" prefix holds the whole key so two
+//  keys with the same prefix are equal.  A "partial" prefix only holds the
+//  beginning of the key so the data records must be compared when the
+//  prefixes are the same.
+//
+typedef enum
+{
+    kp_none = 0,        // The nodes do not cache key prefixes
+    kp_partial,         // The prefix is the beginning of the key
+    kp_complete         // The prefix is the whole key
+
+}   prefix_types;
+
+
 //
 //  Define the btree definition structure.  In this incarnation of the btree
 //  algorithm, the keys are offsets to a user specified data structure
@@ -367,6 +439,10 @@ typedef struct btree_t
     unsigned int count;      // The total number of records in the btree
     offset_t     root;       // The offset of the root node of the btree
     offset_t     keyDef;     // The offset to the key definition structure
+    unsigned int keyCompare; // The comparison routine for the keys
+    unsigned int keyOffset1; // The offset of the first key field
+    unsigned int keyOffset2; // The offset of the second key field
+    unsigned int keyPrefix;  // The kind of key prefix cached in the nodes
 
 }   btree_t;
 
@@ -414,6 +490,10 @@ extern void     btree_destroy  ( btree_t* btree );
 
 extern int      btree_insert   ( btree_t* btree, void* data );
 
+extern int      btree_bulk_load ( btree_t*     btree,
+                                  void**       records,
+                                  unsigned int count );
+
 extern int      btree_delete   ( btree_t* btree, void* key );
 
 extern void*    btree_get_min  ( btree_t* btree );
@@ -481,6 +561,28 @@ extern btree_iter btree_find ( btree_t* btree, void* key );
 //
 extern btree_iter btree_rfind ( btree_t* btree, void* key );
 
+//
+//  The btree_find_into and btree_rfind_into functions are identical to the
+//  btree_find and btree_rfind functions except that they position an
+//  iterator supplied by the caller (usually a local variable) instead of
+//  allocating one from the heap.  The iterator returned is the one supplied
+//  by the caller and it is positioned at the end if the search fails.  These
+//  iterators must not be passed to btree_iter_cleanup.
+//
+//     Example usage:
+//
+//         btree_iterator_t iterator;
+//
+//         btree_iter iter = btree_find_into ( btree, &record, &iterator );
+//
+extern btree_iter btree_find_into  ( btree_t*   btree,
+                                     void*      key,
+                                     btree_iter iter );
+
+extern btree_iter btree_rfind_into ( btree_t*   btree,
+                                     void*      key,
+                                     btree_iter iter );
+
 //
 //  Position the specified iterator to the first record in the btree.
 //
@@ -21,6 +21,8 @@
 #include <string.h>
 #include <locale.h>
 #include <unistd.h>
+#include <limits.h>
+#include <errno.h>
 
 
 #include "vsi.h"
@@ -158,6 +160,791 @@ void traverseFunction ( char* leader, void* dataPtr )
 }
 
 
+//
+//  The following is the user defined data structure used to test each of the
+//  key shapes that has a specialized comparison routine (see compare_types).
+//  Each key shape uses a different set of these fields as it's key.  The
+//  string is an offset into the shared memory segment as the btree expects.
+//
+typedef struct shapeData
+{
+    int           int1;
+    int           int2;
+    unsigned long ulong1;
+    unsigned long ulong2;
+    offset_t      string;
+
+}   shapeData;
+
+
+//
+//  Define the key shapes to be tested along with the comparison routine and
+//  the kind of key prefix that the btree should select for each of them.
+//
+typedef struct keyShape
+{
+    const char*   name;
+    int           fieldCount;
+    field_types   type1;
+    int           offset1;
+    field_types   type2;
+    int           offset2;
+    compare_types compare;
+    prefix_types  prefix;
+
+}   keyShape;
+
+static const keyShape keyShapes[] =
+{
+    { "int", 1, ft_int, offsetof ( shapeData, int1 ),
+      ft_invalid, 0, ct_int, kp_complete },
+
+    { "int+int", 2, ft_int, offsetof ( shapeData, int1 ),
+      ft_int, offsetof ( shapeData, int2 ), ct_int_int, kp_complete },
+
+    { "int+string", 2, ft_int, offsetof ( shapeData, int1 ),
+      ft_string, offsetof ( shapeData, string ), ct_int_string, kp_partial },
+
+    { "ulong", 1, ft_ulong, offsetof ( shapeData, ulong1 ),
+      ft_invalid, 0, ct_ulong, kp_complete },
+
+    { "ulong+ulong", 2, ft_ulong, offsetof ( shapeData, ulong1 ),
+      ft_ulong, offsetof ( shapeData, ulong2 ), ct_ulong_ulong, kp_partial },
+
+    { "string", 1, ft_string, offsetof ( shapeData, string ),
+      ft_invalid, 0, ct_string, kp_partial }
+};
+
+
+//
+//  Report a failure of one of the key shape tests and quit.
+//
+static void shapeError ( const keyShape* shape, const char* test, int record )
+{
+    printf ( "Error: The %s key shape failed the %s test at record %d\n",
+             shape->name, test, record );
+    exit ( 255 );
+}
+
+
+//
+//  Create the test record with the given index for a key shape.  The keys
+//  are generated so that the records sort in the order of their index.  The
+//  values are chosen to cross the sign boundary of the integers and to give
+//  many records the same key prefix for the shapes that only cache a partial
+//  prefix so that the full comparison routines are exercised as well.
+//
+static shapeData* newShapeRecord ( const keyShape* shape, int n, int count )
+{
+    shapeData* record = sm_malloc ( sizeof(shapeData) );
+    char       name[MAX_NAME_LEN];
+    char*      string;
+
+    memset ( record, 0, sizeof(shapeData) );
+
+    switch ( shape->compare )
+    {
+      case ct_int:
+        record->int1 = n - count / 2;
+        break;
+
+      case ct_int_int:
+        record->int1 = n / 10 - count / 20;
+        record->int2 = n % 10 - 5;
+        break;
+
+      case ct_int_string:
+        record->int1 = n / 100 - 1;
+        break;
+
+      case ct_ulong:
+        record->ulong1 = ( 1UL << 63 ) - count / 2 + n;
+        break;
+
+      case ct_ulong_ulong:
+        record->ulong1 = n / 10;
+        record->ulong2 = ~0UL - 9 + n % 10;
+        break;
+
+      default:
+        break;
+    }
+    if ( shape->compare == ct_int_string )
+    {
+        sprintf ( name, "key%05d", n % 100 );
+    }
+    else
+    {
+        sprintf ( name, "signal.%06d", n );
+    }
+    string = sm_malloc ( strlen ( name ) + 1 );
+    strcpy ( string, name );
+    record->string = toOffset ( string );
+
+    return record;
+}
+
+
+//
+//  Test the btree functions with the given key shape.  Half of the records
+//  are bulk loaded and the other half are inserted individually so that the
+//  searches for the missing records can be checked in between.
+//
+static void testKeyShape ( const keyShape* shape, int count )
+{
+    btree_iterator_t iterator;
+    btree_iter       iter;
+    shapeData**      records;
+    shapeData**      evens;
+    int              evenCount = ( count + 1 ) / 2;
+    int              n;
+
+    printf ( "\nTesting the %s key shape with %d records...\n", shape->name,
+             count );
+
+    btree_key_def* keyDef = sm_malloc ( KEY_DEF_SIZE(2) );
+    keyDef->fieldCount = shape->fieldCount;
+    keyDef->btreeFields[0].type   = shape->type1;
+    keyDef->btreeFields[0].offset = shape->offset1;
+    keyDef->btreeFields[0].size   = 1;
+    keyDef->btreeFields[1].type   = shape->type2;
+    keyDef->btreeFields[1].offset = shape->offset2;
+    keyDef->btreeFields[1].size   = 1;
+
+    btree_t* btree = btree_create ( 7, keyDef );
+
+    //
+    //  Make sure the specialized comparison routine and key prefix for this
+    //  key shape were selected.
+    //
+    if ( btree->keyCompare != shape->compare ||
+         btree->keyPrefix != shape->prefix )
+    {
+        shapeError ( shape, "comparison selection", 0 );
+    }
+    //
+    //  Create all of the records and bulk load the even numbered ones.
+    //
+    records = malloc ( count * sizeof(shapeData*) );
+    evens   = malloc ( evenCount * sizeof(shapeData*) );
+
+    for ( n = 0; n < count; ++n )
+    {
+        records[n] = newShapeRecord ( shape, n, count );
+        if ( n % 2 == 0 )
+        {
+            evens[n / 2] = records[n];
+        }
+    }
+    if ( btree_bulk_load ( btree, (void**)evens, evenCount ) != 0 ||
+         btree->count != evenCount )
+    {
+        shapeError ( shape, "bulk load", 0 );
+    }
+    //
+    //  The odd numbered records are not in the btree yet so searching for
+    //  them should fail and finding them should position the iterator at the
+    //  even numbered records on either side of them.
+    //
+    for ( n = 1; n < count; n += 2 )
+    {
+        if ( btree_search ( btree, records[n] ) != NULL )
+        {
+            shapeError ( shape, "missing record search", n );
+        }
+        iter = btree_find_into ( btree, records[n], &iterator );
+        if ( n + 1 < count ? btree_iter_at_end ( iter ) ||
+                             btree_iter_data ( iter ) != records[n + 1]
+                           : ! btree_iter_at_end ( iter ) )
+        {
+            shapeError ( shape, "missing record find", n );
+        }
+        iter = btree_rfind_into ( btree, records[n], &iterator );
+        if ( btree_iter_at_end ( iter ) ||
+             btree_iter_data ( iter ) != records[n - 1] )
+        {
+            shapeError ( shape, "missing record reverse find", n );
+        }
+    }
+    //
+    //  Insert the odd numbered records.
+    //
+    for ( n = 1; n < count; n += 2 )
+    {
+        btree_insert ( btree, records[n] );
+    }
+    if ( btree->count != count )
+    {
+        shapeError ( shape, "insert", count );
+    }
+    //
+    //  Every record should now be found by both the search and find
+    //  functions.
+    //
+    for ( n = 0; n < count; ++n )
+    {
+        if ( btree_search ( btree, records[n] ) != records[n] )
+        {
+            shapeError ( shape, "search", n );
+        }
+        iter = btree_find_into ( btree, records[n], &iterator );
+        if ( btree_iter_at_end ( iter ) ||
+             btree_iter_data ( iter ) != records[n] )
+        {
+            shapeError ( shape, "find", n );
+        }
+    }
+    //
+    //  Iterate through the btree and make sure the records are in order.
+    //
+    iter = btree_iter_begin ( btree );
+
+    n = 0;
+    while ( ! btree_iter_at_end ( iter ) )
+    {
+        if ( n >= count || btree_iter_data ( iter ) != records[n] )
+        {
+            shapeError ( shape, "iteration", n );
+        }
+        ++n;
+        btree_iter_next ( iter );
+    }
+    btree_iter_cleanup ( iter );
+
+    if ( n != count )
+    {
+        shapeError ( shape, "iteration", n );
+    }
+    //
+    //  Delete the even numbered records and make sure that only the odd
+    //  numbered ones can still be found.
+    //
+    for ( n = 0; n < count; n += 2 )
+    {
+        btree_delete ( btree, records[n] );
+    }
+    if ( btree->count != count - evenCount )
+    {
+        shapeError ( shape, "delete", 0 );
+    }
+    for ( n = 0; n < count; ++n )
+    {
+        if ( btree_search ( btree, records[n] ) !=
+             ( n % 2 == 0 ? NULL : records[n] ) )
+        {
+            shapeError ( shape, "search after delete", n );
+        }
+    }
+    //
+    //  Delete the rest of the records and make sure the btree is empty.
+    //
+    for ( n = 1; n < count; n += 2 )
+    {
+        btree_delete ( btree, records[n] );
+    }
+    if ( btree->count != 0 || btree_get_min ( btree ) != NULL )
+    {
+        shapeError ( shape, "delete", 1 );
+    }
+    //
+    //  Give back the memory used by the records.
+    //
+    for ( n = 0; n < count; ++n )
+    {
+        sm_free ( toAddress ( records[n]->string ) );
+        sm_free ( records[n] );
+    }
+    free ( records );
+    free ( evens );
+
+    printf ( "  The %s key shape passed\n", shape->name );
+}
+
+
+//
+//  Create a btree with the given fanout whose key is described by a key
+//  shape.
+//
+static btree_t* newShapeTree ( const keyShape* shape, int fanout )
+{
+    btree_key_def* keyDef = sm_malloc ( KEY_DEF_SIZE(2) );
+    keyDef->fieldCount = shape->fieldCount;
+    keyDef->btreeFields[0].type   = shape->type1;
+    keyDef->btreeFields[0].offset = shape->offset1;
+    keyDef->btreeFields[0].size   = 1;
+    keyDef->btreeFields[1].type   = shape->type2;
+    keyDef->btreeFields[1].offset = shape->offset2;
+    keyDef->btreeFields[1].size   = 1;
+
+    return btree_create ( fanout, keyDef );
+}
+
+
+//
+//  Define the key shapes that do not have a specialized comparison routine
+//  so the btree must fall back to interpreting the key definition and must
+//  not cache any key prefixes.
+//
+static const keyShape genericShapes[] =
+{
+    { "long", 1, ft_long, offsetof ( shapeData, ulong1 ),
+      ft_invalid, 0, ct_generic, kp_none },
+
+    { "ulong+int", 2, ft_ulong, offsetof ( shapeData, ulong1 ),
+      ft_int, offsetof ( shapeData, int1 ), ct_generic, kp_none },
+
+    { "string+int", 2, ft_string, offsetof ( shapeData, string ),
+      ft_int, offsetof ( shapeData, int1 ), ct_generic, kp_none },
+
+    { "int+ulong", 2, ft_int, offsetof ( shapeData, int1 ),
+      ft_ulong, offsetof ( shapeData, ulong1 ), ct_generic, kp_none }
+};
+
+
+//
+//  Define the extreme key values used to test the ordering of each of the
+//  specialized comparison routines.  The keys of each shape are listed in
+//  the order in which they must sort.  They cross the sign boundary of the
+//  integers and are far enough apart that subtracting them would overflow.
+//
+typedef struct extremeKey
+{
+    int           int1;
+    int           int2;
+    unsigned long ulong1;
+    unsigned long ulong2;
+    const char*   string;
+
+}   extremeKey;
+
+static const extremeKey intExtremes[] =
+{
+    { INT_MIN }, { INT_MIN + 1 }, { -1 }, { 0 }, { 1 }, { INT_MAX - 1 },
+    { INT_MAX }
+};
+
+static const extremeKey intIntExtremes[] =
+{
+    { INT_MIN, INT_MAX }, { -1, INT_MIN }, { -1, 0 }, { 0, INT_MIN },
+    { 0, -1 }, { INT_MAX, INT_MIN }, { INT_MAX, INT_MAX }
+};
+
+static const extremeKey intStringExtremes[] =
+{
+    { INT_MIN, 0, 0, 0, "b" }, { -1, 0, 0, 0, "a" }, { -1, 0, 0, 0, "b" },
+    { 0, 0, 0, 0, "" }, { INT_MAX, 0, 0, 0, "a" }
+};
+
+static const extremeKey ulongExtremes[] =
+{
+    { 0, 0, 0 }, { 0, 0, 1 }, { 0, 0, LONG_MAX }, { 0, 0, 1UL << 63 },
+    { 0, 0, ~0UL - 1 }, { 0, 0, ~0UL }
+};
+
+static const extremeKey ulongUlongExtremes[] =
+{
+    { 0, 0, 0, ~0UL }, { 0, 0, 1UL << 63, 0 }, { 0, 0, 1UL << 63, 1UL << 63 },
+    { 0, 0, ~0UL, 0 }, { 0, 0, ~0UL, ~0UL }
+};
+
+static const extremeKey stringExtremes[] =
+{
+    { 0, 0, 0, 0, "" }, { 0, 0, 0, 0, "\x01" }, { 0, 0, 0, 0, "a" },
+    { 0, 0, 0, 0, "signal.00" }, { 0, 0, 0, 0, "signal.01" },
+    { 0, 0, 0, 0, "\xff" }
+};
+
+#define EXTREME_KEYS( keys ) keys, sizeof(keys) / sizeof(keys[0])
+
+static const struct
+{
+    const keyShape*   shape;
+    const extremeKey* keys;
+    int               count;
+
+}   shapeExtremes[] =
+{
+    { &keyShapes[0], EXTREME_KEYS ( intExtremes ) },
+    { &keyShapes[1], EXTREME_KEYS ( intIntExtremes ) },
+    { &keyShapes[2], EXTREME_KEYS ( intStringExtremes ) },
+    { &keyShapes[3], EXTREME_KEYS ( ulongExtremes ) },
+    { &keyShapes[4], EXTREME_KEYS ( ulongUlongExtremes ) },
+    { &keyShapes[5], EXTREME_KEYS ( stringExtremes ) }
+};
+
+
+//
+//  Test the ordering of the specialized comparison routine of a key shape
+//  with it's extreme key values.  The records are inserted in the reverse of
+//  their key order and must then be iterated in key order and be found by a
+//  search.
+//
+static void testKeyExtremes ( const keyShape* shape, const extremeKey* keys,
+                              int count )
+{
+    shapeData* records[count];
+    btree_iter iter;
+    int        n;
+
+    btree_t* btree = newShapeTree ( shape, BTREE_MIN_RECORD_COUNT );
+
+    if ( btree->keyCompare != shape->compare )
+    {
+        shapeError ( shape, "comparison selection", 0 );
+    }
+    for ( n = 0; n < count; ++n )
+    {
+        records[n] = sm_malloc ( sizeof(shapeData) );
+        memset ( records[n], 0, sizeof(shapeData) );
+
+        records[n]->int1   = keys[n].int1;
+        records[n]->int2   = keys[n].int2;
+        records[n]->ulong1 = keys[n].ulong1;
+        records[n]->ulong2 = keys[n].ulong2;
+
+        char* string = sm_malloc ( strlen ( keys[n].string ? keys[n].string
+                                                           : "" ) + 1 );
+        strcpy ( string, keys[n].string ? keys[n].string : "" );
+        records[n]->string = toOffset ( string );
+    }
+    for ( n = count - 1; n >= 0; --n )
+    {
+        btree_insert ( btree, records[n] );
+    }
+    iter = btree_iter_begin ( btree );
+
+    n = 0;
+    while ( ! btree_iter_at_end ( iter ) )
+    {
+        if ( n >= count || btree_iter_data ( iter ) != records[n] )
+        {
+            shapeError ( shape, "extreme key order", n );
+        }
+        ++n;
+        btree_iter_next ( iter );
+    }
+    btree_iter_cleanup ( iter );
+
+    for ( n = 0; n < count; ++n )
+    {
+        if ( btree_search ( btree, records[n] ) != records[n] )
+        {
+            shapeError ( shape, "extreme key search", n );
+        }
+        btree_delete ( btree, records[n] );
+        sm_free ( toAddress ( records[n]->string ) );
+        sm_free ( records[n] );
+    }
+    if ( btree->count != 0 )
+    {
+        shapeError ( shape, "extreme key delete", count );
+    }
+    printf ( "  The %s key shape orders it's extreme keys correctly\n",
+             shape->name );
+}
+
+
+//
+//  Check the structure of a subtree of a btree and return the number of
+//  records in it.  Every node must point back to it's parent, the children
+//  of a node must all be one level below it and every node other than the
+//  root must hold at least the minimum number of records.  Any problem is
+//  reported and the tests are terminated.
+//
+static unsigned int checkSubtree ( btree_t* btree, bt_node_t* node,
+                                   offset_t parent )
+{
+    unsigned int records = node->keysInUse;
+
+    if ( node->parent != parent ||
+         node->keysInUse > btree->maxRecCnt ||
+         ( parent != 0 && node->keysInUse < btree->min ) )
+    {
+        printf ( "Error: Node %p has parent 0x%lx (should be 0x%lx) and %u "
+                 "records\n", node, node->parent, parent, node->keysInUse );
+        exit ( 255 );
+    }
+    if ( node->level == 0 )
+    {
+        return records;
+    }
+    offset_t* children = toAddress ( node->children );
+
+    for ( unsigned int i = 0; i <= node->keysInUse; ++i )
+    {
+        bt_node_t* child = toAddress ( children[i] );
+
+        if ( child->level != node->level - 1 )
+        {
+            printf ( "Error: Child %u of node %p is at level %u under a node "
+                     "at level %u\n", i, node, child->level, node->level );
+            exit ( 255 );
+        }
+        records += checkSubtree ( btree, child, toOffset ( node ) );
+    }
+    return records;
+}
+
+
+//
+//  Check the structure of a whole btree and that it holds the expected
+//  number of records.
+//
+static void checkBtree ( btree_t* btree, unsigned int count )
+{
+    if ( checkSubtree ( btree, toAddress ( btree->root ), 0 ) != count ||
+         btree->count != count )
+    {
+        printf ( "Error: The btree should hold %u records but holds %u\n",
+                 count, btree->count );
+        exit ( 255 );
+    }
+}
+
+
+//
+//  Shuffle the given array of record numbers into a random order.
+//
+static void shuffleRecords ( int* records, int count )
+{
+    for ( int i = count - 1; i > 0; --i )
+    {
+        int j    = rand() % ( i + 1 );
+        int temp = records[i];
+
+        records[i] = records[j];
+        records[j] = temp;
+    }
+}
+
+
+//
+//  Compute the key prefix that a btree node should cache for a record of a
+//  key shape.  The signed integers are biased so that they sort as unsigned
+//  values and the strings contribute their leading bytes, padded with zeros.
+//
+#define BIASED( value ) ( (unsigned long)( (unsigned int)(value) ^ 0x80000000u ) )
+
+static unsigned long expectedPrefix ( const keyShape* shape, shapeData* record )
+{
+    unsigned char* string = toAddress ( record->string );
+    unsigned long  prefix = 0;
+    int            length = 0;
+
+    switch ( shape->compare )
+    {
+      case ct_int:
+        return BIASED ( record->int1 );
+
+      case ct_int_int:
+        return BIASED ( record->int1 ) << 32 | BIASED ( record->int2 );
+
+      case ct_int_string:
+        prefix = BIASED ( record->int1 );
+        length = 4;
+        break;
+
+      case ct_ulong:
+      case ct_ulong_ulong:
+        return record->ulong1;
+
+      case ct_string:
+        length = 8;
+        break;
+
+      default:
+        return 0;
+    }
+    for ( int i = 0; i < length; ++i )
+    {
+        prefix = ( prefix << 8 ) | *string;
+        if ( *string != 0 )
+        {
+            ++string;
+        }
+    }
+    return prefix;
+}
+
+
+//
+//  Make sure that every node of a subtree caches the correct key prefix for
+//  each of it's records.
+//
+static void checkPrefixes ( const keyShape* shape, bt_node_t* node )
+{
+    offset_t*      records  = toAddress ( node->dataRecords );
+    unsigned long* prefixes = toAddress ( node->keys );
+
+    if ( node->keys == 0 )
+    {
+        shapeError ( shape, "prefix cache allocation", 0 );
+    }
+    for ( unsigned int i = 0; i < node->keysInUse; ++i )
+    {
+        if ( prefixes[i] != expectedPrefix ( shape,
+                                             toAddress ( records[i] ) ) )
+        {
+            shapeError ( shape, "prefix cache", i );
+        }
+    }
+    if ( node->level != 0 )
+    {
+        offset_t* children = toAddress ( node->children );
+
+        for ( unsigned int i = 0; i <= node->keysInUse; ++i )
+        {
+            checkPrefixes ( shape, toAddress ( children[i] ) );
+        }
+    }
+}
+
+
+//
+//  Insert and then delete the records of a key shape in a random order and
+//  make sure that the key prefixes cached in the nodes are kept up to date
+//  as the records are moved around by the splits, merges and rotations.
+//  While half of the records are in the btree, the other half are searched
+//  for.  Many of the missing records have the same prefix as a record in the
+//  btree so the search must compare the records themselves to tell them
+//  apart.
+//
+static void testPrefixCache ( const keyShape* shape, int count )
+{
+    shapeData** records = malloc ( count * sizeof(shapeData*) );
+    int*        shuffle = malloc ( count * sizeof(int) );
+    int         n;
+
+    btree_t* btree = newShapeTree ( shape, 5 );
+
+    for ( n = 0; n < count; ++n )
+    {
+        records[n] = newShapeRecord ( shape, n, count );
+        shuffle[n] = n;
+    }
+    shuffleRecords ( shuffle, count );
+
+    for ( n = 0; n < count; ++n )
+    {
+        if ( shuffle[n] % 2 == 0 )
+        {
+            btree_insert ( btree, records[shuffle[n]] );
+            checkPrefixes ( shape, toAddress ( btree->root ) );
+        }
+    }
+    for ( n = 0; n < count; ++n )
+    {
+        if ( btree_search ( btree, records[n] ) !=
+             ( n % 2 == 0 ? records[n] : NULL ) )
+        {
+            shapeError ( shape, "prefix search", n );
+        }
+    }
+    for ( n = 0; n < count; ++n )
+    {
+        if ( shuffle[n] % 2 != 0 )
+        {
+            btree_insert ( btree, records[shuffle[n]] );
+            checkPrefixes ( shape, toAddress ( btree->root ) );
+        }
+    }
+    shuffleRecords ( shuffle, count );
+
+    for ( n = 0; n < count; ++n )
+    {
+        btree_delete ( btree, records[shuffle[n]] );
+        checkPrefixes ( shape, toAddress ( btree->root ) );
+
+        if ( btree_search ( btree, records[shuffle[n]] ) != NULL )
+        {
+            shapeError ( shape, "prefix delete", shuffle[n] );
+        }
+    }
+    for ( n = 0; n < count; ++n )
+    {
+        sm_free ( toAddress ( records[n]->string ) );
+        sm_free ( records[n] );
+    }
+    free ( records );
+    free ( shuffle );
+
+    printf ( "  The %s key shape kept it's key prefixes up to date\n",
+             shape->name );
+}
+
+
+//
+//  Search a btree of the given fanout for every value from below the
+//  smallest key to above the largest one.  The records have the odd values
+//  so every even value falls between two of them.  The search must only
+//  find the odd values, a find must stop at the next larger record and a
+//  reverse find at the next smaller one.  The records are then deleted
+//  from the middle out while the rest are searched for.
+//
+static void testSearchFanout ( const keyShape* shape, int fanout, int count )
+{
+    btree_iterator_t iterator;
+    btree_iter       iter;
+    shapeData        key;
+    shapeData*       records = sm_malloc ( count * sizeof(shapeData) );
+    int              n;
+
+    btree_t* btree = newShapeTree ( shape, fanout );
+
+    printf ( "  Searching the %s key shape with a fanout of %d\n", shape->name,
+             fanout );
+
+    memset ( records, 0, count * sizeof(shapeData) );
+    memset ( &key, 0, sizeof(key) );
+
+    for ( n = 0; n < count; ++n )
+    {
+        records[n].ulong1 = 2 * n + 1;
+        btree_insert ( btree, &records[n] );
+    }
+    for ( unsigned long value = 0; value <= 2UL * count; ++value )
+    {
+        shapeData* match = value % 2 != 0 ? &records[value / 2] : NULL;
+        shapeData* next  = value / 2 < (unsigned long)count ?
+                           &records[value / 2] : NULL;
+        shapeData* prior = value == 0 ? NULL : &records[( value - 1 ) / 2];
+
+        key.ulong1 = value;
+
+        if ( btree_search ( btree, &key ) != match )
+        {
+            shapeError ( shape, "fanout search", (int)value );
+        }
+        iter = btree_find_into ( btree, &key, &iterator );
+        if ( btree_iter_at_end ( iter ) ? next != NULL
+                                        : btree_iter_data ( iter ) != next )
+        {
+            shapeError ( shape, "fanout find", (int)value );
+        }
+        iter = btree_rfind_into ( btree, &key, &iterator );
+        if ( btree_iter_at_end ( iter ) ? prior != NULL
+                                        : btree_iter_data ( iter ) != prior )
+        {
+            shapeError ( shape, "fanout reverse find", (int)value );
+        }
+    }
+    for ( n = 0; n < count; ++n )
+    {
+        int deleted = n % 2 == 0 ? count / 2 + n / 2 : count / 2 - n / 2 - 1;
+
+        btree_delete ( btree, &records[deleted] );
+
+        if ( btree_search ( btree, &records[deleted] ) != NULL ||
+             btree->count != (unsigned int)( count - n - 1 ) )
+        {
+            shapeError ( shape, "fanout delete", deleted );
+        }
+    }
+    btree_destroy ( btree );
+    sm_free ( records );
+}
+
+
 //
 //  Define the usage message function.
 //
@@ -825,6 +1612,293 @@ int main ( int argc, char *argv[] )
     PRINT_TREE ( idTree, printFunction );
     VALIDATE_BTREE ( idTree, recordCount, false, 0, 99999 );
 
+    //-----------------------------------------------------------------------
+    //
+    //  Test the bulk load, search, find, iteration, insert and delete
+    //  functions with each of the key shapes that have a specialized
+    //  comparison routine and key prefix.
+    //
+    printf ( "\nTEST 19\n" );
+    printf ( "\nTest each of the specialized key shapes.\n" );
+
+    for ( i = 0; i < (int)( sizeof(keyShapes) / sizeof(keyShapes[0]) ); ++i )
+    {
+        testKeyShape ( &keyShapes[i], recordCount );
+    }
+
+    //-----------------------------------------------------------------------
+    //
+    //  Fill a root node right up to it's capacity and then insert one more
+    //  record to make it split.  The records are then deleted again so that
+    //  the two halves have to be merged back together.
+    //
+    printf ( "\nTEST 20\n" );
+    printf ( "\nSplit a full root node and merge it back together.\n" );
+
+    btree_t*  splitTree  = btree_create ( 5, idKeyDef );
+    int       splitCount = splitTree->maxRecCnt + 1;
+    userData* splitData  = sm_malloc ( splitCount * sizeof(userData) );
+
+    memset ( splitData, 0, splitCount * sizeof(userData) );
+    for ( i = 0; i < splitCount; ++i )
+    {
+        splitData[i].domainId = i;
+        splitData[i].signalId = i * 11;
+    }
+    for ( i = 0; i < splitCount - 1; ++i )
+    {
+        btree_insert ( splitTree, &splitData[i] );
+    }
+    checkBtree ( splitTree, splitCount - 1 );
+    if ( ((bt_node_t*)toAddress ( splitTree->root ))->level != 0 )
+    {
+        printf ( "Error: A root node split before it was full\n" );
+        exit ( 255 );
+    }
+    btree_insert ( splitTree, &splitData[splitCount - 1] );
+    checkBtree ( splitTree, splitCount );
+    if ( ((bt_node_t*)toAddress ( splitTree->root ))->level != 1 )
+    {
+        printf ( "Error: A full root node did not split\n" );
+        exit ( 255 );
+    }
+    for ( i = 0; i < splitCount; ++i )
+    {
+        btree_delete ( splitTree, &splitData[i] );
+        checkBtree ( splitTree, splitCount - i - 1 );
+    }
+    btree_destroy ( splitTree );
+    sm_free ( splitData );
+
+    //-----------------------------------------------------------------------
+    //
+    //  Build a btree several levels deep with the smallest nodes allowed and
+    //  then delete the records in a random order.  That deletes records from
+    //  the interior nodes (which replaces them with their predecessors) and
+    //  takes records from the siblings on both sides and merges siblings at
+    //  every level of the btree.  The structure of the btree and every record
+    //  still in it are checked after each delete.
+    //
+    printf ( "\nTEST 21\n" );
+    printf ( "\nDelete randomly from a deep btree.\n" );
+
+    const int DEEP_TEST_COUNT = 500;
+
+    btree_t*  deepTree = btree_create ( BTREE_MIN_RECORD_COUNT, idKeyDef );
+    userData* deepData = sm_malloc ( DEEP_TEST_COUNT * sizeof(userData) );
+    int*      shuffle  = malloc ( DEEP_TEST_COUNT * sizeof(int) );
+
+    memset ( deepData, 0, DEEP_TEST_COUNT * sizeof(userData) );
+    for ( i = 0; i < DEEP_TEST_COUNT; ++i )
+    {
+        deepData[i].domainId = i;
+        deepData[i].signalId = i * 11;
+        shuffle[i]           = i;
+    }
+    shuffleRecords ( shuffle, DEEP_TEST_COUNT );
+
+    for ( i = 0; i < DEEP_TEST_COUNT; ++i )
+    {
+        btree_insert ( deepTree, &deepData[shuffle[i]] );
+    }
+    checkBtree ( deepTree, DEEP_TEST_COUNT );
+    if ( ((bt_node_t*)toAddress ( deepTree->root ))->level < 3 )
+    {
+        printf ( "Error: The deep btree is only %u levels deep\n",
+                 ((bt_node_t*)toAddress ( deepTree->root ))->level + 1 );
+        exit ( 255 );
+    }
+    shuffleRecords ( shuffle, DEEP_TEST_COUNT );
+
+    for ( i = 0; i < DEEP_TEST_COUNT; ++i )
+    {
+        status = btree_delete ( deepTree, &deepData[shuffle[i]] );
+        if ( status != 0 )
+        {
+            printf ( "Error: Delete of record %d failed with %d\n",
+                     shuffle[i], status );
+            exit ( 255 );
+        }
+        checkBtree ( deepTree, DEEP_TEST_COUNT - i - 1 );
+
+        for ( int j = i + 1; j < DEEP_TEST_COUNT; ++j )
+        {
+            if ( btree_search ( deepTree, &deepData[shuffle[j]] ) !=
+                 &deepData[shuffle[j]] )
+            {
+                printf ( "Error: Record %d was lost by the delete of record "
+                         "%d\n", shuffle[j], shuffle[i] );
+                exit ( 255 );
+            }
+        }
+    }
+    btree_destroy ( deepTree );
+    sm_free ( deepData );
+    free ( shuffle );
+
+    printf ( "  All of the deletes left a valid btree\n" );
+
+    //-----------------------------------------------------------------------
+    //
+    //  Make sure that the key shapes without a specialized comparison routine
+    //  fall back to the generic one and that each specialized routine orders
+    //  the extreme values of it's key fields correctly.
+    //
+    printf ( "\nTEST 22\n" );
+    printf ( "\nTest the comparison routine selection and extreme keys.\n" );
+
+    for ( i = 0; i < (int)( sizeof(genericShapes) /
+                            sizeof(genericShapes[0]) ); ++i )
+    {
+        btree_t* btree = newShapeTree ( &genericShapes[i], 7 );
+
+        if ( btree->keyCompare != ct_generic || btree->keyPrefix != kp_none )
+        {
+            shapeError ( &genericShapes[i], "comparison selection", 0 );
+        }
+        btree_destroy ( btree );
+    }
+    for ( i = 0; i < (int)( sizeof(shapeExtremes) /
+                            sizeof(shapeExtremes[0]) ); ++i )
+    {
+        testKeyExtremes ( shapeExtremes[i].shape, shapeExtremes[i].keys,
+                          shapeExtremes[i].count );
+    }
+
+    //-----------------------------------------------------------------------
+    //
+    //  Make sure that the key prefixes cached in the nodes are kept up to
+    //  date for each of the key shapes that has them.
+    //
+    printf ( "\nTEST 23\n" );
+    printf ( "\nTest the key prefix cache of each key shape.\n" );
+
+    for ( i = 0; i < (int)( sizeof(keyShapes) / sizeof(keyShapes[0]) ); ++i )
+    {
+        testPrefixCache ( &keyShapes[i], recordCount );
+    }
+
+    //-----------------------------------------------------------------------
+    //
+    //  Search btrees of many different fanouts, both with and without key
+    //  prefixes, so that the binary search within a node is tried with every
+    //  number of records up to the largest node.
+    //
+    printf ( "\nTEST 24\n" );
+    printf ( "\nTest the node search with different fanouts.\n" );
+
+    static const int fanouts[] = { 3, 4, 5, 6, 7, 9, 15, 16, 21, 33, 41, 64 };
+
+    for ( i = 0; i < (int)( sizeof(fanouts) / sizeof(fanouts[0]) ); ++i )
+    {
+        testSearchFanout ( &keyShapes[3], fanouts[i], recordCount );
+        testSearchFanout ( &genericShapes[0], fanouts[i], recordCount );
+    }
+    printf ( "  The node search worked with every fanout\n" );
+
+    //-----------------------------------------------------------------------
+    //
+    //  Bulk load btrees of many sizes and make sure that they are valid and
+    //  that all of their records can be found.  Bulk loads of records that
+    //  contain duplicate keys, that are out of order or that are into a
+    //  btree that is not empty must be rejected without changing the btree.
+    //
+    printf ( "\nTEST 25\n" );
+    printf ( "\nTest bulk loads of valid and invalid records.\n" );
+
+    static const int bulkSizes[] = { 1, 5, 6, 7, 30, 31, 36, 37, 200 };
+
+    btree_t*    bulkTree    = newShapeTree ( &keyShapes[3], 5 );
+    shapeData*  bulkData    = sm_malloc ( recordCount * sizeof(shapeData) );
+    shapeData** bulkRecords = malloc ( ( recordCount + 1 ) *
+                                       sizeof(shapeData*) );
+
+    memset ( bulkData, 0, recordCount * sizeof(shapeData) );
+    for ( i = 0; i < recordCount; ++i )
+    {
+        bulkData[i].ulong1 = i;
+        bulkRecords[i]     = &bulkData[i];
+    }
+    for ( i = 0; i < (int)( sizeof(bulkSizes) / sizeof(bulkSizes[0]) ); ++i )
+    {
+        int size = bulkSizes[i] < recordCount ? bulkSizes[i] : recordCount;
+
+        if ( btree_bulk_load ( bulkTree, (void**)bulkRecords, size ) != 0 )
+        {
+            printf ( "Error: Unable to bulk load %d records\n", size );
+            exit ( 255 );
+        }
+        checkBtree ( bulkTree, size );
+
+        for ( int n = 0; n < recordCount; ++n )
+        {
+            if ( btree_search ( bulkTree, &bulkData[n] ) !=
+                 ( n < size ? &bulkData[n] : NULL ) )
+            {
+                printf ( "Error: Record %d was not found after a bulk load of "
+                         "%d records\n", n, size );
+                exit ( 255 );
+            }
+        }
+        for ( int n = 0; n < size; ++n )
+        {
+            btree_delete ( bulkTree, &bulkData[n] );
+        }
+        checkBtree ( bulkTree, 0 );
+    }
+    //
+    //  A record that appears twice in a row has a duplicate key.
+    //
+    bulkRecords[recordCount] = bulkRecords[recordCount - 1];
+
+    if ( btree_bulk_load ( bulkTree, (void**)bulkRecords,
+                           recordCount + 1 ) != EINVAL )
+    {
+        printf ( "Error: A bulk load of duplicate keys was accepted\n" );
+        exit ( 255 );
+    }
+    checkBtree ( bulkTree, 0 );
+
+    //
+    //  Swap two of the records so that they are out of order.
+    //
+    bulkRecords[0] = &bulkData[1];
+    bulkRecords[1] = &bulkData[0];
+
+    if ( btree_bulk_load ( bulkTree, (void**)bulkRecords,
+                           recordCount ) != EINVAL )
+    {
+        printf ( "Error: A bulk load of unsorted records was accepted\n" );
+        exit ( 255 );
+    }
+    checkBtree ( bulkTree, 0 );
+
+    //
+    //  Put one record into the btree and then try to bulk load the rest.
+    //
+    btree_insert ( bulkTree, &bulkData[0] );
+
+    if ( btree_bulk_load ( bulkTree, (void**)&bulkRecords[2],
+                           recordCount - 2 ) != EINVAL )
+    {
+        printf ( "Error: A bulk load into a btree that is not empty was "
+                 "accepted\n" );
+        exit ( 255 );
+    }
+    checkBtree ( bulkTree, 1 );
+
+    if ( btree_search ( bulkTree, &bulkData[0] ) != &bulkData[0] ||
+         btree_search ( bulkTree, &bulkData[2] ) != NULL )
+    {
+        printf ( "Error: A rejected bulk load changed the btree\n" );
+        exit ( 255 );
+    }
+    btree_destroy ( bulkTree );
+    sm_free ( bulkData );
+    free ( bulkRecords );
+
+    printf ( "  The bulk loads were built or rejected correctly\n" );
+
     dumpSM();
 
     vsi_core_close();
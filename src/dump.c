@@ -59,6 +59,7 @@ Usage: %s options\n\
     -l    List Count       int         4      \n\
     -m    Message Count    int         4      \n\
     -s    Dump of signalId int         0      \n\
+    -t    Trace Records    int         0      \n\
     -h    Help Message     N/A        N/A     \n\
     -?    Help Message     N/A        N/A     \n\
 \n\n\
@@ -86,6 +87,7 @@ int main ( int argc, char* const argv[] )
     unsigned long listsToDump    = 4;
     unsigned int  domain         = 1;
     unsigned int  signal         = 0;
+    unsigned long traceToDump    = 0;
 
     //
     //  The following locale settings will allow the use of the comma
@@ -99,7 +101,7 @@ int main ( int argc, char* const argv[] )
     //
     char ch;
 
-    while ( ( ch = getopt ( argc, argv, "ad:hs:l:m:?" ) ) != -1 )
+    while ( ( ch = getopt ( argc, argv, "ad:hs:l:m:t:?" ) ) != -1 )
     {
         switch ( ch )
         {
@@ -150,6 +152,19 @@ int main ( int argc, char* const argv[] )
             }
             break;
 
+          //
+          //  Get the requested number of trace records.
+          //
+          case 't':
+            traceToDump = atol ( optarg );
+            if ( traceToDump <= 0 )
+            {
+                printf ( "Invalid trace count[%lu] specified.\n", traceToDump );
+                usage ( argv[0] );
+                exit (255);
+            }
+            break;
+
           //
           //    Display the help message.
           //
@@ -179,6 +194,17 @@ int main ( int argc, char* const argv[] )
     //
     vsi_initialize ( false );
 
+    //
+    //  If the user asked for the trace ring, just go render the most recent
+    //  trace records and quit.
+    //
+    if ( traceToDump != 0 )
+    {
+        dumpTrace ( traceToDump );
+        vsi_core_close();
+
+        return 0;
+    }
     //
     //  For each of the messages we were asked to dump...
     //
@@ -225,6 +225,10 @@ int main ( int argc, char* const argv[] )
                 printf ( "====> ERROR: Fetching message[%lu] - Error %d\n",
                          messageKey, status );
             }
+            else
+            {
+                vsi_core_release ( message );
+            }
         }
         clock_gettime(CLOCK_REALTIME, &stopTime);
 
@@ -87,6 +87,7 @@ int main ( int argc, char* const argv[] )
     unsigned long dataSize  = 0;
     int           status    = 0;
     char          ch;
+    char          newestData[1024] = { 0 };
     bool          getOldest = false;
 
 #ifdef VSI_DEBUG
@@ -161,7 +162,15 @@ int main ( int argc, char* const argv[] )
     }
     else
     {
-        status = vsi_core_fetch_newest ( domain, signal, &dataSize, &data );
+        //
+        //  The newest value is copied into our local buffer (leaving room
+        //  for a terminating null byte).
+        //
+        data     = newestData;
+        dataSize = sizeof(newestData) - 1;
+
+        status = vsi_core_fetch_newest_copy ( domain, signal, &dataSize,
+                                              data );
     }
     if ( status == 0 )
     {
@@ -185,6 +194,14 @@ int main ( int argc, char* const argv[] )
         printf ( "----> Error %d[%s] returned\n", status, strerror(status) );
     }
     //
+    //  Give the oldest message back to the data store now that we are done
+    //  looking at it.
+    //
+    if ( status == 0 && getOldest )
+    {
+        vsi_core_release ( data );
+    }
+    //
     //  Close our shared memory segment and exit.
     //
     vsi_core_close();
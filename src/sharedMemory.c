@@ -17,12 +17,15 @@
 -----------------------------------------------------------------------------*/
 
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
+#include <time.h>
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <stdbool.h>
 
 #include "vsi.h"
@@ -38,6 +41,26 @@
 sharedMemory_t* smControl  = 0;
 sysMemory_t*    sysControl = 0;
 
+//
+//  Declare the generation of each shared memory segment that is currently
+//  mapped into this process.
+//
+unsigned long smGeneration  = 0;
+unsigned long sysGeneration = 0;
+
+//
+//  Define the file descriptors of the shared memory segment files and the
+//  number of bytes of each segment that are currently mapped into this
+//  process.  The file descriptors are kept open so that the segments can be
+//  grown and remapped.  The remap lock keeps multiple threads in this process
+//  from remapping the same memory at the same time.
+//
+static int             smFd          = -1;
+static int             sysFd         = -1;
+static unsigned long   smMappedSize  = 0;
+static unsigned long   sysMappedSize = 0;
+static pthread_mutex_t remapLock     = PTHREAD_MUTEX_INITIALIZER;
+
 
 //
 //  Define the size of the shared memory control blocks, making sure they are
@@ -50,6 +73,10 @@ static const unsigned int sysSize = ( sizeof(sysMemory_t)    + 7 ) & 0xfffffff8;
 //  Declare the local functions.
 //
 static void memoryChunkPrint ( char* leader, void* recordPtr );
+static void carveSysNodes ( offset_t offset, unsigned long size );
+static void sm_release_magazines ( void );
+static bool limboSpill ( const offset_t* blocks, const unsigned long* epochs,
+                         unsigned int count );
 
 //
 //  Define the cleanup handler for the semaphore wait below.  This handler
@@ -191,6 +218,412 @@ static int insertMemoryChunk ( memoryChunk_t* chunk )
 }
 
 
+/*!-----------------------------------------------------------------------
+
+    m a p S e g m e n t
+
+    @brief Map a shared memory segment file into a new address reservation.
+
+    This function will reserve enough virtual address space (without
+    committing any memory for it) to hold the maximum size of the segment and
+    then map the first "mappedSize" bytes of the segment file at the
+    beginning of the reservation.  The rest of the reservation is left
+    inaccessible until the segment is grown and the new memory is mapped by
+    extendMapping.
+
+    @param[in] fd - The file descriptor of the segment file
+    @param[in] mappedSize - The number of bytes of the file to map
+    @param[in] maximumSize - The maximum size the segment can grow to
+
+    @return The base address of the segment or MAP_FAILED (with errno set)
+
+------------------------------------------------------------------------*/
+static void* mapSegment ( int fd, unsigned long mappedSize,
+                          unsigned long maximumSize )
+{
+    void* base;
+    void* segment;
+
+    //
+    //  Reserve the address space for the largest segment we will allow.
+    //
+    base = mmap ( NULL, maximumSize, PROT_NONE,
+                  MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0 );
+    if ( base == MAP_FAILED )
+    {
+        return MAP_FAILED;
+    }
+    //
+    //  Map the segment file over the beginning of the reservation.
+    //
+    segment = mmap ( base, mappedSize, PROT_READ|PROT_WRITE,
+                     MAP_SHARED|MAP_FIXED, fd, 0 );
+    if ( segment == MAP_FAILED )
+    {
+        int error = errno;
+
+        (void)munmap ( base, maximumSize );
+        errno = error;
+    }
+    return segment;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    e x t e n d M a p p i n g
+
+    @brief Map the part of a segment file that has been added to it.
+
+    The segment file bytes between the old and new mapped sizes are mapped
+    into the address reservation of the segment immediately following the
+    existing mapping.
+
+    @param[in] base - The base address of the segment
+    @param[in] fd - The file descriptor of the segment file
+    @param[in] mappedSize - The number of bytes currently mapped
+    @param[in] newSize - The number of bytes that should be mapped
+
+    @return  0 = Success
+            ~0 = Failure (errno value)
+
+------------------------------------------------------------------------*/
+static int extendMapping ( void* base, int fd, unsigned long mappedSize,
+                           unsigned long newSize )
+{
+    void* extension;
+
+    extension = mmap ( base + mappedSize, newSize - mappedSize,
+                       PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, fd,
+                       mappedSize );
+    if ( extension == MAP_FAILED )
+    {
+        return errno;
+    }
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    r e m a p S e g m e n t
+
+    @brief Map any memory added to a segment by another process.
+
+    The segment generation is read before the segment size so that if the
+    segment is grown again while we are remapping it, our generation will not
+    match the segment generation and we will come back here the next time
+    the mapping is checked.
+
+    If the new memory cannot be mapped, there is no way for this process to
+    continue using the segment so we just abort.
+
+    @param[in] base - The base address of the segment
+    @param[in] fd - The file descriptor of the segment file
+    @param[in] segmentGeneration - The address of the segment generation
+    @param[in] segmentSize - The address of the segment size
+    @param[in,out] mappedGeneration - The generation mapped in this process
+    @param[in,out] mappedSize - The number of bytes mapped in this process
+
+------------------------------------------------------------------------*/
+static void remapSegment ( void* base, int fd,
+                           unsigned long* segmentGeneration,
+                           unsigned long* segmentSize,
+                           unsigned long* mappedGeneration,
+                           unsigned long* mappedSize )
+{
+    int status;
+
+    pthread_mutex_lock ( &remapLock );
+
+    unsigned long generation = __atomic_load_n ( segmentGeneration,
+                                                 __ATOMIC_ACQUIRE );
+    unsigned long size = __atomic_load_n ( segmentSize, __ATOMIC_ACQUIRE );
+
+    if ( size > *mappedSize )
+    {
+        LOG ( "Remapping shared memory segment at %p from %'lu to %'lu "
+              "bytes\n", base, *mappedSize, size );
+
+        status = extendMapping ( base, fd, *mappedSize, size );
+        if ( status != 0 )
+        {
+            printf ( "Error: Unable to map the grown shared memory segment at "
+                     "%p to %lu bytes - errno: %u[%s] - Aborting\n", base,
+                     size, status, strerror(status) );
+            exit ( 255 );
+        }
+        *mappedSize = size;
+    }
+    __atomic_store_n ( mappedGeneration, generation, __ATOMIC_RELEASE );
+
+    pthread_mutex_unlock ( &remapLock );
+}
+
+
+//
+//  Map any memory added to the user shared memory segment by another
+//  process.
+//
+void sm_remap ( void )
+{
+    remapSegment ( smControl, smFd, &smControl->generation,
+                   &smControl->sharedMemorySegmentSize, &smGeneration,
+                   &smMappedSize );
+}
+
+
+//
+//  Map any memory added to the system shared memory segment by another
+//  process.
+//
+void sm_remap_sys ( void )
+{
+    remapSegment ( sysControl, sysFd, &sysControl->generation,
+                   &sysControl->sharedMemorySegmentSize, &sysGeneration,
+                   &sysMappedSize );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    g r o w S e g m e n t
+
+    @brief Extend a shared memory segment.
+
+    This function will extend the segment file to the new size, map the new
+    memory into this process, and then publish the new size and generation
+    of the segment so that the other processes using the segment will map
+    the new memory as well.
+
+    The caller must hold the lock that protects the allocation of memory in
+    the segment so that only one process can grow a segment at a time.
+
+    @param[in] base - The base address of the segment
+    @param[in] fd - The file descriptor of the segment file
+    @param[in,out] segmentGeneration - The address of the segment generation
+    @param[in,out] segmentSize - The address of the segment size
+    @param[in,out] mappedGeneration - The generation mapped in this process
+    @param[in,out] mappedSize - The number of bytes mapped in this process
+    @param[in] newSize - The new size of the segment
+
+    @return  0 = Success
+            ~0 = Failure (errno value)
+
+------------------------------------------------------------------------*/
+static int growSegment ( void* base, int fd,
+                         unsigned long* segmentGeneration,
+                         unsigned long* segmentSize,
+                         unsigned long* mappedGeneration,
+                         unsigned long* mappedSize,
+                         unsigned long  newSize )
+{
+    int status;
+
+    //
+    //  Make sure this process has all of the current segment mapped before
+    //  we add to it.
+    //
+    remapSegment ( base, fd, segmentGeneration, segmentSize, mappedGeneration,
+                   mappedSize );
+    //
+    //  Extend the segment file.  The new memory in the file will be zero
+    //  filled.
+    //
+    status = ftruncate ( fd, newSize );
+    if ( status != 0 )
+    {
+        return errno;
+    }
+    //
+    //  Map the new memory into this process.
+    //
+    pthread_mutex_lock ( &remapLock );
+
+    status = extendMapping ( base, fd, *mappedSize, newSize );
+    if ( status == 0 )
+    {
+        *mappedSize = newSize;
+
+        //
+        //  Publish the new size of the segment and then the new generation.
+        //
+        __atomic_store_n ( segmentSize, newSize, __ATOMIC_RELEASE );
+
+        unsigned long generation = *segmentGeneration + 1;
+
+        __atomic_store_n ( segmentGeneration, generation, __ATOMIC_RELEASE );
+        __atomic_store_n ( mappedGeneration,  generation, __ATOMIC_RELEASE );
+    }
+    pthread_mutex_unlock ( &remapLock );
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    g r o w t h S i z e
+
+    @brief Compute the new size of a segment that needs to be grown.
+
+    Segments are doubled in size (rounded up to a whole number of pages) each
+    time they are grown unless more than that is needed, up to the maximum
+    size of the segment.
+
+    @param[in] currentSize - The current size of the segment
+    @param[in] neededSize - The minimum number of bytes that must be added
+    @param[in] maximumSize - The maximum size of the segment
+
+    @return The new size of the segment or 0 if the segment cannot be grown
+            by the needed amount
+
+------------------------------------------------------------------------*/
+static unsigned long growthSize ( unsigned long currentSize,
+                                  unsigned long neededSize,
+                                  unsigned long maximumSize )
+{
+    unsigned long pageSize = sysconf ( _SC_PAGESIZE );
+    unsigned long growth   = currentSize;
+
+    if ( growth < neededSize )
+    {
+        growth = neededSize;
+    }
+    growth = ( growth + pageSize - 1 ) & ~( pageSize - 1 );
+
+    if ( currentSize + growth > maximumSize )
+    {
+        growth = maximumSize - currentSize;
+    }
+    if ( growth < neededSize )
+    {
+        return 0;
+    }
+    return currentSize + growth;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ g r o w
+
+    @brief Grow the user shared memory segment.
+
+    This function will grow the user shared memory segment by at least the
+    specified number of bytes and add the new memory to the available memory
+    pool (merging it with the last chunk of memory in the segment if that one
+    is free).
+
+    This function must be called with the shared memory manager lock held.
+
+    @param[in] neededSize - The minimum number of bytes to add
+
+    @return  0 = Success
+            ~0 = Failure (errno value)
+
+------------------------------------------------------------------------*/
+static int sm_grow ( unsigned long neededSize )
+{
+    int status;
+
+    unsigned long oldSize = smControl->sharedMemorySegmentSize;
+    unsigned long newSize = growthSize ( oldSize, neededSize,
+                                         MAXIMUM_SHARED_MEMORY_SIZE );
+    if ( newSize == 0 )
+    {
+        printf ( "Error: The user shared memory segment cannot grow past "
+                 "%'lu bytes\n", MAXIMUM_SHARED_MEMORY_SIZE );
+        return ENOMEM;
+    }
+    LOG ( "Growing the user shared memory segment from %'lu to %'lu bytes\n",
+          oldSize, newSize );
+
+    status = growSegment ( smControl, smFd, &smControl->generation,
+                           &smControl->sharedMemorySegmentSize, &smGeneration,
+                           &smMappedSize, newSize );
+    if ( status != 0 )
+    {
+        printf ( "Error: Unable to grow the user shared memory segment to %'lu "
+                 "bytes - errno: %u[%s]\n", newSize, status, strerror(status) );
+        return status;
+    }
+    smControl->currentSize += newSize - oldSize;
+
+    SM_TRACE ( te_grow, 0, 0, newSize );
+
+    //
+    //  Turn the new memory into an allocated memory chunk and then go free
+    //  it.  This will put it into the available memory pool and merge it with
+    //  the previous chunk of memory if that one is free.
+    //
+    memoryChunk_t* newMemory = (void*)smControl + oldSize;
+
+    newMemory->marker      = SM_IN_USE_MARKER;
+    newMemory->segmentSize = newSize - oldSize;
+    newMemory->offset      = oldSize;
+    newMemory->type        = TYPE_USER;
+
+    sm_free ( &newMemory->data );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ g r o w _ s y s
+
+    @brief Grow the system shared memory segment.
+
+    This function will double the size of the system shared memory segment
+    and add the new memory to the free list of B-tree node blocks.
+
+    This function must be called with the shared memory manager lock held.
+
+    @return  0 = Success
+            ~0 = Failure (errno value)
+
+------------------------------------------------------------------------*/
+static int sm_grow_sys ( void )
+{
+    int status;
+
+    unsigned long oldSize = sysControl->sharedMemorySegmentSize;
+    unsigned long newSize = growthSize ( oldSize, 1,
+                                         SYS_MAXIMUM_SHARED_MEMORY_SIZE );
+    if ( newSize == 0 )
+    {
+        printf ( "Error: The system shared memory segment cannot grow past "
+                 "%'lu bytes\n", SYS_MAXIMUM_SHARED_MEMORY_SIZE );
+        return ENOMEM;
+    }
+    LOG ( "Growing the system shared memory segment from %'lu to %'lu "
+          "bytes\n", oldSize, newSize );
+
+    status = growSegment ( sysControl, sysFd, &sysControl->generation,
+                           &sysControl->sharedMemorySegmentSize,
+                           &sysGeneration, &sysMappedSize, newSize );
+    if ( status != 0 )
+    {
+        printf ( "Error: Unable to grow the system shared memory segment to "
+                 "%'lu bytes - errno: %u[%s]\n", newSize, status,
+                 strerror(status) );
+        return status;
+    }
+    sysControl->currentSize += newSize - oldSize;
+
+    SM_TRACE ( te_grow, 0, 1, newSize );
+
+    //
+    //  Divide the new memory up into B-tree node blocks.
+    //
+    carveSysNodes ( oldSize, newSize - oldSize );
+
+    return 0;
+}
+
+
 /*!-----------------------------------------------------------------------
 
     s m _ i n i t i a l i z e
@@ -228,8 +661,8 @@ sharedMemory_t* sm_initialize ( int fd, size_t sharedMemorySegmentSize )
     //
     //  Map the shared memory file into virtual memory.
     //
-    sharedMemory = mmap ( NULL, INITIAL_SHARED_MEMORY_SIZE,
-                          PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0 );
+    sharedMemory = mapSegment ( fd, sharedMemorySegmentSize,
+                                MAXIMUM_SHARED_MEMORY_SIZE );
     if ( sharedMemory == MAP_FAILED )
     {
         printf ( "Unable to map the user shared memory segment. errno: %u[%m].\n",
@@ -241,11 +674,11 @@ sharedMemory_t* sm_initialize ( int fd, size_t sharedMemorySegmentSize )
     //  shared memory segment.  Note that this will destroy any existing data
     //  if the segment already exists.
     //
-    status = ftruncate ( fd, INITIAL_SHARED_MEMORY_SIZE );
+    status = ftruncate ( fd, sharedMemorySegmentSize );
     if (status != 0)
     {
         printf ( "Unable to resize the user shared memory segment to [%'lu] bytes - "
-                 "errno: %u[%m].\n", INITIAL_SHARED_MEMORY_SIZE, errno );
+                 "errno: %u[%m].\n", sharedMemorySegmentSize, errno );
         return 0;
     }
     //
@@ -259,6 +692,14 @@ sharedMemory_t* sm_initialize ( int fd, size_t sharedMemorySegmentSize )
     //
     smControl = sharedMemory;
 
+    //
+    //  Save the segment file descriptor and mapped size so that we can grow
+    //  this segment later.
+    //
+    smFd         = fd;
+    smMappedSize = sharedMemorySegmentSize;
+    smGeneration = 0;
+
     //
     //  Initialize the fields in the shared memory control structure.  This
     //  structure is located at the beginning of the shared memory region that
@@ -269,6 +710,37 @@ sharedMemory_t* sm_initialize ( int fd, size_t sharedMemorySegmentSize )
     smControl->currentOffset           = smSize;
     smControl->currentSize             = sharedMemorySegmentSize - smSize;
     smControl->systemInitialized       = 0;
+    smControl->generation              = 0;
+
+    //
+    //  Clear the trace ring.  A record with a zero sequence number is empty.
+    //
+    smControl->traceIndex = 0;
+    (void)memset ( smControl->traceRing, 0, sizeof(smControl->traceRing) );
+
+    //
+    //  Empty all of the slab free lists.
+    //
+    (void)memset ( smControl->slabFreeList, 0,
+                   sizeof(smControl->slabFreeList) );
+    smControl->slabPageCount = 0;
+
+    //
+    //  Mark all of the magazines as being available.
+    //
+    (void)memset ( smControl->magazines, 0, sizeof(smControl->magazines) );
+
+    //
+    //  Start the reclamation epoch at 1 since an epoch of 0 in a magazine
+    //  means that it's owner is not in an epoch protected section.
+    //
+    smControl->reclaimEpoch      = 1;
+    smControl->anonymousOverflow = 0;
+    smControl->limboList         = 0;
+    smControl->limboPageCount    = 0;
+
+    (void)memset ( smControl->anonymousReaders, 0,
+                   sizeof(smControl->anonymousReaders) );
 
     //
     //  Create the mutex attribute initializer that we can use to initialize
@@ -424,8 +896,8 @@ sysMemory_t* sm_initialize_sys ( int fd, size_t sharedMemorySegmentSize )
     //
     //  Map the shared memory file into virtual memory.
     //
-    sharedMemory = mmap ( NULL, SYS_INITIAL_SHARED_MEMORY_SIZE,
-                          PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0 );
+    sharedMemory = mapSegment ( fd, sharedMemorySegmentSize,
+                                SYS_MAXIMUM_SHARED_MEMORY_SIZE );
     if ( sharedMemory == MAP_FAILED )
     {
         printf ( "Unable to map the system shared memory segment. errno: %u[%m].\n",
@@ -437,11 +909,11 @@ sysMemory_t* sm_initialize_sys ( int fd, size_t sharedMemorySegmentSize )
     //  shared memory segment.  Note that this will destroy any existing data
     //  if the segment already exists.
     //
-    status = ftruncate ( fd, SYS_INITIAL_SHARED_MEMORY_SIZE );
+    status = ftruncate ( fd, sharedMemorySegmentSize );
     if (status != 0)
     {
         printf ( "Unable to resize the system shared memory segment to [%lu] "
-                 "bytes - errno: %u[%m].\n", SYS_INITIAL_SHARED_MEMORY_SIZE,
+                 "bytes - errno: %u[%m].\n", sharedMemorySegmentSize,
                   errno );
         return 0;
     }
@@ -456,6 +928,14 @@ sysMemory_t* sm_initialize_sys ( int fd, size_t sharedMemorySegmentSize )
     //
     sysControl = sharedMemory;
 
+    //
+    //  Save the segment file descriptor and mapped size so that we can grow
+    //  this segment later.
+    //
+    sysFd         = fd;
+    sysMappedSize = sharedMemorySegmentSize;
+    sysGeneration = 0;
+
     //
     //  Initialize the fields in the shared memory control structure.  This
     //  structure is located at the beginning of the shared memory region that
@@ -466,6 +946,7 @@ sysMemory_t* sm_initialize_sys ( int fd, size_t sharedMemorySegmentSize )
     sysControl->currentOffset           = sysSize;
     sysControl->currentSize             = sharedMemorySegmentSize - sysSize;
     sysControl->systemInitialized       = 0;
+    sysControl->generation              = 0;
 
     //
     //  Create the mutex attribute initializer that we can use to initialize
@@ -516,600 +997,2046 @@ sysMemory_t* sm_initialize_sys ( int fd, size_t sharedMemorySegmentSize )
     //  Now we can divide up the rest of the system shared memory segment into
     //  the free B-tree blocks list.
     //
-    //  We do this by creating a singly linked list of blocks using the blocks
-    //  themselves containing the offset to the next block.
-    //
-    //  Now compute the size of each node in the system B-trees...
+    sysControl->freeListHead  = 0;
+    sysControl->freeListTail  = 0;
+    sysControl->freeListCount = 0;
+
+    carveSysNodes ( sysSize, sharedMemorySegmentSize - sysSize );
+
     //
-    //  If the user specified an even number of records, increment it to be an
-    //  odd number.  The btree algorithm here only operates correctly if the
-    //  record count is odd.
+    //  Set the "initialized" flag to indicate that the shared memory
+    //  allocation system is in a usable state.  Note that this indicator is
+    //  primarily used by the sm_malloc function to determine how to allocate
+    //  memory for the shared memory memory management function B-trees that
+    //  we just defined above.
     //
-    unsigned int maxRecordsPerNode = SYS_RECORD_COUNT;
+    sysControl->systemInitialized = 1;
 
-    if ( ( maxRecordsPerNode & 1 ) == 0 )
-    {
-        maxRecordsPerNode++;
-    }
-    //
-    //  Compute the node size as the btree node header size plus the size of
-    //  the record offset area plus the link offfset area.
     //
-    unsigned int nodeSize = sN + ( maxRecordsPerNode * sO ) +
-                            ( ( maxRecordsPerNode + 1 ) * sO );
+    //  Initialize the 2 sets of data structures defined in the system shared
+    //  memory segment that we will need in order to create the system B-trees
+    //  that come next.
     //
-    //  Round up the node size to the next multiple of 8 bytes to maintain
-    //  long int alignment in the structures.
+    //  These data structures were allocated in the definition of the
+    //  sysMemory_t object typedef but we need to fill them in since the
+    //  compiler can't do the runtime initialization of these.
     //
-    nodeSize = ( nodeSize + 7 ) & 0xfffffff8;
+    sysControl->sizeKeyDef.fieldCount = 2;
+    sysControl->sizeFieldDef1.type   = ft_ulong;
+    sysControl->sizeFieldDef1.offset = offsetof ( memoryChunk_t, segmentSize );
+    sysControl->sizeFieldDef1.size   = 1;
+    sysControl->sizeFieldDef2.type   = ft_ulong;
+    sysControl->sizeFieldDef2.offset = offsetof ( memoryChunk_t, offset );
+    sysControl->sizeFieldDef2.size   = 1;
 
-    //
-    //  Round up the current free memory offset to the next multiple of 8
-    //  bytes.
-    //
-    offset_t currentOffset = ( sysControl->currentOffset + 7 ) & 0xfffffff8;
+    sysControl->offsetKeyDef.fieldCount = 1;
+    sysControl->offsetFieldDef.type   = ft_ulong;
+    sysControl->offsetFieldDef.offset = offsetof ( memoryChunk_t, offset );
+    sysControl->offsetFieldDef.size   = 1;
 
     //
-    //  Adjust the number of bytes of free memory available after the rounding
-    //  up of the offset above.
+    //  Now go initialize the 2 B-trees that will be used to perform the
+    //  memory management in the user shared memory segment.
     //
-    unsigned int currentSize =
-        sysControl->currentSize - ( currentOffset - sysControl->currentOffset );
-
+    sysControl->availableMemoryBySize.type = TYPE_SYSTEM;
+    btree_create_sys ( &sysControl->availableMemoryBySize,
+                       SYS_RECORD_COUNT,
+                       &sysControl->sizeKeyDef );
+
+    sysControl->availableMemoryByOffset.type = TYPE_SYSTEM;
+    btree_create_sys ( &sysControl->availableMemoryByOffset,
+                       SYS_RECORD_COUNT,
+                       &sysControl->offsetKeyDef );
+    //
+    //  Let the user know that the system initialization has been completed.
+    //
+    LOG ( "\n===== System shared memory is Initialized at %p =====\n\n",
+          sysControl );
+    //
+    //  Return the address of the shared memory segment to the caller.
+    //
+    return sharedMemory;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ a t t a c h
+
+    @brief Map an existing user shared memory segment into this process.
+
+    The segment file is mapped into a new address reservation and then any
+    memory that has been added to the segment since the file size was
+    obtained is mapped as well.  The magazines of any processes that died
+    with the segment open are reclaimed.
+
+    @param[in] fd - The file descriptor of the segment file.  This file
+               descriptor must remain open until sm_detach is called.
+    @param[in] segmentFileSize - The current size of the segment file
+
+    @return The address of the shared memory segment or a null pointer if it
+            could not be mapped.
+
+------------------------------------------------------------------------*/
+sharedMemory_t* sm_attach ( int fd, size_t segmentFileSize )
+{
+    sharedMemory_t* sharedMemory;
+
+    sharedMemory = mapSegment ( fd, segmentFileSize,
+                                MAXIMUM_SHARED_MEMORY_SIZE );
+    if ( sharedMemory == MAP_FAILED )
+    {
+        printf ( "Unable to map the user shared memory segment. errno: %u[%m].\n",
+                 errno );
+        return 0;
+    }
+    smControl    = sharedMemory;
+    smFd         = fd;
+    smMappedSize = segmentFileSize;
+
+    sm_remap();
+
+    //
+    //  Recover any memory cached by processes that died while they had the
+    //  segment open.
+    //
+    sm_reclaim_magazines();
+
+    return smControl;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ a t t a c h _ s y s
+
+    @brief Map an existing system shared memory segment into this process.
+
+    See sm_attach.
+
+------------------------------------------------------------------------*/
+sysMemory_t* sm_attach_sys ( int fd, size_t segmentFileSize )
+{
+    sysMemory_t* sharedMemory;
+
+    sharedMemory = mapSegment ( fd, segmentFileSize,
+                                SYS_MAXIMUM_SHARED_MEMORY_SIZE );
+    if ( sharedMemory == MAP_FAILED )
+    {
+        printf ( "Unable to map the system shared memory segment. errno: "
+                 "%u[%m].\n", errno );
+        return 0;
+    }
+    sysControl    = sharedMemory;
+    sysFd         = fd;
+    sysMappedSize = segmentFileSize;
+
+    sm_remap_sys();
+
+    return sysControl;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ d e t a c h
+
+    @brief Unmap the user shared memory segment from this process.
+
+    This will drain the magazines owned by this process, release the entire
+    address reservation of the segment and close the segment file.
+
+    @return  0 = Success
+            ~0 = Failure (errno value)
+
+------------------------------------------------------------------------*/
+int sm_detach ( void )
+{
+    int status = 0;
+
+    //
+    //  Give back all of the memory cached in this process' magazines.
+    //
+    sm_release_magazines();
+
+    if ( munmap ( smControl, MAXIMUM_SHARED_MEMORY_SIZE ) != 0 )
+    {
+        status = errno;
+    }
+    (void)close ( smFd );
+
+    //
+    //  Forget the segment so that nothing (such as the thread exit handler
+    //  of the magazines) touches it after it has been unmapped.
+    //
+    smControl    = NULL;
+    smFd         = -1;
+    smMappedSize = 0;
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ d e t a c h _ s y s
+
+    @brief Unmap the system shared memory segment from this process.
+
+    See sm_detach.
+
+------------------------------------------------------------------------*/
+int sm_detach_sys ( void )
+{
+    int status = 0;
+
+    if ( munmap ( sysControl, SYS_MAXIMUM_SHARED_MEMORY_SIZE ) != 0 )
+    {
+        status = errno;
+    }
+    (void)close ( sysFd );
+
+    sysControl    = NULL;
+    sysFd         = -1;
+    sysMappedSize = 0;
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    S l a b   A l l o c a t o r   F u n c t i o n s
+
+    The slab free lists are lock-free stacks so allocating or freeing a
+    small block is a single compare-and-swap on the head of the free list
+    for it's size class.  The shared memory manager lock is only needed when
+    a size class runs out of blocks and a new slab page has to be allocated.
+
+------------------------------------------------------------------------*/
+//
+//  Define the mask used to extract the block offset from a free list head.
+//
+#define SLAB_OFFSET_MASK ( 0xffffffffUL )
+
+//
+//  Build a new free list head value from an old head value and the offset of
+//  the new first block in the list.
+//
+static inline unsigned long slabHead ( unsigned long oldHead, offset_t offset )
+{
+    return ( ( ( oldHead >> 32 ) + 1 ) << 32 ) | ( offset >> 3 );
+}
+
+
+//
+//  Return the offset of the first block in a free list given it's head.
+//
+static inline offset_t slabHeadOffset ( unsigned long head )
+{
+    return ( head & SLAB_OFFSET_MASK ) << 3;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s l a b _ p u s h
+
+    @brief Push a chain of blocks onto a size class free list.
+
+    The blocks from "first" to "last" must already be linked together.  The
+    whole chain is pushed onto the free list with a single compare-and-swap
+    by linking the last block to the current first block of the list.
+
+    @param[in] sizeClass - The index of the size class free list
+    @param[in] first - The offset of the first block in the chain
+    @param[in] last - The address of the last block in the chain
+
+------------------------------------------------------------------------*/
+static void sm_slab_push ( unsigned int sizeClass, offset_t first,
+                           slabBlock_t* last )
+{
+    unsigned long* head    = &smControl->slabFreeList[sizeClass];
+    unsigned long  oldHead = __atomic_load_n ( head, __ATOMIC_RELAXED );
+
+    do
+    {
+        *(offset_t*)last->data = slabHeadOffset ( oldHead );
+
+    }   while ( ! __atomic_compare_exchange_n ( head, &oldHead,
+                                                slabHead ( oldHead, first ),
+                                                true, __ATOMIC_RELEASE,
+                                                __ATOMIC_RELAXED ) );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s l a b _ r e f i l l
+
+    @brief Add a new slab page of blocks to a size class free list.
+
+    The new page is allocated from the B-tree allocator, carved up into
+    blocks of the size class size, and the whole chain of blocks is pushed
+    onto the free list with a single compare-and-swap.
+
+    @param[in] sizeClass - The index of the size class to refill
+
+    @return  0 = Success
+            ~0 = Failure (errno value)
+
+------------------------------------------------------------------------*/
+static int sm_slab_refill ( unsigned int sizeClass )
+{
+    unsigned long blockSize  = SM_SLAB_MIN_SIZE << sizeClass;
+    unsigned long blockCount = SM_SLAB_PAGE_SIZE / blockSize;
+    slabBlock_t*  block      = NULL;
+
+    LOG ( "Refilling slab size class %u[%lu bytes]\n", sizeClass, blockSize );
+
+    void* page = sm_malloc ( SM_SLAB_PAGE_SIZE );
+    if ( page == NULL )
+    {
+        return ENOMEM;
+    }
+    offset_t pageOffset = toOffset ( page );
+
+    //
+    //  Initialize all of the blocks in the new page and link them together.
+    //
+    for ( unsigned long i = 0; i < blockCount; ++i )
+    {
+        block = page + i * blockSize;
+
+        block->type      = TYPE_SLAB_FREE;
+        block->sizeClass = sizeClass;
+
+        *(offset_t*)block->data = pageOffset + ( i + 1 ) * blockSize;
+    }
+    //
+    //  Push the entire chain of new blocks onto the free list.
+    //
+    sm_slab_push ( sizeClass, pageOffset, block );
+
+    __atomic_add_fetch ( &smControl->slabPageCount, 1, __ATOMIC_RELAXED );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s l a b _ p o p
+
+    @brief Pop the first block off of a size class free list.
+
+    If the list is empty, a new page of blocks is added to it and we try
+    again.
+
+    Note that the block we are looking at may be popped (and then written
+    to) by another thread before we get to our compare-and-swap so the
+    "next" offset we read may be garbage.  In that case the tag in the head
+    will have changed and our compare-and-swap will fail.
+
+    @param[in] sizeClass - The index of the size class free list
+
+    @return The address of the block or NULL if no memory is available.
+
+------------------------------------------------------------------------*/
+static slabBlock_t* sm_slab_pop ( unsigned int sizeClass )
+{
+    unsigned long* head    = &smControl->slabFreeList[sizeClass];
+    unsigned long  oldHead = __atomic_load_n ( head, __ATOMIC_ACQUIRE );
+    slabBlock_t*   block;
+
+    for ( ;; )
+    {
+        if ( slabHeadOffset ( oldHead ) == 0 )
+        {
+            if ( sm_slab_refill ( sizeClass ) != 0 )
+            {
+                printf ( "Error: Unable to allocate a slab page for size "
+                         "class %u\n", sizeClass );
+                return NULL;
+            }
+            oldHead = __atomic_load_n ( head, __ATOMIC_ACQUIRE );
+            continue;
+        }
+        block = toAddress ( slabHeadOffset ( oldHead ) );
+
+        offset_t next = __atomic_load_n ( (offset_t*)block->data,
+                                          __ATOMIC_RELAXED );
+
+        if ( __atomic_compare_exchange_n ( head, &oldHead,
+                                           slabHead ( oldHead, next ), true,
+                                           __ATOMIC_ACQUIRE,
+                                           __ATOMIC_ACQUIRE ) )
+        {
+            return block;
+        }
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    M a g a z i n e   F u n c t i o n s
+
+    Each thread that allocates small blocks claims one of the magazines in
+    the shared memory segment the first time it needs one.  Blocks are
+    allocated from and freed to the thread's magazine without touching any
+    shared data.  When a magazine is empty it is refilled with a batch of
+    blocks from the slab free lists and when it is full, a batch of blocks is
+    pushed back onto the slab free lists as a single chain.
+
+    Since the magazines live in the shared memory segment, the blocks cached
+    in a magazine belonging to a process that died are not lost.  They are
+    put back on the slab free lists by the next process that attaches to the
+    shared memory segment (or that cannot find a free magazine).
+
+    Note that a magazine is only ever modified by the thread that owns it
+    (or by a reclaimer once the owner is known to be dead) so the count is
+    always updated such that a crash can leak a block but can never leave
+    the same block in a magazine and somewhere else.
+
+------------------------------------------------------------------------*/
+//
+//  Define the magazine owned by this thread.  If no magazine could be
+//  claimed, the "unavailable" flag keeps us from searching for one on every
+//  allocation.
+//
+//  The segment address and generation of the magazine when it was claimed
+//  are kept so that a magazine that was drained when the segment was
+//  detached (by another thread of this process) is never used again.
+//
+static __thread magazine_t*     threadMagazine      = NULL;
+static __thread bool            magazineUnavailable = false;
+static __thread sharedMemory_t* magazineSegment     = NULL;
+static __thread unsigned long   magazineGeneration  = 0;
+
+//
+//  Define the nesting depth of this thread's epoch protected sections and
+//  the magazine (if any) that recorded the epoch of the outermost one.  If
+//  there is no magazine, the anonymous reader count that this thread was
+//  counted in is kept instead.
+//
+static __thread unsigned int   epochDepth     = 0;
+static __thread magazine_t*    epochMagazine  = NULL;
+static __thread unsigned long* epochAnonymous = NULL;
+
+//
+//  Define the key used to drain a thread's magazine when the thread exits.
+//
+static pthread_key_t  magazineKey;
+static pthread_once_t magazineOnce = PTHREAD_ONCE_INIT;
+
+
+//
+//  Push a list of blocks from a magazine onto the slab free list for their
+//  size class.
+//
+static void magazinePush ( unsigned int sizeClass, offset_t* blocks,
+                           unsigned int count )
+{
+    slabBlock_t* block = toAddress ( blocks[0] );
+
+    for ( unsigned int i = 1; i < count; ++i )
+    {
+        *(offset_t*)block->data = blocks[i];
+        block = toAddress ( blocks[i] );
+    }
+    sm_slab_push ( sizeClass, blocks[0], block );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    m a g a z i n e D r a i n
+
+    @brief Empty a magazine and give up ownership of it.
+
+    All of the blocks in the magazine are pushed back onto the slab free
+    lists, any retired blocks still in it's limbo are moved to the shared
+    limbo list, and then the magazine is marked as being available.  The caller
+    must be either the owner of the magazine or the reclaimer of a magazine
+    whose owner has died.
+
+    @param[in] magazine - The address of the magazine to release
+
+------------------------------------------------------------------------*/
+static void magazineDrain ( magazine_t* magazine )
+{
+    offset_t blocks[SM_MAGAZINE_SIZE];
+
+    for ( unsigned int sizeClass = 0; sizeClass < SM_SLAB_CLASS_COUNT;
+          ++sizeClass )
+    {
+        //
+        //  Take the blocks out of the magazine before pushing them so that
+        //  if we crash in the middle of this, the blocks are leaked instead
+        //  of being pushed twice by the next reclaimer.
+        //
+        unsigned int count = magazine->count[sizeClass];
+        if ( count > SM_MAGAZINE_SIZE )
+        {
+            count = SM_MAGAZINE_SIZE;
+        }
+        memcpy ( blocks, magazine->blocks[sizeClass],
+                 count * sizeof(offset_t) );
+
+        __atomic_store_n ( &magazine->count[sizeClass], 0, __ATOMIC_RELEASE );
+
+        if ( count > 0 )
+        {
+            magazinePush ( sizeClass, blocks, count );
+        }
+    }
+    //
+    //  Move any blocks that are still waiting in the limbo of this magazine
+    //  to the shared limbo list where they will be reclaimed by someone else.
+    //
+    offset_t      limbo[SM_EPOCH_LIMBO_SIZE];
+    unsigned long limboEpoch[SM_EPOCH_LIMBO_SIZE];
+
+    unsigned int count = magazine->limboCount;
+    if ( count > SM_EPOCH_LIMBO_SIZE )
+    {
+        count = SM_EPOCH_LIMBO_SIZE;
+    }
+    memcpy ( limbo, magazine->limbo, count * sizeof(offset_t) );
+    memcpy ( limboEpoch, magazine->limboEpoch, count * sizeof(unsigned long) );
+
+    __atomic_store_n ( &magazine->limboCount, 0, __ATOMIC_RELEASE );
+
+    if ( count > 0 )
+    {
+        limboSpill ( limbo, limboEpoch, count );
+    }
+    __atomic_store_n ( &magazine->epoch, 0, __ATOMIC_RELEASE );
+
+    //
+    //  Let the thread that owned this magazine know that it is no longer
+    //  it's magazine.
+    //
+    __atomic_add_fetch ( &magazine->generation, 1, __ATOMIC_RELEASE );
+
+    magazine->threadId = 0;
+    __atomic_store_n ( &magazine->processId, 0, __ATOMIC_RELEASE );
+}
+
+
+//
+//  Return true if the magazine of this thread is still it's own.  It isn't
+//  if the segment was detached (and maybe attached again) since the magazine
+//  was claimed.
+//
+static inline bool magazineValid ( void )
+{
+    return threadMagazine != NULL && smControl != NULL &&
+           magazineSegment == smControl &&
+           __atomic_load_n ( &threadMagazine->generation, __ATOMIC_ACQUIRE ) ==
+               magazineGeneration;
+}
+
+
+//
+//  Drain the magazine of a thread that is exiting.  If the segment has been
+//  detached since the magazine was claimed, the magazine was already drained
+//  and may not even be mapped any more.
+//
+static void magazineThreadExit ( void* magazine )
+{
+    if ( threadMagazine == magazine && magazineValid() )
+    {
+        magazineDrain ( magazine );
+    }
+    threadMagazine = NULL;
+}
+
+
+//
+//  A child process starts out without a magazine since the one belonging to
+//  the forking thread still belongs to the parent.
+//
+static void magazineForkChild ( void )
+{
+    threadMagazine      = NULL;
+    magazineUnavailable = false;
+    epochDepth          = 0;
+    epochMagazine       = NULL;
+    epochAnonymous      = NULL;
+
+    (void)pthread_setspecific ( magazineKey, NULL );
+}
+
+
+//
+//  Set up the thread exit and fork handlers for the magazines.
+//
+static void magazineSetup ( void )
+{
+    (void)pthread_key_create ( &magazineKey, magazineThreadExit );
+    (void)pthread_atfork ( NULL, NULL, magazineForkChild );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ r e c l a i m _ m a g a z i n e s
+
+    @brief Recover the blocks cached by processes that have died.
+
+    Every magazine whose owning process no longer exists is drained back into
+    the slab free lists and made available again.  The anonymous readers of
+    those processes are written off as well (see anonymousReader_t).
+
+    Note that if the process ID of a dead process has already been reused by
+    a new process, it's magazines will not be reclaimed until the new process
+    also goes away.
+
+------------------------------------------------------------------------*/
+void sm_reclaim_magazines ( void )
+{
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        magazine_t* magazine = &smControl->magazines[i];
+        pid_t       owner    = __atomic_load_n ( &magazine->processId,
+                                                 __ATOMIC_ACQUIRE );
+        //
+        //  If this magazine is not in use or it's owner is still alive, skip
+        //  it.
+        //
+        if ( owner <= 0 || kill ( owner, 0 ) == 0 || errno != ESRCH )
+        {
+            continue;
+        }
+        //
+        //  Take ownership of the magazine so that no one else tries to
+        //  reclaim it at the same time and then give it's blocks back.
+        //
+        if ( __atomic_compare_exchange_n ( &magazine->processId, &owner,
+                                           SM_MAGAZINE_RECLAIMING, false,
+                                           __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED ) )
+        {
+            LOG ( "Reclaiming the magazine of dead process %d\n", owner );
+
+            magazineDrain ( magazine );
+        }
+    }
+    //
+    //  Write off the anonymous readers of the dead processes the same way.
+    //
+    for ( int i = 0; i < SM_ANONYMOUS_READER_COUNT; ++i )
+    {
+        anonymousReader_t* reader = &smControl->anonymousReaders[i];
+        pid_t              owner  = __atomic_load_n ( &reader->processId,
+                                                      __ATOMIC_ACQUIRE );
+        if ( owner <= 0 || kill ( owner, 0 ) == 0 || errno != ESRCH )
+        {
+            continue;
+        }
+        if ( __atomic_compare_exchange_n ( &reader->processId, &owner,
+                                           SM_MAGAZINE_RECLAIMING, false,
+                                           __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED ) )
+        {
+            LOG ( "Reclaiming the %lu anonymous readers of dead process %d\n",
+                  reader->count, owner );
+
+            __atomic_store_n ( &reader->count, 0, __ATOMIC_RELEASE );
+            __atomic_store_n ( &reader->processId, 0, __ATOMIC_RELEASE );
+        }
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ r e l e a s e _ m a g a z i n e s
+
+    @brief Drain all of the magazines owned by this process.
+
+    This is called when the shared memory segment is being detached so no
+    other threads in this process should be allocating memory at this point.
+    The other threads will see that their magazines were drained by the
+    change in the magazine generation.
+
+------------------------------------------------------------------------*/
+static void sm_release_magazines ( void )
+{
+    pid_t processId = getpid();
+
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        magazine_t* magazine = &smControl->magazines[i];
+
+        if ( __atomic_load_n ( &magazine->processId, __ATOMIC_ACQUIRE ) ==
+             processId )
+        {
+            magazineDrain ( magazine );
+        }
+    }
+    threadMagazine      = NULL;
+    magazineUnavailable = false;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    m a g a z i n e C l a i m
+
+    @brief Find a magazine for the current thread.
+
+    If all of the magazines are in use, the magazines of any dead processes
+    are reclaimed and we look one more time.
+
+    @return The address of the magazine or NULL if none are available.
+
+------------------------------------------------------------------------*/
+static magazine_t* magazineClaim ( void )
+{
+    pid_t processId = getpid();
+
+    (void)pthread_once ( &magazineOnce, magazineSetup );
+
+    for ( int pass = 0; pass < 2; ++pass )
+    {
+        for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+        {
+            magazine_t* magazine = &smControl->magazines[i];
+            pid_t       expected = 0;
+
+            if ( __atomic_compare_exchange_n ( &magazine->processId,
+                                               &expected, processId, false,
+                                               __ATOMIC_ACQUIRE,
+                                               __ATOMIC_RELAXED ) )
+            {
+                magazine->threadId = syscall ( SYS_gettid );
+
+                (void)pthread_setspecific ( magazineKey, magazine );
+
+                LOG ( "Thread %d claimed magazine %d\n", magazine->threadId,
+                      i );
+                return magazine;
+            }
+        }
+        sm_reclaim_magazines();
+    }
+    return NULL;
+}
+
+
+//
+//  Return the magazine for the current thread, claiming one if needed.
+//
+static inline magazine_t* magazineGet ( void )
+{
+    //
+    //  If our magazine was drained when the segment was detached, forget
+    //  about it and claim a new one.
+    //
+    if ( threadMagazine != NULL && ! magazineValid() )
+    {
+        threadMagazine      = NULL;
+        magazineUnavailable = false;
+    }
+    if ( threadMagazine == NULL && ! magazineUnavailable )
+    {
+        threadMagazine = magazineClaim();
+        if ( threadMagazine == NULL )
+        {
+            magazineUnavailable = true;
+        }
+        else
+        {
+            magazineSegment    = smControl;
+            magazineGeneration = __atomic_load_n ( &threadMagazine->generation,
+                                                   __ATOMIC_ACQUIRE );
+        }
+    }
+    return threadMagazine;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s l a b _ m a l l o c
+
+    @brief Allocate a small block of shared memory from the slabs.
+
+    The block is taken from the current thread's magazine if it has one.  An
+    empty magazine is first refilled with a batch of blocks from the slab
+    free list.
+
+    @param[in] size - The size in bytes of the memory desired.  This plus the
+                      slab block header must not be larger than
+                      SM_SLAB_MAX_SIZE.
+
+    @return The address of the allocated memory or NULL if the request could
+            not be honored.
+
+------------------------------------------------------------------------*/
+static void* sm_slab_malloc ( size_t size )
+{
+    unsigned int sizeClass = 0;
+    slabBlock_t* block     = NULL;
+
+    //
+    //  Find the smallest size class that will hold the requested size.
+    //
+    while ( ( SM_SLAB_MIN_SIZE << sizeClass ) < size + SLAB_HEADER_SIZE )
+    {
+        ++sizeClass;
+    }
+    magazine_t* magazine = magazineGet();
+
+    //
+    //  If there is no magazine for this thread, just take the block directly
+    //  from the slab free list.
+    //
+    if ( magazine == NULL )
+    {
+        block = sm_slab_pop ( sizeClass );
+    }
+    else
+    {
+        //
+        //  If the magazine is empty, refill it with a batch of blocks.  Each
+        //  block is recorded in the magazine before the count is updated.
+        //
+        unsigned int count = magazine->count[sizeClass];
+        if ( count == 0 )
+        {
+            while ( count < SM_MAGAZINE_BATCH )
+            {
+                block = sm_slab_pop ( sizeClass );
+                if ( block == NULL )
+                {
+                    break;
+                }
+                magazine->blocks[sizeClass][count] = toOffset ( block );
+                __atomic_store_n ( &magazine->count[sizeClass], ++count,
+                                   __ATOMIC_RELEASE );
+            }
+        }
+        //
+        //  Take the last block out of the magazine.  The count is decremented
+        //  before the block is handed out.
+        //
+        if ( count == 0 )
+        {
+            block = NULL;
+        }
+        else
+        {
+            __atomic_store_n ( &magazine->count[sizeClass], --count,
+                               __ATOMIC_RELEASE );
+            block = toAddress ( magazine->blocks[sizeClass][count] );
+        }
+    }
+    if ( block == NULL )
+    {
+        return NULL;
+    }
+    block->type = TYPE_SLAB_IN_USE;
+
+    LOG ( "  sm_slab_malloc returning[%p]\n", block->data );
+
+    return block->data;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s l a b _ f r e e
+
+    @brief Return a small block of shared memory to the slabs.
+
+    The block is put in the current thread's magazine if it has one.  A full
+    magazine first has a batch of it's blocks pushed back onto the slab free
+    list.
+
+    @param[in] block - The address of the slab block header
+
+------------------------------------------------------------------------*/
+static void sm_slab_free ( slabBlock_t* block )
+{
+    unsigned int sizeClass   = block->sizeClass;
+    offset_t     blockOffset = toOffset ( block );
+    magazine_t*  magazine    = magazineGet();
+
+    block->type = TYPE_SLAB_FREE;
+
+    //
+    //  If there is no magazine for this thread, just push the block directly
+    //  onto the slab free list.
+    //
+    if ( magazine == NULL )
+    {
+        sm_slab_push ( sizeClass, blockOffset, block );
+        return;
+    }
+    //
+    //  If the magazine is full, give a batch of blocks back to the slab free
+    //  list.  The count is decremented before the blocks are pushed.
+    //
+    unsigned int count = magazine->count[sizeClass];
+    if ( count >= SM_MAGAZINE_SIZE )
+    {
+        count -= SM_MAGAZINE_BATCH;
+        __atomic_store_n ( &magazine->count[sizeClass], count,
+                           __ATOMIC_RELEASE );
+
+        magazinePush ( sizeClass, &magazine->blocks[sizeClass][count],
+                       SM_MAGAZINE_BATCH );
+    }
+    //
+    //  Add the block to the magazine.
+    //
+    magazine->blocks[sizeClass][count] = blockOffset;
+    __atomic_store_n ( &magazine->count[sizeClass], count + 1,
+                       __ATOMIC_RELEASE );
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    s m _ m a l l o c
+
+    @brief Allocate a chunk of shared memory for a user.
+
+    This function will allocate a chunk of shared memory of the specified size
+    (in bytes).  If no memory is available of the specified size, a NULL
+    pointer will be returned, otherwise, the address (not the offset) of the
+    allocated chunk will be returned to the caller.
+
+    This function operates identically to the system "malloc" function and can
+    be used the same way.
+
+    @param[in] size - The size in bytes of the memory desired.
+
+    @return The address of the allocated memory chunk.
+            NULL if the request could not be honored.
+
+-----------------------------------------------------------------------------*/
+void* sm_malloc ( size_t size )
+{
+#ifdef VSI_DEBUG
+    LOG ( "In sm_malloc[%lu]\n", size );
+
+    //dumpSM();
+#endif
+
+    memoryChunk_t  needed = { 0 };
+    memoryChunk_t* found;
+    memoryChunk_t* availableChunk = NULL;
+    unsigned long  neededSize;
+    int            status;
+
+    SM_TRACE ( te_malloc, 0, 0, size );
+
+    //
+    //  Initialize the size of the memory we need.  Note that we need enough
+    //  space to insert the chunkHeader_t at the beginning of the block the
+    //  user wants.
+    //
+    neededSize = size + CHUNK_HEADER_SIZE;
+
+    //
+    //  Make sure the memory we are going to allocate is a multiple of 8 bytes
+    //  by rounding it up to the next multiple of 8.  Note that since we start
+    //  with a properly aligned block of memory, all of the allocated blocks
+    //  will also be properly aligned as long as we make sure they are all a
+    //  multiple of 8 bytes.
+    //
+    //  TODO: Do we need to generalize this?  (like using "sizeof(long)", etc.
+    //
+    neededSize = ( neededSize + 7 ) & 0xfffffffffffffff8;
+
+    //
+    //  If the shared memory memory management system has not yet been
+    //  initialized, just grab what we need from the beginning of the shared
+    //  memory segment.
+    //
+    if ( ! sysControl->systemInitialized )
+    {
+        printf ( "Error: sm_malloc called before init finished for size: [%zu]\n",
+                 size );
+        exit ( 255 );
+    }
+    //
+    //  If this is a small piece of memory, go get it from the slabs.
+    //
+    if ( size + SLAB_HEADER_SIZE <= SM_SLAB_MAX_SIZE )
+    {
+        return sm_slab_malloc ( size );
+    }
+    //
+    //  If we got here we are operating in "normal" mode rather than
+    //  "infrastructure initialization" mode.
+    //
+    //  Lock the mutex that controls the shared memory manager.
+    //
+    SM_LOCK;
+
+    //
+    //  Make sure we have all of the memory that has been added to the
+    //  segments by other processes mapped before we start.
+    //
+    sm_check_mapping();
+    sm_check_mapping_sys();
+
+    //
+    //  Set up the data structure that we need to search for the appropriately
+    //  sized chunk of memory.
+    //
+    needed.segmentSize = neededSize;
+    needed.offset      = 0;
+
+    //
+    //  Go find the first block in the available B-tree that is equal to or
+    //  greater than the size we need.  The iterator is kept on the stack so
+    //  that this search does not need any heap memory.
+    //
+    btree_iterator_t iterator;
+    btree_iter       iter;
+
+    iter = btree_find_into ( &sysControl->availableMemoryBySize, &needed,
+                             &iterator );
+
+    //
+    //  If the search didn't find anything then we don't have any memory
+    //  chunks large enough to fulfill the request so go grow the shared
+    //  memory segment and then try again.
+    //
+    if ( btree_iter_at_end ( iter ) )
+    {
+        availableChunk = NULL;
+        if ( sm_grow ( neededSize ) != 0 )
+        {
+            printf ( "Error: No memory block of size %zu is available!\n",
+                     size );
+            goto mallocEnd;
+        }
+        iter = btree_find_into ( &sysControl->availableMemoryBySize, &needed,
+                                 &iterator );
+        if ( btree_iter_at_end ( iter ) )
+        {
+            printf ( "Error: No memory block of size %zu is available after "
+                     "growing the shared memory segment!\n", size );
+            goto mallocEnd;
+        }
+    }
+    //
+    //  Get the address of the chunk of memory that we found.
+    //
+    found = availableChunk = btree_iter_data ( iter );
+
+    //
+    //  Go remove the chunk of memory we found from the indices.
+    //
+    (void)deleteMemoryChunk ( found );
+
+    //
+    //  If the memory chunk we found is much larger than what we asked for
+    //  then we will need to split the chunk into 2 pieces.  The split
+    //  threashold is here to keep us from splitting off a piece of memory
+    //  that is so small that it's not useful.  Anything less than the split
+    //  threshold will just be left as a single block with some unused space
+    //  at the end to cut down on memory fragmentation.
+    //
+    if ( found->segmentSize - neededSize > SPLIT_THRESHOLD )
+    {
+        //
+        //  Remove the size of the memory chunk we need from the beginning of
+        //  what was found and put the remainder back into the "available"
+        //  B-tree.
+        //
+        //  Increment our pointer to the beginning of the leftover memoryChunk
+        //  header structure location.
+        //
+        found = (void*)found + neededSize;
+
+        //
+        //  Populate the new header with all the new information for the
+        //  leftover piece of memory.
+        //
+        found->marker      = SM_FREE_MARKER;
+        found->offset      = availableChunk->offset + neededSize;
+        found->segmentSize = availableChunk->segmentSize - neededSize;
+        found->type        = TYPE_SYSTEM;
+
+        //
+        //  Go insert the leftover piece of memory back into the indices.
+        //
+        (void)insertMemoryChunk ( found );
+
+        //
+        //  Fix the fields of the initial piece that we split off to be correct
+        //  now.
+        //
+        availableChunk->marker      = SM_IN_USE_MARKER;
+        availableChunk->segmentSize = neededSize;
+    }
+    //
+    //  If there is no need to split the piece that we found, just mark it as
+    //  "in use".
+    //
+    else
+    {
+        availableChunk->marker = SM_IN_USE_MARKER;
+    }
+
+mallocEnd:
+
+    //
+    //  Go unlock our shared memory mutex.
+    //
+    SM_UNLOCK;
+
+    //
+    //  If we could not find or make a large enough chunk of memory, return a
+    //  null pointer to the caller.
+    //
+    if ( availableChunk == NULL )
+    {
+        return NULL;
+    }
+
+#ifdef VSI_DEBUG
+    //
+    //  Return the address of the user data part of the available memory chunk
+    //  to the caller.
+    //
+    LOG ( "  sm_malloc returning[%p]\n", &availableChunk->data );
+
+    //
+    //  Perform a sanity check on this chunk of memory by checking to make
+    //  sure it is not past the end of the shared memory segment.
+    //
+    //  TODO: Check for greater than start of SM also!
+    //
+    if ( (void*)&availableChunk->data >=
+         (void*)smControl + smControl->sharedMemorySegmentSize )
+    {
+        printf ( "\n\nERROR!!! sm_malloc retuning a bad address!!\n\n" );
+        printf ( "    %lu past end of shared memory segment!\n",
+                 (void*)&availableChunk->data -
+                 ( (void*)smControl + smControl->sharedMemorySegmentSize ) );
+    }
+#endif
+    //
+    //  Return the address of the shared memory chunk just allocated to the
+    //  caller.
+    //
+    return &availableChunk->data;
+}
+
+
+//
+//  Allocate each of the chunks of a batch, giving back the ones we did get if
+//  any of them can't be allocated.
+//
+static int mallocBatch ( size_t count, const size_t* sizes, void** blocks )
+{
+    size_t i;
+
+    for ( i = 0; i < count; ++i )
+    {
+        blocks[i] = sm_malloc ( sizes[i] );
+        if ( blocks[i] == NULL )
+        {
+            break;
+        }
+    }
+    if ( i < count )
+    {
+        while ( i > 0 )
+        {
+            sm_free ( blocks[--i] );
+        }
+        return ENOMEM;
+    }
+    return 0;
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    s m _ m a l l o c _ b a t c h
+
+    @brief Allocate several chunks of shared memory for a user.
+
+    This function is equivalent to calling sm_malloc for each of the sizes
+    specified except that if any of the chunks are too large for the slabs,
+    the shared memory manager lock is held for the entire batch so that no
+    other thread or process can get in between the individual allocations.
+    The lock is recursive so each sm_malloc still acquires and releases it
+    again, but that never blocks while we hold it.  A batch of only small
+    allocations is satisfied from this thread's slab magazine without taking
+    the lock at all.
+
+    If any of the allocations fail, all of the chunks already allocated by
+    this call are released again so that the caller never has to deal with
+    a partially allocated batch.
+
+    @param[in] count - The number of chunks to allocate.
+    @param[in] sizes - The array of sizes in bytes of each chunk.
+    @param[out] blocks - The array in which the chunk addresses are returned.
+
+    @return 0 if successful
+            ENOMEM if the chunks could not be allocated
+
+-----------------------------------------------------------------------------*/
+int sm_malloc_batch ( size_t count, const size_t* sizes, void** blocks )
+{
+    int    status;
+    size_t i;
+    bool   locked = false;
+
+    LOG ( "In sm_malloc_batch[%zu]\n", count );
+
+    //
+    //  If any of the chunks will not come from the slabs, lock the mutex
+    //  that controls the shared memory manager for the duration of the whole
+    //  batch.
+    //
+    for ( i = 0; i < count && ! locked; ++i )
+    {
+        locked = sizes[i] + SLAB_HEADER_SIZE > SM_SLAB_MAX_SIZE;
+    }
+    if ( locked )
+    {
+        SM_LOCK;
+
+        status = mallocBatch ( count, sizes, blocks );
+
+        SM_UNLOCK;
+    }
+    else
+    {
+        status = mallocBatch ( count, sizes, blocks );
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    c a r v e S y s N o d e s
+
+    @brief Add a block of system memory to the B-tree node free list.
+
+    The memory is divided up into as many B-tree node blocks as will fit and
+    those blocks are appended to the free list of node blocks.  The free list
+    is a singly linked list of blocks using the blocks themselves to contain
+    the offset to the next block.
+
+    @param[in] offset - The system segment offset of the memory
+    @param[in] size - The size of the memory in bytes
+
+------------------------------------------------------------------------*/
+static void carveSysNodes ( offset_t offset, unsigned long size )
+{
+    //
+    //  Now compute the size of each node in the system B-trees...
+    //
+    //  If the user specified an even number of records, increment it to be an
+    //  odd number.  The btree algorithm here only operates correctly if the
+    //  record count is odd.
+    //
+    unsigned int maxRecordsPerNode = SYS_RECORD_COUNT;
+
+    if ( ( maxRecordsPerNode & 1 ) == 0 )
+    {
+        maxRecordsPerNode++;
+    }
+    //
+    //  Compute the node size as the btree node header size plus the size of
+    //  the record offset area plus the link offfset area plus the key prefix
+    //  area.  Both of the system B-trees have unsigned long keys so their
+    //  nodes always have room for the key prefixes.
+    //
+    unsigned int nodeSize = BTREE_NODE_SIZE ( maxRecordsPerNode, true );
+    //
+    //  Round up the node size to the next multiple of 8 bytes to maintain
+    //  long int alignment in the structures.
+    //
+    nodeSize = ( nodeSize + 7 ) & 0xfffffff8;
+
+    //
+    //  Round up the free memory offset to the next multiple of 8 bytes and
+    //  adjust the number of bytes of free memory available after the
+    //  rounding.
+    //
+    offset_t currentOffset = ( offset + 7 ) & ~7UL;
+
+    size -= currentOffset - offset;
+
+    unsigned long nodeCount = size / nodeSize;
+    if ( nodeCount == 0 )
+    {
+        return;
+    }
+    //
+    //  Store the offset to the next block in each of the blocks.  The last
+    //  block gets the NULL offset value.
+    //
+    for ( unsigned long i = 0; i < nodeCount; ++i )
+    {
+        void* currentPtr = (void*)sysControl + currentOffset + i * nodeSize;
+
+        *(offset_t*)currentPtr = ( i + 1 < nodeCount ) ?
+                                 currentOffset + ( i + 1 ) * nodeSize : 0;
+    }
+    //
+    //  Link the new blocks onto the end of the free list.
+    //
+    if ( sysControl->freeListHead == 0 )
+    {
+        sysControl->freeListHead = currentOffset;
+    }
+    else
+    {
+        *(offset_t*)( (void*)sysControl + sysControl->freeListTail ) =
+            currentOffset;
+    }
+    sysControl->freeListTail   = currentOffset + ( nodeCount - 1 ) * nodeSize;
+    sysControl->freeListCount += nodeCount;
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    s m _ m a l l o c _ s y s
+
+    @brief
+
+    This function will
+
+    @param[in]
+    @param[out]
+    @param[in,out]
+
+    @return None
+
+-----------------------------------------------------------------------------*/
+void* sm_malloc_sys ( size_t size )
+{
+    LOG ( "In SM sm_malloc_sys[%lu]\n", size );
+
+    void* nodePtr;
+
     //
-    //  Initialize the free list head offset to point to the first block in
-    //  our free list.
+    //  If there are no more node blocks available, go grow the system shared
+    //  memory segment to get some more.
     //
-    sysControl->freeListHead = currentOffset;
+    if ( sysControl->freeListHead == 0 && sm_grow_sys() != 0 )
+    {
+        printf ( "Error: No B-tree node blocks available\n" );
+        return 0;
+    }
+
+    nodePtr = sysControl->freeListHead + (void*)sysControl;
+
+    sysControl->freeListHead = *(offset_t*)nodePtr;
+
+#ifdef VSI_DEBUG
+    //dumpSM();
+#endif
+
+    return nodePtr;
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    s m _ f r e e
+
+    @brief Deallocate a chunk of shared memory.
+
+    This function will deallocate the specified chunk of shared memory
+    supplied by the caller.  If the supplied chunk of memory is not a valid
+    shared memory block or the block is not currently allocated (i.e. already
+    freed), the request will be ignored and an error message generated.
+
+    This function will check each piece of memory that is being free to see if
+    it is contiguous to another piece of memory in the free list.  If we find
+    a contiguous chunk, the two will be merged into a single larger chunk of
+    memory.  This operation will cut down on the memory fragmentation by
+    combining smaller pieces of memory into larger ones.
+
+    This function operates identically to the system "free" function and can
+    be used the same way.
 
+    @param[in] allocatedMemory - The address of the chunk of shared memory to free.
+
+    @return None
+
+-----------------------------------------------------------------------------*/
+void sm_free ( void* userMemory )
+{
+    LOG ( "In SM sm_free[%p]\n", userMemory );
+
+#ifdef VSI_DEBUG
+    //dumpSM();
+#endif
+
+    int            status;
+    memoryChunk_t* nextChunk;
+    memoryChunk_t* prevChunk;
+
+    SM_TRACE ( te_free, 0, 0, toOffset ( userMemory ) );
+
+#ifdef VSI_DEBUG
     //
-    //  Initialize the free list block counter.
+    //  Validate that the memory the user is trying to free is within the
+    //  bounds of the shared memory region.
     //
-    sysControl->freeListCount = 0;
+    void* smStart = smControl;
+    void* smEnd   = smStart + smControl->sharedMemorySegmentSize;
+    if ( userMemory <= smStart || userMemory >= smEnd )
+    {
+        printf ( "Error: Attempt to sm_free memory[%p] not located in the \n"
+                 "       shared memory segment[%p->%p]\n", userMemory, smStart,
+                  smEnd );
+        exit ( 255 );
+        return;
+    }
+#endif
+    //
+    //  If this piece of memory came from the slabs, just put it back on it's
+    //  slab free list.
+    //
+    slabBlock_t* slabBlock = userMemory - SLAB_HEADER_SIZE;
 
+    if ( slabBlock->type == TYPE_SLAB_IN_USE )
+    {
+        sm_slab_free ( slabBlock );
+        return;
+    }
+    if ( slabBlock->type == TYPE_SLAB_FREE )
+    {
+        printf ( "Error: sm_free was called with [%p] which has already "
+                 "been freed.\n", userMemory );
+        return;
+    }
     //
-    //  Get the pointer to the first free memory block.
+    //  Get the pointer to the memoryChunk header from the user supplied
+    //  memory pointer by backing up the pointer by the size of the
+    //  memoryChunk data structure.
     //
-    void* currentPtr = (void*)sysControl + sysSize;
+    memoryChunk_t* memoryChunk = userMemory - CHUNK_HEADER_SIZE;
 
     //
-    //  while we have not exhausted the amount of memory in this shared memory
-    //  segment...
+    //  If there is no valid SM marker in the header of this piece of memory
+    //  then there is a serious error so complain and quit.
     //
-    offset_t workingOffset = currentOffset;
-    while ( currentSize >= nodeSize )
+    if ( memoryChunk->marker != SM_IN_USE_MARKER )
     {
-        //
-        //  Store the offset to the next block in the current block.
-        //
-        workingOffset += nodeSize;
-        *(offset_t*)currentPtr = workingOffset;
+        if ( memoryChunk->marker != SM_FREE_MARKER )
+        {
+            printf ( "Error: sm_free was called with [%p] which is NOT an\n"
+                     "allocated piece of shared memory (it does not have a "
+                     "valid chunk marker).\n",
+                     userMemory );
+        }
+        else
+        {
+            printf ( "Error: sm_free was called with [%p] which has already "
+                     "been freed.\n", userMemory );
+        }
+        // exit ( 255 );
+        return;
+    }
+    //
+    //  Lock the shared memory data structures while we play with the B-trees.
+    //
+    SM_LOCK;
+
+    //
+    //  Make sure we have all of the memory that has been added to the
+    //  segments by other processes mapped before we start.
+    //
+    sm_check_mapping();
+    sm_check_mapping_sys();
+
+    //
+    //  Check to see if the chunk of memory immediately following this one is
+    //  already in the available pool.  If it is then we can coalesce these
+    //  two blocks into one larger block.  Note that the last chunk in the
+    //  segment has no following chunk.
+    //
+    nextChunk = (void*)memoryChunk + memoryChunk->segmentSize;
+    if ( memoryChunk->offset + memoryChunk->segmentSize <
+             smControl->sharedMemorySegmentSize &&
+         nextChunk->marker == SM_FREE_MARKER )
+    {
+        LOG ( "  Merging memory with next block\n" );
 
         //
-        //  Increment the current memory pointer and decrement the amount of
-        //  space we still have left.
+        //  The next chunk of memory is contiguous to the current one so it is
+        //  going to disappear.  We need to first remove it from both indices.
         //
-        currentPtr  += nodeSize;
-        currentSize -= nodeSize;
+        status = deleteMemoryChunk ( nextChunk );
 
         //
-        //  Increment the number of blocks in the free list.
+        //  Add the space that used to be occupied by the following chunk to
+        //  our current chunk.
         //
-        ++sysControl->freeListCount;
+        memoryChunk->segmentSize += nextChunk->segmentSize;
     }
     //
-    //  We have finished setting up the list of free blocks so set the tail
-    //  pointer to point to the last block and mark the last block with the
-    //  NULL offset value.
+    //  Now check to see if the previous chunk of memory is contiguous with
+    //  the current one.
+    //
+    //  Note that we need to decrement the current chunk offset before the
+    //  "rfind" call because that call will do a "<=" comparison and we just
+    //  want the "<" operation, otherwise, we will just find the current block
+    //  again.  The offset gets incremented again after the "rfind" operation
+    //  to restore it's proper value.
     //
-    sysControl->freeListTail = workingOffset;
-    *(offset_t*)currentPtr = 0;
+    --memoryChunk->offset;
+
+    btree_iterator_t iterator;
+    btree_iter       iter;
+
+    iter = btree_rfind_into ( &sysControl->availableMemoryByOffset,
+                              memoryChunk, &iterator );
+    ++memoryChunk->offset;
 
     //
-    //  Set the "initialized" flag to indicate that the shared memory
-    //  allocation system is in a usable state.  Note that this indicator is
-    //  primarily used by the sm_malloc function to determine how to allocate
-    //  memory for the shared memory memory management function B-trees that
-    //  we just defined above.
+    //  Get the address of the previous memory chunk found in the iterator.
     //
-    sysControl->systemInitialized = 1;
+    prevChunk = btree_iter_data ( iter );
 
     //
-    //  Initialize the 2 sets of data structures defined in the system shared
-    //  memory segment that we will need in order to create the system B-trees
-    //  that come next.
+    //  If we found a chunk of free memory and it is contiguous with the
+    //  beginning of our current chunk then combine those 2 chunks into a
+    //  single one.
     //
-    //  These data structures were allocated in the definition of the
-    //  sysMemory_t object typedef but we need to fill them in since the
-    //  compiler can't do the runtime initialization of these.
+    if ( prevChunk &&
+         ( ( prevChunk->offset + prevChunk->segmentSize ) == memoryChunk->offset ) )
+    {
+        LOG ( "  Merging memory with previous block\n" );
+
+        //
+        //  Now since we need to change the size of the previous chunk, delete
+        //  the old record, change the size, and add the new record back in.
+        //
+        (void)deleteMemoryChunk ( prevChunk );
+
+        //
+        //  Add the space that used to be occupied by the current chunk to the
+        //  previous chunk to coalesce the two pieces into one.
+        //
+        prevChunk->segmentSize += memoryChunk->segmentSize;
+
+        //
+        //  Add the new previous chunk data record to the btree.
+        //
+        (void)insertMemoryChunk ( prevChunk );
+    }
     //
-    sysControl->sizeKeyDef.fieldCount = 2;
-    sysControl->sizeFieldDef1.type   = ft_ulong;
-    sysControl->sizeFieldDef1.offset = offsetof ( memoryChunk_t, segmentSize );
-    sysControl->sizeFieldDef1.size   = 1;
-    sysControl->sizeFieldDef2.type   = ft_ulong;
-    sysControl->sizeFieldDef2.offset = offsetof ( memoryChunk_t, offset );
-    sysControl->sizeFieldDef2.size   = 1;
+    //  If the previous chunk of memory is not contiguous with the one we want
+    //  to free, just add the new chunk to the free list.
+    //
+    else
+    {
+        LOG ( "  Adding this memory block to free list B-Trees.\n" );
 
-    sysControl->offsetKeyDef.fieldCount = 1;
-    sysControl->offsetFieldDef.type   = ft_ulong;
-    sysControl->offsetFieldDef.offset = offsetof ( memoryChunk_t, offset );
-    sysControl->offsetFieldDef.size   = 1;
+        //
+        //  Go put the current chunk of memory into the "free" pool.
+        //
+        memoryChunk->marker = SM_FREE_MARKER;
+        (void)insertMemoryChunk ( memoryChunk );
+    }
+    //
+    //  Unlock the shared memory B-trees.
+    //
+    SM_UNLOCK;
 
     //
-    //  Now go initialize the 2 B-trees that will be used to perform the
-    //  memory management in the user shared memory segment.
+    //  Return to the caller.
     //
-    sysControl->availableMemoryBySize.type = TYPE_SYSTEM;
-    btree_create_sys ( &sysControl->availableMemoryBySize,
-                       SYS_RECORD_COUNT,
-                       &sysControl->sizeKeyDef );
+    return;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f r e e _ s y s
+
+    @brief
+
+    This function will
+
+    @param[in]
+    @param[out]
+    @param[in,out]
+
+    @return None
+
+------------------------------------------------------------------------*/
+void sm_free_sys ( void* memoryBlock )
+{
+    LOG ( "In SM sm_free_sys[%p]\n", memoryBlock );
 
-    sysControl->availableMemoryByOffset.type = TYPE_SYSTEM;
-    btree_create_sys ( &sysControl->availableMemoryByOffset,
-                       SYS_RECORD_COUNT,
-                       &sysControl->offsetKeyDef );
-    //
-    //  Let the user know that the system initialization has been completed.
-    //
-    LOG ( "\n===== System shared memory is Initialized at %p =====\n\n",
-          sysControl );
+#ifdef VSI_DEBUG
+    //dumpSM();
+#endif
+
+    // TODO ###############
     //
-    //  Return the address of the shared memory segment to the caller.
+    //  Right now, the system blocks are never freed so this function isn't
+    //  urgent.
     //
-    return sharedMemory;
 }
 
 
 /*!----------------------------------------------------------------------------
 
-    s m _ m a l l o c
+    E p o c h   B a s e d   R e c l a m a t i o n
 
-    @brief Allocate a chunk of shared memory for a user.
+    Some of the shared structures (the signal lists in particular) are read
+    without taking any locks so a block that a writer unlinks from one of
+    them can't be freed right away since a reader may still be looking at it.
 
-    This function will allocate a chunk of shared memory of the specified size
-    (in bytes).  If no memory is available of the specified size, a NULL
-    pointer will be returned, otherwise, the address (not the offset) of the
-    allocated chunk will be returned to the caller.
+    Readers bracket their accesses with sm_epoch_enter and sm_epoch_exit
+    which record the current global epoch in the reader's magazine.  Writers
+    call sm_retire instead of sm_free which puts the block in the limbo of
+    the writer's magazine tagged with the current global epoch.  When the
+    limbo fills up, the writer advances the global epoch and frees every
+    block that was retired before the oldest epoch that any reader is still
+    in.  Readers never block and writers never wait for readers, a block that
+    is held up by a slow reader just stays in limbo (or on the shared limbo
+    list) a little longer.
 
-    This function operates identically to the system "malloc" function and can
-    be used the same way.
+    A reader that dies inside an epoch protected section holds up the
+    reclamation until it's magazine (or it's process' anonymous reader count)
+    is reclaimed by sm_reclaim_magazines.
 
-    @param[in] size - The size in bytes of the memory desired.
+-----------------------------------------------------------------------------*/
+/*!-----------------------------------------------------------------------
 
-    @return The address of the allocated memory chunk.
-            NULL if the request could not be honored.
+    a n o n y m o u s R e a d e r G e t
 
------------------------------------------------------------------------------*/
-void* sm_malloc ( size_t size )
-{
-#ifdef VSI_DEBUG
-    LOG ( "In sm_malloc[%lu]\n", size );
+    @brief Find the anonymous reader count of the current process.
 
-    //dumpSM();
-#endif
+    The record of this process is found or an available one is claimed for
+    it.  If all of the records are in use by other processes, the shared
+    overflow count is used instead.
 
-    memoryChunk_t  needed = { 0 };
-    memoryChunk_t* found;
-    memoryChunk_t* availableChunk;
-    unsigned long  neededSize;
-    int            status;
+    @return The address of the count to add this thread to.
 
-    //
-    //  Initialize the size of the memory we need.  Note that we need enough
-    //  space to insert the chunkHeader_t at the beginning of the block the
-    //  user wants.
-    //
-    neededSize = size + CHUNK_HEADER_SIZE;
+------------------------------------------------------------------------*/
+static unsigned long* anonymousReaderGet ( void )
+{
+    pid_t processId = getpid();
+    int   i;
 
-    //
-    //  Make sure the memory we are going to allocate is a multiple of 8 bytes
-    //  by rounding it up to the next multiple of 8.  Note that since we start
-    //  with a properly aligned block of memory, all of the allocated blocks
-    //  will also be properly aligned as long as we make sure they are all a
-    //  multiple of 8 bytes.
-    //
-    //  TODO: Do we need to generalize this?  (like using "sizeof(long)", etc.
-    //
-    neededSize = ( neededSize + 7 ) & 0xfffffffffffffff8;
+    for ( i = 0; i < SM_ANONYMOUS_READER_COUNT; ++i )
+    {
+        anonymousReader_t* reader = &smControl->anonymousReaders[i];
 
-    //
-    //  If the shared memory memory management system has not yet been
-    //  initialized, just grab what we need from the beginning of the shared
-    //  memory segment.
-    //
-    if ( ! sysControl->systemInitialized )
+        if ( __atomic_load_n ( &reader->processId, __ATOMIC_ACQUIRE ) ==
+             processId )
+        {
+            return &reader->count;
+        }
+    }
+    for ( i = 0; i < SM_ANONYMOUS_READER_COUNT; ++i )
     {
-        printf ( "Error: sm_malloc called before init finished for size: [%zu]\n",
-                 size );
-        exit ( 255 );
+        anonymousReader_t* reader = &smControl->anonymousReaders[i];
+        pid_t              owner  = 0;
+
+        if ( __atomic_compare_exchange_n ( &reader->processId, &owner,
+                                           processId, false, __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED ) )
+        {
+            return &reader->count;
+        }
     }
-    //
-    //  If we got here we are operating in "normal" mode rather than
-    //  "infrastructure initialization" mode.
-    //
-    //  Lock the mutex that controls the shared memory manager.
-    //
-    SM_LOCK;
+    return &smControl->anonymousOverflow;
+}
 
-    //
-    //  Set up the data structure that we need to search for the appropriately
-    //  sized chunk of memory.
-    //
-    needed.segmentSize = neededSize;
-    needed.offset      = 0;
 
-    //
-    //  Go find the first block in the available B-tree that is equal to or
-    //  greater than the size we need.
-    //
-    btree_iter iter = btree_find ( &sysControl->availableMemoryBySize, &needed );
 
+/*!-----------------------------------------------------------------------
+
+    s m _ e p o c h _ e n t e r
+
+    @brief Enter an epoch protected section.
+
+    No memory retired by any thread after this call will be freed until the
+    matching sm_epoch_exit call.  These sections may be nested in which case
+    only the outermost one has any effect.
+
+------------------------------------------------------------------------*/
+void sm_epoch_enter ( void )
+{
     //
-    //  If the search didn't find anything then we don't have any memory
-    //  chunks large enough to fulfill the request so there is something
-    //  seriously wrong and we should just abort for the time being.
-    //
-    //  TODO: In the future we should be able to extend the shared memory
-    //  segment with little overhead.
+    //  If we are already inside an epoch protected section, the outer one
+    //  covers us.
     //
-    if ( btree_iter_at_end ( iter ) )
+    if ( epochDepth++ > 0 )
     {
-        printf ( "Error: No memory block of size %zu is available! Aborting\n",
-                 size );
-        goto mallocEnd;
+        return;
     }
     //
-    //  Get the address of the chunk of memory that we found.
+    //  If this thread has no magazine, count it as an anonymous reader of
+    //  this process.
     //
-    found = availableChunk = btree_iter_data ( iter );
+    epochMagazine = magazineGet();
+    if ( epochMagazine == NULL )
+    {
+        epochAnonymous = anonymousReaderGet();
 
+        __atomic_add_fetch ( epochAnonymous, 1, __ATOMIC_SEQ_CST );
+        return;
+    }
     //
-    //  Go remove the chunk of memory we found from the indices.
+    //  Publish the current epoch in our magazine and make sure that it is
+    //  visible to the reclaimers before we read anything in the shared
+    //  structures.
     //
-    (void)deleteMemoryChunk ( found );
+    unsigned long epoch = __atomic_load_n ( &smControl->reclaimEpoch,
+                                            __ATOMIC_SEQ_CST );
 
-    //
-    //  If the memory chunk we found is much larger than what we asked for
-    //  then we will need to split the chunk into 2 pieces.  The split
-    //  threashold is here to keep us from splitting off a piece of memory
-    //  that is so small that it's not useful.  Anything less than the split
-    //  threshold will just be left as a single block with some unused space
-    //  at the end to cut down on memory fragmentation.
-    //
-    if ( found->segmentSize - neededSize > SPLIT_THRESHOLD )
-    {
-        //
-        //  Remove the size of the memory chunk we need from the beginning of
-        //  what was found and put the remainder back into the "available"
-        //  B-tree.
-        //
-        //  Increment our pointer to the beginning of the leftover memoryChunk
-        //  header structure location.
-        //
-        found = (void*)found + neededSize;
+    __atomic_store_n ( &epochMagazine->epoch, epoch, __ATOMIC_SEQ_CST );
+    __atomic_thread_fence ( __ATOMIC_SEQ_CST );
+}
 
-        //
-        //  Populate the new header with all the new information for the
-        //  leftover piece of memory.
-        //
-        found->marker      = SM_FREE_MARKER;
-        found->offset      = availableChunk->offset + neededSize;
-        found->segmentSize = availableChunk->segmentSize - neededSize;
-        found->type        = TYPE_SYSTEM;
 
-        //
-        //  Go insert the leftover piece of memory back into the indices.
-        //
-        (void)insertMemoryChunk ( found );
+/*!-----------------------------------------------------------------------
 
-        //
-        //  Fix the fields of the initial piece that we split off to be correct
-        //  now.
-        //
-        availableChunk->marker      = SM_IN_USE_MARKER;
-        availableChunk->segmentSize = neededSize;
+    s m _ e p o c h _ e x i t
+
+    @brief Exit an epoch protected section.
+
+    Once the outermost section has been exited, no pointers into the shared
+    structures that were read inside of it may be used any more.
+
+------------------------------------------------------------------------*/
+void sm_epoch_exit ( void )
+{
+    if ( epochDepth == 0 || --epochDepth > 0 )
+    {
+        return;
+    }
+    if ( epochMagazine == NULL )
+    {
+        __atomic_sub_fetch ( epochAnonymous, 1, __ATOMIC_RELEASE );
     }
-    //
-    //  If there is no need to split the piece that we found, just mark it as
-    //  "in use".
-    //
     else
     {
-        availableChunk->marker = SM_IN_USE_MARKER;
+        __atomic_store_n ( &epochMagazine->epoch, 0, __ATOMIC_RELEASE );
     }
+    epochMagazine  = NULL;
+    epochAnonymous = NULL;
+}
 
-mallocEnd:
 
-    //
-    //  Go clean up all of the iterator data and memory.
-    //
-    btree_iter_cleanup ( iter );
+/*!-----------------------------------------------------------------------
 
-    //
-    //  Go unlock our shared memory mutex.
-    //
-    SM_UNLOCK;
+    e p o c h O l d e s t
 
-#ifdef VSI_DEBUG
-    //
-    //  Return the address of the user data part of the available memory chunk
-    //  to the caller.
-    //
-    LOG ( "  sm_malloc returning[%p]\n", &availableChunk->data );
+    @brief Advance the global epoch and find the oldest epoch in use.
 
+    @return The oldest epoch that any reader might still be in.  Blocks that
+            were retired in an earlier epoch than this can be freed.
+
+------------------------------------------------------------------------*/
+static unsigned long epochOldest ( void )
+{
+    unsigned long oldest = __atomic_add_fetch ( &smControl->reclaimEpoch, 1,
+                                                __ATOMIC_SEQ_CST );
     //
-    //  Perform a sanity check on this chunk of memory by checking to make
-    //  sure it is not past the end of the shared memory segment.
-    //
-    //  TODO: Check for greater than start of SM also!
+    //  We don't know what epoch the anonymous readers are in so nothing can
+    //  be freed while there are any.
     //
-    if ( (void*)&availableChunk->data >=
-         (void*)sysControl + sysControl->sharedMemorySegmentSize )
+    if ( __atomic_load_n ( &smControl->anonymousOverflow,
+                           __ATOMIC_SEQ_CST ) != 0 )
     {
-        printf ( "\n\nERROR!!! sm_malloc retuning a bad address!!\n\n" );
-        printf ( "    %lu past end of shared memory segment!\n",
-                 (void*)&availableChunk->data -
-                 (void*)sysControl->sharedMemorySegmentSize );
+        return 0;
     }
-#endif
-    //
-    //  Return the address of the shared memory chunk just allocated to the
-    //  caller.
-    //
-    return &availableChunk->data;
+    for ( int i = 0; i < SM_ANONYMOUS_READER_COUNT; ++i )
+    {
+        if ( __atomic_load_n ( &smControl->anonymousReaders[i].count,
+                               __ATOMIC_SEQ_CST ) != 0 )
+        {
+            return 0;
+        }
+    }
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        unsigned long epoch =
+            __atomic_load_n ( &smControl->magazines[i].epoch,
+                              __ATOMIC_SEQ_CST );
+
+        if ( epoch != 0 && epoch < oldest )
+        {
+            oldest = epoch;
+        }
+    }
+    return oldest;
 }
 
 
-/*!----------------------------------------------------------------------------
+/*!-----------------------------------------------------------------------
 
-    s m _ m a l l o c _ s y s
+    l i m b o S p i l l
 
-    @brief
+    @brief Move a set of retired blocks to the shared limbo list.
 
-    This function will
+    The blocks are added to the first page of the shared limbo list and a
+    new page is only started when that one is full, so retiring blocks one
+    at a time does not use up a whole page for each of them.
 
-    @param[in]
-    @param[out]
-    @param[in,out]
+    If a limbo page can't be allocated, the blocks are leaked rather than
+    being freed while a reader might still be looking at them.
 
-    @return None
+    @param[in] blocks - The offsets of the retired blocks
+    @param[in] epochs - The epochs in which the blocks were retired
+    @param[in] count - The number of blocks
 
------------------------------------------------------------------------------*/
-void* sm_malloc_sys ( size_t size )
+    @return true if a new limbo page was started
+
+------------------------------------------------------------------------*/
+static bool limboSpill ( const offset_t* blocks, const unsigned long* epochs,
+                         unsigned int count )
 {
-    LOG ( "In SM sm_malloc_sys[%lu]\n", size );
+    int  status;
+    bool started = false;
 
-    void* nodePtr;
+    SM_LOCK;
 
-    if ( sysControl->freeListHead == 0 )
+    limboPage_t* page = NULL;
+
+    if ( smControl->limboList != 0 )
     {
-        printf ( "Error: No B-tree node blocks available\n" );
-        return 0;
+        page = toAddress ( smControl->limboList );
     }
+    for ( unsigned int i = 0; i < count; ++i )
+    {
+        //
+        //  If there is no page with room for this block, start a new one at
+        //  the front of the list.
+        //
+        if ( page == NULL || page->count >= SM_EPOCH_LIMBO_SIZE )
+        {
+            page = sm_malloc ( sizeof(limboPage_t) );
+            if ( page == NULL )
+            {
+                printf ( "Error: Unable to allocate a limbo page - %u retired "
+                         "blocks have been leaked\n", count - i );
+                break;
+            }
+            page->epoch          = 0;
+            page->count          = 0;
+            page->next           = smControl->limboList;
+            smControl->limboList = toOffset ( page );
+
+            __atomic_add_fetch ( &smControl->limboPageCount, 1,
+                                 __ATOMIC_RELAXED );
+            started = true;
+        }
+        page->blocks[page->count++] = blocks[i];
 
-    nodePtr = sysControl->freeListHead + (void*)sysControl;
-
-    sysControl->freeListHead = *(offset_t*)nodePtr;
-
-#ifdef VSI_DEBUG
-    //dumpSM();
-#endif
+        if ( epochs[i] > page->epoch )
+        {
+            page->epoch = epochs[i];
+        }
+    }
+    SM_UNLOCK;
 
-    return nodePtr;
+    return started;
 }
 
 
-/*!----------------------------------------------------------------------------
-
-    s m _ f r e e
-
-    @brief Deallocate a chunk of shared memory.
-
-    This function will deallocate the specified chunk of shared memory
-    supplied by the caller.  If the supplied chunk of memory is not a valid
-    shared memory block or the block is not currently allocated (i.e. already
-    freed), the request will be ignored and an error message generated.
-
-    This function will check each piece of memory that is being free to see if
-    it is contiguous to another piece of memory in the free list.  If we find
-    a contiguous chunk, the two will be merged into a single larger chunk of
-    memory.  This operation will cut down on the memory fragmentation by
-    combining smaller pieces of memory into larger ones.
+/*!-----------------------------------------------------------------------
 
-    This function operates identically to the system "free" function and can
-    be used the same way.
+    l i m b o R e c l a i m
 
-    @param[in] allocatedMemory - The address of the chunk of shared memory to free.
+    @brief Free the pages of the shared limbo list that are no longer in use.
 
-    @return None
+    @param[in] oldest - The oldest epoch that any reader might still be in
 
------------------------------------------------------------------------------*/
-void sm_free ( void* userMemory )
+------------------------------------------------------------------------*/
+static void limboReclaim ( unsigned long oldest )
 {
-    LOG ( "In SM sm_free[%p]\n", userMemory );
+    int status;
 
-#ifdef VSI_DEBUG
-    //dumpSM();
-#endif
+    SM_LOCK;
 
-    int            status;
-    memoryChunk_t* nextChunk;
-    memoryChunk_t* prevChunk;
+    offset_t* link = &smControl->limboList;
 
-#ifdef VSI_DEBUG
-    //
-    //  Validate that the memory the user is trying to free is within the
-    //  bounds of the shared memory region.
-    //
-    void* smStart = smControl;
-    void* smEnd   = smStart + smControl->sharedMemorySegmentSize;
-    if ( userMemory <= smStart || userMemory >= smEnd )
+    while ( *link != 0 )
     {
-        printf ( "Error: Attempt to sm_free memory[%p] not located in the \n"
-                 "       shared memory segment[%p->%p]\n", userMemory, smStart,
-                  smEnd );
-        exit ( 255 );
-        return;
-    }
-#endif
-    //
-    //  Get the pointer to the memoryChunk header from the user supplied
-    //  memory pointer by backing up the pointer by the size of the
-    //  memoryChunk data structure.
-    //
-    memoryChunk_t* memoryChunk = userMemory - CHUNK_HEADER_SIZE;
+        limboPage_t* page = toAddress ( *link );
 
-    //
-    //  If there is no valid SM marker in the header of this piece of memory
-    //  then there is a serious error so complain and quit.
-    //
-    if ( memoryChunk->marker != SM_IN_USE_MARKER )
-    {
-        if ( memoryChunk->marker != SM_FREE_MARKER )
+        if ( page->epoch >= oldest )
         {
-            printf ( "Error: sm_free was called with [%p] which is NOT an\n"
-                     "allocated piece of shared memory (it does not have a "
-                     "valid chunk marker).\n",
-                     userMemory );
+            link = &page->next;
+            continue;
         }
-        else
+        *link = page->next;
+
+        __atomic_sub_fetch ( &smControl->limboPageCount, 1, __ATOMIC_RELAXED );
+
+        for ( unsigned long i = 0; i < page->count; ++i )
         {
-            printf ( "Error: sm_free was called with [%p] which has already "
-                     "been freed.\n", userMemory );
+            sm_free ( toAddress ( page->blocks[i] ) );
         }
-        // exit ( 255 );
-        return;
+        sm_free ( page );
     }
-    //
-    //  Lock the shared memory data structures while we play with the B-trees.
-    //
-    SM_LOCK;
+    SM_UNLOCK;
+}
 
-    //
-    //  Check to see if the chunk of memory immediately following this one is
-    //  already in the available pool.  If it is then we can coalesce these
-    //  two blocks into one larger block.
-    //
-    nextChunk = (void*)memoryChunk + memoryChunk->segmentSize;
-    if ( nextChunk->marker == SM_FREE_MARKER )
-    {
-        LOG ( "  Merging memory with next block\n" );
 
-        //
-        //  The next chunk of memory is contiguous to the current one so it is
-        //  going to disappear.  We need to first remove it from both indices.
-        //
-        status = deleteMemoryChunk ( nextChunk );
+/*!-----------------------------------------------------------------------
 
-        //
-        //  Add the space that used to be occupied by the following chunk to
-        //  our current chunk.
-        //
-        memoryChunk->segmentSize += nextChunk->segmentSize;
+    e p o c h R e c l a i m
+
+    @brief Free the retired blocks in a magazine's limbo that are no longer
+           in use.
+
+    The blocks in the limbo are always in the order in which they were
+    retired so the blocks that can be freed are at the front of the limbo.
+    If none of them can be freed, all of them are moved to the shared limbo
+    list to make room for more.
+
+    @param[in] magazine - The address of the current thread's magazine
+
+------------------------------------------------------------------------*/
+static void epochReclaim ( magazine_t* magazine )
+{
+    offset_t      blocks[SM_EPOCH_LIMBO_SIZE];
+    unsigned long epochs[SM_EPOCH_LIMBO_SIZE];
+    unsigned int  count  = magazine->limboCount;
+    unsigned int  freed  = 0;
+    unsigned long oldest = epochOldest();
+
+    while ( freed < count && magazine->limboEpoch[freed] < oldest )
+    {
+        ++freed;
     }
     //
-    //  Now check to see if the previous chunk of memory is contiguous with
-    //  the current one.
-    //
-    //  Note that we need to decrement the current chunk offset before the
-    //  "rfind" call because that call will do a "<=" comparison and we just
-    //  want the "<" operation, otherwise, we will just find the current block
-    //  again.  The offset gets incremented again after the "rfind" operation
-    //  to restore it's proper value.
+    //  If nothing can be freed, a reader that has died might be holding
+    //  things up so go reclaim the magazines of any dead processes and try
+    //  again.
     //
-    --memoryChunk->offset;
-
-    btree_iter iter = btree_rfind ( &sysControl->availableMemoryByOffset,
-                                    memoryChunk );
-    ++memoryChunk->offset;
+    if ( freed == 0 )
+    {
+        sm_reclaim_magazines();
 
+        oldest = epochOldest();
+        while ( freed < count && magazine->limboEpoch[freed] < oldest )
+        {
+            ++freed;
+        }
+    }
     //
-    //  Get the address of the previous memory chunk found in the iterator.
+    //  Take the blocks we are going to deal with out of the limbo before
+    //  doing anything with them so that if we crash in the middle of this,
+    //  the blocks are leaked instead of being freed twice by the reclaimer
+    //  of our magazine.
     //
-    prevChunk = btree_iter_data ( iter );
+    memcpy ( blocks, magazine->limbo, count * sizeof(offset_t) );
+    memcpy ( epochs, magazine->limboEpoch, count * sizeof(unsigned long) );
+
+    __atomic_store_n ( &magazine->limboCount, 0, __ATOMIC_RELEASE );
 
     //
-    //  If we found a chunk of free memory and it is contiguous with the
-    //  beginning of our current chunk then combine those 2 chunks into a
-    //  single one.
+    //  If some live reader is still using everything in the limbo, move all
+    //  of it to the shared limbo list.
     //
-    if ( prevChunk &&
-         ( ( prevChunk->offset + prevChunk->segmentSize ) == memoryChunk->offset ) )
+    if ( freed == 0 )
     {
-        LOG ( "  Merging memory with previous block\n" );
-
-        //
-        //  Now since we need to change the size of the previous chunk, delete
-        //  the old record, change the size, and add the new record back in.
-        //
-        (void)deleteMemoryChunk ( prevChunk );
-
-        //
-        //  Add the space that used to be occupied by the current chunk to the
-        //  previous chunk to coalesce the two pieces into one.
-        //
-        prevChunk->segmentSize += memoryChunk->segmentSize;
-
-        //
-        //  Add the new previous chunk data record to the btree.
-        //
-        (void)insertMemoryChunk ( prevChunk );
+        limboSpill ( blocks, epochs, count );
     }
     //
-    //  If the previous chunk of memory is not contiguous with the one we want
-    //  to free, just add the new chunk to the free list.
+    //  Otherwise, keep the blocks that are still in use and free the rest.
     //
     else
     {
-        LOG ( "  Adding this memory block to free list B-Trees.\n" );
+        memmove ( magazine->limbo, &blocks[freed],
+                  ( count - freed ) * sizeof(offset_t) );
+        memmove ( magazine->limboEpoch, &epochs[freed],
+                  ( count - freed ) * sizeof(unsigned long) );
 
-        //
-        //  Go put the current chunk of memory into the "free" pool.
-        //
-        memoryChunk->marker = SM_FREE_MARKER;
-        (void)insertMemoryChunk ( memoryChunk );
-    }
-    //
-    //  Unlock the shared memory B-trees.
-    //
-    SM_UNLOCK;
+        __atomic_store_n ( &magazine->limboCount, count - freed,
+                           __ATOMIC_RELEASE );
 
+        for ( unsigned int i = 0; i < freed; ++i )
+        {
+            sm_free ( toAddress ( blocks[i] ) );
+        }
+    }
     //
-    //  Return to the caller.
+    //  While we are at it, free anything on the shared limbo list that is
+    //  no longer in use.
     //
-    return;
+    if ( __atomic_load_n ( &smControl->limboList, __ATOMIC_RELAXED ) != 0 )
+    {
+        limboReclaim ( oldest );
+    }
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    s m _ f r e e _ s y s
-
-    @brief
+    s m _ r e t i r e
 
-    This function will
+    @brief Free a block of shared memory once no reader can be using it.
 
-    @param[in]
-    @param[out]
-    @param[in,out]
+    This is used instead of sm_free for blocks that have been unlinked from
+    a shared structure that readers access inside of epoch protected
+    sections.  The block must already be unreachable from the structure.
 
-    @return None
+    @param[in] memoryToRetire - The address of the block to be freed
 
 ------------------------------------------------------------------------*/
-void sm_free_sys ( void* memoryBlock )
+void sm_retire ( void* memoryToRetire )
 {
-    LOG ( "In SM sm_free_sys[%p]\n", memoryBlock );
+    offset_t blockOffset = toOffset ( memoryToRetire );
 
-#ifdef VSI_DEBUG
-    //dumpSM();
-#endif
+    //
+    //  Make sure that the unlinking of this block is visible to everyone
+    //  before we find out what epoch it was retired in.
+    //
+    __atomic_thread_fence ( __ATOMIC_SEQ_CST );
 
-    // TODO ###############
+    unsigned long epoch = __atomic_load_n ( &smControl->reclaimEpoch,
+                                            __ATOMIC_SEQ_CST );
     //
-    //  Right now, the system blocks are never freed so this function isn't
-    //  urgent.
+    //  If this thread has no magazine, put the block directly on the shared
+    //  limbo list.  Each time that starts a new page, free whatever pages
+    //  are no longer in use.
+    //
+    magazine_t* magazine = magazineGet();
+    if ( magazine == NULL )
+    {
+        if ( limboSpill ( &blockOffset, &epoch, 1 ) )
+        {
+            limboReclaim ( epochOldest() );
+        }
+        return;
+    }
+    //
+    //  Make room in the limbo if it is full and then add the block to it.
     //
+    if ( magazine->limboCount >= SM_EPOCH_LIMBO_SIZE )
+    {
+        epochReclaim ( magazine );
+    }
+    unsigned int count = magazine->limboCount;
+
+    magazine->limbo[count]      = blockOffset;
+    magazine->limboEpoch[count] = epoch;
+
+    __atomic_store_n ( &magazine->limboCount, count + 1, __ATOMIC_RELEASE );
 }
 
 
@@ -1194,6 +3121,180 @@ void dumpFreeByOffset ( void )
 }
 
 
+/*!-----------------------------------------------------------------------
+
+    s m _ t r a c e
+
+    @brief Record an event in the shared memory trace ring.
+
+    The writer claims the next position in the ring with an atomic increment
+    of the trace index and then fills in the record at that position.  The
+    sequence number is cleared before and set after the record contents are
+    written so that readers can detect (and skip) records that are being
+    written concurrently.  No locks are taken so this function may be called
+    from anywhere, including while holding any of the VSI mutexes.
+
+    @param[in] event - The traceEvent_t value of the event being recorded
+    @param[in] domainId - The domain of the signal involved (or 0)
+    @param[in] signalId - The ID of the signal involved (or 0)
+    @param[in] argument - The event specific argument value
+
+------------------------------------------------------------------------*/
+//
+//  The kernel thread ID of the current thread.  This is cached so that we
+//  only need to ask the kernel for it the first time a thread traces an
+//  event.
+//
+static __thread unsigned int traceThreadId = 0;
+
+void sm_trace ( traceEvent_t event, int domainId, int signalId,
+                unsigned long argument )
+{
+    struct timespec timeSpec;
+
+    //
+    //  If the shared memory segment has not been mapped yet, there is no
+    //  place to record anything so just ignore this call.
+    //
+    if ( smControl == 0 )
+    {
+        return;
+    }
+    //
+    //  If this is the first event traced by this thread, get it's thread ID.
+    //
+    if ( traceThreadId == 0 )
+    {
+        traceThreadId = syscall ( SYS_gettid );
+    }
+    //
+    //  Claim the next position in the trace ring and get the address of the
+    //  record at that position.
+    //
+    unsigned long position = __atomic_fetch_add ( &smControl->traceIndex, 1,
+                                                  __ATOMIC_RELAXED );
+
+    traceRecord_t* record =
+        &smControl->traceRing[position & ( SM_TRACE_RECORD_COUNT - 1 )];
+
+    //
+    //  Mark the record as being written and then fill in the record.
+    //
+    __atomic_store_n ( &record->sequence, 0, __ATOMIC_RELAXED );
+    __atomic_thread_fence ( __ATOMIC_RELEASE );
+
+    clock_gettime ( CLOCK_MONOTONIC, &timeSpec );
+
+    record->timestamp = timeSpec.tv_sec * 1000000000UL + timeSpec.tv_nsec;
+    record->event     = event;
+    record->threadId  = traceThreadId;
+    record->domainId  = domainId;
+    record->signalId  = signalId;
+    record->argument  = argument;
+
+    //
+    //  Publish the completed record.
+    //
+    __atomic_store_n ( &record->sequence, position + 1, __ATOMIC_RELEASE );
+}
+
+
+//
+//  Define the printable names of the trace events.  These must be kept in
+//  the same order as the traceEvent_t definitions.
+//
+static const char* traceEventNames[te_count] =
+{
+    "none",
+    "insert",
+    "fetch",
+    "fetch_newest",
+    "fetch_latest",
+    "fetch_range",
+    "flush",
+    "semaphore_post",
+    "semaphore_wait",
+    "semaphore_wake",
+    "malloc",
+    "free",
+    "grow"
+};
+
+
+//
+//  Dump the most recent records in the trace ring.
+//
+//  Each record is copied out of the ring and then it's sequence number is
+//  checked again.  If the record was overwritten while we were copying it
+//  (or is still being written), it is skipped.  The times are displayed in
+//  microseconds relative to the first record displayed.
+//
+void dumpTrace ( unsigned long recordCount )
+{
+    traceRecord_t record;
+    unsigned long baseTime = 0;
+    unsigned long skipped  = 0;
+
+    unsigned long last  = __atomic_load_n ( &smControl->traceIndex,
+                                            __ATOMIC_ACQUIRE );
+    unsigned long first = last > SM_TRACE_RECORD_COUNT ?
+                          last - SM_TRACE_RECORD_COUNT : 0;
+
+    if ( recordCount < last - first )
+    {
+        first = last - recordCount;
+    }
+    printf ( "\nTrace ring: %'lu events recorded, displaying %'lu\n\n",
+             last, last - first );
+
+    printf ( "     Sequence     Time(us)  Event            Thread  "
+             "Domain  Signal  Argument\n" );
+    printf ( "  ===========  ===========  ==============  =======  "
+             "======  ======  ==========\n" );
+
+    for ( unsigned long position = first; position < last; ++position )
+    {
+        traceRecord_t* slot =
+            &smControl->traceRing[position & ( SM_TRACE_RECORD_COUNT - 1 )];
+
+        //
+        //  Copy the record and make sure that it was not changed while we
+        //  were copying it.
+        //
+        if ( __atomic_load_n ( &slot->sequence, __ATOMIC_ACQUIRE ) !=
+             position + 1 )
+        {
+            ++skipped;
+            continue;
+        }
+        record = *slot;
+        __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+
+        if ( __atomic_load_n ( &slot->sequence, __ATOMIC_RELAXED ) !=
+             position + 1 )
+        {
+            ++skipped;
+            continue;
+        }
+        if ( baseTime == 0 )
+        {
+            baseTime = record.timestamp;
+        }
+        printf ( "  %'11lu  %'11lu  %-14s  %7u  %6d  %6d  %'lu\n",
+                 position + 1, ( record.timestamp - baseTime ) / 1000,
+                 record.event < te_count ? traceEventNames[record.event] : "???",
+                 record.threadId, record.domainId, record.signalId,
+                 record.argument );
+    }
+    if ( skipped != 0 )
+    {
+        printf ( "\n  %'lu records were being rewritten and were skipped.\n",
+                 skipped );
+    }
+    printf ( "\n" );
+}
+
+
 //
 //  Dump both of the memory management B-trees.
 //
@@ -1209,6 +3310,25 @@ void dumpSM ( void )
     }
     dumpFreeBySize();
     dumpFreeByOffset();
+
+    printf ( "Slab pages allocated: %'lu\n", smControl->slabPageCount );
+
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        magazine_t* magazine = &smControl->magazines[i];
+
+        if ( magazine->processId != 0 )
+        {
+            printf ( "  Magazine %d: process %d, thread %d, blocks:", i,
+                     magazine->processId, magazine->threadId );
+
+            for ( int j = 0; j < SM_SLAB_CLASS_COUNT; ++j )
+            {
+                printf ( " %u", magazine->count[j] );
+            }
+            printf ( "\n" );
+        }
+    }
 }
 
 
@@ -40,6 +40,7 @@
 //
 #include <pthread.h>
 #include <stdbool.h>
+#include <sys/types.h>
 
 //
 //  Include the local header files we need.
@@ -70,14 +71,23 @@
 //
 //  Both segments can be dynamically resized as needed with minimal cost.
 //
-//  TODO: The resizing of the shared memory segments needs to be written!
+//  Each process reserves (but does not commit) enough virtual address space
+//  for the maximum size of each segment and maps the segment file at the
+//  beginning of that reservation.  When a segment runs out of memory, the
+//  segment file is extended and the new piece is mapped immediately after
+//  the existing mapping so the base address of the segment never changes.
+//  The segment "generation" is then incremented and every other process that
+//  has the segment open will map the new piece the next time it converts an
+//  offset to an address (see sm_check_mapping).
 //
 #define MB ( 1024L * 1024L )
 #define SHARED_MEMORY_SEGMENT_NAME "/var/run/shm/vsiUserDataStore"
 #define INITIAL_SHARED_MEMORY_SIZE ( 20 * MB )
+#define MAXIMUM_SHARED_MEMORY_SIZE ( 1024 * MB )
 
 #define SYS_SHARED_MEMORY_SEGMENT_NAME "/var/run/shm/vsiSysDataStore"
 #define SYS_INITIAL_SHARED_MEMORY_SIZE ( 10 * MB )
+#define SYS_MAXIMUM_SHARED_MEMORY_SIZE ( 512 * MB )
 
 //
 //  Define the maximum number of records in each node of the 2 shared memory
@@ -98,9 +108,18 @@
 
 //
 //  Define the maximum number of records in each node of the "signals" B-tree
-//  structure defined in the user space.
+//  structures defined in the user space (the signal name, signal ID, private
+//  ID and group ID indices).  This is the fanout of those trees.  Since the
+//  records in each node are searched with a binary search, larger nodes make
+//  the trees shallower without making the search within each node much more
+//  expensive.  This value may be overridden at build time.
 //
+//  Note: The record count should be an odd number.  If an even number is
+//  specified, the btree_initialize function will increment it to be odd.
+//
+#ifndef SM_SIGNALS_RECORD_COUNT
 #define SM_SIGNALS_RECORD_COUNT           ( 41 )
+#endif
 #define SM_SIGNALS_KEY_COUNT              (  2 )
 #define SM_SIGNALS_KEY1                   (  0 )
 #define SM_SIGNALS_KEY2                   (  1 )
@@ -150,7 +169,9 @@ typedef unsigned long offset_t;
     memoryChunk_t header block begins.
 
     The "type" is the identifier of whether this memory block is located in
-    the user shared memory segment or the system shared memory segment.
+    the user shared memory segment or the system shared memory segment.  Note
+    that the "type" field immediately precedes the "data" so that it is in
+    the same place as the "type" field of a slab block (see slabBlock_t).
 
     The "data" is the fist location that is usable by the user.  This is the
     address that will be returned to the user from his "sm_malloc" function
@@ -171,12 +192,269 @@ typedef struct memoryChunk_t
 
 
 //
-//  Define the constants used with the memoryChunk structure.
+//  Define the constants used with the memoryChunk structure.  Note that the
+//  split threshold must leave room for the header of the leftover piece of
+//  a split chunk, otherwise that header will overwrite the chunk following
+//  it.
 //
 static const unsigned long SM_IN_USE_MARKER  = (unsigned long)0xdeadbeefdeadbeef;
 static const unsigned long SM_FREE_MARKER    = (unsigned long)0xfceefceefceefcee;
 static const unsigned long CHUNK_HEADER_SIZE = sizeof(memoryChunk_t);
-static const unsigned long SPLIT_THRESHOLD   = 16;
+static const unsigned long SPLIT_THRESHOLD   = sizeof(memoryChunk_t) + 16;
+
+
+/*!-----------------------------------------------------------------------
+
+    s l a b B l o c k _ t
+
+    @brief Define the header of the small memory blocks.
+
+    Small allocations (up to SM_SLAB_MAX_SIZE bytes including this header)
+    are not taken from the memory chunk B-trees.  Instead, they are taken
+    from "slabs" of fixed size blocks with one slab free list per size class.
+    The slab blocks are carved out of slab pages which are allocated from the
+    B-tree allocator (and never given back) whenever a size class runs out of
+    free blocks.
+
+    The "type" is TYPE_SLAB_IN_USE or TYPE_SLAB_FREE.  This field occupies the
+    same position relative to the "data" as the "type" field in the
+    memoryChunk_t header so sm_free can tell which allocator a piece of
+    memory came from by looking at the 8 bytes in front of it.
+
+    The "sizeClass" is the index of the size class of this block.
+
+    While a block is on a free list, the first 8 bytes of it's "data" contain
+    the offset of the next free block in the list.
+
+------------------------------------------------------------------------*/
+typedef struct slabBlock_t
+{
+    unsigned int type;
+    unsigned int sizeClass;
+    char         data[0] __attribute__ ((aligned (8)));
+
+}   slabBlock_t;
+
+//
+//  Define the constants used with the slab blocks.  The size classes are
+//  the powers of 2 from the minimum to the maximum size and the sizes
+//  include the slab block header.
+//
+#define TYPE_SLAB_IN_USE    ( 2 )
+#define TYPE_SLAB_FREE      ( 3 )
+
+#define SM_SLAB_CLASS_COUNT ( 5 )
+#define SM_SLAB_MIN_SHIFT   ( 4 )
+#define SM_SLAB_MIN_SIZE    ( 1UL << SM_SLAB_MIN_SHIFT )
+#define SM_SLAB_MAX_SIZE    ( SM_SLAB_MIN_SIZE << ( SM_SLAB_CLASS_COUNT - 1 ) )
+#define SM_SLAB_PAGE_SIZE   ( 64 * 1024 )
+
+static const unsigned long SLAB_HEADER_SIZE = sizeof(slabBlock_t);
+
+
+/*!-----------------------------------------------------------------------
+
+    m a g a z i n e _ t
+
+    @brief Define a per-thread cache of free slab blocks.
+
+    Each thread that allocates small blocks owns one of these magazines (if
+    one is available) and allocates blocks from it and frees blocks to it
+    without any locking.  The magazine is refilled from and drained to the
+    slab free lists in batches of SM_MAGAZINE_BATCH blocks.
+
+    The magazines are kept in the shared memory segment so that the blocks
+    cached by a process that dies can be recovered by the next process that
+    attaches to the segment.
+
+    The "processId" is the process ID of the owner of the magazine, 0 if the
+    magazine is available, or SM_MAGAZINE_RECLAIMING while the magazine of a
+    dead process is being drained.
+
+    The "threadId" is the kernel thread ID of the owning thread.
+
+    The "generation" is incremented every time the magazine is drained.  A
+    thread remembers the generation of the magazine it claimed so that it
+    can tell that it's magazine was drained out from under it (when the
+    segment is detached) and must not be used any more.
+
+    The "count" is the number of free blocks of each size class currently in
+    the magazine and the "blocks" are the offsets of those blocks.
+
+    The magazine is also the owning thread's record in the epoch based
+    reclamation scheme (see sm_epoch_enter).  The "epoch" is the global
+    epoch that was current when the thread entered it's outermost epoch
+    protected section or 0 if the thread is not in one.  The "limbo" holds
+    the offsets of the "limboCount" blocks that this thread has retired but
+    that may still be referenced by readers and "limboEpoch" holds the
+    global epoch at the time each of them was retired.
+
+------------------------------------------------------------------------*/
+#define SM_MAGAZINE_COUNT      ( 64 )
+#define SM_MAGAZINE_SIZE       ( 32 )
+#define SM_MAGAZINE_BATCH      ( SM_MAGAZINE_SIZE / 2 )
+#define SM_MAGAZINE_RECLAIMING ( -1 )
+
+#define SM_EPOCH_LIMBO_SIZE    ( 32 )
+
+typedef struct magazine_t
+{
+    pid_t         processId;
+    pid_t         threadId;
+    unsigned long generation;
+    unsigned int  count[SM_SLAB_CLASS_COUNT];
+    offset_t      blocks[SM_SLAB_CLASS_COUNT][SM_MAGAZINE_SIZE];
+
+    unsigned long epoch;
+    unsigned int  limboCount;
+    offset_t      limbo[SM_EPOCH_LIMBO_SIZE];
+    unsigned long limboEpoch[SM_EPOCH_LIMBO_SIZE];
+
+}   magazine_t;
+
+
+/*!-----------------------------------------------------------------------
+
+    l i m b o P a g e _ t
+
+    @brief Define a page of the shared limbo list.
+
+    Retired blocks that could not be kept in a thread's magazine (because
+    the thread has no magazine, it's limbo is full and still in use by some
+    reader, or the thread is going away) are moved to a page on the shared
+    limbo list which is protected by the shared memory manager lock.
+
+    The "next" is the offset of the next page in the list, the "epoch" is
+    the newest retirement epoch of any of the "count" blocks whose offsets
+    are in "blocks".  The whole page is freed at once when no reader is in
+    an epoch at or before the page epoch.  Blocks are added to the first
+    page of the list until it is full before a new page is started.
+
+------------------------------------------------------------------------*/
+typedef struct limboPage_t
+{
+    offset_t      next;
+    unsigned long epoch;
+    unsigned long count;
+    offset_t      blocks[SM_EPOCH_LIMBO_SIZE];
+
+}   limboPage_t;
+
+
+/*!-----------------------------------------------------------------------
+
+    a n o n y m o u s R e a d e r _ t
+
+    @brief Define the anonymous readers of one process.
+
+    A thread that has no magazine has nowhere to record the epoch it is in
+    so it is counted as an anonymous reader while it is in an epoch protected
+    section, and nothing can be reclaimed while there are any.  The count is
+    kept per process so that the readers of a process that died inside an
+    epoch protected section can be written off by sm_reclaim_magazines
+    instead of holding up the reclamation forever.
+
+    The "processId" is the process ID of the owner of the record, 0 if the
+    record is available, or SM_MAGAZINE_RECLAIMING while the record of a dead
+    process is being reset.  The "count" is the number of threads of that
+    process that are currently anonymous readers.
+
+    If all of the records are in use, the threads of any other process are
+    counted in the shared "anonymousOverflow" count which can't be reset.
+
+------------------------------------------------------------------------*/
+#define SM_ANONYMOUS_READER_COUNT ( 64 )
+
+typedef struct anonymousReader_t
+{
+    pid_t         processId;
+    unsigned long count;
+
+}   anonymousReader_t;
+
+
+/*!-----------------------------------------------------------------------
+
+    t r a c e R e c o r d _ t
+
+    @brief Define the records of the shared memory trace ring.
+
+    The trace ring is a fixed size circular array of these binary records
+    located in the shared memory control structure.  Every process that uses
+    the shared memory segment appends records to this ring as it executes the
+    interesting events in the VSI core (inserts, fetches, semaphore waits,
+    etc.).  Recording an event is just an atomic increment and a few stores
+    so this can be left enabled in release builds where all of the LOG output
+    has been compiled out.  The "dump" utility will render the contents of
+    the ring on demand.
+
+    The "sequence" is the position of this record in the stream of trace
+    events plus one.  It is written last so a reader can tell whether or not
+    a record has been completely written (and not yet overwritten).
+
+    The "timestamp" is the CLOCK_MONOTONIC time of the event in nanoseconds.
+
+    The "event" is one of the traceEvent_t values defined below.
+
+    The "threadId" is the kernel thread ID of the thread that recorded the
+    event.
+
+    The "domainId" and "signalId" identify the signal involved in the event
+    if there is one.
+
+    The "argument" is an event specific value (usually a data size or the
+    offset of the object involved).
+
+------------------------------------------------------------------------*/
+typedef struct traceRecord_t
+{
+    unsigned long sequence;
+    unsigned long timestamp;
+    unsigned int  event;
+    unsigned int  threadId;
+    int           domainId;
+    int           signalId;
+    unsigned long argument;
+
+}   traceRecord_t;
+
+//
+//  Define the number of records in the trace ring.  This must be a power of
+//  2 so that the ring index can be computed with a simple mask.
+//
+#define SM_TRACE_RECORD_COUNT ( 4096 )
+
+//
+//  Define the events that are recorded in the trace ring.
+//
+typedef enum
+{
+    te_none = 0,
+    te_insert,
+    te_fetch,
+    te_fetch_newest,
+    te_fetch_latest,
+    te_fetch_range,
+    te_flush,
+    te_semaphore_post,
+    te_semaphore_wait,
+    te_semaphore_wake,
+    te_malloc,
+    te_free,
+    te_grow,
+    te_count
+
+}   traceEvent_t;
+
+//
+//  Define the macro used to record trace events.  If the VSI_NO_TRACE symbol
+//  is defined, all of the trace calls will be compiled out of the code.
+//
+#ifdef VSI_NO_TRACE
+#   define SM_TRACE(...)
+#else
+#   define SM_TRACE sm_trace
+#endif
 
 
 /*!---------------------------------------------------------------------------
@@ -208,6 +486,14 @@ typedef struct sharedMemory_t
     unsigned long currentSize;
     unsigned long systemInitialized;
 
+    //
+    //  Define the segment generation.  This is incremented each time the
+    //  segment is grown (after the new segment size has been stored) so that
+    //  the other processes using this segment can tell that they need to map
+    //  the new memory.
+    //
+    unsigned long generation;
+
     //
     //  The following is used to access the VSI specific data structures.
     //
@@ -253,6 +539,44 @@ typedef struct sharedMemory_t
     unsigned long globalTime;
 #endif
 
+    //
+    //  Define the heads of the slab free lists (one for each size class).
+    //  Each head contains the offset of the first free block divided by 8 in
+    //  the low 32 bits and a tag that is incremented on every change in the
+    //  high 32 bits.  The tag keeps a compare-and-swap from succeeding if the
+    //  list was changed and then changed back (the "ABA" problem) while we
+    //  were looking at it.
+    //
+    unsigned long slabFreeList[SM_SLAB_CLASS_COUNT];
+    unsigned long slabPageCount;
+
+    //
+    //  Define the per-thread magazines of free slab blocks.
+    //
+    magazine_t magazines[SM_MAGAZINE_COUNT];
+
+    //
+    //  Define the epoch based reclamation state.  The reclaim epoch is the
+    //  global epoch which is advanced every time a thread tries to reclaim
+    //  it's retired blocks.  The anonymous readers are the threads without
+    //  a magazine that are currently in an epoch protected section, counted
+    //  per process (nothing can be reclaimed while there are any).  The
+    //  limbo list is the offset of the first page of the shared limbo list.
+    //
+    unsigned long     reclaimEpoch;
+    anonymousReader_t anonymousReaders[SM_ANONYMOUS_READER_COUNT];
+    unsigned long     anonymousOverflow;
+    offset_t          limboList;
+    unsigned long     limboPageCount;
+
+    //
+    //  Define the binary trace ring.  The trace index is the total number of
+    //  events that have ever been recorded and is atomically incremented by
+    //  each writer to claim a record in the ring.
+    //
+    unsigned long traceIndex;
+    traceRecord_t traceRing[SM_TRACE_RECORD_COUNT];
+
 }   sharedMemory_t, *sharedMemory_p;
 
 
@@ -283,6 +607,11 @@ typedef struct sysMemory_t
     unsigned long freeListCount;
     unsigned long systemInitialized;
 
+    //
+    //  Define the segment generation.  See the sharedMemory_t definition.
+    //
+    unsigned long generation;
+
     //
     //  Create the mutex attribute initializer that we can use to initialize
     //  all of the mutexes in the B-trees.
@@ -370,6 +699,51 @@ typedef struct sysMemory_t
     S h a r e d   M e m o r y   M e m b e r   F u n c t i o n s
 
 ------------------------------------------------------------------------*/
+//
+//  Declare the generation of each of the shared memory segments that is
+//  currently mapped into this process.
+//
+extern unsigned long smGeneration;
+extern unsigned long sysGeneration;
+
+//
+//  Map any memory that has been added to the shared memory segments by
+//  other processes since this process last mapped them.
+//
+void sm_remap     ( void );
+void sm_remap_sys ( void );
+
+//
+//  Make sure that all of the memory in the shared memory segments is
+//  accessible to this process.
+//
+//  If another process has grown a segment since we last looked at it, the
+//  generation in the segment will not match ours and we need to go map the
+//  new memory before using any address in the segment.  In the normal case,
+//  this is a single load and compare.
+//
+inline static void sm_check_mapping ( void )
+{
+    if ( __builtin_expect ( __atomic_load_n ( &smControl->generation,
+                                              __ATOMIC_ACQUIRE ) !=
+                            smGeneration, 0 ) )
+    {
+        sm_remap();
+    }
+}
+
+
+inline static void sm_check_mapping_sys ( void )
+{
+    if ( __builtin_expect ( __atomic_load_n ( &sysControl->generation,
+                                              __ATOMIC_ACQUIRE ) !=
+                            sysGeneration, 0 ) )
+    {
+        sm_remap_sys();
+    }
+}
+
+
 //
 //  Return the address of a message from the specified signal list.
 //
@@ -380,6 +754,8 @@ typedef struct sysMemory_t
 //
 inline static void* toAddress ( offset_t offset )
 {
+    sm_check_mapping();
+
     return (void*)( (void*)smControl + offset );
 }
 
@@ -402,6 +778,34 @@ sharedMemory_p sm_initialize ( int fd, size_t sharedMemorySegmentSize );
 sysMemory_p sm_initialize_sys ( int fd, size_t sharedMemorySegmentSize );
 
 
+//
+//  Map existing shared memory segments into this process.
+//
+//  These functions will take the file descriptor of an existing (already
+//  initialized) shared memory segment file and the current size of that
+//  file and map the segment into memory.  The file descriptor is kept open
+//  (by these functions and the initialize functions above) so that the
+//  segment can be grown and remapped later.
+//
+sharedMemory_p sm_attach     ( int fd, size_t segmentFileSize );
+sysMemory_p    sm_attach_sys ( int fd, size_t segmentFileSize );
+
+
+//
+//  Unmap the shared memory segments from this process and close their
+//  segment files.
+//
+int sm_detach     ( void );
+int sm_detach_sys ( void );
+
+
+//
+//  Give the blocks cached in the magazines of any processes that have died
+//  back to the slab free lists.  This is done automatically by sm_attach.
+//
+void sm_reclaim_magazines ( void );
+
+
 //
 //  Find an available chunk of memory of an appropriate size and return the
 //  virtual memory address of it to the caller.  This will mark that section
@@ -411,6 +815,15 @@ void* sm_malloc     ( size_t size );
 void* sm_malloc_sys ( size_t size );
 
 
+//
+//  Allocate several chunks of memory at once.  The shared memory manager
+//  lock is held for the whole batch (unless all of the chunks come from the
+//  slabs).  Either all of the chunks are allocated and 0 is returned or none
+//  of them are and ENOMEM is returned.
+//
+int sm_malloc_batch ( size_t count, const size_t* sizes, void** blocks );
+
+
 //
 //  Give the specified chunk of memory back to the page manager.  This will
 //  mark the page as "available" and erase all data in the page (for security
@@ -422,12 +835,39 @@ void sm_free     ( void* memoryToFree );
 void sm_free_sys ( void* memoryToFree );
 
 
+//
+//  Enter and exit an epoch protected section.  Memory that is retired by
+//  any thread while a reader is inside one of these sections is not given
+//  back to the memory manager until the reader has exited.  The sections
+//  may be nested and never block.
+//
+void sm_epoch_enter ( void );
+void sm_epoch_exit  ( void );
+
+
+//
+//  Retire a chunk of memory that has been unlinked from a shared structure
+//  but may still be referenced by readers in epoch protected sections.  The
+//  memory is freed once all of those readers have exited.
+//
+void sm_retire ( void* memoryToRetire );
+
+
+//
+//  Record an event in the shared memory trace ring.  This should normally be
+//  called through the SM_TRACE macro so that it can be compiled out.
+//
+void sm_trace ( traceEvent_t event, int domainId, int signalId,
+                unsigned long argument );
+
+
 //
 //  Declare the dumping debugging functions.
 //
 void dumpSM           ( void );
 void dumpFreeBySize   ( void );
 void dumpFreeByOffset ( void );
+void dumpTrace        ( unsigned long recordCount );
 
 
 #endif  // End of #ifndef SHARED_MEMORY_H
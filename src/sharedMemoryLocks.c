@@ -22,8 +22,11 @@
 #include <unistd.h>
 #include <time.h>
 #include <stdio.h>
-#include <sys/types.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #include "vsi_core_api.h"
 #include "sharedMemoryLocks.h"
@@ -33,6 +36,68 @@
 /*! @{ */
 
 
+/*!-----------------------------------------------------------------------
+
+    f u t e x
+
+    @brief Issue a futex system call on a semaphore's futex word.
+
+    Note that the futex operations used here are the shared (not private)
+    versions since the semaphores live in shared memory and are used by
+    multiple processes.
+
+    Waits are done with FUTEX_WAIT_BITSET rather than FUTEX_WAIT since that
+    takes an absolute timeout measured against CLOCK_MONOTONIC instead of a
+    relative one, so the deadline does not have to be recomputed after every
+    spurious wakeup.
+
+    @param[in] semaphore - The address of the semaphore object.
+    @param[in] operation - The futex operation (FUTEX_WAIT_BITSET or
+                           FUTEX_WAKE).
+    @param[in] value - The expected futex value or the number to wake.
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which a wait
+                          gives up or NULL to wait forever.
+
+    @return The system call return value.
+
+------------------------------------------------------------------------*/
+static inline long futex ( semaphore_p            semaphore,
+                           int                    operation,
+                           unsigned int           value,
+                           const struct timespec* deadline )
+{
+    return syscall ( SYS_futex, &semaphore->futex, operation, value, deadline,
+                     NULL, FUTEX_BITSET_MATCH_ANY );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    d e a d l i n e P a s s e d
+
+    @brief Determine if an absolute CLOCK_MONOTONIC deadline has passed.
+
+    @param[in] deadline - The deadline to be tested or NULL for none.
+
+    @return true if there is a deadline and it has passed.
+
+------------------------------------------------------------------------*/
+static bool deadlinePassed ( const struct timespec* deadline )
+{
+    struct timespec now;
+
+    if ( deadline == NULL )
+    {
+        return false;
+    }
+    clock_gettime ( CLOCK_MONOTONIC, &now );
+
+    return now.tv_sec > deadline->tv_sec ||
+           ( now.tv_sec == deadline->tv_sec &&
+             now.tv_nsec >= deadline->tv_nsec );
+}
+
+
 /*!-----------------------------------------------------------------------
 
     s e m a p h o r e P o s t
@@ -40,13 +105,13 @@
     @brief Perform a "post" operation on a semaphore.
 
     This function will perform a "post" operation on a semaphore object
-    (similar to a "signal" on a mutex).  This operation will increment the
-    semaphore's count value and if there are any processes waiting on this
-    semahore, one (or possibly more) of them will be released and allowed to
-    run.  Under normal conditions, only one waiting process will be released
-    when this signal occurs but there is a very small window in which more
-    than one could be released.  This is not a problem - See the man page for
-    pthread_cond_signal.
+    (similar to a "signal" on a mutex).  The caller is expected to have
+    already incremented the semaphore's count value.  If there are any
+    threads waiting on this semahore, all of them will be released and
+    allowed to run.
+
+    If no one is waiting on the semaphore (the normal case), this is just an
+    atomic load and no system call is made.
 
     That this code assumes that the semaphore object to be operated on already
     exists and has been mapped into this process's shared memory segment.  The
@@ -57,28 +122,35 @@
 ------------------------------------------------------------------------*/
 void semaphorePost ( semaphore_p semaphore )
 {
-    int status;
+    SM_TRACE ( te_semaphore_post, 0, 0, toOffset ( semaphore ) );
 
     //
-    //  If the semaphore count is at 0 then someone may be currently waiting
-    //  on this semaphore so just signal the condition variable to indicate
-    //  that the resource is available and release the process(s) that are
-    //  waiting.
+    //  Make sure that the caller's increment of the message count is visible
+    //  before we look for sleepers.  This pairs with the increment of the
+    //  sleeper count in semaphoreWait so that either the waiter sees the new
+    //  message count or we see the waiter.
     //
-    pthread_mutex_lock ( &semaphore->mutex );
+    __atomic_thread_fence ( __ATOMIC_SEQ_CST );
 
-    LOG ( "Before semaphore broadcast (post) of sem: %p\n", semaphore );
+    if ( __atomic_load_n ( &semaphore->sleeperCount, __ATOMIC_RELAXED ) == 0 )
+    {
+        return;
+    }
+    LOG ( "Before semaphore wake (post) of sem: %p\n", semaphore );
     SEM_DUMP ( semaphore );
 
-    status = pthread_cond_broadcast ( &semaphore->conditionVariable );
-    if ( status != 0 )
+    //
+    //  Advance the wake sequence so that any thread that is just about to go
+    //  to sleep will not, and wake up everyone that is already asleep.
+    //
+    __atomic_add_fetch ( &semaphore->futex, 1, __ATOMIC_RELEASE );
+
+    if ( futex ( semaphore, FUTEX_WAKE, INT_MAX, NULL ) < 0 )
     {
-        printf ( "Unable to broadcast to condition variable - "
-                 "errno: %u[%s].\n", status, strerror(status) );
+        printf ( "Unable to wake the semaphore waiters - errno: %u[%m].\n",
+                 errno );
     }
-    pthread_mutex_unlock ( &semaphore->mutex );
-
-    LOG ( "After semaphore broadcast of %p:\n", semaphore );
+    LOG ( "After semaphore wake of %p:\n", semaphore );
     SEM_DUMP ( semaphore );
 }
 
@@ -86,61 +158,183 @@ void semaphorePost ( semaphore_p semaphore )
 //
 //  Define the cleanup handler for the semaphore wait below.  This handler
 //  will be executed if this thread is cancelled while it is waiting.  What
-//  this function needs to do is release the mutex that this thread is holding
-//  when it enters the wait state.  Without this cleanup handler, the mutex
-//  will remain locked when this thread is cancelled and almost certainly
-//  cause a hang condition in the code the next time someone tries to lock
-//  this same mutex.
+//  this function needs to do is remove this thread from the sleeper count.
+//  Without this cleanup handler, every subsequent post would go into the
+//  kernel to wake up a thread that no longer exists.
 //
 static void semaphoreCleanupHandler ( void* arg )
 {
-    pthread_mutex_unlock ( arg );
+    semaphore_p semaphore = arg;
+
+    __atomic_sub_fetch ( &semaphore->sleeperCount, 1, __ATOMIC_RELAXED );
 }
 
 
-void semaphoreWait ( semaphore_p semaphore )
+/*!-----------------------------------------------------------------------
+
+    s e m a p h o r e W a i t
+
+    @brief Perform a "wait" operation on a semaphore.
+
+    This function will return immediately if the semaphore's count value is
+    non-zero and otherwise block until it becomes non-zero.  Note that the
+    count is not decremented here - That is up to the caller.
+
+    The wait is a cancellation point just like the pthread_cond_wait it
+    replaced.
+
+    If a deadline is specified, the wait gives up once the CLOCK_MONOTONIC
+    time reaches it.
+
+    @param[in] semaphore - The address of the semaphore object to operate on.
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which to give
+                          up or NULL to wait forever.
+
+    @return 0 if the semaphore count is non-zero
+            ETIMEDOUT - The deadline passed first.
+
+------------------------------------------------------------------------*/
+int semaphoreWait ( semaphore_p semaphore, const struct timespec* deadline )
 {
-    int status;
+    int oldType;
+    int status = 0;
+
+    SM_TRACE ( te_semaphore_wait, 0, 0, toOffset ( semaphore ) );
+
+    LOG ( "Before semaphore wait on sem: %p\n", semaphore );
+    SEM_DUMP ( semaphore );
 
     //
     //  If the semaphore count is at 0 then the resource is not available so
     //  we need to wait for it to become available.  This is done in a "while"
-    //  loop because we could be released spuriously due to a very small
-    //  window in the semaphore code that results in more than one process
-    //  being released at times.  By checking the semaphore again after being
-    //  released, we guarantee that only one process will actually acquire the
-    //  semaphore.
+    //  loop because the futex wait can return spuriously (or because another
+    //  thread already took the message) so we need to check the count again
+    //  after every wakeup.
     //
-    pthread_mutex_lock ( &semaphore->mutex );
+    while ( __atomic_load_n ( &semaphore->messageCount, __ATOMIC_ACQUIRE ) == 0 )
+    {
+        if ( deadlinePassed ( deadline ) )
+        {
+            status = ETIMEDOUT;
+            break;
+        }
+        //
+        //  Get the current wake sequence before we announce ourselves so that
+        //  a post that happens after this point will make the futex wait
+        //  return immediately.
+        //
+        unsigned int sequence = __atomic_load_n ( &semaphore->futex,
+                                                  __ATOMIC_ACQUIRE );
 
-    LOG ( "Before semaphore wait on sem: %p\n", semaphore );
-    SEM_DUMP ( semaphore );
+        __atomic_add_fetch ( &semaphore->sleeperCount, 1, __ATOMIC_SEQ_CST );
 
-    while ( semaphore->messageCount == 0 )
-    {
-        LOG ( "In semaphore while[%p] - waiterCount: %d, messageCount: %d\n",
-              semaphore, semaphore->waiterCount, semaphore->messageCount );
+        LOG ( "In semaphore while[%p] - sleeperCount: %d, messageCount: %d\n",
+              semaphore, semaphore->sleeperCount, semaphore->messageCount );
         //
         //  Install the cancellation cleanup handler function.
         //
-        pthread_cleanup_push ( semaphoreCleanupHandler, &semaphore->mutex );
+        pthread_cleanup_push ( semaphoreCleanupHandler, semaphore );
 
-        status = pthread_cond_wait ( &semaphore->conditionVariable,
-                                     &semaphore->mutex );
-        if ( status != 0 )
+        //
+        //  Check the count once more now that any poster is guaranteed to
+        //  see us and then go to sleep.  The futex system call is not a
+        //  cancellation point on it's own so asynchronous cancellation is
+        //  enabled just for the duration of the call.
+        //
+        if ( __atomic_load_n ( &semaphore->messageCount, __ATOMIC_SEQ_CST ) == 0 )
         {
-            printf ( "Unable to wait on condition variable - "
-                     "errno: %u[%s].\n", status, strerror(status) );
+            pthread_setcanceltype ( PTHREAD_CANCEL_ASYNCHRONOUS, &oldType );
+
+            (void)futex ( semaphore, FUTEX_WAIT_BITSET, sequence, deadline );
+
+            pthread_setcanceltype ( oldType, NULL );
         }
         //
         //  Release the cancellation cleanup handler function.
         //
-        pthread_cleanup_pop ( 0 );
+        pthread_cleanup_pop ( 1 );
     }
-    pthread_mutex_unlock ( &semaphore->mutex );
+    SM_TRACE ( te_semaphore_wake, 0, 0, toOffset ( semaphore ) );
 
     LOG ( "After semaphore wait on %p:\n", semaphore );
     SEM_DUMP ( semaphore );
+
+    return status;
+}
+
+
+
+/*!-----------------------------------------------------------------------
+
+    s e m a p h o r e W a i t U n t i l
+
+    @brief Wait on a semaphore until a caller defined condition is true.
+
+    This function is identical to semaphoreWait except that instead of
+    waiting for the semaphore's count to become non-zero, it waits until the
+    "ready" function returns true.  The ready function is called again after
+    every post to the semaphore so it must only depend on state that is
+    changed before the semaphore is posted.
+
+    @param[in] semaphore - The address of the semaphore object to operate on.
+    @param[in] ready - The function that tests the condition being waited for.
+    @param[in] context - The argument to be passed to the ready function.
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which to give
+                          up or NULL to wait forever.
+
+    @return 0 if the condition is true
+            ETIMEDOUT - The deadline passed first.
+
+------------------------------------------------------------------------*/
+int semaphoreWaitUntil ( semaphore_p            semaphore,
+                         bool                   ( *ready ) ( void* context ),
+                         void*                  context,
+                         const struct timespec* deadline )
+{
+    int oldType;
+    int status = 0;
+
+    SM_TRACE ( te_semaphore_wait, 0, 0, toOffset ( semaphore ) );
+
+    while ( ! ready ( context ) )
+    {
+        if ( deadlinePassed ( deadline ) )
+        {
+            status = ETIMEDOUT;
+            break;
+        }
+        //
+        //  Get the current wake sequence before we announce ourselves so that
+        //  a post that happens after this point will make the futex wait
+        //  return immediately.
+        //
+        unsigned int sequence = __atomic_load_n ( &semaphore->futex,
+                                                  __ATOMIC_ACQUIRE );
+
+        __atomic_add_fetch ( &semaphore->sleeperCount, 1, __ATOMIC_SEQ_CST );
+
+        pthread_cleanup_push ( semaphoreCleanupHandler, semaphore );
+
+        //
+        //  Check the condition once more now that any poster is guaranteed
+        //  to see us and then go to sleep.  The fence pairs with the one in
+        //  semaphorePost since the ready function may use relaxed loads.
+        //
+        __atomic_thread_fence ( __ATOMIC_SEQ_CST );
+
+        if ( ! ready ( context ) )
+        {
+            pthread_setcanceltype ( PTHREAD_CANCEL_ASYNCHRONOUS, &oldType );
+
+            (void)futex ( semaphore, FUTEX_WAIT_BITSET, sequence, deadline );
+
+            pthread_setcanceltype ( oldType, NULL );
+        }
+        pthread_cleanup_pop ( 1 );
+    }
+    SM_TRACE ( te_semaphore_wake, 0, 0, toOffset ( semaphore ) );
+
+    return status;
 }
 
 /*! @} */
@@ -19,6 +19,8 @@
 #define SHARED_MEMORY_LOCKS_H
 
 #include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
 
 
 /*! @{ */
@@ -26,12 +28,24 @@
 //
 //  Define the semaphore control structure.
 //
+//  The semaphore is implemented directly on top of a Linux futex.  The
+//  "messageCount" is maintained atomically by the callers and the semaphore
+//  is available whenever it is non-zero.  The "futex" word is a wake sequence
+//  number that is incremented by every post that has to wake someone up and
+//  the "sleeperCount" is the number of threads currently blocked in the
+//  kernel on that futex word.  A post with no sleepers never enters the
+//  kernel.
+//
+//  The "waiterCount" is not used by the semaphore itself - It is the number
+//  of fetch operations currently in progress on the signal list (see
+//  sm_fetch).
+//
 typedef struct semaphore_t
 {
-    pthread_mutex_t mutex;
-    pthread_cond_t  conditionVariable;
-    int             messageCount;
-    int             waiterCount;
+    int          messageCount;
+    int          waiterCount;
+    unsigned int futex;
+    int          sleeperCount;
 
 }   semaphore_t, *semaphore_p;
 
@@ -40,7 +54,16 @@ typedef struct semaphore_t
 //  Define the semaphore member functions.
 //
 void semaphorePost ( semaphore_p semaphore );
-void semaphoreWait ( semaphore_p semaphore );
+//
+//  The "deadline" arguments are absolute CLOCK_MONOTONIC times (or NULL to
+//  wait forever) and the waits return ETIMEDOUT if they pass first.
+//
+int semaphoreWait ( semaphore_p semaphore, const struct timespec* deadline );
+
+int semaphoreWaitUntil ( semaphore_p            semaphore,
+                         bool                   ( *ready ) ( void* context ),
+                         void*                  context,
+                         const struct timespec* deadline );
 
 
 #ifdef SEM_DUMP
@@ -21,6 +21,14 @@
 #include <errno.h>
 #include <string.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
 
 #include "vsi.h"
 #include "signals.h"
@@ -161,9 +169,19 @@ int vsi_insert_signal ( vsi_result* result )
     //
     PRINT_RESULT ( result, "\nCalled vsi_insert_signal with" );
 
-    vsi_core_insert ( result->domainId, result->signalId, result->dataLength,
-                      result->data );
-    return 0;
+    //
+    //  Insert the signal with the caller's capture time (if any) and return
+    //  the stamp that was stored to the caller.
+    //
+    signal_stamp stamp = { .timestamp = result->timestamp };
+
+    result->status = sm_insert ( result->domainId, result->signalId,
+                                 result->dataLength, result->data, &stamp );
+
+    result->timestamp = stamp.timestamp;
+    result->sequence  = stamp.sequence;
+
+    return result->status;
 }
 
 
@@ -184,6 +202,34 @@ int vsi_insert_signal_by_name ( vsi_result* result )
 }
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ i n s e r t _ s i g n a l s
+
+    Fire several vehicle signals by their IDs.
+
+------------------------------------------------------------------------*/
+int vsi_insert_signals ( vsi_result* results, size_t count )
+{
+    size_t i;
+
+    if ( count == 0 )
+    {
+        return 0;
+    }
+    CHECK_AND_RETURN_IF_ERROR ( results );
+
+    for ( i = 0; i < count; ++i )
+    {
+        CHECK_AND_RETURN_IF_ERROR ( results[i].data );
+        CHECK_AND_RETURN_IF_ERROR ( results[i].dataLength );
+
+        PRINT_RESULT ( &results[i], "\nCalled vsi_insert_signals with" );
+    }
+    return vsi_core_insert_batch ( results, count );
+}
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ g e t _ o l d e s t _ s i g n a l
@@ -198,8 +244,14 @@ int vsi_get_oldest_signal ( vsi_result* result )
 
     CHECK_AND_RETURN_IF_ERROR ( result && result->data && result->dataLength );
 
-    result->status = vsi_core_fetch ( result->domainId, result->signalId,
-                                      &result->dataLength, (void**)&result->data );
+    signal_stamp stamp = { 0 };
+
+    result->status = sm_fetch ( result->domainId, result->signalId,
+                                &result->dataLength, result->data, false,
+                                NULL, &stamp );
+
+    result->timestamp = stamp.timestamp;
+    result->sequence  = stamp.sequence;
 
     PRINT_RESULT ( result, "vsi_get_oldest_signal returning" );
 
@@ -228,14 +280,23 @@ int vsi_get_oldest_signal_by_name ( vsi_result* result )
 
     Fetch the latest value of the specified signal by ID.
 
+    The data is copied into the buffer supplied in the result structure and
+    the dataLength is updated with the number of bytes copied.
+
 ------------------------------------------------------------------------*/
 int vsi_get_newest_signal ( vsi_result* result )
 {
     CHECK_AND_RETURN_IF_ERROR ( result && result->data && result->dataLength );
 
-    result->status = vsi_core_fetch_newest ( result->domainId, result->signalId,
-                                             &result->dataLength,
-                                             (void**)&result->data );
+    signal_stamp stamp = { 0 };
+
+    result->status = sm_fetch_latest ( result->domainId, result->signalId,
+                                       &result->dataLength, result->data,
+                                       true, NULL, &stamp );
+
+    result->timestamp = stamp.timestamp;
+    result->sequence  = stamp.sequence;
+
     return result->status;
 }
 
@@ -255,6 +316,117 @@ int vsi_get_newest_signal_by_name ( vsi_result* result )
 }
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ s i g n a l _ r a n g e
+
+    Copy the signals captured within a time range without removing them.
+
+------------------------------------------------------------------------*/
+int vsi_get_signal_range ( const domain_t domainId,
+                           const signal_t signalId,
+                           unsigned long  beginTime,
+                           unsigned long  endTime,
+                           vsi_result*    results,
+                           size_t*        count )
+{
+    size_t i;
+
+    CHECK_AND_RETURN_IF_ERROR ( ( results && count && beginTime <= endTime ) );
+
+    int status = sm_fetch_range ( domainId, signalId, beginTime, endTime,
+                                  results, count );
+
+    for ( i = 0; i < *count; ++i )
+    {
+        results[i].domainId = domainId;
+        results[i].signalId = signalId;
+        results[i].status   = 0;
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l e a s e _ o l d e s t _ s i g n a l
+
+    Lease the oldest entry in the core database for a signal by ID.
+
+------------------------------------------------------------------------*/
+int vsi_lease_oldest_signal ( vsi_lease*             lease,
+                              bool                   wait,
+                              const struct timespec* deadline )
+{
+    signal_data* record;
+
+    CHECK_AND_RETURN_IF_ERROR ( lease );
+
+    int status = sm_fetch_lease ( lease->domainId, lease->signalId, false,
+                                  wait, deadline, &record );
+    if ( status == 0 )
+    {
+        lease->data       = record->data;
+        lease->dataLength = record->messageSize;
+        lease->timestamp  = record->stamp.timestamp;
+        lease->sequence   = record->stamp.sequence;
+        lease->record     = toOffset ( record );
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l e a s e _ n e w e s t _ s i g n a l
+
+    Lease the newest entry in the core database for a signal by ID.
+
+------------------------------------------------------------------------*/
+int vsi_lease_newest_signal ( vsi_lease*             lease,
+                              bool                   wait,
+                              const struct timespec* deadline )
+{
+    signal_data* record;
+
+    CHECK_AND_RETURN_IF_ERROR ( lease );
+
+    int status = sm_fetch_lease ( lease->domainId, lease->signalId, true,
+                                  wait, deadline, &record );
+    if ( status == 0 )
+    {
+        lease->data       = record->data;
+        lease->dataLength = record->messageSize;
+        lease->timestamp  = record->stamp.timestamp;
+        lease->sequence   = record->stamp.sequence;
+        lease->record     = toOffset ( record );
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ r e l e a s e _ l e a s e
+
+    Release a signal lease.
+
+------------------------------------------------------------------------*/
+int vsi_release_lease ( vsi_lease* lease )
+{
+    CHECK_AND_RETURN_IF_ERROR ( lease );
+    CHECK_AND_RETURN_IF_ERROR ( lease->record );
+
+    sm_release_signal_data ( toAddress ( lease->record ) );
+
+    lease->data       = NULL;
+    lease->dataLength = 0;
+    lease->record     = 0;
+
+    return 0;
+}
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ f l u s h _ s i g n a l
@@ -290,2507 +462,7341 @@ int vsi_flush_signal_by_name ( const domain_t domain, const char* name )
 
 /*!----------------------------------------------------------------------------
 
-    f i n d S i g n a l L i s t
-
-    @brief Find the the signal list for a domain and signal value.
+    d e n s e S i g n a l L o o k u p
 
-    This function will search the signals btree for a match to the domain and
-    id value supplied.  If a match is found, the address of the signal list
-    control block will be returned to the caller.  If no match is found, a new
-    signal list control block will be created and inserted into the btree
-    database.  In either case, the signal list control address will be
-    returned to the caller.
+    @brief Look up a signal list in the dense signal index.
 
-    The caller is responsible for populating the privateId and name for this
-    signal if it is a new one and updating the appropriate indices for those
-    fields.
+    If the domain and signal IDs are within the range covered by the dense
+    signal index and the signal has been entered into it, the address of the
+    signal list is returned.  Otherwise a NULL is returned and the caller
+    must look the signal up in the signal ID btree.
 
     @param[in] - domain - The domain of the signal list to find
     @param[in] - signal - The id of the signal list to find
 
-    @return If successful, the address of the signal list control block
-            If no memory is availabe for a new list, a NULL
+    @return The address of the signal list or NULL
 
 -----------------------------------------------------------------------------*/
-signal_list* findSignalList ( domain_t domain, signal_t signal )
+static inline signal_list* denseSignalLookup ( domain_t domain, signal_t signal )
 {
-    signal_list  requestedSignal;
-    signal_list* signalList;
-    int          status = 0;
+    if ( (unsigned int)domain >= VSI_DENSE_DOMAIN_COUNT ||
+         (unsigned int)signal >= VSI_DENSE_SIGNAL_COUNT )
+    {
+        return NULL;
+    }
+    offset_t indexOffset = __atomic_load_n ( &vsiContext->denseSignalIndex[domain],
+                                             __ATOMIC_ACQUIRE );
+    if ( indexOffset == 0 )
+    {
+        return NULL;
+    }
+    offset_t* denseIndex = toAddress ( indexOffset );
 
-    //
-    //  Initialize the fields we will need to find the requested signal list.
-    //
-    requestedSignal.domainId = domain;
-    requestedSignal.signalId = signal;
+    offset_t signalListOffset = __atomic_load_n ( &denseIndex[signal],
+                                                  __ATOMIC_ACQUIRE );
+    if ( signalListOffset == 0 )
+    {
+        return NULL;
+    }
+    return toAddress ( signalListOffset );
+}
 
-    //
-    //  Go find the requested signal list.
-    //
-    signalList = btree_search ( &vsiContext->signalIdIndex, &requestedSignal );
 
+/*!----------------------------------------------------------------------------
+
+    d e n s e S i g n a l S t o r e
+
+    @brief Enter a signal list into the dense signal index.
+
+    If the domain and signal IDs of the signal list are within the range
+    covered by the dense signal index, the offset of the signal list is stored
+    in it.  The array for the domain is allocated the first time a signal in
+    that domain is stored.  If two processes race to allocate the same
+    array, the loser frees it's copy and uses the winner's.
+
+    Failures here are not fatal since the signal can always be found in the
+    signal ID btree.
+
+    @param[in] - signalList - The signal list to be entered into the index
+
+    @return None
+
+-----------------------------------------------------------------------------*/
+static void denseSignalStore ( signal_list* signalList )
+{
+    domain_t domain = signalList->domainId;
+    signal_t signal = signalList->signalId;
+
+    if ( (unsigned int)domain >= VSI_DENSE_DOMAIN_COUNT ||
+         (unsigned int)signal >= VSI_DENSE_SIGNAL_COUNT )
+    {
+        return;
+    }
+    offset_t indexOffset = __atomic_load_n ( &vsiContext->denseSignalIndex[domain],
+                                             __ATOMIC_ACQUIRE );
     //
-    //  If we didn't find this signal list control block then this is the
-    //  first time this domain/id have been seen so we need to create a new
-    //  signal list control block for it.
+    //  If this domain does not have a dense index yet, go allocate one.
     //
-    if ( signalList == NULL )
+    if ( indexOffset == 0 )
     {
-        LOG ( "Creating a new signal list for %d,%d\n", domain, signal );
-
-        //
-        //  Go allocate a new signal list control block in the shared memory
-        //  segment.
-        //
-        signalList = sm_malloc ( SIGNAL_LIST_SIZE );
-
-        //
-        //  If the allocation failed, we have exceeded the amount of memory in
-        //  the shared memory segment.  This is a fatal condition so let the
-        //  user know and quit!
-        //
-        if ( signalList == NULL )
+        offset_t* newIndex = sm_malloc ( VSI_DENSE_SIGNAL_COUNT * sizeof(offset_t) );
+        if ( newIndex == NULL )
         {
-            printf ( "Error: Unable to allocate a new signal list - "
-                     "Shared memory segment is full!\n" );
-            return 0;
+            return;
         }
-        //
-        //  Initialize and populate the new signal list control block.
-        //
-        signalList->domainId           = domain;
-        signalList->signalId           = signal;
-        signalList->privateId          = 0;
-        signalList->name               = 0;
-        signalList->currentSignalCount = 0;
-        signalList->totalSignalSize    = 0;
-        signalList->head               = END_OF_LIST_MARKER;
-        signalList->tail               = END_OF_LIST_MARKER;
+        memset ( newIndex, 0, VSI_DENSE_SIGNAL_COUNT * sizeof(offset_t) );
 
-        //
-        //  Initialize the signal list mutex and condition variable.
-        //
-        status = pthread_mutex_init ( &signalList->semaphore.mutex,
-                                      &smControl->masterMutexAttributes );
-        if ( status != 0 )
+        offset_t newOffset = toOffset ( newIndex );
+        if ( __atomic_compare_exchange_n ( &vsiContext->denseSignalIndex[domain],
+                                           &indexOffset, newOffset, false,
+                                           __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
         {
-            printf ( "Unable to initialize signal list mutex - errno: %u[%m].\n",
-                     status );
-            sm_free ( signalList );
-            return 0;
+            indexOffset = newOffset;
         }
-        status = pthread_cond_init ( &signalList->semaphore.conditionVariable,
-                                     &smControl->masterCvAttributes );
-        if ( status != 0 )
+        else
         {
-            printf ( "Unable to initialize signal list condition variable - "
-                     "errno: %u[%m].\n", status );
-            sm_free ( signalList );
-            return 0;
+            sm_free ( newIndex );
         }
-        //
-        //  If debugging is enabled, to dump the semaphore we just created.
-        //
-        SEM_DUMP ( &signalList->semaphore );
-
-        //
-        //  Initialize the semaphore counters for this signal list control
-        //  block.
-        //
-        signalList->semaphore.messageCount = 0;
-        signalList->semaphore.waiterCount  = 0;
-
-        //
-        //  Insert the new signal list control block into the btree.
-        //
-        btree_insert ( &vsiContext->signalIdIndex, signalList );
     }
-    //
-    //  Return the requested signal list to the caller.
-    //
-    return signalList;
-}
+    offset_t* denseIndex = toAddress ( indexOffset );
 
+    __atomic_store_n ( &denseIndex[signal], toOffset ( signalList ),
+                       __ATOMIC_RELEASE );
+}
 
-/*!-----------------------------------------------------------------------
-
-    s m _ i n s e r t
 
-    @brief Insert a new signal into the signal list.
+/*!----------------------------------------------------------------------------
 
-    This function will find the appropriate signal list for the given signal
-    and domain and insert the caller's data into the message list.  New
-    messages are inserted at the end of the list so the oldest messages are at
-    the beginning of the list.
+    l i s t L o c k I n i t
 
-    The "signal" is an arbitrary integer that uniquely identifies the message
-    type within the domain of the message.  Domains are an identifier that
-    specifies a class of messages.  For instance, CAN messages can all be
-    considered to be messages in the CAN domain.  Within that domain, the
-    message ID field uniquely identifies the type of message.
+    @brief Initialize the lock of a new signal list.
 
-    The "body" pointer supplied by the caller must point to the beginning of
-    the data that makes up the message we want to store.  The message size
-    specifies the number of bytes that will be read from the user's pointer
-    and copied into the shared memory segment.
+    The lock is shared between processes and is robust so that if the
+    process holding it dies, the next process to lock it is told so and can
+    repair the list (see listLock).
 
-    @param[in] domain - The domain associated with this message.
-    @param[in] signal - The signal value associated with this message.
-    @param[in] newMessageSize - The size of the new message in bytes.
-    @param[in] body - The address of the body of the new message.
+    @param[in] signalList - The address of the new signal list.
 
     @return 0 if successful
             Otherwise the error code
 
-------------------------------------------------------------------------*/
-int sm_insert ( domain_t domain, signal_t signal, unsigned long newMessageSize,
-                void* body )
+-----------------------------------------------------------------------------*/
+static int listLockInit ( signal_list* signalList )
 {
-    int status = 0;
+    pthread_mutexattr_t attributes;
+    int                 status;
 
-    //
-    //  Display the input parameters for the call if debug is enabled.
-    //
-    LOG ( "\nCalled sm_insert with:\n" );
-    LOG ( "  Domain Id: %u\n",    domain );
-    LOG ( "  Signal Id: %u\n",    signal );
-    LOG ( "       Name: [%s]\n",  "" );
-    LOG ( "   Data Len: %lu\n",   newMessageSize );
-    if ( newMessageSize == sizeof(unsigned long) )
+    status = pthread_mutexattr_init ( &attributes );
+    if ( status == 0 )
     {
-        LOG ( "       Data: %lu\n", *(unsigned long*)body );
+        status = pthread_mutexattr_setpshared ( &attributes,
+                                                PTHREAD_PROCESS_SHARED );
     }
-    else
+    if ( status == 0 )
     {
-        LOG ( "       Data: %s\n", (char*)body );
+        status = pthread_mutexattr_setrobust ( &attributes,
+                                               PTHREAD_MUTEX_ROBUST );
     }
-    // LOG ( "Inserting domain[%d] signal[%d]\n", domain, signal );
+    if ( status == 0 )
+    {
+        status = pthread_mutex_init ( &signalList->listLock, &attributes );
+    }
+    pthread_mutexattr_destroy ( &attributes );
 
-    HX_DUMP ( body, newMessageSize, "New Message" );
+    return status;
+}
 
-    //
-    //  Go find the signal list control block for this domain and signal.  Note
-    //  that if the signal list does not exist yet, a new one will be created
-    //  and initialized.
-    //
-    signal_list* signalList = findSignalList ( domain, signal );
 
-    //
-    //  Now we need to create a new entry for this message list so compute the
-    //  size that we will need and allocate that much memory in the shared
-    //  memory segment.
-    //
-    int signalDataSize = newMessageSize + SIGNAL_DATA_HEADER_SIZE;
-    signal_data* signalData = sm_malloc ( signalDataSize );
-    if ( signalData == NULL )
+/*!----------------------------------------------------------------------------
+
+    l i s t L o c k
+
+    @brief Acquire the lock of a signal list.
+
+    If the previous owner of the lock died while holding it, it may have
+    died between linking a new signal to the end of the list and updating
+    the tail offset (or between removing the last signal and emptying the
+    tail) so the tail offset is recomputed by walking the list from it's
+    head before the lock is marked as consistent again.
+
+    @param[in] signalList - The address of the signal list to lock.
+
+-----------------------------------------------------------------------------*/
+static void listLock ( signal_list* signalList )
+{
+    int status = pthread_mutex_lock ( &signalList->listLock );
+
+    if ( status == EOWNERDEAD )
     {
-        printf ( "Error: Unable to allocate a new signal list - "
-                 "Shared memory segment is full!\n" );
-        return ENOMEM;
-    }
-    //
-    //  Acquire the lock on this signal list.
-    //
-    //  Note that this call will hang if someone else is currently using this
-    //  signal list.  It will return once the lock is acquired and it is safe
-    //  to manipulate the signal list.
-    //
-    // SL_LOCK ( signalList );
+        printf ( "Warning: Repairing signal list %d-%d after it's lock owner "
+                 "died\n", signalList->domainId, signalList->signalId );
+
+        offset_t tail = signalList->head;
+
+        while ( tail != END_OF_LIST_MARKER )
+        {
+            offset_t next = ((signal_data*)toAddress ( tail ))->
+                            nextMessageOffset;
+            if ( next == END_OF_LIST_MARKER )
+            {
+                break;
+            }
+            tail = next;
+        }
+        signalList->tail = tail;
+
+        pthread_mutex_consistent ( &signalList->listLock );
+    }
+    else if ( status != 0 )
+    {
+        printf ( "Error: Unable to acquire the signal list lock: %d-%d - "
+                 "%d[%s]\n", signalList->domainId, signalList->signalId,
+                 status, strerror(status) );
+    }
+}
+
+
+//
+//  Release the lock of a signal list.
+//
+static inline void listUnlock ( signal_list* signalList )
+{
+    pthread_mutex_unlock ( &signalList->listLock );
+}
+
+
+/*!----------------------------------------------------------------------------
+
+    n e w S i g n a l L i s t
+
+    @brief Create a new signal list for a domain and signal value.
+
+    This function will allocate a new signal list control block in the shared
+    memory segment and initialize it as an empty signal list.  The new signal
+    list is not entered into any of the indices.  That is left to the caller.
+
+    @param[in] - domain - The domain of the new signal list
+    @param[in] - signal - The id of the new signal list
+
+    @return If successful, the address of the new signal list control block
+            If no memory is availabe for a new list, a NULL
+
+-----------------------------------------------------------------------------*/
+static signal_list* newSignalList ( domain_t domain, signal_t signal )
+{
+    signal_list* signalList;
 
     //
-    //  Initialize all of the fields in the message header of the new message
-    //  that we are inserting.  We will be inserting this new message at the
-    //  end of the message list which is where the "tail" pointer is pointing.
-    //
-    //  If the message list is currently empty (because the head pointer is
-    //  NULL), make the head pointer point to our new message.
+    //  Go allocate a new signal list control block in the shared memory
+    //  segment.
     //
-    offset_t newMessageOffset = toOffset ( signalData );
-    if ( signalList->head == END_OF_LIST_MARKER )
+    signalList = sm_malloc ( SIGNAL_LIST_SIZE );
+
+    //
+    //  If the allocation failed, we have exceeded the amount of memory in
+    //  the shared memory segment.  This is a fatal condition so let the
+    //  user know and quit!
+    //
+    if ( signalList == NULL )
     {
-        signalList->head = newMessageOffset;
+        printf ( "Error: Unable to allocate a new signal list - "
+                 "Shared memory segment is full!\n" );
+        return NULL;
     }
     //
-    //  If the tail pointer is not NULL, make the current tail message point
-    //  to our new message.
+    //  Initialize and populate the new signal list control block.
     //
-    if ( signalList->tail != END_OF_LIST_MARKER )
+    signalList->domainId           = domain;
+    signalList->signalId           = signal;
+    signalList->privateId          = 0;
+    signalList->name               = 0;
+    signalList->currentSignalCount = 0;
+    signalList->totalSignalSize    = 0;
+    signalList->head               = END_OF_LIST_MARKER;
+    signalList->tail               = END_OF_LIST_MARKER;
+
+    if ( listLockInit ( signalList ) != 0 )
     {
-        ((signal_data*)toAddress(signalList->tail))->nextMessageOffset =
-            newMessageOffset;
+        printf ( "Error: Unable to initialize the signal list lock\n" );
+        sm_free ( signalList );
+        return NULL;
     }
     //
-    //  Now make the tail pointer point to our new message.
+    //  New signal lists always start out in the linked list storage mode.
+    //  The ring storage mode can be selected later with sm_create_ring.
     //
-    signalList->tail = newMessageOffset;
+    signalList->ringCapacity       = 0;
+    signalList->ringSlotSize       = 0;
+    signalList->ringSlotStride     = 0;
+    signalList->ring               = END_OF_LIST_MARKER;
+    signalList->ringHead           = 0;
+    signalList->ringTail           = 0;
 
     //
-    //  Make the "next" pointer in our new message indicate the "end" of the
-    //  list.
+    //  Mark the latest value cache as empty.
     //
-    signalData->nextMessageOffset = END_OF_LIST_MARKER;
+    signalList->latestSequence     = 0;
+    signalList->latestSize         = 0;
 
     //
-    //  Copy the message body into the message list.
-    //
-    //  TODO: Validate that the message size is "reasonable"!
+    //  Start the sample sequence numbers of the signal at 1.
     //
-    signalData->messageSize = newMessageSize;
-    memcpy ( (void*)(&signalData->data), body, newMessageSize );
+    signalList->sampleSequence     = 0;
 
     //
-    //  Increment the signal count and total message data size.
+    //  New signal lists use the retention policy of their domain.
     //
-    ++signalList->currentSignalCount;
-    signalList->totalSignalSize += newMessageSize;
+    signalList->retention.maxCount = 0;
+    signalList->retention.maxBytes = 0;
+    signalList->retention.maxAge   = 0;
 
     //
-    //  Post to the semaphore to reflect the message we just inserted into the
-    //  message list.
-    //
-    //  Note that doing this post may result in a different process and/or
-    //  thread running before the call comes back here.
+    //  No consumer cursors have been opened on the new signal list yet.
     //
-    LOG ( "Before semaphore post with sem: %p[%lu]\n",
-          &signalList->semaphore, toOffset ( &signalList->semaphore ) );
+    signalList->cursors            = END_OF_LIST_MARKER;
 
-    SEM_DUMP ( &signalList->semaphore );
-
-    ++signalList->semaphore.messageCount;
+    //
+    //  No one is watching the new signal list yet.
+    //
+    signalList->notifyMask         = 0;
 
-    semaphorePost ( &signalList->semaphore );
+    //
+    //  The new signal list is not a member of any groups yet.
+    //
+    signalList->groups             = END_OF_LIST_MARKER;
 
-    LOG ( "After semaphore post:\n" );
-    SEM_DUMP ( &signalList->semaphore );
+    //
+    //  Initialize the semaphore counters and futex word for this signal
+    //  list control block.
+    //
+    signalList->semaphore.messageCount = 0;
+    signalList->semaphore.waiterCount  = 0;
+    signalList->semaphore.futex        = 0;
+    signalList->semaphore.sleeperCount = 0;
 
     //
-    //  Give up the signal list lock.
+    //  If debugging is enabled, to dump the semaphore we just created.
     //
-    // SL_UNLOCK ( signalList );
+    SEM_DUMP ( &signalList->semaphore );
 
     //
-    //  Return the status indicator to the caller.
+    //  Return the new signal list to the caller.
     //
-    return status;
+    return signalList;
 }
 
 
-/*!-----------------------------------------------------------------------
+/*!----------------------------------------------------------------------------
 
-    s m _ r e m o v e S i g n a l
+    f i n d S i g n a l L i s t
 
-    @brief Remove the oldest signal from the signal list.
+    @brief Find the the signal list for a domain and signal value.
 
-    This function will remove the signal at the beginning of the specified
-    signal list.  This will be the oldest message in the list.
+    This function will search the signals btree for a match to the domain and
+    id value supplied.  If a match is found, the address of the signal list
+    control block will be returned to the caller.  If no match is found, a new
+    signal list control block will be created and inserted into the btree
+    database.  In either case, the signal list control address will be
+    returned to the caller.
 
-    @param[in] signalList - The address of the signal list to operate on.
+    Signals with small domain and signal IDs are looked up in the dense
+    signal index first so the btree is only searched for sparse IDs and for
+    signals that have not been entered into the dense index yet.
 
-    @return 0 - Message successfully removed.
+    The caller is responsible for populating the privateId and name for this
+    signal if it is a new one and updating the appropriate indices for those
+    fields.
 
-------------------------------------------------------------------------*/
-int sm_removeSignal ( signal_list* signalList )
-{
-    signal_data* signalData;
+    @param[in] - domain - The domain of the signal list to find
+    @param[in] - signal - The id of the signal list to find
 
-    LOG ( "Removing signal with %d-%d\n", signalList->domainId, signalList->signalId );
+    @return If successful, the address of the signal list control block
+            If no memory is availabe for a new list, a NULL
+
+-----------------------------------------------------------------------------*/
+signal_list* findSignalList ( domain_t domain, signal_t signal )
+{
+    signal_list  requestedSignal;
+    signal_list* signalList;
 
     //
-    //  If this signal list is empty, just return without doing anything.
+    //  If this signal is in the dense signal index, we're done.
     //
-    if ( signalList->head == END_OF_LIST_MARKER )
+    signalList = denseSignalLookup ( domain, signal );
+    if ( signalList != NULL )
     {
-        return 0;
+        return signalList;
     }
     //
-    //  Grab the first signal on the given signalList control block.
+    //  Initialize the fields we will need to find the requested signal list.
     //
-    signalData = toAddress ( signalList->head );
+    requestedSignal.domainId = domain;
+    requestedSignal.signalId = signal;
 
     //
-    //  If there is only one message in the current list then the head and
-    //  tail offsets will be the same and we should just set both of them to
-    //  the "empty" list state.
+    //  Go find the requested signal list.
     //
-    if ( signalList->currentSignalCount == 1 )
-    {
-        signalList->head = END_OF_LIST_MARKER;
-        signalList->tail = END_OF_LIST_MARKER;
-    }
+    signalList = btree_search ( &vsiContext->signalIdIndex, &requestedSignal );
+
     //
-    //  Otherwise, just make the head offset be the offset of the next signal
-    //  after the one we are removing.
+    //  If we found it in the btree, make sure it's in the dense signal index
+    //  so we find it there next time.
     //
-    else
+    if ( signalList != NULL )
     {
-        signalList->head = signalData->nextMessageOffset;
+        denseSignalStore ( signalList );
     }
-    //
-    //  Decrement the count of the number of signals in this list and the
-    //  total amount of space occupied by those signals.
-    //
-    --signalList->currentSignalCount;
-    signalList->totalSignalSize -= signalData->messageSize;
 
     //
-    //  Free up the shared memory occupied by this signal data structure.
+    //  If we didn't find this signal list control block then this is the
+    //  first time this domain/id have been seen so we need to create a new
+    //  signal list control block for it.
     //
-    sm_free ( signalData );
+    if ( signalList == NULL )
+    {
+        LOG ( "Creating a new signal list for %d,%d\n", domain, signal );
 
+        //
+        //  Go allocate and initialize a new signal list control block in the
+        //  shared memory segment.
+        //
+        signalList = newSignalList ( domain, signal );
+        if ( signalList == NULL )
+        {
+            return 0;
+        }
+        //
+        //  Insert the new signal list control block into the btree.
+        //
+        btree_insert ( &vsiContext->signalIdIndex, signalList );
+
+        //
+        //  Enter the new signal list into the dense signal index as well.
+        //
+        denseSignalStore ( signalList );
+    }
     //
-    //  Return a good completion code to the caller.
+    //  Return the requested signal list to the caller.
     //
-    return 0;
+    return signalList;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    s m _ f e t c h
+    S i g n a l   R i n g   F u n c t i o n s
+    =========================================
 
-    @brief Retrieve a signal from the signal buffer.
+    The following functions implement the ring buffer storage mode of the
+    signal lists.  The ring is a bounded multi-producer/multi-consumer queue
+    in which each slot carries a sequence number that tells producers and
+    consumers whether the slot is free or published for a given ring
+    position.  The head and tail positions are claimed with a compare and
+    swap so none of these functions ever take a lock.
 
-    This function will attempt to retrieve the oldest signal with the
-    specified signal and domain from the shared memory signal buffer.  The
-    signal that was found (and returned to the caller) will be removed from
-    the signal list.  If there are no signal that matches the user's request,
-    this function will hang (on a semaphore) until an appropriate signal is
-    available before returning to the caller if requested.
 
-    If the signal list is not empty, the head of the list will be returned to
-    the caller.  This is also the oldest signal in the list since the signals
-    are added at the end of the list.
+    r i n g S l o t
 
-    The size of the data buffer that was found will be returned to the caller
-    along with a pointer to the location of the data.  It is the
-    responsibility of the caller to copy the data out of the shared memory
-    segment if he needs it to persist.
+    @brief Return the address of the ring slot for a ring position.
 
-    Note that since this function does not alter the structure of the signal
-    list we don't need to lock the signal list semaphore during the processing
-    (except when we wait on an empty list).  We do lock the list of signal
-    instance records attached to the signalList however as we will be
-    modifying that list.
+------------------------------------------------------------------------*/
+static inline signal_ring_slot* ringSlot ( signal_list*  signalList,
+                                           unsigned long position )
+{
+    return toAddress ( signalList->ring + signalList->ringSlotStride *
+                       ( position & ( signalList->ringCapacity - 1 ) ) );
+}
 
-    @param[in]  domain - The domain value of the signal to be removed.
-    @param[in]  signal - The signal ID value of the signal to be removed.
-    @param[out] bodySize - The address of where to store the data size.
-    @param[out] body - The address of where to store the data pointer.
-    @param[in]  wait - If true, wait for data if domain/signal is not found.
 
-    @return 0 if successful.
-            ENODATA - If waitForData == false and domain/signal is not found.
-            any other value is an errno value.
+/*!-----------------------------------------------------------------------
 
-    TODO: Can we combine this function with sm_fetch_newest?
-------------------------------------------------------------------------*/
-int sm_fetch ( domain_t domain, signal_t signal, unsigned long* bodySize,
-               void** body, bool wait )
-{
-    signal_data* signalData = NULL;
-    int          status     = 0;
+    r i n g R e l e a s e
 
-    LOG ( "Fetching signal domain[%d], signal[%d], bodySize[%p], "
-          "body[%p], wait[%d]\n", domain, signal, bodySize, body, wait );
-    //
-    //  Go find the signal list control block for this domain and signal.
-    //
-    signal_list* signalList = findSignalList ( domain, signal );
+    @brief Give a ring slot that has just been claimed back to the producers.
 
+    The caller must have advanced the head of the ring past the position of
+    the slot.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] slot - The address of the slot that was claimed.
+    @param[in] position - The ring position the slot was claimed for.
+
+------------------------------------------------------------------------*/
+static void ringRelease ( signal_list*      signalList,
+                          signal_ring_slot* slot,
+                          unsigned long     position )
+{
     //
-    //  If we didn't find this signal list control block then we need to just
-    //  return an error code to the caller.  This should only happen if we run
-    //  out of memory.
-    //
-    //  If this signal list was found but it is empty and we don't want to
-    //  wait for the data to arrive then just return the "no data" error code
-    //  to the caller and quit.
-    //
-    if ( !signalList || ( ( signalList->currentSignalCount == 0 ) && !wait ) )
-    {
-        LOG ( "Warning: Signal list for domain %d, signal %d was not found "
-              "or empty.\n", domain, signal );
-        return ENODATA;
-    }
+    //  Update the informational counters for this signal list.
     //
-    //  Go wait if there are no signals in the signal list to be read.
+    __atomic_sub_fetch ( &signalList->currentSignalCount, 1, __ATOMIC_RELAXED );
+    __atomic_sub_fetch ( &signalList->totalSignalSize, slot->messageSize,
+                         __ATOMIC_RELAXED );
     //
-    //  Note that we will increment the "waiter" count during the time that we
-    //  are potentially waiting on the semaphore and decrement it again when
-    //  we come back from the wait.  This is used to tell the "fetch" logic
-    //  when it is OK to delete the signal that is being waited on.  If more
-    //  than one process is waiting on this signal then we want to give the
-    //  signal to all of the processes that are waiting before we delete the
-    //  signal from the signal list.
+    //  Give the slot back to the producers for their next lap of the ring.
     //
-    // SL_LOCK ( signalList );
+    __atomic_store_n ( &slot->sequence, position + signalList->ringCapacity,
+                       __ATOMIC_RELEASE );
+}
 
-    ++signalList->semaphore.waiterCount;
 
-    LOG ( "Before Fetch/semaphore wait sem: %p[%lu]\n",
-          &signalList->semaphore, toOffset ( &signalList->semaphore ) );
+/*!-----------------------------------------------------------------------
 
-    SEM_DUMP ( &signalList->semaphore );
+    s m _ r i n g _ r e m o v e
 
-    semaphoreWait ( &signalList->semaphore );
+    @brief Remove the oldest signal from a signal ring.
 
-    --signalList->semaphore.messageCount;
+    This function will claim the oldest published slot in the ring and then
+    release it to the producers.  The address of the slot is returned to the
+    caller so that the data can be returned to the user.  The data in the
+    slot remains intact until the producers have wrapped all the way around
+    the ring and claimed this slot again.
 
-    --signalList->semaphore.waiterCount;
+    @param[in] signalList - The address of the signal list to operate on.
 
-    LOG ( "After Fetch/semaphore wait:\n" );
-    SEM_DUMP ( &signalList->semaphore );
+    @return The address of the slot that was removed
+            NULL if the ring is empty
 
-    //
-    //  When we come back from the wait above, there should be some signal
-    //  data to read.  If there is no data, report an error condition.
-    //
-    if ( signalList->head == END_OF_LIST_MARKER )
-    {
-        printf ( "Error: sm_fetch was released from wait but no data present." );
-        return ENODATA;
-    }
-    //
-    //  Get the actual memory pointer to the current signal.
-    //
-    signalData = toAddress ( signalList->head );
+------------------------------------------------------------------------*/
+static signal_ring_slot* sm_ring_remove ( signal_list* signalList )
+{
+    signal_ring_slot* slot;
+    unsigned long     sequence;
+    long              difference;
 
     //
-    //  Return the size of the data block and the pointer to that block to the
-    //  caller.
+    //  Get the position of the oldest signal in the ring.
     //
-    *bodySize = signalData->messageSize;
-    // TODO: *body = (void*)&signalData->data[0];
-    *body = signalData->data;
-
+    unsigned long position = __atomic_load_n ( &signalList->ringHead,
+                                               __ATOMIC_RELAXED );
     //
-    //  If no one else is now waiting for this signal, go remove this signal
-    //  from the signal list.
+    //  Repeat until we have claimed the slot at the head of the ring or
+    //  discovered that the ring is empty.
     //
-    if ( signalList->semaphore.waiterCount <= 0 )
+    while ( true )
     {
-        status = sm_removeSignal ( signalList );
+        slot       = ringSlot ( signalList, position );
+        sequence   = __atomic_load_n ( &slot->sequence, __ATOMIC_ACQUIRE );
+        difference = (long)( sequence - ( position + 1 ) );
+
+        //
+        //  If the slot has been published for this position, try to advance
+        //  the head past it.  If someone else got there first, the compare
+        //  and swap will reload the current head position for us.
+        //
+        if ( difference == 0 )
+        {
+            if ( __atomic_compare_exchange_n ( &signalList->ringHead, &position,
+                                               position + 1, true,
+                                               __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        //
+        //  If the slot has not been published yet, the ring is empty.
+        //
+        else if ( difference < 0 )
+        {
+            return NULL;
+        }
+        //
+        //  Otherwise another consumer has already taken this position so go
+        //  look at the new head of the ring.
+        //
+        else
+        {
+            position = __atomic_load_n ( &signalList->ringHead,
+                                         __ATOMIC_RELAXED );
+        }
     }
-    LOG ( "At the end of Fetch - waiterCount: %d\n", signalList->semaphore.waiterCount );
+    ringRelease ( signalList, slot, position );
 
-    SEM_DUMP ( &signalList->semaphore );
-
-    //
-    //  Unlock the condition variable for this signal.
-    //
-    // SL_UNLOCK ( signalList );
-
-    //
-    //  Return the completion code to the caller.
-    //
-    return status;
-}
+    return slot;
+}
 
 
 /*!-----------------------------------------------------------------------
 
-    s m _ f e t c h _ n e w e s t
-
-    @brief Retrieve the newest signal from the signal list.
-
-    This function will attempt to retrieve the newest signal with the
-    specified signal and domain from the shared memory signal list.  The
-    signal that is found (and returned to the caller) will NOT be removed from
-    the signal list.  If there are no signals that match the user's request,
-    this function will hang (on a semaphore) until an appropriate signal is
-    available before returning to the caller depending on the setting of the
-    "wait" input parameter.
+    s m _ r i n g _ r e m o v e _ i f
 
-    When calling this function, the bodySize should be the size of the data
-    buffer supplied as the "body" argument.  When we copy the data from the
-    shared memory segment to the "body" buffer, the smaller of either the body
-    buffer size or the number of bytes of data in the signal found will be
-    copied into the body buffer.  The actual number of data bytes copied will
-    be returned to the caller in the bodySize variable.
+    @brief Remove the oldest signal from a ring if it is at a given position.
 
-    Note that since this function does not alter the structure of the signal
-    list we don't need to lock the signal list semaphore during the processing
-    (except when we wait on an empty list).
+    This is used by consumers that have already read the oldest signal and
+    only want to remove it if no one else has removed it in the meantime.
+    The head of the ring is only advanced if it is still at the position
+    that was read.
 
-    @param[in]  domain - The domain value of the signal to be removed.
-    @param[in]  signal - The signal value of the signal to be removed.
-    @param[out] bodySize - The address of where to store the body size.
-    @param[out] body - The address of where to put the address of the signal data.
-    @param[in]  wait - If true, wait for data if domain/signal is not found.
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] position - The ring position that the caller read.
 
-    @return 0 if successful.
-            ENODATA - If waitForData == true and domain/signal is not found.
-            any other value is an errno value.
+    @return true if the signal at that position was removed by this call
+            false if it had already been removed by someone else
 
 ------------------------------------------------------------------------*/
-int sm_fetch_newest ( domain_t domain, signal_t signal, unsigned long* bodySize,
-                      void** body, bool wait )
+static bool sm_ring_remove_if ( signal_list* signalList,
+                                unsigned long position )
 {
-    //
-    //  Define the local signal offset and pointer variables.
-    //
-    signal_list* signalList = NULL;
-    signal_data* signalData = NULL;
-    int          status     = 0;
-
-    LOG ( "Fetching newest signal domain[%d], signal[%d], wait[%d]\n", domain,
-          signal, wait );
-    //
-    //  Go find the signal list control block for this domain and signal.
-    //
-    signalList = findSignalList ( domain, signal );
+    signal_ring_slot* slot = ringSlot ( signalList, position );
 
-    //
-    //  If this signal list is empty and we don't want to wait for the data to
-    //  arrive then just return the "no data" error code to the caller and
-    //  quit.
-    //
-    if ( !signalList || ( signalList->currentSignalCount == 0 && !wait ) )
+    if ( __atomic_load_n ( &slot->sequence, __ATOMIC_ACQUIRE ) != position + 1 )
     {
-        LOG ( "Signal list is empty - Returning error code 61 - ENODATA\n" );
-        return ENODATA;
+        return false;
     }
-    //
-    //  Go wait if there are no messages in the signal list to be read.
-    //
-    //  Note that we will increment the "waiter" count during the time that we
-    //  are potentially waiting on the semaphore and decrement it again when
-    //  we come back from the wait.  This is used to tell the "fetch" logic
-    //  when it is OK to delete the signal that is being waited on.  If more
-    //  than one process is waiting on this signal then we want to give the
-    //  signal to all of the processes that are waiting before we delete the
-    //  signal from the signal list.
-    //
-    // SL_LOCK ( signalList );
-
-    ++signalList->semaphore.waiterCount;
-
-    LOG ( "Before Fetch/semaphore wait sem: %p[%lu]\n",
-          &signalList->semaphore, toOffset ( &signalList->semaphore ) );
-
-    SEM_DUMP ( &signalList->semaphore );
-
-    semaphoreWait ( &signalList->semaphore );
+    if ( ! __atomic_compare_exchange_n ( &signalList->ringHead, &position,
+                                         position + 1, false, __ATOMIC_RELAXED,
+                                         __ATOMIC_RELAXED ) )
+    {
+        return false;
+    }
+    ringRelease ( signalList, slot, position );
 
-    --signalList->semaphore.waiterCount;
+    return true;
+}
 
-    LOG ( "After Fetch/semaphore wait:\n" );
-    SEM_DUMP ( &signalList->semaphore );
 
-    //
-    //  If we get here, there is at least one signal in this signal list.  At
-    //  that point, we can take a look at the last signal in the list.
-    //
-    //  TODO: Check to make sure the tail is not END.
-    //
-    signalData = toAddress ( signalList->tail );
+/*!-----------------------------------------------------------------------
 
-    //
-    //  Return the size of the message data and the pointer to that data to
-    //  the caller.
-    //
-    *bodySize = signalData->messageSize;
-    *body     = signalData->data;
+    s m _ r i n g _ c h e c k
 
-    //
-    //  Return to the caller with a good completion code.
-    //
-    LOG ( "At the end of Fetch - waiterCount: %d\n", signalList->semaphore.waiterCount );
+    @brief Check that a new signal will fit into the slots of a signal ring.
 
-    SEM_DUMP ( &signalList->semaphore );
+    This is the only reason that inserting into a ring can fail so it is
+    checked before the new signal is stamped.  That way a signal that can't
+    be stored never uses up a sequence number of the signal list.
 
-    //
-    //  Unlock the condition variable for this signal list.
-    //
-    // SL_UNLOCK ( signalList );
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] newMessageSize - The size of the new message in bytes.
 
-    //
-    //  Return the completion code to the caller.
-    //
-    LOG ( "Returning error code %d\n", status );
+    @return 0 if the signal fits
+            EMSGSIZE - The message is larger than the ring slots
 
-    return status;
+------------------------------------------------------------------------*/
+static int sm_ring_check ( signal_list*  signalList,
+                           unsigned long newMessageSize )
+{
+    if ( newMessageSize > signalList->ringSlotSize )
+    {
+        printf ( "Error: Signal %d,%d data size %lu exceeds the ring slot "
+                 "size of %lu\n", signalList->domainId, signalList->signalId,
+                 newMessageSize, signalList->ringSlotSize );
+        return EMSGSIZE;
+    }
+    return 0;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    s m _ f l u s h _ s i g n a l
+    s m _ r i n g _ i n s e r t
 
-    @brief Flush all specified signals from the data store.
+    @brief Insert a new signal into a signal ring.
 
-    This function will find all signals in the data store with the specified
-    domain and signal value and remove them from the data store.
+    This function will claim the next available slot in the ring, copy the
+    caller's data into it and then publish it to the consumers.  If the ring
+    is full, the oldest signal in the ring will be discarded to make room for
+    the new signal.
 
-    @param[in]  domain - The domain value of the message to be removed.
-    @param[in]  signal - The signal value of the message to be removed.
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] newMessageSize - The size of the new message in bytes.
+    @param[in] body - The address of the body of the new message.
+    @param[in] stamp - The capture time and sequence of the new message.
 
-    @return 0 if successful.
-            any other value is an errno value.
+    @return 0 if successful
+            EMSGSIZE - The message is larger than the ring slots
 
 ------------------------------------------------------------------------*/
-int sm_flush_signal ( domain_t domain, signal_t signal )
+static int sm_ring_insert ( signal_list*        signalList,
+                            unsigned long       newMessageSize,
+                            void*               body,
+                            const signal_stamp* stamp )
 {
-    //
-    //  Define the local signal offset and pointer variables.
-    //
-    signal_data* signalData;
-    offset_t     signalDataOffset;
-    int          status = 0;
-
-    LOG ( "Flushing signal domain[%d], signal[%d]\n", domain, signal );
+    signal_ring_slot* slot;
+    unsigned long     sequence;
+    long              difference;
 
     //
-    //  Go find the signal list control block for this domain and signal.
-    //
-    signal_list* signalList = findSignalList ( domain, signal );
-
+    //  If this message will not fit into a ring slot, complain and quit.
     //
-    //  If this signal list doesn't exist or is empty then we don't need to do
-    //  anything.  In this case, just return a good completion code.
-    //
-    if ( signalList == NULL || signalList->currentSignalCount == 0 )
+    int status = sm_ring_check ( signalList, newMessageSize );
+    if ( status != 0 )
     {
-        return 0;
+        return status;
     }
     //
-    //  Acquire the lock on this signal list.
-    //
-    //  Note that this call will hang if someone else is currently using this
-    //  signal list.  It will return once the lock is acquired and it is safe
-    //  to manipulate the signal list.
-    //
-    // SL_LOCK ( signalList );
-
-    //
-    //  Get the head of the signal list.
+    //  Get the position that the next signal should be stored in.
     //
-    signalDataOffset = signalList->head;
-
+    unsigned long position = __atomic_load_n ( &signalList->ringTail,
+                                               __ATOMIC_RELAXED );
     //
-    //  Repeat until we reach the end of the signal list in this bucket.
+    //  Repeat until we have claimed a free slot.
     //
-    while ( signalDataOffset != END_OF_LIST_MARKER )
+    while ( true )
     {
-        //
-        //  Get the actual memory pointer to the current signal data.
-        //
-        signalData =  toAddress ( signalDataOffset );
+        slot       = ringSlot ( signalList, position );
+        sequence   = __atomic_load_n ( &slot->sequence, __ATOMIC_ACQUIRE );
+        difference = (long)( sequence - position );
 
         //
-        //  Save the offset of the next signal before we destroy the current
-        //  signal.
+        //  If the slot is free for this position, try to advance the tail
+        //  past it.  If another producer got there first, the compare and
+        //  swap will reload the current tail position for us.
         //
-        signalDataOffset = signalData->nextMessageOffset;
-
+        if ( difference == 0 )
+        {
+            if ( __atomic_compare_exchange_n ( &signalList->ringTail, &position,
+                                               position + 1, true,
+                                               __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
         //
-        //  Go free the memory occupied by this signal record.
+        //  If the slot still holds a signal from the previous lap, the ring
+        //  is full so discard the oldest signal and try again.
         //
-        sm_free ( signalData );
-
+        else if ( difference < 0 )
+        {
+            if ( sm_ring_remove ( signalList ) != NULL )
+            {
+                __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                                     __ATOMIC_RELAXED );
+            }
+            position = __atomic_load_n ( &signalList->ringTail,
+                                         __ATOMIC_RELAXED );
+        }
         //
-        //  Increment our signal offsets to the next signal in the list.
+        //  Otherwise another producer has already taken this position so go
+        //  look at the new tail of the ring.
         //
-        signalData = toAddress ( signalDataOffset );
+        else
+        {
+            position = __atomic_load_n ( &signalList->ringTail,
+                                         __ATOMIC_RELAXED );
+        }
     }
     //
-    //  When we get here, we've removed all of the signal data records from
-    //  this signal list so set everything in the signal list to it's "empty"
-    //  state.
+    //  Copy the message body into the slot we claimed and then publish it to
+    //  the consumers.
     //
-    signalList->head               = END_OF_LIST_MARKER;
-    signalList->tail               = END_OF_LIST_MARKER;
-    signalList->currentSignalCount = 0;
-    signalList->totalSignalSize    = 0;
+    slot->messageSize = newMessageSize;
+    slot->stamp       = *stamp;
+    memcpy ( slot->data, body, newMessageSize );
 
-    //
-    //  If anyone is waiting for this signal, go release them to search the
-    //  signal list again.
-    //
-    //  Note that this call may not return immediately if executing the post
-    //  resulted in another thread/process running.
-    //
-    signalList->semaphore.messageCount = 0;
-    semaphorePost ( &signalList->semaphore );
+    __atomic_add_fetch ( &signalList->currentSignalCount, 1, __ATOMIC_RELAXED );
+    __atomic_add_fetch ( &signalList->totalSignalSize, newMessageSize,
+                         __ATOMIC_RELAXED );
 
-    //
-    //  Give up the signal list lock.
-    //
-    // SL_UNLOCK ( signalList );
+    __atomic_store_n ( &slot->sequence, position + 1, __ATOMIC_RELEASE );
 
-    //
-    //  Return the completion code to the caller.
-    //
-    return status;
+    return 0;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    V S I   S i g n a l   G r o u p   F u n c t i o n s
-    ===================================================
+    s m _ r i n g _ p e e k
 
-    g r o u p E x i s t s
+    @brief Return the oldest or newest signal in a ring without removing it.
 
-    This is a helper function that determines if the specified group currently
-    exists in the group btree.  This function is only used by the internal VSI
-    API functions.
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] newest - If true, return the newest signal, else the oldest.
+
+    @return The address of the slot found
+            NULL if the ring is empty
 
 ------------------------------------------------------------------------*/
-static bool groupExists ( const group_t groupId )
+static signal_ring_slot* sm_ring_peek ( signal_list* signalList, bool newest )
 {
-    vsi_signal_group  requestedSignalGroup = { 0 };
-    vsi_signal_group* signalGroup;
-
-    CHECK_AND_RETURN_IF_ERROR ( groupId );
-
-    requestedSignalGroup.groupId = groupId;
+    signal_ring_slot* slot;
 
-    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedSignalGroup );
-
-    if ( signalGroup != NULL )
+    unsigned long head = __atomic_load_n ( &signalList->ringHead,
+                                           __ATOMIC_ACQUIRE );
+    unsigned long tail = __atomic_load_n ( &signalList->ringTail,
+                                           __ATOMIC_ACQUIRE );
+    //
+    //  Scan from the requested end of the ring towards the other end until
+    //  we find a slot that has been published.  Slots at the ends of the ring
+    //  may still be in the process of being written by a producer.
+    //
+    while ( head != tail )
     {
-        return true;
+        unsigned long position = newest ? tail - 1 : head;
+
+        slot = ringSlot ( signalList, position );
+        if ( __atomic_load_n ( &slot->sequence, __ATOMIC_ACQUIRE ) ==
+             position + 1 )
+        {
+            return slot;
+        }
+        if ( newest )
+        {
+            --tail;
+        }
+        else
+        {
+            ++head;
+        }
     }
-    return false;
+    return NULL;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ c r e a t e _ s i g n a l _ g r o u p
+    s m _ r i n g _ r e a d
 
-    @brief Create a new signal group.
+    @brief Read the stamp and data of a ring slot without removing it.
+
+    The slot for the given ring position is read without taking any locks.
+    The sequence number of the slot is checked before and after the copy
+    so that a slot that is consumed or overwritten while we are reading it
+    is never returned as valid data.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] position - The ring position to be read.
+    @param[out] stamp - The address of where to store the slot's stamp.
+    @param[in/out] result - The result to copy the slot data into (may be
+                            NULL if only the stamp is wanted).
+
+    @return 0 if the slot was read
+            < 0 if the position has not been published yet
+            > 0 if the position has already been consumed or overwritten
 
 ------------------------------------------------------------------------*/
-int vsi_create_signal_group ( const group_t groupId )
+static int sm_ring_read ( signal_list*  signalList,
+                          unsigned long position,
+                          signal_stamp* stamp,
+                          vsi_result*   result )
 {
-    int status = 0;
+    signal_ring_slot* slot = ringSlot ( signalList, position );
+    unsigned long     size = 0;
 
-    LOG ( "Creating group %d\n", groupId );
-
-    CHECK_AND_RETURN_IF_ERROR ( groupId );
+    unsigned long sequence = __atomic_load_n ( &slot->sequence,
+                                               __ATOMIC_ACQUIRE );
+    long difference = (long)( sequence - ( position + 1 ) );
 
-    if ( groupExists ( groupId ) )
+    if ( difference != 0 )
     {
-        LOG ( "Error: group[%d] already exists\n", groupId );
-        return EINVAL;
+        return difference < 0 ? -1 : 1;
     }
-    vsi_signal_group* signalGroup = sm_malloc ( sizeof(vsi_signal_group) );
+    *stamp = slot->stamp;
 
-    if ( signalGroup == NULL )
+    //
+    //  Copy the smaller of the slot data or the user's buffer.  The message
+    //  size is also limited to the slot size in case a producer is changing
+    //  it while we look at it.
+    //
+    if ( result != NULL )
     {
-        printf ( "ERROR: Unable to allocate shared memory for group\n" );
-        return ENOMEM;
+        size = slot->messageSize;
+
+        if ( size > signalList->ringSlotSize )
+        {
+            size = signalList->ringSlotSize;
+        }
+        if ( size > result->dataLength )
+        {
+            size = result->dataLength;
+        }
+        memcpy ( result->data, slot->data, size );
     }
     //
-    //  Initialize the rest of the fields in the signal group data structure.
+    //  Make sure the copy is complete before we look at the sequence again.
+    //  If it changed, the slot was recycled while we were reading it.
     //
-    signalGroup->groupId = groupId;
-    signalGroup->count   = 0;
-    signalGroup->head    = 0;
-    signalGroup->tail    = 0;
+    __atomic_thread_fence ( __ATOMIC_ACQUIRE );
 
-	//
-	//  Initialize the group record mutex.
-	//
-	status = pthread_mutex_init ( &signalGroup->mutex,
-								  &smControl->masterMutexAttributes );
-	if ( status != 0 )
-	{
-		printf ( "Unable to initialize the group mutex - errno: %u[%m].\n",
-				 status );
-		sm_free ( signalGroup );
-		return status;
-	}
+    if ( __atomic_load_n ( &slot->sequence, __ATOMIC_RELAXED ) != sequence )
+    {
+        return 1;
+    }
+    if ( result != NULL )
+    {
+        result->dataLength = size;
+    }
+    return 0;
+}
 
-    LOG ( "  inserting into btree\n" );
 
-    status = btree_insert ( &vsiContext->groupIdIndex, signalGroup );
+/*!-----------------------------------------------------------------------
 
-    LOG ( "  returning %d\n", status );
+    s m _ r i n g _ f e t c h
 
-    return status;
-}
-
-
-/*!-----------------------------------------------------------------------
+    @brief Copy the oldest or newest signal in a ring into a user buffer.
 
-    v s i _ d e l e t e _ s i g n a l _ g r o u p
+    The slot is copied with sm_ring_read so a slot that is recycled by the
+    producers while we are copying it is never returned.  If the oldest
+    signal is being consumed, it is only removed from the ring if no one
+    else removed it while we were copying it, otherwise we go copy the new
+    oldest signal.
 
-    @brief Delete an existing signal group.
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] newest - If true, copy the newest signal, else the oldest.
+    @param[in] consume - If true, remove the oldest signal from the ring.
+    @param[in/out] bodySize - The size of the buffer on input and the number
+                              of bytes copied into it on output.
+    @param[out] body - The address of the buffer to copy the data into.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
 
-    Delete a signal group.  This function will delete the specified signal
-    group and release any shared memory occupied by it's members.  If there
-    are any signal lists associated with the group, they will not be deleted.
+    @return 0 if successful
+            ENODATA - The ring is empty
 
 ------------------------------------------------------------------------*/
-int vsi_delete_signal_group ( const group_t groupId )
+static int sm_ring_fetch ( signal_list*   signalList,
+                           bool           newest,
+                           bool           consume,
+                           unsigned long* bodySize,
+                           void*          body,
+                           signal_stamp*  stamp )
 {
-    int status = 0;
-
-    CHECK_AND_RETURN_IF_ERROR ( groupId );
-
-    //
-    //  Get the group object that the user specified.
-    //
-    vsi_signal_group  requestedGroup = { 0 };
-    vsi_signal_group* signalGroup;
-
-    requestedGroup.groupId = groupId;
-
-    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedGroup );
-
-    //
-    //  If the specified group does not exist, return an error code to the
-    //  caller.
-    //
-    if ( signalGroup == NULL )
-    {
-        return EINVAL;
-    }
-    //
-    //  Get the offset of the beginning of the signal list.
-    //
-    offset_t groupDataOffset = signalGroup->head;
-
-    //
-    //  While we have not reached the end of the signal list for this group...
-    //
-	vsi_signal_group_data* groupData;
-#ifdef VSI_DEBUG
-	signal_list*           signalList;
-#endif
+    signal_stamp slotStamp;
+    vsi_result   copy;
+    int          status;
 
-    while ( groupDataOffset != END_OF_LIST_MARKER )
+    while ( true )
     {
-        //
-        //  Get an actual pointer to this group data record.
-        //
-        groupData = toAddress ( groupDataOffset );
+        unsigned long head = __atomic_load_n ( &signalList->ringHead,
+                                               __ATOMIC_ACQUIRE );
+        unsigned long tail = __atomic_load_n ( &signalList->ringTail,
+                                               __ATOMIC_ACQUIRE );
+        unsigned long position = head;
 
-        //
-        //  Now get the address of the signal list structure.
-        //
-
-#ifdef VSI_DEBUG
+        copy.data       = body;
+        copy.dataLength = *bodySize;
 
-        signalList = toAddress ( groupData->signalList );
         //
-        //  Go print the contents of the current signal structure.
+        //  The newest slots of the ring may still be in the process of being
+        //  written by a producer so look for the newest one that has been
+        //  published.
         //
-        LOG ( "%s      Removing... Domain: %d, Signal: %d, Name: %s\n", "",
-              signalList->domainId, signalList->signalId,
-              (char*)toAddress ( signalList->name ) );
-#endif
+        status = -1;
+        if ( newest )
+        {
+            while ( tail != head && status < 0 )
+            {
+                position = --tail;
+                status   = sm_ring_read ( signalList, position, &slotStamp,
+                                          &copy );
+            }
+        }
+        else if ( head != tail )
+        {
+            status = sm_ring_read ( signalList, position, &slotStamp, &copy );
+        }
+        if ( status < 0 )
+        {
+            return ENODATA;
+        }
         //
-        //  Get the next signal definition object in the list for this group.
+        //  If the slot was recycled while we were copying it or someone else
+        //  removed it before we could, go try again.
         //
-        groupDataOffset = groupData->nextMessageOffset;
+        if ( status > 0 || ( consume &&
+                             ! sm_ring_remove_if ( signalList, position ) ) )
+        {
+            continue;
+        }
+        *bodySize = copy.dataLength;
 
-        //
-        //  Go give this signal structure back to the system.
-        //
-        sm_free ( groupData );
+        if ( stamp != NULL )
+        {
+            *stamp = slotStamp;
+        }
+        return 0;
     }
-    //
-    //  Go remove this signal group object from the group definition btree.
-    //
-    status = btree_delete ( &vsiContext->groupIdIndex, signalGroup );
-
-    //
-    //  Give the signal group object back to the memory manager.
-    //
-    sm_free ( signalGroup );
-
-    //
-    //  Return the completion status back to the caller.
-    //
-    return status;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ f e t c h _ s i g n a l _ g r o u p
+    s m _ r i n g _ f i n d _ t i m e
 
-    @brief Find and return an existing signal group.
+    @brief Find the first ring position at or after a capture time.
 
-    Fetch a signal group definition structure.  This function will find and
-    return the specified signal group structure.
+    The slots of a ring are stored in insertion order which is also the
+    capture time order of the signals so a binary search over the ring
+    positions finds the oldest signal whose timestamp is not less than the
+    specified time.  Positions that have already been consumed are treated
+    as being older than any time and positions that have not been published
+    yet as being newer.
 
-------------------------------------------------------------------------*/
-vsi_signal_group* vsi_fetch_signal_group ( const group_t groupId )
-{
-    LOG ( "vsi_fetch_signal_group called with group: %u\n", groupId );
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] head - The oldest ring position to be searched.
+    @param[in] tail - The position after the newest one to be searched.
+    @param[in] timestamp - The capture time to search for.
 
-    //
-    //  Get the group object that the user specified.
-    //
-    vsi_signal_group  requestedGroup = { 0 };
-    vsi_signal_group* signalGroup;
+    @return The ring position found (tail if all signals are older)
 
-    requestedGroup.groupId = groupId;
+------------------------------------------------------------------------*/
+static unsigned long sm_ring_find_time ( signal_list*  signalList,
+                                         unsigned long head,
+                                         unsigned long tail,
+                                         unsigned long timestamp )
+{
+    signal_stamp stamp;
 
-    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedGroup );
+    while ( head != tail )
+    {
+        unsigned long middle = head + ( tail - head ) / 2;
 
-    LOG ( "  vsi_fetch_signal_group returning signal group: %p\n", signalGroup );
+        int status = sm_ring_read ( signalList, middle, &stamp, NULL );
 
-    if ( signalGroup )
-    {
-        printSignalGroup ( "   ", signalGroup );
-    }
-    else
-    {
-        LOG ( "Warning: groupId[%u] was NOT found! (in vsi_fetch_signal_group)\n",
-              groupId );
+        if ( status > 0 || ( status == 0 && stamp.timestamp < timestamp ) )
+        {
+            head = middle + 1;
+        }
+        else
+        {
+            tail = middle;
+        }
     }
-    //
-    //  Return the address of the signal group structure.  Note that this will
-    //  return a NULL pointer if the group could not be found.
-    //
-    return signalGroup;
+    return head;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ a d d _ s i g n a l _ t o _ g r o u p
+    s m _ c r e a t e _ r i n g
 
-    @brief Add a new signal to the specified group.
+    @brief Convert an empty signal list to the ring buffer storage mode.
 
-    This function will add a new signal to the specified group.  New signals
-    will be added to the tail end of the group's signal list.
+    This function will allocate the ring slots for the specified signal list
+    and initialize them.  The capacity will be rounded up to a power of 2 so
+    that ring positions can be converted to slot indices with a simple mask.
+
+    The list lock is held while the list is checked for signals and the ring
+    is installed.  Appends take the same lock and check for a ring under it
+    (see sm_append_signal) so no signal can be linked into the list while it
+    is being converted.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] capacity - The number of signals the ring can hold.
+    @param[in] maxDataSize - The largest signal data size to be stored.
+
+    @return 0 if successful
+            EINVAL - The capacity or data size is not valid
+            EBUSY - The signal list already contains signals
+            ENOMEM - The ring could not be allocated
 
 ------------------------------------------------------------------------*/
-int vsi_add_signal_to_group ( const domain_t domainId,
-                              const signal_t signalId,
-                              const group_t  groupId )
+int sm_create_ring ( signal_list* signalList, unsigned long capacity,
+                     unsigned long maxDataSize )
 {
-    vsi_signal_group*      signalGroup = 0;
-    vsi_signal_group_data* groupData   = 0;
+    unsigned long ringCapacity = 1;
+    unsigned long slotStride;
+    unsigned long ringSize;
+    unsigned long i;
 
-    LOG ( "vsi_add_signal_to_group called with: %d,%d group %d\n", domainId,
-          signalId, groupId );
     //
-    //  Go find the group record for this groupId.
+    //  Make sure all of the required input arguments are supplied.
     //
-    signalGroup = vsi_fetch_signal_group ( groupId );
+    CHECK_AND_RETURN_IF_ERROR ( signalList );
 
-    //
-    //  If the group record was not found, return an error code to the caller
-    //  and quit.
-    //
-    if ( signalGroup == NULL )
+    if ( capacity == 0 || capacity > SIGNAL_RING_MAX_CAPACITY ||
+         maxDataSize == 0 || maxDataSize > UINT_MAX )
     {
-        return ENOENT;
+        return EINVAL;
     }
     //
-    //  Go find the signal list for this domain/signal.
-    //
-    signal_list* signalList = findSignalList ( domainId, signalId );
-
-    //
-    //  If the could not be found or created, return an error code to the
-    //  caller.
+    //  If this signal list is already a ring, there is nothing to do.
     //
-    if ( signalList == NULL )
+    if ( __atomic_load_n ( &signalList->ringCapacity, __ATOMIC_ACQUIRE ) != 0 )
     {
-        return ENOMEM;
+        return 0;
     }
-	//
-    //	Make sure that the new signal data is not already in the signal list.
-	//
-    offset_t     groupDataOffset = signalGroup->head;
-    signal_list* existingSignal  = 0;
-
     //
-    //  While we have not reached the end of the signal list...
+    //  Round the capacity up to the next power of 2.
     //
-    while ( groupDataOffset != END_OF_LIST_MARKER )
+    while ( ringCapacity < capacity )
     {
-        //
-        //  Get an actual pointer to this signal in this list.
-        //
-        groupData = toAddress ( groupDataOffset );
-
-        //
-        //  Now get the address of the signal list structure.
-        //
-        existingSignal = toAddress ( groupData->signalList );
-
-        //
-        //  If this signal list is for the same domain and signal as the one
-        //  we are trying to add, then we have run into a duplicate signal.
-        //  In this case, just output an error message and return an error
-        //  code to the caller.
-        //
-        if ( existingSignal->domainId == domainId &&
-             existingSignal->signalId == signalId )
-        {
-            printf ( "WARNING: Attempting to add domain[%d], signal[%d] to "
-                     "group[%d] which already exists - Ignored\n",
-                     domainId, signalId, groupId );
-            return EINVAL;
-        }
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
+        ringCapacity <<= 1;
     }
     //
-    //  Go get the memory for a new signal group data record.
+    //  Compute the size of each slot with the data area rounded up to keep
+    //  all of the slot headers 8 byte aligned and the size of the whole ring.
+    //  A ring that is too large to be addressed is not valid.
     //
-    groupData = sm_malloc ( sizeof(vsi_signal_group_data) );
+    slotStride = SIGNAL_RING_SLOT_HEADER_SIZE + ( ( maxDataSize + 7 ) & ~7UL );
 
+    if ( __builtin_mul_overflow ( ringCapacity, slotStride, &ringSize ) )
+    {
+        return EINVAL;
+    }
     //
-    //  If the memory allocation failed, issue an error message and return an
-    //  error code.
+    //  Go allocate all of the slots in one block.
     //
-    if ( groupData == NULL )
+    char* ring = sm_malloc ( ringSize );
+    if ( ring == NULL )
     {
-        printf ( "Error: Unable to allocate shared memory for a new signal "
-                 "group data record\n" );
+        printf ( "Error: Unable to allocate a signal ring of %lu bytes - "
+                 "Shared memory segment is full!\n", ringSize );
         return ENOMEM;
     }
     //
-    //  Fill in the fields of the new signal group data structure.
-    //
-    groupData->nextMessageOffset = END_OF_LIST_MARKER;
-    groupData->signalList        = toOffset ( signalList );
-
-    //
-    //  Get the offset of the new signal group data structure.
-    //
-    offset_t newGroupDataOffset = toOffset ( groupData );
-
-    //
-    //  If this signal group is not empty, make the current tail record
-    //  point to this new signal group data record.  We will insert this new
-    //  record at the end of the list.
+    //  Initialize each slot to be free for it's position in the first lap of
+    //  the ring.
     //
-    if ( signalGroup->count != 0 )
+    for ( i = 0; i < ringCapacity; ++i )
     {
-        ((signal_data*)toAddress(signalGroup->tail))->nextMessageOffset =
-            newGroupDataOffset;
+        signal_ring_slot* slot = (signal_ring_slot*)( ring + i * slotStride );
+
+        slot->sequence    = i;
+        slot->messageSize = 0;
     }
     //
-    //  If the signal group is currently empty, make the head pointer point to
-    //  our new signal group data record.
+    //  The storage mode can only be changed while the list is empty and
+    //  nobody else has converted it meanwhile.  Both are checked under the
+    //  list lock so that no signal can be appended until the ring is in
+    //  place.
     //
-    else
+    listLock ( signalList );
+
+    if ( signalList->ringCapacity != 0 ||
+         signalList->head != END_OF_LIST_MARKER ||
+         signalList->currentSignalCount != 0 )
     {
-        signalGroup->head = newGroupDataOffset;
+        int status = signalList->ringCapacity != 0 ? 0 : EBUSY;
+
+        listUnlock ( signalList );
+        sm_free ( ring );
+
+        return status;
     }
     //
-    //  Now make the tail pointer point to our new message.
+    //  Populate the ring fields of the signal list.  The capacity is stored
+    //  last since a non-zero capacity is what selects the ring storage mode.
     //
-    signalGroup->tail = newGroupDataOffset;
+    signalList->ringSlotSize   = maxDataSize;
+    signalList->ringSlotStride = slotStride;
+    signalList->ring           = toOffset ( ring );
+    signalList->ringHead       = 0;
+    signalList->ringTail       = 0;
 
-    //
-    //  Increment the signal count for this group.
-    //
-    signalGroup->count++;
+    __atomic_store_n ( &signalList->ringCapacity, ringCapacity,
+                       __ATOMIC_RELEASE );
+
+    listUnlock ( signalList );
 
-    //
-    //  Return a good completion code to the caller.
-    //
-    printSignalGroup ( "", signalGroup );
     return 0;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ a d d _ s i g n a l _ t o _ g r o u p _ b y _ n a m e
-
-    @brief Add a new signal to the specified group by name.
-
-    This function will add a new signal to the specified group.
-
-------------------------------------------------------------------------*/
-int vsi_add_signal_to_group_by_name ( const domain_t domainId,
-                                      const char*    name,
-                                      const group_t  groupId )
-{
-    signal_t signalId;
-
-    vsi_name_string_to_id ( domainId, name, &signalId );
-
-    return vsi_add_signal_to_group ( domainId, signalId, groupId );
-}
+    s m _ s t o r e _ l a t e s t
 
+    @brief Store a new signal in the latest value cache of a signal list.
 
-/*!-----------------------------------------------------------------------
+    This function will acquire the write side of the sequence lock on the
+    latest value cache by making the sequence odd, copy the signal data into
+    the cache and then release the sequence lock by making the sequence even
+    again.  Concurrent producers serialize on the sequence itself so no
+    mutex is required.
 
-    v s i _ r e m o v e _ s i g n a l _ f r o m _ g r o u p
+    If the signal data is too large to fit in the cache, the cache is marked
+    as "uncached" so that readers know to get the data from the signal list.
 
-    @brief Remove a signal from the specified group.
+    If another writer holds the cache for longer than the spin limit, it is
+    assumed to have died while holding it and the cache is disabled.  If that
+    writer was only delayed, it will see that the cache was disabled when it
+    tries to release it.
 
-    This function will add a new signal to the specified group.
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] newMessageSize - The size of the new message in bytes.
+    @param[in] body - The address of the body of the new message.
+    @param[in] stamp - The capture time and sequence of the new message.
 
-    TODO: This removal is awkward.  We need to search for the item we want and
-    then call the remove function which will perform another search for the
-    same item - Because we don't know what the "pointer" values is!  We need a
-    better way to do this that is still fairly generic.
+    @return None
 
 ------------------------------------------------------------------------*/
-int vsi_remove_signal_from_group ( const domain_t domainId,
-                                   const signal_t signalId,
-                                   const group_t  groupId )
+static void sm_store_latest ( signal_list*        signalList,
+                              unsigned long       newMessageSize,
+                              void*               body,
+                              const signal_stamp* stamp )
 {
-    vsi_signal_group*      signalGroup;
-    vsi_signal_group_data* groupData;
-    vsi_signal_group_data* trailingPtr;
-    signal_list*           signalList;
+    unsigned long sequence = __atomic_load_n ( &signalList->latestSequence,
+                                               __ATOMIC_RELAXED );
+    unsigned long spins = 0;
 
     //
-    //  Go find the group record for this groupId.
+    //  Wait until no other writer is updating the cache and then claim the
+    //  cache by making the sequence odd.  If the writer that holds the cache
+    //  never releases it, disable the cache.
     //
-    signalGroup = vsi_fetch_signal_group ( groupId );
-
+    while ( ( sequence & 1 ) ||
+            ! __atomic_compare_exchange_n ( &signalList->latestSequence,
+                                            &sequence, sequence + 1, true,
+                                            __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED ) )
+    {
+        if ( sequence == SIGNAL_LATEST_DISABLED )
+        {
+            return;
+        }
+        if ( ( sequence & 1 ) && ++spins >= SIGNAL_LATEST_SPIN_LIMIT )
+        {
+            __atomic_compare_exchange_n ( &signalList->latestSequence,
+                                          &sequence, SIGNAL_LATEST_DISABLED,
+                                          false, __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED );
+            return;
+        }
+        sequence = __atomic_load_n ( &signalList->latestSequence,
+                                     __ATOMIC_RELAXED );
+    }
     //
-    //  If the group record was not found, return an error code to the caller
-    //  and quit.
+    //  Copy the new signal into the cache if it fits.
     //
-    if ( signalGroup == NULL )
+    signalList->latestStamp = *stamp;
+
+    if ( newMessageSize <= SIGNAL_LATEST_VALUE_SIZE )
     {
-        return ENOENT;
+        memcpy ( signalList->latestValue, body, newMessageSize );
+        signalList->latestSize = newMessageSize;
+    }
+    else
+    {
+        signalList->latestSize = SIGNAL_LATEST_UNCACHED;
     }
     //
-    //  While we have not reached the last signal in the group list...
+    //  Release the cache by making the sequence even again unless the cache
+    //  was disabled while we held it.
     //
-    offset_t groupDataOffset = signalGroup->head;
+    unsigned long held = sequence + 1;
+
+    __atomic_compare_exchange_n ( &signalList->latestSequence, &held,
+                                  sequence + 2, false, __ATOMIC_RELEASE,
+                                  __ATOMIC_RELAXED );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ l o a d _ l a t e s t
+
+    @brief Copy the latest value cache of a signal list into a user buffer.
+
+    This function is the read side of the latest value sequence lock.  The
+    cache is copied into the caller's buffer and the copy is retried if a
+    writer updated the cache while we were copying it.  No locks are taken
+    and the data returned is never a mixture of two different signals.
+
+    If a writer holds the cache for longer than the spin limit or the cache
+    has been disabled, EAGAIN is returned so that the caller will get the
+    data from the signal list instead.
 
-    trailingPtr = 0;
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in/out] bodySize - The size of the buffer on input and the number
+                              of bytes copied into it on output.
+    @param[out] body - The address of the buffer to copy the data into.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
+    @param[out] loaded - The address of where to store the cache sequence
+                         the data was copied at (may be NULL).
+
+    @return 0 if successful
+            ENODATA - No signal has been cached yet
+            EAGAIN - The latest signal is not available from the cache
+
+------------------------------------------------------------------------*/
+static int sm_load_latest ( signal_list*   signalList,
+                            unsigned long* bodySize,
+                            void*          body,
+                            signal_stamp*  stamp,
+                            unsigned long* loaded )
+{
+    unsigned long sequence;
+    unsigned long size;
+    unsigned long spins = 0;
+    signal_stamp  latestStamp;
 
-    while ( groupDataOffset != END_OF_LIST_MARKER )
+    do
     {
+        if ( spins++ >= SIGNAL_LATEST_SPIN_LIMIT )
+        {
+            return EAGAIN;
+        }
         //
-        //  Get a pointer to the signal group data structure.
+        //  Wait for any writer currently updating the cache to finish.
         //
-        groupData = toAddress ( groupDataOffset );
-
-        //
-        //  Get the pointer to the signal list in the group data structure.
-        //
-        signalList = toAddress ( groupData->signalList );
-
+        sequence = __atomic_load_n ( &signalList->latestSequence,
+                                     __ATOMIC_ACQUIRE );
+        if ( sequence == SIGNAL_LATEST_DISABLED )
+        {
+            return EAGAIN;
+        }
+        if ( sequence & 1 )
+        {
+            continue;
+        }
+        if ( sequence == 0 )
+        {
+            return ENODATA;
+        }
+        size = __atomic_load_n ( &signalList->latestSize, __ATOMIC_RELAXED );
+        if ( size == SIGNAL_LATEST_UNCACHED )
+        {
+            return EAGAIN;
+        }
         //
-        //  If this is the signal that we are looking for...
+        //  Copy the smaller of the cached data or the user's buffer.
         //
-        if ( signalList->domainId == domainId &&
-             signalList->signalId == signalId )
+        if ( size > *bodySize )
         {
-            //
-            //  If we are at the beginning of the list then just fix the
-            //  signal group head pointer to point to the next structure.
-            //  Note that if this is the only structure in the list then the
-            //  head pointer will be set to END_OF_LIST_MARKER which is what
-            //  we want.
-            //
-            if ( trailingPtr == 0 )
-            {
-                signalGroup->head = groupData->nextMessageOffset;
-            }
-            else
-            {
-                trailingPtr->nextMessageOffset = groupData->nextMessageOffset;
-            }
-            //
-            //  If the structure we want to delete is the last structure in
-            //  the group list then reset the group head offset to be the
-            //  trailing pointer offset value.
-            //
-            if ( groupData->nextMessageOffset == END_OF_LIST_MARKER )
-            {
-                if ( trailingPtr == 0 )
-                {
-                    signalGroup->tail = END_OF_LIST_MARKER;
-                }
-                else
-                {
-                    signalGroup->tail = toOffset ( trailingPtr );
-                }
-            }
-            //
-            //  Go return the structure we found to the shared memory free
-            //  list.
-            //
-            sm_free ( groupData );
+            size = *bodySize;
+        }
+        memcpy ( body, signalList->latestValue, size );
 
-            //
-            //  Decrement the number of records in this signal group.
-            //
-            signalGroup->count--;
+        latestStamp = signalList->latestStamp;
 
-            //
-            //  Return a good completion code to the caller.
-            //
-            return 0;
-        }
         //
-        //  If this record is not the one we are looking for, save the current
-        //  position as the "trailing pointer" and advance to the next record
-        //  in the list.
+        //  Make sure the copy is complete before we look at the sequence
+        //  again.
         //
-        trailingPtr = groupData;
-        groupDataOffset = groupData->nextMessageOffset;
+        __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+
+    }   while ( ( sequence & 1 ) ||
+                __atomic_load_n ( &signalList->latestSequence,
+                                  __ATOMIC_RELAXED ) != sequence );
+
+    *bodySize = size;
+
+    if ( stamp != NULL )
+    {
+        *stamp = latestStamp;
     }
-    //
-    //  If we get here, the specified domain/signal were not found in any of
-    //  the signal structures associated with this group.  In this case,
-    //  return a "not found" error to the caller.
-    //
-    return ENOENT;
+    if ( loaded != NULL )
+    {
+        *loaded = sequence;
+    }
+    return 0;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ r e m o v e _ s i g n a l _ f r o m _ g r o u p _ b y _ n a m e
+    n o t i f i e r A d d r e s s
 
-    @brief Remove a signal from the specified group by name.
+    @brief Build the socket address of a notifier.
 
-    This function will add a new signal to the specified group.
+    Each notifier is a datagram socket bound to a name in the Linux abstract
+    socket namespace so there is nothing to clean up in the file system if
+    it's owner dies.  The generation of the notifier is part of the name.
+
+    @param[in] - index - The index of the notifier
+    @param[in] - generation - The generation of the notifier
+    @param[out] - address - The address of the socket address to fill in
+
+    @return The length of the socket address
 
 ------------------------------------------------------------------------*/
-int vsi_remove_signal_from_group_by_name ( const domain_t domainId,
-                                           const char*    name,
-                                           const group_t  groupId )
+static socklen_t notifierAddress ( int                 index,
+                                   unsigned long       generation,
+                                   struct sockaddr_un* address )
 {
-    signal_t signalId;
+    memset ( address, 0, sizeof(*address) );
+    address->sun_family = AF_UNIX;
 
-    vsi_name_string_to_id ( domainId, name, &signalId );
+    int length = snprintf ( &address->sun_path[1],
+                            sizeof(address->sun_path) - 1,
+                            "vsi-notify-%d-%lu", index, generation );
 
-    return vsi_remove_signal_from_group ( domainId, signalId, groupId );
+    return offsetof ( struct sockaddr_un, sun_path ) + 1 + length;
 }
 
 
-/*!-----------------------------------------------------------------------
-
-    V S I   S i g n a l   P r o c e s s i n g
-    =========================================
-
-    TODO: Note that the code in all of the functions below that operate on
-    everything in a group is similar.  It would be a good idea to abstract
-    these operations and use a callback function to specify the specific
-    operation to be performed by a generic iterator.
+//
+//  Define the socket this process uses to send notifications.  It is
+//  created the first time it is needed.
+//
+static int            notifySocket = -1;
+static pthread_once_t notifyOnce   = PTHREAD_ONCE_INIT;
 
+static void notifySocketCreate ( void )
+{
+    notifySocket = socket ( AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                            0 );
+    if ( notifySocket < 0 )
+    {
+        printf ( "Error: Unable to create the notification socket - "
+                 "errno: %u[%m].\n", errno );
+    }
+}
 
-    v s i _ g e t _ n e w e s t _ i n _ g r o u p
 
-    @brief Get the newest signal available for all signals in a group.
+/*!-----------------------------------------------------------------------
 
-    This function will fetch the newest (the one with the most recent
-    timestamp) signal available for each member signal in the specified group.
+    s m _ n o t i f y
 
-    Note that the result pointer in this case MUST be a pointer to an array of
-    result structures sufficiently large to contain one structure for each
-    member of the group.  The newest signal information for each member of the
-    group will be returned in one of the result structures.  Each result
-    structure will also contain the completion code for the signal fetch
-    operation that it represents so it is entirely possible for some signals
-    to have good completion codes and some to have errors (if a signal does
-    not have any data for instance).
+    @brief Notify all of the notifiers watching a signal list.
 
-    All of the results are retrieved in the "no wait" mode so any signals that
-    do not contain any data will have an error code returned for them
-    indicating that there was no data available for that signal.
+    A one byte datagram is sent to every notifier in the signal list's
+    notification mask.  If the notifier already has as many notifications
+    queued as it can hold, the send fails and the new notification is simply
+    dropped since the notifier is already readable.  Any other failure (such
+    as the owner of the notifier having died) is ignored as well.
 
-    Also note that none of the signal information will be removed from the
-    database during this operation.  Fetches of the "newest" signal data do
-    not automatically delete that information from the database.
+    @param[in] - signalList - The signal list that was just inserted into
 
 ------------------------------------------------------------------------*/
-int vsi_get_newest_in_group ( const group_t groupId,
-                              vsi_result*   results )
+static inline void sm_notify ( signal_list* signalList )
 {
-    int                    resultIndex = 0;
-    vsi_signal_group*      signalGroup = 0;
-    vsi_signal_group_data* groupData = 0;
-    signal_list*           signalList = 0;
-
-    printf ( "vsi_get_newest_in_group called with group: %d\n", groupId );
-
-    //
-    //  Make sure the inputs are all present.
-    //
-    CHECK_AND_RETURN_IF_ERROR ( groupId && results );
-
-    //
-    //  Go get the signal group structure for the specified group id.
-    //
-    signalGroup = vsi_fetch_signal_group ( groupId );
-
+    struct sockaddr_un address;
+    unsigned long      mask = __atomic_load_n ( &signalList->notifyMask,
+                                                __ATOMIC_ACQUIRE );
     //
-    //  If the group id specified does not exist, return an error code to the
-    //  caller.
+    //  If no one is watching this signal, we're done.
     //
-    if ( signalGroup == NULL )
+    if ( mask == 0 )
     {
-        return ENOENT;
+        return;
     }
-    //
-    //  While we have not reached the end of the signal list...
-    //
-    offset_t groupDataOffset = signalGroup->head;
+    (void)pthread_once ( &notifyOnce, notifySocketCreate );
 
-    while ( groupDataOffset != END_OF_LIST_MARKER )
+    while ( mask != 0 )
     {
-        //
-        //  Get a pointer to the signal group data structure.
-        //
-        groupData = toAddress ( groupDataOffset );
-
-        //
-        //  Get the pointer to the signal list in the group data structure.
-        //
-        signalList = toAddress ( groupData->signalList );
+        int index = __builtin_ctzl ( mask );
+        mask &= mask - 1;
 
-		//
-		//  Populate the current result structure with the signal
-		//  identification information.
-		//
-		results[resultIndex].domainId = signalList->domainId;
-		results[resultIndex].signalId = signalList->signalId;
+        unsigned long generation =
+            __atomic_load_n ( &vsiContext->notifiers[index].generation,
+                              __ATOMIC_ACQUIRE );
 
-        //
-        //  Go get the newest entry in the database for this signal.
-        //
-        //  Note that the return information will be populated in the result
-        //  object that is passed in.
-        //
-        vsi_get_newest_signal ( &results[resultIndex++] );
+        socklen_t length = notifierAddress ( index, generation, &address );
 
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
+        (void)sendto ( notifySocket, "", 1, MSG_DONTWAIT | MSG_NOSIGNAL,
+                       (struct sockaddr*)&address, length );
     }
-    //
-    //  Return a good completion code to the caller.
-    //
-    return 0;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ g e t _ n e w e s t _ i n _ g r o u p _ w a i t
+    g r o u p N o t i f i e r M a s k
 
-    @brief Retrieve the newest signal for every member of the specified group.
+    @brief Get the notification mask of all notifiers watching a group.
 
-    TODO: WARNING: Unimplemented!
+    Only notifiers that have been completely opened are included.  A notifier
+    that is still being opened will set it's own bit in all of the group
+    members once it is ready.
 
-    The newest member of each signal in the specified group will be retrieved
-    and stored in the result array.  If any of the signals in the group do not
-    contain any members, execution will be suspended for the current thread
-    until some data is received for that member.  When execution resumes, the
-    next signal will be fetched and so forth until all of the signals have
-    been retrieved.  At that point this function will return to the caller.
+    @param[in] - groupId - The group ID
 
-    The groupId is the numeric group ID previously assigned to the group being
-    operated on.
+    @return The mask of all of the notifiers watching this group
 
-    In the case of this group fetch function, the result pointer is not a
-    pointer to a single vsi_result structure instance, it is a pointer to an
-    array of vsi_result structure instances.  The number of data structures
-    must be at least as large as the number of signals defined in the
-    specified group.  Failure to allocate enough space for the return data
-    will result in memory corruption and undefined behavior (almost always
-    very bad!).
+------------------------------------------------------------------------*/
+static unsigned long groupNotifierMask ( group_t groupId )
+{
+    unsigned long mask = 0;
 
-    The signal data that is retrieved and returned to the caller will NOT be
-    removed from the VSI core database once it is copied into the result
-    structures.
+    for ( int i = 0; i < VSI_NOTIFIER_COUNT; ++i )
+    {
+        vsi_notifier* notifier = &vsiContext->notifiers[i];
 
-    @param[in] - groupId - The ID value of the group to be modified.
-    @param[in/out] - result - The array of structures that will hold the data.
+        if ( __atomic_load_n ( &notifier->processId, __ATOMIC_ACQUIRE ) > 0 &&
+             notifier->isGroup && notifier->groupId == groupId )
+        {
+            mask |= 1UL << i;
+        }
+    }
+    return mask;
+}
 
-    @return - status - The return status of the function
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s t a m p _ s i g n a l
+
+    @brief Build the stamp for a new signal in a signal list.
+
+    The next sequence number of the signal list is assigned to the signal
+    and if the caller did not supply a capture time, the current time is
+    used.
+
+    @param[in] signalList - The signal list the signal will be inserted into.
+    @param[in] timestamp - The capture time of the signal or 0 for now.
+    @param[out] stamp - The address of where to store the new stamp.
 
 ------------------------------------------------------------------------*/
-int vsi_get_newest_in_group_wait ( const group_t groupId,
-                                   vsi_result*   result )
+static void sm_stamp_signal ( signal_list*  signalList,
+                              unsigned long timestamp,
+                              signal_stamp* stamp )
 {
-    printf ( "Warning: Unimplemented function \"vsi_get_newest_in_group_wait\" "
-             "called - Call ignored!\n" );
+    struct timespec timeSpec;
 
-    return ENOSYS;
+    if ( timestamp == 0 )
+    {
+        clock_gettime ( CLOCK_MONOTONIC, &timeSpec );
+
+        timestamp = timeSpec.tv_sec * 1000000000UL + timeSpec.tv_nsec;
+    }
+    stamp->timestamp = timestamp;
+    stamp->sequence  = __atomic_add_fetch ( &signalList->sampleSequence, 1,
+                                            __ATOMIC_RELAXED );
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ g e t _ o l d e s t _ i n _ g r o u p
+    s m _ a p p e n d _ s i g n a l
 
-    @brief Get the oldest signal available for all signals in a group.
+    @brief Append a new signal to the end of a signal list.
 
-    This function will fetch the oldest (the one with the least recent
-    timestamp) signal available for each member signal in the specified group.
+    The signal data record must already have been allocated by the caller.
+    The message is copied into it, it is stamped, linked to the end of the
+    signal list and the signal list counters are updated but the semaphore
+    is not posted.
 
-    Note that the result pointer in this case MUST be a pointer to an array of
-    result structures sufficiently large to contain one structure for each
-    member of the group.  The oldest signal information for each member of the
-    group will be returned in one of the result structures.  Each result
-    structure will also contain the completion code for the signal fetch
-    operation that it represents so it is entirely possible for some signals
-    to have good completion codes and some to have errors (if a signal does
-    not have any data for instance).
+    The signal is stamped and linked while holding the signal list lock so
+    that the sequence numbers of the signals in the list are always in list
+    order and so that the link can't race with the removal of the oldest
+    signal (see sm_removeSignalIf).
 
-    All of the results are retrieved in the "no wait" mode so any signals that
-    do not contain any data will have an error code returned for them
-    indicating that there was no data available for that signal.
+    If the signal list was switched to the ring storage mode after the
+    caller decided to append to it, nothing is done and the caller still
+    owns the signal data record.
 
-    Also note that the signal information retrieved will be removed from the
-    database during this operation.  Fetches of the "oldest" signal data
-    automatically delete that information from the database.
+    @param[in] signalList - The signal list to append to.
+    @param[in] signalData - The new signal data record.
+    @param[in] newMessageSize - The size of the new message in bytes.
+    @param[in] body - The address of the body of the new message.
+    @param[in] timestamp - The capture time of the message or 0 for now.
+    @param[out] stamp - The address of where to store the new stamp.
+
+    @return true if the signal was appended
+            false if the signal list is now a ring
 
 ------------------------------------------------------------------------*/
-int vsi_get_oldest_in_group ( const group_t groupId,
-                              vsi_result*   results )
+static bool sm_append_signal ( signal_list*  signalList,
+                               signal_data*  signalData,
+                               unsigned long newMessageSize,
+                               void*         body,
+                               unsigned long timestamp,
+                               signal_stamp* stamp )
 {
-    int                    resultIndex = 0;
-    vsi_signal_group*      signalGroup = 0;
-    vsi_signal_group_data* groupData = 0;
-    signal_list*           signalList = 0;
-    vsi_result*            result = 0;
+    //
+    //  Initialize all of the fields in the message header of the new message
+    //  that we are inserting.  We will be inserting this new message at the
+    //  end of the message list which is where the "tail" pointer is pointing.
+    //
+    //  The whole message is filled in before it is linked into the list
+    //  since removers and history readers may look at it as soon as it is
+    //  linked.  The "next" pointer in our new message indicates the "end" of
+    //  the list and the only reference to the new message is the signal list.
+    //
+    signalData->nextMessageOffset = END_OF_LIST_MARKER;
+    signalData->referenceCount    = 1;
 
-    LOG ( "Called vsi_get_oldest_in_group with group: %u, results: %p\n",
-          groupId, results );
     //
-    //  Make sure the inputs are all present.
+    //  Copy the message body into the message list.
     //
-    CHECK_AND_RETURN_IF_ERROR ( groupId && results );
+    //  TODO: Validate that the message size is "reasonable"!
+    //
+    signalData->messageSize = newMessageSize;
+    memcpy ( (void*)(&signalData->data), body, newMessageSize );
 
     //
-    //  Go get the signal group structure for the specified group id.
+    //  Acquire the lock on this signal list.
     //
-    signalGroup = vsi_fetch_signal_group ( groupId );
+    //  Note that this call will hang if someone else is currently changing
+    //  this signal list.  It will return once the lock is acquired and it is
+    //  safe to manipulate the signal list.
+    //
+    listLock ( signalList );
 
-    LOG ( "  Signal group found: %p\n", signalGroup );
+    if ( signalList->ringCapacity != 0 )
+    {
+        listUnlock ( signalList );
+        return false;
+    }
+    sm_stamp_signal ( signalList, timestamp, stamp );
+    signalData->stamp = *stamp;
 
     //
-    //  If the group id specified does not exist, return an error code to the
-    //  caller.
+    //  If the message list is currently empty (because the tail offset is
+    //  the end of list marker), make the head offset point to our new
+    //  message.  Otherwise make the current tail message point to it.  Since
+    //  removers hold the lock to take the last message off the list, the
+    //  current tail message can't be released while we link to it.
     //
-    if ( signalGroup == NULL )
+    offset_t newMessageOffset = toOffset ( signalData );
+
+    if ( signalList->tail == END_OF_LIST_MARKER )
     {
-        return ENOENT;
+        __atomic_store_n ( &signalList->head, newMessageOffset,
+                           __ATOMIC_RELEASE );
+    }
+    else
+    {
+        __atomic_store_n ( &((signal_data*)toAddress(signalList->tail))->
+                           nextMessageOffset, newMessageOffset,
+                           __ATOMIC_RELEASE );
     }
     //
-    //  While we have not reached the end of the signal list...
+    //  Now make the tail pointer point to our new message.
     //
-    offset_t groupDataOffset = signalGroup->head;
+    __atomic_store_n ( &signalList->tail, newMessageOffset, __ATOMIC_RELEASE );
 
-    while ( groupDataOffset != END_OF_LIST_MARKER )
-    {
-        //
-        //  Get a pointer to the signal group data structure.
-        //
-        groupData = toAddress ( groupDataOffset );
+    //
+    //  Increment the signal count and total message data size.
+    //
+    __atomic_add_fetch ( &signalList->currentSignalCount, 1, __ATOMIC_RELAXED );
+    __atomic_add_fetch ( &signalList->totalSignalSize, newMessageSize,
+                         __ATOMIC_RELAXED );
 
-        //
-        //  Get the pointer to the signal list in the group data structure.
-        //
-        signalList = toAddress ( groupData->signalList );
+    __atomic_add_fetch ( &signalList->semaphore.messageCount, 1,
+                         __ATOMIC_RELAXED );
 
-        LOG ( "  Found signal %u, %u\n", signalList->domainId,
-              signalList->signalId );
-		//
-		//  Populate the current result structure with the signal
-		//  identification information.
-		//
-        result = &results[resultIndex++];
+    //
+    //  Update the latest value cache for this signal list.  This is done
+    //  last so that anyone who sees the cache sequence change (see
+    //  listenInGroup) also sees the new message count.
+    //
+    sm_store_latest ( signalList, newMessageSize, body, stamp );
 
-		result->domainId    = signalList->domainId;
-		result->signalId    = signalList->signalId;
-		result->name        = toAddress ( signalList->name );
-		result->data        = NULL;
-		result->literalData = 0;
-        result->dataLength  = 0;
-
-        //
-        //  Go get the oldest entry in the database for this signal.
-        //
-        //  Note that the return information will be populated in the result
-        //  object that is passed in.
-        //
-        vsi_get_oldest_signal ( result );
-
-        //
-        //  Display the result that was found.
-        //
-        PRINT_RESULT ( result, NULL );
-
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
-    }
     //
-    //  Return a good completion code to the caller.
+    //  Give up the signal list lock.
     //
-    return 0;
+    listUnlock ( signalList );
+
+    return true;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ g e t _ o l d e s t _ i n _ g r o u p _ w a i t
-
-    @brief Retrieve the oldest signal for every member of the specified group.
-
-    The groupId is the numeric group ID previously assigned to the group being
-    operated on.
-
-    In the case of this group fetch function, the result pointer is not a
-    pointer to a single vsi_result structure instance, it is a pointer to an
-    array of vsi_result structure instances.  The number of data structures
-    must be at least as large as the number of signals defined in the
-    specified group.  Failure to allocate enough space for the return data
-    will result in memory corruption and undefined behavior (almost always
-    very bad!).
+    s m _ p o s t _ g r o u p s
 
-    The signal data that is retrieved and returned to the caller will be
-    removed from the VSI core database once it is copied into the result
-    structures.
+    @brief Notify every group that a signal list is a member of.
 
-    @param[in] - groupId - The ID value of the group to be modified.
-    @param[in/out] - result - The array of structures that will hold the data.
+    The insert count of each group is incremented and it's semaphore is
+    posted so that any listeners on the group wake up.  The groups are
+    walked inside an epoch protected section so that a group that is being
+    deleted can't be freed while we look at it.
 
-    @return - status - The return status of the function
+    @param[in] signalList - The address of the signal list to operate on.
 
 ------------------------------------------------------------------------*/
-int vsi_get_oldest_in_group_wait ( const group_t groupId,
-                                   vsi_result*   results )
+static void sm_post_groups ( signal_list* signalList )
 {
-    int status = 0;
-
-    LOG ( "Called vsi_get_oldest_in_group_wait with group: %u, results: %p\n",
-          groupId, results );
-
+    offset_t offset = __atomic_load_n ( &signalList->groups,
+                                        __ATOMIC_ACQUIRE );
     //
-    //  Go wait for a signal on any of the signals in the specified group.
+    //  Most signals are not in any group.
     //
-    status = vsi_listen_any_in_group ( groupId, 0, results );
+    if ( offset == END_OF_LIST_MARKER )
+    {
+        return;
+    }
+    sm_epoch_enter();
 
-    if ( status != 0 )
+    while ( offset != END_OF_LIST_MARKER )
     {
-        LOG ( "Warning: Error[%d-%s] returned by vsi_listen_any_in_group.\n",
-              status, strerror(status) );
+        signal_membership* membership = toAddress ( offset );
 
-        return status;
-    }
+        offset_t group = __atomic_load_n ( &membership->group,
+                                           __ATOMIC_ACQUIRE );
+        if ( group != END_OF_LIST_MARKER )
+        {
+            vsi_signal_group* signalGroup = toAddress ( group );
 
-    LOG ( "  Signal seen for domain[%u], signal[%u]\n", results->domainId,
-          results->signalId );
-    //
-    //  Return the oldest value in all of the signals of the group.
-    //
-    return status;
+            __atomic_add_fetch ( &signalGroup->insertCount, 1,
+                                 __ATOMIC_RELEASE );
+
+            semaphorePost ( &signalGroup->semaphore );
+        }
+        offset = membership->next;
+    }
+    sm_epoch_exit();
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    w a i t F o r S i g n a l O n A n y
-
-    @brief Wait for a signal to arrive.
+    s m _ p o s t _ s i g n a l
 
-    This is the "main" function for the threads that are created to manage
-    the wait for any one of a set of signals.  We will create a thread for
-    each of the signals in the set we are waiting for and the first of the
-    threads that catches a signal will trigger the end of the wait and all of
-    the threads in this set will be destoyed at that point.
+    @brief Release everyone waiting for a signal list.
 
-    Note that this function does not return a value even though it claims to.
-    This is because of the required function signature for callback functions
-    to be used with the "pthread_create" call.
+    This will post to the semaphore of the signal list to reflect the
+    message(s) just inserted into it and notify anyone watching the signal
+    list with a notifier.
 
-    On entry, the results object must contain the data required to make the
-    call to the VSI core library to retrieve the specified signal.  That
-    includes the domain ID and the signal ID.
+    Note that doing this post may result in a different process and/or
+    thread running before the call comes back here.
 
-    @param[in/out] resultsPtr - The structure to populate with the results data.
-    @param[in] threadIds - The array of thread Ids that were created.
-    @param[in] numberOfThreads - The number of threads that were created.
-
-    @return None
+    @param[in] signalList - The signal list that was inserted into.
 
 ------------------------------------------------------------------------*/
-//
-//  Define the data structure that is passed to the threads being created.
-//
-typedef struct threadData_t
+static void sm_post_signal ( signal_list* signalList )
 {
-    vsi_result* result;
-    pthread_t*  threadIds;
-    int         numberOfThreads;
+    LOG ( "Before semaphore post with sem: %p[%lu]\n",
+          &signalList->semaphore, toOffset ( &signalList->semaphore ) );
 
-}   threadData_t;
+    SEM_DUMP ( &signalList->semaphore );
 
+    semaphorePost ( &signalList->semaphore );
 
-static void* waitForSignalOnAny ( void* resultsPtr )
-{
-    threadData_t* tData  = resultsPtr;
-    vsi_result*   result = tData->result;
-    int           status = 0;
+    LOG ( "After semaphore post:\n" );
+    SEM_DUMP ( &signalList->semaphore );
 
-    LOG ( "New thread %'lu has started - Waiting for %d, %d\n",
-          pthread_self(), result->domainId, result->signalId );
     //
-    //  Go fetch the requested signal from the core data store.  Note that
-    //  this function will hang on a semaphore if there is nothing to fetch.
-    //  When it returns, it will have gotten the requested signal data.
+    //  Notify anyone listening to a group that this signal is in.
     //
-    status = vsi_core_fetch_wait ( result->domainId,
-                                   result->signalId,
-                                   &result->dataLength,
-                                   (void**)&result->data );
-    //
-    //  Save the returned status in the result structure.
-    //
-    result->status = status;
+    sm_post_groups ( signalList );
 
     //
-    //  If the above call failed, abort this function and just quit.
-    //
-    if ( status != 0 )
-    {
-        return NULL;
-    }
-    LOG ( "Thread found signal, %d, %d status[%d], with data %p\n",
-          result->domainId, result->signalId, result->status, result->data );
-    //
-    //  If we get here it's because we were able to fetch the requested signal
-    //  data.  At this point, we need to kill all the other threads that have
-    //  not received their data yet.  Once we return, the function that
-    //  spawned this thread will regain control and handle the returned data.
-    //
-    LOG ( "Cancelling all the other threads that were waiting...\n" );
-    for ( int i = 0; i < tData->numberOfThreads; ++i )
-    {
-        if ( tData->threadIds[i] != pthread_self() )
-        {
-            LOG ( "  Cancelling thread %'lu\n", tData->threadIds[i] );
-            pthread_cancel ( tData->threadIds[i] );
-        }
-    }
-    //
-    //  Exit the thread.
+    //  Notify anyone watching this signal with a notifier.
     //
-    return NULL;
+    sm_notify ( signalList );
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ l i s t e n _ a n y _ i n _ g r o u p
+    r e t e n t i o n L i m i t
 
-    @brief Listen for any signal in the signal list
+    @brief Resolve one limit of the retention policy of a signal list.
 
-    This function will listen for any signal in the specified group.  The
-    signal list must have been previously built by adding the desired signals
-    to the group before making this call.  The first signal received after
-    this call is made will return it's value and the function will return to
-    the caller.
+    @param[in] signalLimit - The limit from the signal's own policy.
+    @param[in] domainLimit - The limit from the policy of it's domain.
 
-    Upon return, the caller can check the array of result structures passed in
-    for on with a status of 0 to determine which signal was received.
+    @return The limit to be enforced or 0 if there is no limit.
 
-    TODO: Implement the timeout argument.
+------------------------------------------------------------------------*/
+static inline unsigned long retentionLimit ( unsigned long signalLimit,
+                                             unsigned long domainLimit )
+{
+    unsigned long limit = signalLimit != 0 ? signalLimit : domainLimit;
 
-    @param[in] groupId - The group ID to listen for
-    @param[in] timeout - The optional timeout value in nanoseconds
-    @param[in/out] results - The array of results structures to fill in
+    return limit == VSI_RETAIN_UNLIMITED ? 0 : limit;
+}
 
-    @return 0 if no errors occurred
-              Otherwise the negative errno value will be returned.
 
-            -EINVAL - There are no signals or groups to listen to.
-            -ENOMEM - Memory could not be allocated.
+/*!-----------------------------------------------------------------------
 
-------------------------------------------------------------------------*/
-int vsi_listen_any_in_group ( const group_t groupId,
-                              unsigned int  timeout,
-                              vsi_result*   results )
-{
-    int                    groupCount  = 0;
-    int                    i           = 0;
-    int                    status      = 0;
-    vsi_signal_group*      signalGroup = 0;
-	vsi_signal_group_data* groupData   = 0;
-    signal_list*           signalList  = 0;
-    threadData_t*          tData       = 0;
-    pthread_t*             threadIds   = 0;
-    vsi_result*            tempResult  = 0;
+    s m _ o l d e s t _ t i m e s t a m p
 
-    LOG ( "Called vsi_listen_any_in_group with group: %u\n", groupId );
+    @brief Return the capture time of the oldest signal in a signal list.
 
-    //
-    //  Make sure the required inputs are all present.
-    //
-    CHECK_AND_RETURN_IF_ERROR ( groupId );
+    @param[in] signalList - The signal list to look at.
+    @param[out] timestamp - The address of where to store the capture time.
 
-    //
-    //  Go get the signal group structure for the specified group id.
-    //
-    signalGroup = vsi_fetch_signal_group ( groupId );
+    @return true if the signal list is not empty.
 
-    LOG ( "  Signal group found: %p\n", signalGroup );
+------------------------------------------------------------------------*/
+static bool sm_oldest_timestamp ( signal_list*   signalList,
+                                  unsigned long* timestamp )
+{
+    bool found = false;
 
-    //
-    //  If the group id specified does not exist, return an error code to the
-    //  caller.
-    //
-    if ( signalGroup == NULL )
+    if ( signalList->ringCapacity != 0 )
     {
-        return ENOENT;
+        signal_ring_slot* slot = sm_ring_peek ( signalList, false );
+        if ( slot != NULL )
+        {
+            *timestamp = slot->stamp.timestamp;
+            found      = true;
+        }
+        return found;
     }
     //
-    //  Display the signal group that we found.
+    //  The oldest record may be removed by a consumer while we look at it
+    //  so this is done inside an epoch protected section.
     //
-    printSignalGroup ( "", signalGroup );
+    sm_epoch_enter();
 
-    //
-    //  Allocate the array of thread ids that we will need.
-    //
-    groupCount = signalGroup->count;
-    threadIds = malloc ( groupCount * sizeof(pthread_t) );
-    if ( ! threadIds )
-    {
-        return ENOMEM;
-    }
-    //
-    //  Allocate the array of thread data structures.
-    //
-    tData = malloc ( groupCount * sizeof(threadData_t) );
-    if ( ! tData )
+    offset_t head = __atomic_load_n ( &signalList->head, __ATOMIC_ACQUIRE );
+    if ( head != END_OF_LIST_MARKER )
     {
-        free ( threadIds );
-        return ENOMEM;
+        *timestamp = ((signal_data*)toAddress ( head ))->stamp.timestamp;
+        found      = true;
     }
-    //
-    //  Get the offset of the first signal in the group's signal list.
-    //
-    offset_t groupDataOffset = signalGroup->head;
-
-    //
-    //  While we have not reached the end of the signal list...
-    //
-    while ( groupDataOffset != END_OF_LIST_MARKER )
-    {
-        groupData = toAddress ( groupDataOffset );
+    sm_epoch_exit();
 
-        //
-        //  Get the pointer to the signal list in the group data structure.
-        //
-        signalList = toAddress ( groupData->signalList );
+    return found;
+}
 
-        LOG ( "  Creating listening thread for %d, %d\n",
-              signalList->domainId, signalList->signalId );
-        //
-        //  Get a pointer to the current result structure.  This result
-        //  structure will be filled in by the thread we are going to create.
-        //
-        tempResult = &results[i];
 
-        //
-        //  Initialize the mutex for this result structure.
-        //
-        status = pthread_mutex_init ( &tempResult->lock,
-                                      &smControl->masterMutexAttributes );
-        //
-        //  Specify the domain and signal IDs for the current signal in the
-        //  results structure that will be passed to the new thread.
-        //
-        tempResult->domainId    = signalList->domainId;
-        tempResult->signalId    = signalList->signalId;
-        tempResult->data        = NULL;
-        tempResult->literalData = 0;
-        tempResult->dataLength  = 0;
-        tempResult->status      = ENOENT;
+/*!-----------------------------------------------------------------------
 
-        //
-        //  Initialize all of the fields of the thread data structure.
-        //
-        tData[i].result          = tempResult;
-        tData[i].threadIds       = threadIds;
-        tData[i].numberOfThreads = groupCount;
+    s m _ e n f o r c e _ r e t e n t i o n
 
-        //
-        //  Go create a new thread that will wait for the specified signal to
-        //  occur in the core data store.
-        //
-        status = pthread_create ( &threadIds[i], NULL, waitForSignalOnAny, &tData[i] );
+    @brief Discard the oldest signals of a list that exceed it's retention.
 
-        LOG ( "  Created thread %'lu\n", threadIds[i] );
+    This is called after every insert so at most a few signals need to be
+    discarded each time and each of those is removed from the head of the
+    signal list in constant time.  The signal that was just inserted is
+    never discarded.  See vsi_retention for how the policy of the signal
+    list and the policy of it's domain are combined.
 
-        ++i;
+    @param[in] signalList - The signal list that was inserted into.
+    @param[in] stamp - The stamp of the signal that was just inserted.
 
-        //
-        //  If we could not create a new thread, return the error code to the
-        //  caller.
-        //
-        if ( status != 0 )
-        {
-            printf ( "Error creating thread: %m\n" );
+------------------------------------------------------------------------*/
+static void sm_enforce_retention ( signal_list*        signalList,
+                                   const signal_stamp* stamp )
+{
+    vsi_retention  noRetention     = { 0 };
+    vsi_retention* domainRetention = &noRetention;
+    unsigned long  oldest;
 
-            free ( threadIds );
-            free ( tData );
-            return status;
-        }
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
+    if ( signalList->domainId >= 0 &&
+         signalList->domainId < VSI_DENSE_DOMAIN_COUNT )
+    {
+        domainRetention = &vsiContext->domainRetention[signalList->domainId];
     }
+    unsigned long maxCount = retentionLimit ( signalList->retention.maxCount,
+                                              domainRetention->maxCount );
+    unsigned long maxBytes = retentionLimit ( signalList->retention.maxBytes,
+                                              domainRetention->maxBytes );
+    unsigned long maxAge   = retentionLimit ( signalList->retention.maxAge,
+                                              domainRetention->maxAge );
     //
-    //  Wait for all of the threads to terminate.  Note that under normal
-    //  conditions, one of the threads will receive the signal that it has
-    //  been waiting for.  When that happens, that thread will then cancel all
-    //  of the other threads that are waiting and then terminate itself.  At
-    //  that point all of the threads will be dead and this loop should
-    //  terminate.
+    //  Most signals don't have any retention limits at all.
     //
-    LOG ( "Waiting for threads to terminate...\n" );
-
-    for ( i = 0; i < groupCount; ++i )
+    if ( maxCount == 0 && maxBytes == 0 && maxAge == 0 )
     {
-        LOG ( "  Waiting for thread %'lu to terminate\n", threadIds[i] );
-        pthread_join ( threadIds[i], NULL );
-        LOG ( "  Thread %'lu has terminated\n", threadIds[i] );
+        return;
     }
     //
-    //  Clean up our temporary memory and return a good completion code to the
-    //  caller.
-    //
-    free ( threadIds );
-    free ( tData );
-
-    //
-    //  Return a good completion code to the caller.
+    //  Discard the oldest signal until the list is within all of the limits.
     //
-    return 0;
+    while ( signalList->currentSignalCount > 1 )
+    {
+        if ( ! ( ( maxCount != 0 &&
+                   signalList->currentSignalCount > maxCount ) ||
+                 ( maxBytes != 0 &&
+                   signalList->totalSignalSize > maxBytes ) ||
+                 ( maxAge != 0 &&
+                   sm_oldest_timestamp ( signalList, &oldest ) &&
+                   oldest < stamp->timestamp &&
+                   stamp->timestamp - oldest > maxAge ) ) )
+        {
+            break;
+        }
+        //
+        //  The discarded signal will never be consumed so take it out of
+        //  the semaphore's message count just as a ring overflow does.
+        //
+        if ( sm_removeSignal ( signalList ) != 0 )
+        {
+            break;
+        }
+        __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                             __ATOMIC_RELAXED );
+    }
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    w a i t F o r S i g n a l O n A l l
+    s m _ i n s e r t
 
-    @brief Wait for all signals to arrive for a group.
+    @brief Insert a new signal into the signal list.
 
-    This is the "main" function for the threads that are created to manage the
-    wait for all of the signals in a specified set.  We will create a thread
-    to fetch each individual signal in the desired set and as each thread
-    receives it's signal, the results for that signal will be recorded in the
-    results structure assigned to it and then terminate.  When all of the
-    threads have terminated, the calling function will resume and the results
-    array returned to the caller.
+    This function will find the appropriate signal list for the given signal
+    and domain and insert the caller's data into the message list.  New
+    messages are inserted at the end of the list so the oldest messages are at
+    the beginning of the list.
 
-    The caller must supply a pointer to a "vsi_result" structure that can be
-    used to record the result data.  Each thread will record it's fetch signal
-    data in one of these structures.
+    The "signal" is an arbitrary integer that uniquely identifies the message
+    type within the domain of the message.  Domains are an identifier that
+    specifies a class of messages.  For instance, CAN messages can all be
+    considered to be messages in the CAN domain.  Within that domain, the
+    message ID field uniquely identifies the type of message.
 
-    Note that this function does not return a value even though it claims to.
-    This is because of the required function signature for callback functions
-    to be used with the "pthread_create" call.
+    The "body" pointer supplied by the caller must point to the beginning of
+    the data that makes up the message we want to store.  The message size
+    specifies the number of bytes that will be read from the user's pointer
+    and copied into the shared memory segment.
 
-    On entry, the results object must contain the data required to make the
-    call to the VSI core library to retrieve the specified signal.  That
-    includes the domain ID and the signal ID.
+    Every new message is stamped with it's capture time and the next
+    sequence number of the signal list (see signal_stamp).  If the caller
+    supplies a stamp with a non-zero timestamp, that is used as the capture
+    time, otherwise the current time is used.  The stamp that was stored is
+    returned in the caller's stamp.
 
-    @param[in/out] resultsPtr - The structure to populate with the results data.
+    @param[in] domain - The domain associated with this message.
+    @param[in] signal - The signal value associated with this message.
+    @param[in] newMessageSize - The size of the new message in bytes.
+    @param[in] body - The address of the body of the new message.
+    @param[in/out] stamp - The address of the stamp of the new message (may
+                           be NULL).
 
-    @return None
+    @return 0 if successful
+            Otherwise the error code
 
 ------------------------------------------------------------------------*/
-static void* waitForSignalOnAll ( void* resultsPtr )
+int sm_insert ( domain_t domain, signal_t signal, unsigned long newMessageSize,
+                void* body, signal_stamp* stamp )
 {
-    threadData_t* tData  = resultsPtr;
-    vsi_result*   result = tData->result;
-    int           status = 0;
+    int          status = 0;
+    signal_stamp newStamp;
+
+    //
+    //  Display the input parameters for the call if debug is enabled.
+    //
+    LOG ( "\nCalled sm_insert with:\n" );
+    LOG ( "  Domain Id: %u\n",    domain );
+    LOG ( "  Signal Id: %u\n",    signal );
+    LOG ( "       Name: [%s]\n",  "" );
+    LOG ( "   Data Len: %lu\n",   newMessageSize );
+    if ( newMessageSize == sizeof(unsigned long) )
+    {
+        LOG ( "       Data: %lu\n", *(unsigned long*)body );
+    }
+    else
+    {
+        LOG ( "       Data: %s\n", (char*)body );
+    }
+    // LOG ( "Inserting domain[%d] signal[%d]\n", domain, signal );
+
+    HX_DUMP ( body, newMessageSize, "New Message" );
 
-    LOG ( "New thread %'lu has started - Waiting for %d, %d\n",
-          pthread_self(), result->domainId, result->signalId );
     //
-    //  Go fetch the requested signal from the core data store.  Note that
-    //  this function will hang on a semaphore if there is nothing to fetch.
-    //  When it returns, it will have gotten the requested signal data.
+    //  Record this insert in the trace ring.
     //
-    status = vsi_core_fetch_wait ( result->domainId,
-                                   result->signalId,
-                                   &result->dataLength,
-                                   (void**)&result->data );
+    SM_TRACE ( te_insert, domain, signal, newMessageSize );
+
     //
-    //  If the above called failed, abort this function and just quit.
+    //  Go find the signal list control block for this domain and signal.  Note
+    //  that if the signal list does not exist yet, a new one will be created
+    //  and initialized.
     //
-    if ( status != 0 )
+    signal_list* signalList = findSignalList ( domain, signal );
+    if ( signalList == NULL )
     {
-        return NULL;
+        return ENOMEM;
     }
-    LOG ( "Thread found signal, %d, %d status[%d], with data %u\n",
-          result->domainId, result->signalId, status, result->data[0] );
     //
-    //  Exit the thread.
+    //  If this signal list is stored in a ring, go store the new message in
+    //  the next ring slot and release anyone waiting for it.  No shared
+    //  memory allocation is required in this case.
     //
-    return NULL;
-}
-
-
-/*!-----------------------------------------------------------------------
+    //  The new message is only stamped with it's capture time and sequence
+    //  number once we know that it can be stored so that failed inserts
+    //  don't leave gaps in the sequence numbers.
+    //
+    if ( signalList->ringCapacity != 0 )
+    {
+        status = sm_ring_check ( signalList, newMessageSize );
+        if ( status != 0 )
+        {
+            return status;
+        }
+        sm_stamp_signal ( signalList, stamp != NULL ? stamp->timestamp : 0,
+                          &newStamp );
+        if ( stamp != NULL )
+        {
+            *stamp = newStamp;
+        }
+        status = sm_ring_insert ( signalList, newMessageSize, body, &newStamp );
+        if ( status == 0 )
+        {
+            __atomic_add_fetch ( &signalList->semaphore.messageCount, 1,
+                                 __ATOMIC_RELAXED );
 
-    v s i _ l i s t e n _ a l l _ i n _ g r o u p
+            sm_store_latest ( signalList, newMessageSize, body, &newStamp );
+            sm_enforce_retention ( signalList, &newStamp );
+            sm_post_signal ( signalList );
+        }
+        return status;
+    }
+    //
+    //  Now we need to create a new entry for this message list so compute the
+    //  size that we will need and allocate that much memory in the shared
+    //  memory segment.
+    //
+    int signalDataSize = newMessageSize + SIGNAL_DATA_HEADER_SIZE;
+    signal_data* signalData = sm_malloc ( signalDataSize );
+    if ( signalData == NULL )
+    {
+        printf ( "Error: Unable to allocate a new signal list - "
+                 "Shared memory segment is full!\n" );
+        return ENOMEM;
+    }
+    //
+    //  Go add the new message to the end of the signal list, discard any old
+    //  messages that the retention policy no longer allows and then post to
+    //  the semaphore to release anyone waiting for it.
+    //
+    //  If the signal list was switched to a ring since we looked at it, the
+    //  message is stored in the ring instead.
+    //
+    if ( ! sm_append_signal ( signalList, signalData, newMessageSize, body,
+                              stamp != NULL ? stamp->timestamp : 0,
+                              &newStamp ) )
+    {
+        sm_free ( signalData );
 
-    @brief Listen for all signals in the specified group
+        return sm_insert ( domain, signal, newMessageSize, body, stamp );
+    }
+    if ( stamp != NULL )
+    {
+        *stamp = newStamp;
+    }
+    sm_enforce_retention ( signalList, &newStamp );
 
-    This function will listen for all signals in the specified group.  The
-    signal list must have been previously built by adding the desired signals
-    to the group before making this call.  When all of the signals defined in
-    the specified group have received a signal, this call will return to the
-    caller.  This function will hang until all of the specified signals have
-    been received.
+    sm_post_signal ( signalList );
 
-    Note that the results pointer argument here MUST be a pointer to an array
-    of vsi_result structures and that array must be at least as large as the
-    number of signals that are expected.  The resultsSize argument is the
-    number of structures being supplied (NOT the total size of the results
-    array in bytes!).  If the resultsSize is not large enough to hold all of
-    the results required, an error will be returned to the caller.
+    //
+    //  Return the status indicator to the caller.
+    //
+    return status;
+}
 
-    TODO: Implement the timeout argument.
 
-    @param[in] groupId - The ID of the group to listen for
-    @param[out] resultsPtr - The address of where to store the results
-    @param[in] resultsSize - The size of the results array being supplied
-    @param[in] timeout - The optional timeout value in nanoseconds
+/*!-----------------------------------------------------------------------
 
-    @return 0 if no errors occurred
-              Otherwise the negative errno value will be returned.
+    s m _ i n s e r t _ b a t c h
 
-            EINVAL - There are no signals or groups to listen to.
-            ENOMEM - Memory could not be allocated.
+    @brief Insert several new signals into the shared memory segment.
 
-------------------------------------------------------------------------*/
-int vsi_listen_all_in_group ( const group_t groupId,
-                              vsi_result*   results,
-                              unsigned int  resultsSize,
-                              unsigned int  timeout )
-{
-    int                    groupCount = 0;
-    int                    i = 0;
-    int                    status = 0;
-    vsi_signal_group       requestedSignalGroup = { 0 };
-    vsi_signal_group*      signalGroup = 0;
-    vsi_signal_group_data* groupData = 0;
-    signal_list*           signalList = 0;
-    vsi_result*            result = 0;
-    threadData_t*          tData;
-    pthread_t*             threadIds = 0;
+    This function is equivalent to calling sm_insert for each of the results
+    supplied in order but all of the signal lists are resolved first, all of
+    the memory needed is allocated in a single allocator critical section
+    and the semaphore of each signal list is posted only once, after all of
+    the signals in the batch have been linked into their lists.
 
-    //
-    //  Make sure the inputs are all present.
-    //
-    CHECK_AND_RETURN_IF_ERROR ( groupId && results && resultsSize );
+    The domainId, signalId, data, dataLength and timestamp fields of each
+    result must be set.  The status field of each result is set to the
+    completion status of that signal's insert and the timestamp and sequence
+    fields are set to the stamp of the signal that was stored.
 
-    //
-    //  Go get the signal group structure for the specified group id.
-    //
-    requestedSignalGroup.groupId = groupId;
+    @param[in/out] results - The array of signals to insert.
+    @param[in] count - The number of signals in the results array.
 
-    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedSignalGroup );
+    @return 0 if successful
+            Otherwise the error code of the first signal that failed
 
-    //
-    //  If the group id specified does not exist, return an error code to the
-    //  caller.
-    //
-    if ( signalGroup == NULL )
+------------------------------------------------------------------------*/
+int sm_insert_batch ( vsi_result* results, size_t count )
+{
+    int    status = 0;
+    size_t i;
+    size_t j;
+
+    LOG ( "\nCalled sm_insert_batch with %zu signals\n", count );
+
+    if ( count == 0 )
     {
-        return ENOENT;
+        return 0;
     }
     //
-    //  If the supplied results structure array is not large enough to hold
-    //  all of the results we will get, abort this call with an error code.
+    //  Get some local memory to hold the signal list and new signal data
+    //  pointers and the allocation sizes for each signal in the batch.
     //
-    groupCount = signalGroup->count;
-    if ( resultsSize < groupCount )
+    signal_list** signalLists = malloc ( count * ( sizeof(signal_list*) +
+                                                   sizeof(void*) +
+                                                   sizeof(size_t) ) );
+    if ( signalLists == NULL )
     {
         return ENOMEM;
     }
+    void**  blocks = (void**)&signalLists[count];
+    size_t* sizes  = (size_t*)&blocks[count];
+    size_t  blockCount = 0;
+
     //
-    //  Allocate the array of thread ids that we will need.
+    //  Find the signal list for each signal in the batch and figure out how
+    //  much memory each of them will need.  Signals stored in a ring don't
+    //  need any memory allocated.
     //
-    threadIds = malloc ( groupCount * sizeof(pthread_t) );
-    if ( ! threadIds )
+    for ( i = 0; i < count; ++i )
     {
-        return ENOMEM;
+        SM_TRACE ( te_insert, results[i].domainId, results[i].signalId,
+                   results[i].dataLength );
+
+        signalLists[i] = findSignalList ( results[i].domainId,
+                                          results[i].signalId );
+
+        if ( signalLists[i] != NULL && signalLists[i]->ringCapacity == 0 )
+        {
+            sizes[blockCount++] = results[i].dataLength +
+                                  SIGNAL_DATA_HEADER_SIZE;
+        }
     }
     //
-    //  Allocate the array of thread data structures.
+    //  Go allocate all of the memory for the new signals at once.  If this
+    //  fails then none of the signals will be inserted.
     //
-    tData = malloc ( groupCount * sizeof(threadData_t) );
-    if ( ! tData )
+    if ( blockCount != 0 && sm_malloc_batch ( blockCount, sizes, blocks ) != 0 )
     {
+        printf ( "Error: Unable to allocate %zu new signals - "
+                 "Shared memory segment is full!\n", blockCount );
+        for ( i = 0; i < count; ++i )
+        {
+            results[i].status = ENOMEM;
+        }
+        free ( signalLists );
         return ENOMEM;
     }
     //
-    //  Get the offset of the first signal in the group's signal list.
-    //
-    offset_t groupDataOffset = signalGroup->head;
-
-    //
-    //  While we have not reached the end of the signal list...
+    //  Now go insert each of the signals into it's signal list.
     //
-    while ( groupDataOffset != END_OF_LIST_MARKER )
+    blockCount = 0;
+    for ( i = 0; i < count; ++i )
     {
-        groupData = toAddress ( groupDataOffset );
-
-        //
-        //  Get the pointer to the signal list in the group data structure.
-        //
-        signalList = toAddress ( groupData->signalList );
-
-        LOG ( "  Creating listening thread for %d, %d\n",
-              signalList->domainId, signalList->signalId );
-        //
-        //  Get a pointer to the current result structure.
-        //
-        result = &results[i];
+        signal_list* signalList = signalLists[i];
+        signal_stamp stamp;
 
         //
-        //  Initialize the mutex for this result structure.
+        //  Each signal is only stamped once we know that it can be stored so
+        //  that failed inserts don't leave gaps in the sequence numbers.
         //
-        pthread_mutex_init ( &result->lock, NULL );
-
-        //
-        //  Specify the domain and signal IDs for the current signal in the
-        //  results structure that will be passed to the new thread.
-        //
-        pthread_mutex_lock ( &result->lock );
-
-        result->dataLength = 0;
-
-        result->domainId = signalList->domainId;
-        result->signalId = signalList->signalId;
-
-        result->status = ENOENT;
+        if ( signalList == NULL )
+        {
+            results[i].status = ENOMEM;
+        }
+        else if ( signalList->ringCapacity != 0 )
+        {
+            results[i].status = sm_ring_check ( signalList,
+                                                results[i].dataLength );
+            if ( results[i].status == 0 )
+            {
+                sm_stamp_signal ( signalList, results[i].timestamp, &stamp );
 
-        pthread_mutex_unlock ( &result->lock );
+                results[i].status = sm_ring_insert ( signalList,
+                                                     results[i].dataLength,
+                                                     results[i].data, &stamp );
+            }
+            if ( results[i].status == 0 )
+            {
+                __atomic_add_fetch ( &signalList->semaphore.messageCount, 1,
+                                     __ATOMIC_RELAXED );
 
-        //
-        //  Initialize all of the fields of the thread data structure.
-        //
-        tData[i].result          = results;
-        tData[i].threadIds       = NULL;
-        tData[i].numberOfThreads = 0;
+                sm_store_latest ( signalList, results[i].dataLength,
+                                  results[i].data, &stamp );
 
-        //
-        //  Go create a new thread that will wait for the specified signal to
-        //  occur in the core data store.
-        //
-        status = pthread_create ( &threadIds[i], NULL, waitForSignalOnAll, &tData[i] );
+                sm_enforce_retention ( signalList, &stamp );
+            }
+        }
+        else if ( sm_append_signal ( signalList, blocks[blockCount],
+                                     results[i].dataLength, results[i].data,
+                                     results[i].timestamp, &stamp ) )
+        {
+            ++blockCount;
 
-        LOG ( "  Created thread %'lu\n", threadIds[i] );
+            sm_enforce_retention ( signalList, &stamp );
 
-        ++i;
+            results[i].status = 0;
+        }
+        else
+        {
+            //
+            //  The signal list was switched to a ring since we looked at it
+            //  so the signal is stored in the ring instead.
+            //
+            sm_free ( blocks[blockCount++] );
 
-        //
-        //  If we could not create a new thread, return the error code to the
-        //  caller.
-        //
-        if ( status != 0 )
+            stamp.timestamp   = results[i].timestamp;
+            results[i].status = sm_insert ( results[i].domainId,
+                                            results[i].signalId,
+                                            results[i].dataLength,
+                                            results[i].data, &stamp );
+        }
+        if ( results[i].status == 0 )
         {
-            printf ( "Error creating thread: %m\n" );
-            return status;
+            results[i].timestamp = stamp.timestamp;
+            results[i].sequence  = stamp.sequence;
+        }
+        if ( results[i].status != 0 && status == 0 )
+        {
+            status = results[i].status;
         }
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
     }
     //
-    //  Wait for all of the threads to terminate.  Note that under normal
-    //  conditions, one of the threads will receive the signal that it has
-    //  been waiting for.  When that happens, that thread will then cancel all
-    //  of the other threads that are waiting and then terminate itself.  At
-    //  that point all of the threads will be dead and this loop should
-    //  terminate.
+    //  Post to the semaphore of each signal list that was inserted into.  If
+    //  the same signal list appears more than once in the batch, only the
+    //  last occurrence is posted.
     //
-    LOG ( "Waiting for threads to terminate...\n" );
-
-    for ( i = 0; i < groupCount; ++i )
+    for ( i = 0; i < count; ++i )
     {
-        LOG ( "  Waiting for thread %'lu to terminate\n", threadIds[i] );
-        pthread_join ( threadIds[i], NULL );
-        LOG ( "  Thread %'lu has terminated\n", threadIds[i] );
+        if ( signalLists[i] == NULL )
+        {
+            continue;
+        }
+        for ( j = i + 1; j < count; ++j )
+        {
+            if ( signalLists[j] == signalLists[i] )
+            {
+                break;
+            }
+        }
+        if ( j == count )
+        {
+            sm_post_signal ( signalLists[i] );
+        }
     }
-    //
-    //  Clean up our temporary memory and return a good completion code to the
-    //  caller.
-    //
-    free ( threadIds );
-    free ( tData );
+    free ( signalLists );
 
-    //
-    //  Return a good completion code to the caller.
-    //
-    return 0;
+    return status;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    v s i _ f l u s h _ g r o u p
+    s m _ r e m o v e S i g n a l
 
-    @brief Flush all of the signals available for all signals in a group.
+    @brief Remove the oldest signal from the signal list.
 
-    This function will flush all of the signals available for each member
-    signal in the specified group.
+    This function will remove the signal at the beginning of the specified
+    signal list.  This will be the oldest message in the list.
 
-    If an application is no longer interested in any of the pending signals to
-    be read or simply wants to synchronize with the latest information, it may
-    call this function to flush all pending messages from the queues of every
-    signal in the group.
+    @param[in] signalList - The address of the signal list to operate on.
+
+    @return 0 - Message successfully removed.
+            ENODATA - The signal list was empty.
 
 ------------------------------------------------------------------------*/
-int vsi_flush_group ( const group_t groupId )
+int sm_removeSignal ( signal_list* signalList )
 {
-    vsi_signal_group       requestedSignalGroup = { 0 };
-    vsi_signal_group*      signalGroup = 0;
-    vsi_signal_group_data* groupData = 0;
-    signal_list*           signalList = 0;
+    LOG ( "Removing signal with %d-%d\n", signalList->domainId, signalList->signalId );
 
     //
-    //  Make sure the inputs are all present.
+    //  If this signal list is stored in a ring, just release the oldest slot.
     //
-    CHECK_AND_RETURN_IF_ERROR ( groupId );
-
+    if ( signalList->ringCapacity != 0 )
+    {
+        return sm_ring_remove ( signalList ) != NULL ? 0 : ENODATA;
+    }
     //
-    //  Go get the signal group structure for the specified group id.
+    //  Keep trying to remove whatever signal is at the head of the list until
+    //  we succeed or the list is empty.
     //
-    requestedSignalGroup.groupId = groupId;
+    //  A producer enforcing the retention policy of the signal list (see
+    //  sm_enforce_retention) can be removing signals at the same time as a
+    //  consumer so the head can change out from under us.
+    //
+    while ( true )
+    {
+        offset_t head = __atomic_load_n ( &signalList->head, __ATOMIC_ACQUIRE );
 
-    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedSignalGroup );
+        //
+        //  If this signal list is empty, just return without doing anything.
+        //
+        if ( head == END_OF_LIST_MARKER )
+        {
+            return ENODATA;
+        }
+        if ( sm_removeSignalIf ( signalList, head ) )
+        {
+            return 0;
+        }
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ r e m o v e S i g n a l I f
+
+    @brief Remove the oldest signal from the signal list if it is a given one.
+
+    This is used by callers that have looked at the oldest signal and only
+    want to remove that signal.  If some other remover has already removed
+    it, nothing is removed.
+
+    The head of the list is claimed while holding the signal list lock so
+    that each signal is only released once and so that a producer can't be
+    linking a new signal to the last signal while it is being removed (see
+    sm_append_signal).  To be sure that the expected head is not a recycled
+    record that happens to be at the same offset, the caller must have
+    stayed inside an epoch protected section since it read the offset.
 
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] expectedHead - The offset of the signal to be removed.
+
+    @return true if the signal was removed by this call
+            false if it was not the head of the list (any more)
+
+------------------------------------------------------------------------*/
+bool sm_removeSignalIf ( signal_list* signalList, offset_t expectedHead )
+{
+    signal_data* signalData;
+    offset_t     head = expectedHead;
+    offset_t     next;
+
+    if ( head == END_OF_LIST_MARKER )
+    {
+        return false;
+    }
     //
-    //  If the group id specified does not exist, return an error code to the
-    //  caller.
+    //  Claim the signal by making the head offset be the offset of the next
+    //  signal after it.  If someone else got to it first, the head has
+    //  already moved on.
     //
-    if ( signalGroup == NULL )
+    listLock ( signalList );
+
+    if ( signalList->head != head )
     {
-        return ENOENT;
+        listUnlock ( signalList );
+        return false;
     }
-	//
-    //  Get the offset of the first signal in the group's signal list.
-    //
-    offset_t groupDataOffset = signalGroup->head;
+    signalData = toAddress ( head );
+    next       = signalData->nextMessageOffset;
+
+    __atomic_store_n ( &signalList->head, next, __ATOMIC_RELEASE );
 
     //
-    //  If the head pointer is NULL, the list is empty so return an error code
-    //  to the caller.
+    //  If that was the only message in the current list then the tail offset
+    //  must also be set to the "empty" list state.
     //
-    if ( groupDataOffset == END_OF_LIST_MARKER )
+    if ( next == END_OF_LIST_MARKER )
     {
-        return ENOENT;
+        __atomic_store_n ( &signalList->tail, END_OF_LIST_MARKER,
+                           __ATOMIC_RELEASE );
     }
+    listUnlock ( signalList );
+
     //
-    //  While we have not reached the end of the signal list...
+    //  Decrement the count of the number of signals in this list and the
+    //  total amount of space occupied by those signals.
     //
-    while ( groupDataOffset != END_OF_LIST_MARKER )
-    {
-        groupData = toAddress ( groupDataOffset );
-
-        //
-        //  Get the pointer to the signal list in the group data structure.
-        //
-        signalList = toAddress ( groupData->signalList );
-
-        //
-        //  Go flush all of the signal data for this signal.
-        //
-        vsi_flush_signal ( signalList->domainId, signalList->signalId );
+    __atomic_sub_fetch ( &signalList->currentSignalCount, 1, __ATOMIC_RELAXED );
+    __atomic_sub_fetch ( &signalList->totalSignalSize, signalData->messageSize,
+                         __ATOMIC_RELAXED );
 
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
-    }
     //
-    //  Return a good completion code to the caller.
+    //  Drop the signal list's reference to this signal data structure.  This
+    //  will free up the shared memory it occupies unless it is leased.
     //
-    return 0;
+    sm_release_signal_data ( signalData );
+
+    return true;
 }
 
 
 /*!-----------------------------------------------------------------------
 
-    N a m e / I D   M a n i u p l a t i o n   F u n c t i o n s
-    ===========================================================
+    s m _ r e l e a s e _ s i g n a l _ d a t a
 
+    @brief Release a reference to a signal data record.
 
-    v s i _ n a m e _ s t r i n g _ t o _ i d
+    When the last reference to the record is released, the shared memory it
+    occupies is retired and will be given back to the memory manager once
+    no reader can still be looking at it (see sm_retire).
 
-    @brief Convert a domain and signal name to it's signal ID.
+    @param[in] signalData - The address of the signal data record.
 
-    The name is an ASCII character string that has been defined in the VSS and
-    associated with a domain.
+------------------------------------------------------------------------*/
+void sm_release_signal_data ( signal_data* signalData )
+{
+    if ( __atomic_sub_fetch ( &signalData->referenceCount, 1,
+                              __ATOMIC_ACQ_REL ) == 0 )
+    {
+        sm_retire ( signalData );
+    }
+}
 
-    The domainId is the ID of the domain in which the name is defined.
 
-    The signalId is a pointer to an identifier in which the signal ID will
-    be stored.
+/*!-----------------------------------------------------------------------
 
-    @param[in] - name - The name of the signal to be converted.
-    @param[in] - domainId - The domain of the name to look up.
-    @param[out] - signalId - A pointer in which the signal ID will be stored.
+    s m _ a c q u i r e _ s i g n a l _ d a t a
 
-    @return - status - The return status of the function
+    @brief Acquire a new reference to a signal data record.
 
-------------------------------------------------------------------------*/
+    The reference is only acquired if the record is still referenced by
+    someone else, otherwise it is already on it's way back to the memory
+    manager and can't be used.  The caller must be inside an epoch protected
+    section so that the record can't be freed while we look at it.
+
+    @param[in] signalData - The address of the signal data record.
+
+    @return true if the reference was acquired.
+
+------------------------------------------------------------------------*/
+static bool sm_acquire_signal_data ( signal_data* signalData )
+{
+    unsigned int count = __atomic_load_n ( &signalData->referenceCount,
+                                           __ATOMIC_RELAXED );
+    while ( count != 0 )
+    {
+        if ( __atomic_compare_exchange_n ( &signalData->referenceCount, &count,
+                                           count + 1, true, __ATOMIC_ACQUIRE,
+                                           __ATOMIC_RELAXED ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    c o p y S i g n a l D a t a
+
+    @brief Copy a signal data record into a user buffer.
+
+    The smaller of the signal data or the user's buffer is copied and the
+    number of bytes copied is returned in bodySize.  The caller must make
+    sure the record can't be recycled while it is being copied, normally by
+    being inside an epoch protected section.
+
+    @param[in] signalData - The address of the signal data record.
+    @param[in/out] bodySize - The size of the buffer on input and the number
+                              of bytes copied into it on output.
+    @param[out] body - The address of the buffer to copy the data into.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
+
+------------------------------------------------------------------------*/
+static void copySignalData ( signal_data*   signalData,
+                             unsigned long* bodySize,
+                             void*          body,
+                             signal_stamp*  stamp )
+{
+    unsigned long size = signalData->messageSize;
+
+    if ( size > *bodySize )
+    {
+        size = *bodySize;
+    }
+    memcpy ( body, signalData->data, size );
+
+    *bodySize = size;
+
+    if ( stamp != NULL )
+    {
+        *stamp = signalData->stamp;
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ s i g n a l _ p r e s e n t
+
+    @brief Determine if a signal list has a signal in it.
+
+    This is the predicate passed to semaphoreWaitUntil by the fetch functions
+    when they were released from the semaphore wait but found no signal.  In
+    that case the message count of the semaphore may say that there is a
+    signal when there isn't one so waiting on the count would not block.
+
+    @param[in] context - The address of the signal list.
+
+    @return true if there is a signal in the list.
+
+------------------------------------------------------------------------*/
+static bool sm_signal_present ( void* context )
+{
+    signal_list* signalList = context;
+
+    if ( signalList->ringCapacity != 0 )
+    {
+        return __atomic_load_n ( &signalList->ringHead, __ATOMIC_ACQUIRE ) !=
+               __atomic_load_n ( &signalList->ringTail, __ATOMIC_ACQUIRE );
+    }
+    return __atomic_load_n ( &signalList->head, __ATOMIC_ACQUIRE ) !=
+           END_OF_LIST_MARKER;
+}
+
+
+//
+//  Wait until a signal list that a fetch found empty has a signal in it.
+//
+static int sm_wait_present ( signal_list*           signalList,
+                             const struct timespec* deadline )
+{
+    __atomic_add_fetch ( &signalList->semaphore.waiterCount, 1,
+                         __ATOMIC_RELAXED );
+
+    int status = semaphoreWaitUntil ( &signalList->semaphore,
+                                      sm_signal_present, signalList,
+                                      deadline );
+
+    __atomic_sub_fetch ( &signalList->semaphore.waiterCount, 1,
+                         __ATOMIC_RELAXED );
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f e t c h
+
+    @brief Retrieve a signal from the signal buffer.
+
+    This function will attempt to retrieve the oldest signal with the
+    specified signal and domain from the shared memory signal buffer.  The
+    signal that was found (and returned to the caller) will be removed from
+    the signal list.  If there are no signal that matches the user's request,
+    this function will hang (on a semaphore) until an appropriate signal is
+    available before returning to the caller if requested.
+
+    If the signal list is not empty, the head of the list will be returned to
+    the caller.  This is also the oldest signal in the list since the signals
+    are added at the end of the list.
+
+    When calling this function, the bodySize should be the size of the data
+    buffer supplied as the "body" argument.  The smaller of either the body
+    buffer size or the number of bytes of data in the signal found will be
+    copied into the body buffer and the number of bytes copied will be
+    returned in bodySize.  The copy is made before the signal is removed from
+    the signal list and while the record is still protected from being
+    recycled, so the caller never looks at a record that may already have
+    been freed.  Callers that want to read the data in place should use
+    sm_fetch_lease instead.
+
+    Note that since this function does not alter the structure of the signal
+    list we don't need to lock the signal list semaphore during the processing
+    (except when we wait on an empty list).  We do lock the list of signal
+    instance records attached to the signalList however as we will be
+    modifying that list.
+
+    @param[in]  domain - The domain value of the signal to be removed.
+    @param[in]  signal - The signal ID value of the signal to be removed.
+    @param[in/out] bodySize - The size of the buffer on input and the number
+                              of bytes copied into it on output.
+    @param[out] body - The address of the buffer to copy the data into.
+    @param[in]  wait - If true, wait for data if domain/signal is not found.
+    @param[in]  deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                           waiting or NULL to wait forever.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
+
+    @return 0 if successful.
+            ENODATA - If waitForData == false and domain/signal is not found.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            any other value is an errno value.
+
+    TODO: Can we combine this function with sm_fetch_newest?
+------------------------------------------------------------------------*/
+int sm_fetch ( domain_t domain, signal_t signal, unsigned long* bodySize,
+               void* body, bool wait, const struct timespec* deadline,
+               signal_stamp* stamp )
+{
+    static const struct timespec noWait = { 0, 0 };
+
+    signal_data* signalData = NULL;
+    int          status     = 0;
+
+    LOG ( "Fetching signal domain[%d], signal[%d], bodySize[%p], "
+          "body[%p], wait[%d]\n", domain, signal, bodySize, body, wait );
+
+    SM_TRACE ( te_fetch, domain, signal, wait );
+
+    //
+    //  Go find the signal list control block for this domain and signal.
+    //
+    signal_list* signalList = findSignalList ( domain, signal );
+
+    //
+    //  If we didn't find this signal list control block then we need to just
+    //  return an error code to the caller.  This should only happen if we run
+    //  out of memory.
+    //
+    //  If this signal list was found but it is empty and we don't want to
+    //  wait for the data to arrive then just return the "no data" error code
+    //  to the caller and quit.
+    //
+    if ( !signalList || ( ( signalList->currentSignalCount == 0 ) && !wait ) )
+    {
+        LOG ( "Warning: Signal list for domain %d, signal %d was not found "
+              "or empty.\n", domain, signal );
+        return ENODATA;
+    }
+    //
+    //  Go wait if there are no signals in the signal list to be read.
+    //
+    //  Note that we will increment the "waiter" count during the time that we
+    //  are potentially waiting on the semaphore and decrement it again when
+    //  we come back from the wait.  This is used to tell the "fetch" logic
+    //  when it is OK to delete the signal that is being waited on.  If more
+    //  than one process is waiting on this signal then we want to give the
+    //  signal to all of the processes that are waiting before we delete the
+    //  signal from the signal list.
+    //
+    //  If we are not waiting for data, the wait gives up immediately.  If we
+    //  are released from the wait but the signal we were released for is
+    //  gone by the time we look for it (it was discarded by the retention
+    //  policy of the signal list or taken by someone else), we give back the
+    //  message count we took and go back to waiting until the same deadline.
+    //  Since the message count may then be wrong, we first wait for a signal
+    //  to actually be present.
+    //
+    // SL_LOCK ( signalList );
+
+    while ( true )
+    {
+        __atomic_add_fetch ( &signalList->semaphore.waiterCount, 1,
+                             __ATOMIC_RELAXED );
+
+        LOG ( "Before Fetch/semaphore wait sem: %p[%lu]\n",
+              &signalList->semaphore, toOffset ( &signalList->semaphore ) );
+
+        SEM_DUMP ( &signalList->semaphore );
+
+        if ( semaphoreWait ( &signalList->semaphore,
+                             wait ? deadline : &noWait ) != 0 )
+        {
+            __atomic_sub_fetch ( &signalList->semaphore.waiterCount, 1,
+                                 __ATOMIC_RELAXED );
+            return wait ? ETIMEDOUT : ENODATA;
+        }
+        __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                             __ATOMIC_RELAXED );
+
+        __atomic_sub_fetch ( &signalList->semaphore.waiterCount, 1,
+                             __ATOMIC_RELAXED );
+
+        LOG ( "After Fetch/semaphore wait:\n" );
+        SEM_DUMP ( &signalList->semaphore );
+
+        //
+        //  If this signal list is stored in a ring, copy the oldest signal
+        //  out of the ring and take it if no one else is waiting for it.  The
+        //  slot is released to the producers as soon as it is taken so it is
+        //  copied first.
+        //
+        if ( signalList->ringCapacity != 0 )
+        {
+            if ( sm_ring_fetch ( signalList, false,
+                                 signalList->semaphore.waiterCount <= 0,
+                                 bodySize, body, stamp ) == 0 )
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            //
+            //  The signal list is read inside an epoch protected section so
+            //  that the head record can't be freed by another fetcher while
+            //  we are looking at it.
+            //
+            sm_epoch_enter();
+
+            offset_t head = __atomic_load_n ( &signalList->head,
+                                              __ATOMIC_ACQUIRE );
+            bool     copied = false;
+
+            while ( head != END_OF_LIST_MARKER && ! copied )
+            {
+                //
+                //  Get the actual memory pointer to the current signal.
+                //
+                signalData = toAddress ( head );
+
+                //
+                //  Copy the signal data into the caller's buffer.  This is
+                //  done before the signal is removed and before we leave the
+                //  epoch protected section so that the record can't be
+                //  recycled while we are copying it.
+                //
+                copySignalData ( signalData, bodySize, body, stamp );
+
+                //
+                //  If no one else is now waiting for this signal, go remove
+                //  this signal from the signal list.  If someone else removed
+                //  it first, the signal we copied belongs to them so go copy
+                //  the new head of the list.
+                //
+                copied = signalList->semaphore.waiterCount > 0 ||
+                         sm_removeSignalIf ( signalList, head );
+                if ( ! copied )
+                {
+                    head = __atomic_load_n ( &signalList->head,
+                                             __ATOMIC_ACQUIRE );
+                }
+            }
+            sm_epoch_exit();
+
+            if ( copied )
+            {
+                break;
+            }
+        }
+        //
+        //  The signal we were released for is gone so give back the message
+        //  count we took and go wait for the next one.
+        //
+        __atomic_add_fetch ( &signalList->semaphore.messageCount, 1,
+                             __ATOMIC_RELAXED );
+
+        LOG ( "sm_fetch was released from wait but no data present\n" );
+
+        if ( ! wait )
+        {
+            return ENODATA;
+        }
+        if ( sm_wait_present ( signalList, deadline ) != 0 )
+        {
+            return ETIMEDOUT;
+        }
+    }
+    LOG ( "At the end of Fetch - waiterCount: %d\n", signalList->semaphore.waiterCount );
+
+    SEM_DUMP ( &signalList->semaphore );
+
+    //
+    //  Unlock the condition variable for this signal.
+    //
+    // SL_UNLOCK ( signalList );
+
+    //
+    //  Return the completion code to the caller.
+    //
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    l e a s e S i g n a l
+
+    @brief Pin the oldest or newest signal in a signal list.
+
+    This is the part of sm_fetch_lease that runs once the caller has been
+    released from the semaphore wait.  If the oldest signal is wanted and no
+    one else is waiting for it, it is removed from the signal list.
+
+    @param[in]  signalList - The address of the signal list to operate on.
+    @param[in]  newest - If true, pin the newest signal otherwise the oldest.
+    @param[out] record - The address of where to store the record address.
+
+    @return 0 if successful.
+            ENODATA - The signal list is empty.
+            ENOMEM - A record for a ring signal could not be allocated.
+
+------------------------------------------------------------------------*/
+static int leaseSignal ( signal_list* signalList, bool newest,
+                         signal_data** record )
+{
+    signal_data* signalData;
+
+    //
+    //  If this signal list is stored in a ring, copy the slot we want into a
+    //  new record that only the caller references.
+    //
+    if ( signalList->ringCapacity != 0 )
+    {
+        unsigned long size = signalList->ringSlotSize;
+
+        signalData = sm_malloc ( size + SIGNAL_DATA_HEADER_SIZE );
+        if ( signalData == NULL )
+        {
+            return ENOMEM;
+        }
+        if ( sm_ring_fetch ( signalList, newest,
+                             ! newest && signalList->semaphore.waiterCount <= 0,
+                             &size, signalData->data,
+                             &signalData->stamp ) != 0 )
+        {
+            sm_free ( signalData );
+            return ENODATA;
+        }
+        signalData->nextMessageOffset = END_OF_LIST_MARKER;
+        signalData->messageSize       = size;
+        signalData->referenceCount    = 1;
+
+        *record = signalData;
+
+        return 0;
+    }
+    //
+    //  Get the signal that we want and pin it.  This is done inside an epoch
+    //  protected section so that the record can't be freed between the time
+    //  we read it's offset and the time we pin it.  If it is being released
+    //  out from under us, there is no data to return.
+    //
+    sm_epoch_enter();
+
+    offset_t offset = newest ? signalList->tail : signalList->head;
+
+    if ( offset == END_OF_LIST_MARKER )
+    {
+        sm_epoch_exit();
+        return ENODATA;
+    }
+    signalData = toAddress ( offset );
+
+    bool pinned = sm_acquire_signal_data ( signalData );
+
+    sm_epoch_exit();
+
+    if ( ! pinned )
+    {
+        return ENODATA;
+    }
+    //
+    //  If we are consuming the oldest signal and no one else is now waiting
+    //  for it, go remove it from the signal list.  Our reference keeps the
+    //  record alive until the caller releases it.  If someone else removed
+    //  it first, it belongs to them so go pin the new oldest signal.
+    //
+    if ( ! newest && signalList->semaphore.waiterCount <= 0 &&
+         ! sm_removeSignalIf ( signalList, offset ) )
+    {
+        sm_release_signal_data ( signalData );
+
+        return leaseSignal ( signalList, newest, record );
+    }
+    *record = signalData;
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f e t c h _ l e a s e
+
+    @brief Pin the oldest or newest signal in a signal list.
+
+    This function waits for a signal exactly the same way that sm_fetch and
+    sm_fetch_newest do but instead of returning a pointer to the data, it
+    acquires a reference to the signal data record and returns the address of
+    the record.  The caller must release the reference with
+    sm_release_signal_data when it is done with the data.
+
+    If the oldest signal is requested, it is removed from the signal list
+    just as it is by sm_fetch.
+
+    Signals in a ring are copied into a new signal data record which is only
+    referenced by the caller.
+
+    @param[in]  domain - The domain value of the signal.
+    @param[in]  signal - The signal ID value of the signal.
+    @param[in]  newest - If true, pin the newest signal otherwise the oldest.
+    @param[in]  wait - If true, wait for data if the signal list is empty.
+    @param[in]  deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                           waiting or NULL to wait forever.
+    @param[out] record - The address of where to store the record address.
+
+    @return 0 if successful.
+            ENODATA - If wait == false and the signal list is empty.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            any other value is an errno value.
+
+------------------------------------------------------------------------*/
+int sm_fetch_lease ( domain_t domain, signal_t signal, bool newest, bool wait,
+                     const struct timespec* deadline, signal_data** record )
+{
+    static const struct timespec noWait = { 0, 0 };
+
+    signal_data* signalData = NULL;
+    int          status     = 0;
+
+    LOG ( "Leasing signal domain[%d], signal[%d], newest[%d], wait[%d]\n",
+          domain, signal, newest, wait );
+
+    SM_TRACE ( newest ? te_fetch_newest : te_fetch, domain, signal, wait );
+
+    //
+    //  Go find the signal list control block for this domain and signal.
+    //
+    signal_list* signalList = findSignalList ( domain, signal );
+
+    if ( !signalList || ( ( signalList->currentSignalCount == 0 ) && !wait ) )
+    {
+        LOG ( "Warning: Signal list for domain %d, signal %d was not found "
+              "or empty.\n", domain, signal );
+        return ENODATA;
+    }
+    //
+    //  Go wait if there are no signals in the signal list to be read.  See
+    //  sm_fetch for how the waiter count is used and for what happens when
+    //  the signal we were released for is gone.
+    //
+    while ( true )
+    {
+        __atomic_add_fetch ( &signalList->semaphore.waiterCount, 1,
+                             __ATOMIC_RELAXED );
+
+        if ( semaphoreWait ( &signalList->semaphore,
+                             wait ? deadline : &noWait ) != 0 )
+        {
+            __atomic_sub_fetch ( &signalList->semaphore.waiterCount, 1,
+                                 __ATOMIC_RELAXED );
+            return wait ? ETIMEDOUT : ENODATA;
+        }
+        if ( ! newest )
+        {
+            __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                                 __ATOMIC_RELAXED );
+        }
+        __atomic_sub_fetch ( &signalList->semaphore.waiterCount, 1,
+                             __ATOMIC_RELAXED );
+
+        status = leaseSignal ( signalList, newest, &signalData );
+        if ( status != ENODATA )
+        {
+            break;
+        }
+        if ( ! newest )
+        {
+            __atomic_add_fetch ( &signalList->semaphore.messageCount, 1,
+                                 __ATOMIC_RELAXED );
+        }
+        LOG ( "sm_fetch_lease was released from wait but no data present\n" );
+
+        if ( ! wait )
+        {
+            return ENODATA;
+        }
+        if ( sm_wait_present ( signalList, deadline ) != 0 )
+        {
+            return ETIMEDOUT;
+        }
+    }
+    if ( status == 0 )
+    {
+        *record = signalData;
+    }
+    else if ( ! newest )
+    {
+        __atomic_add_fetch ( &signalList->semaphore.messageCount, 1,
+                             __ATOMIC_RELAXED );
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f e t c h _ i n _ p l a c e
+
+    @brief Return the address of the oldest or newest signal's data.
+
+    This function implements the original contract of the vsi_core_fetch
+    functions, which return the address of the signal data in the shared
+    memory segment instead of copying it.  The signal is fetched with
+    sm_fetch_lease and the lease is handed to the caller along with the data
+    address.  The data stays valid until the caller gives the lease back by
+    passing the same address to sm_release_in_place.
+
+    @param[in]  domain - The domain value of the signal.
+    @param[in]  signal - The signal ID value of the signal.
+    @param[in]  newest - If true, return the newest signal otherwise remove
+                         and return the oldest one.
+    @param[out] bodySize - The address of where to store the data size.
+    @param[out] body - The address of where to store the data pointer.
+    @param[in]  wait - If true, wait for data if the signal list is empty.
+    @param[in]  deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                           waiting or NULL to wait forever.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
+
+    @return 0 if successful.  The caller must call sm_release_in_place with
+              the data address when it is done with the data.
+            ENODATA - If wait == false and the signal list is empty.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            any other value is an errno value.
+
+------------------------------------------------------------------------*/
+int sm_fetch_in_place ( domain_t domain, signal_t signal, bool newest,
+                        unsigned long* bodySize, void** body, bool wait,
+                        const struct timespec* deadline, signal_stamp* stamp )
+{
+    signal_data* record;
+
+    int status = sm_fetch_lease ( domain, signal, newest, wait, deadline,
+                                  &record );
+    if ( status == 0 )
+    {
+        *bodySize = record->messageSize;
+        *body     = record->data;
+
+        if ( stamp != NULL )
+        {
+            *stamp = record->stamp;
+        }
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ r e l e a s e _ i n _ p l a c e
+
+    @brief Release the lease on data returned by sm_fetch_in_place.
+
+    The data address that was returned is the "data" field at the end of a
+    leased signal data record so the record is found by backing up over the
+    record header.  The data must not be looked at after this call.
+
+    @param[in] body - The data address returned by sm_fetch_in_place.
+
+------------------------------------------------------------------------*/
+void sm_release_in_place ( void* body )
+{
+    if ( body != NULL )
+    {
+        sm_release_signal_data ( (signal_data*)( (char*)body -
+                                 offsetof ( signal_data, data ) ) );
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f e t c h _ n e w e s t
+
+    @brief Retrieve the newest signal from the signal list.
+
+    This function will attempt to retrieve the newest signal with the
+    specified signal and domain from the shared memory signal list.  The
+    signal that is found (and returned to the caller) will NOT be removed from
+    the signal list.  If there are no signals that match the user's request,
+    this function will hang (on a semaphore) until an appropriate signal is
+    available before returning to the caller depending on the setting of the
+    "wait" input parameter.
+
+    When calling this function, the bodySize should be the size of the data
+    buffer supplied as the "body" argument.  When we copy the data from the
+    shared memory segment to the "body" buffer, the smaller of either the body
+    buffer size or the number of bytes of data in the signal found will be
+    copied into the body buffer.  The actual number of data bytes copied will
+    be returned to the caller in the bodySize variable.  The copy is made
+    while the record is protected from being recycled by a concurrent fetch.
+
+    Note that since this function does not alter the structure of the signal
+    list we don't need to lock the signal list semaphore during the processing
+    (except when we wait on an empty list).
+
+    @param[in]  domain - The domain value of the signal to be removed.
+    @param[in]  signal - The signal value of the signal to be removed.
+    @param[in/out] bodySize - The size of the buffer on input and the number
+                              of bytes copied into it on output.
+    @param[out] body - The address of the buffer to copy the data into.
+    @param[in]  wait - If true, wait for data if domain/signal is not found.
+    @param[in]  deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                           waiting or NULL to wait forever.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
+
+    @return 0 if successful.
+            ENODATA - If waitForData == true and domain/signal is not found.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            any other value is an errno value.
+
+------------------------------------------------------------------------*/
+int sm_fetch_newest ( domain_t domain, signal_t signal, unsigned long* bodySize,
+                      void* body, bool wait, const struct timespec* deadline,
+                      signal_stamp* stamp )
+{
+    //
+    //  Define the local signal offset and pointer variables.
+    //
+    signal_list* signalList = NULL;
+    signal_data* signalData = NULL;
+    int          status     = 0;
+
+    LOG ( "Fetching newest signal domain[%d], signal[%d], wait[%d]\n", domain,
+          signal, wait );
+
+    SM_TRACE ( te_fetch_newest, domain, signal, wait );
+
+    //
+    //  Go find the signal list control block for this domain and signal.
+    //
+    signalList = findSignalList ( domain, signal );
+
+    //
+    //  If this signal list is empty and we don't want to wait for the data to
+    //  arrive then just return the "no data" error code to the caller and
+    //  quit.
+    //
+    if ( !signalList || ( signalList->currentSignalCount == 0 && !wait ) )
+    {
+        LOG ( "Signal list is empty - Returning error code 61 - ENODATA\n" );
+        return ENODATA;
+    }
+    //
+    //  Go wait if there are no messages in the signal list to be read.
+    //
+    //  Note that we will increment the "waiter" count during the time that we
+    //  are potentially waiting on the semaphore and decrement it again when
+    //  we come back from the wait.  This is used to tell the "fetch" logic
+    //  when it is OK to delete the signal that is being waited on.  If more
+    //  than one process is waiting on this signal then we want to give the
+    //  signal to all of the processes that are waiting before we delete the
+    //  signal from the signal list.
+    //
+    //  If the signal list is emptied by the time we look at it, we go back to
+    //  waiting until the same deadline.
+    //
+    // SL_LOCK ( signalList );
+
+    while ( true )
+    {
+        __atomic_add_fetch ( &signalList->semaphore.waiterCount, 1,
+                             __ATOMIC_RELAXED );
+
+        LOG ( "Before Fetch/semaphore wait sem: %p[%lu]\n",
+              &signalList->semaphore, toOffset ( &signalList->semaphore ) );
+
+        SEM_DUMP ( &signalList->semaphore );
+
+        status = semaphoreWait ( &signalList->semaphore, deadline );
+
+        __atomic_sub_fetch ( &signalList->semaphore.waiterCount, 1,
+                             __ATOMIC_RELAXED );
+
+        if ( status != 0 )
+        {
+            return status;
+        }
+
+        LOG ( "After Fetch/semaphore wait:\n" );
+        SEM_DUMP ( &signalList->semaphore );
+
+        //
+        //  If this signal list is stored in a ring, copy the newest published
+        //  slot in the ring.
+        //
+        if ( signalList->ringCapacity != 0 )
+        {
+            status = sm_ring_fetch ( signalList, true, false, bodySize, body,
+                                     stamp );
+        }
+        else
+        {
+            //
+            //  If we get here, there should be at least one signal in this
+            //  signal list.  At that point, we can take a look at the last
+            //  signal in the list.  This is done inside an epoch protected
+            //  section so that the record can't be freed by a fetcher while
+            //  we are looking at it.
+            //
+            sm_epoch_enter();
+
+            offset_t tail = signalList->tail;
+
+            if ( tail == END_OF_LIST_MARKER )
+            {
+                status = ENODATA;
+            }
+            else
+            {
+                signalData = toAddress ( tail );
+
+                //
+                //  Copy the message data into the caller's buffer before we
+                //  leave the epoch protected section.
+                //
+                copySignalData ( signalData, bodySize, body, stamp );
+            }
+            sm_epoch_exit();
+        }
+        if ( status != ENODATA || ! wait )
+        {
+            return status;
+        }
+        if ( sm_wait_present ( signalList, deadline ) != 0 )
+        {
+            return ETIMEDOUT;
+        }
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f e t c h _ l a t e s t
+
+    @brief Copy the newest signal from the signal list into a user buffer.
+
+    This function returns the same signal as sm_fetch_newest but copies the
+    data into the caller's buffer instead of returning a pointer into the
+    shared memory segment.  If the signal list is not empty, the data is
+    read from the latest value cache of the signal list without taking any
+    locks.  If the list is empty and the caller wants to wait, or the newest
+    signal is too large for the cache, the data is read with sm_fetch_newest
+    instead.
+
+    @param[in]  domain - The domain value of the signal to be read.
+    @param[in]  signal - The signal value of the signal to be read.
+    @param[in/out] bodySize - The size of the buffer on input and the number
+                              of bytes copied into it on output.
+    @param[out] body - The address of the buffer to copy the data into.
+    @param[in]  wait - If true, wait for data if domain/signal is not found.
+    @param[in]  deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                           waiting or NULL to wait forever.
+    @param[out] stamp - The address of where to store the stamp of the
+                        signal (may be NULL).
+
+    @return 0 if successful.
+            ENODATA - If wait == false and domain/signal is not found.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            any other value is an errno value.
+
+------------------------------------------------------------------------*/
+int sm_fetch_latest ( domain_t domain, signal_t signal, unsigned long* bodySize,
+                      void* body, bool wait, const struct timespec* deadline,
+                      signal_stamp* stamp )
+{
+    SM_TRACE ( te_fetch_latest, domain, signal, wait );
+
+    //
+    //  Go find the signal list control block for this domain and signal.
+    //
+    signal_list* signalList = findSignalList ( domain, signal );
+    if ( signalList == NULL )
+    {
+        return ENODATA;
+    }
+    //
+    //  If there is a signal in the list, try to read it from the latest value
+    //  cache.
+    //
+    if ( __atomic_load_n ( &signalList->currentSignalCount,
+                           __ATOMIC_ACQUIRE ) > 0 )
+    {
+        if ( sm_load_latest ( signalList, bodySize, body, stamp, NULL ) == 0 )
+        {
+            return 0;
+        }
+    }
+    else if ( ! wait )
+    {
+        return ENODATA;
+    }
+    //
+    //  The cache could not be used so get the newest signal from the signal
+    //  list itself.
+    //
+    return sm_fetch_newest ( domain, signal, bodySize, body, wait, deadline,
+                             stamp );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f e t c h _ r a n g e
+
+    @brief Copy the signals captured within a time range into user buffers.
+
+    This function copies every signal in the signal list whose timestamp is
+    within the (inclusive) range from beginTime to endTime into the caller's
+    result structures, oldest first.  None of the signals are removed from
+    the signal list.
+
+    The signals must be stored in a ring (see vsi_define_signal_ring).  They
+    are located with a binary search over the ring positions and then copied
+    without taking any locks.  Signals stored in a linked list can only be
+    reached by walking the list from it's head on every call so those are
+    rejected rather than making the cost of a query grow with the length of
+    the history.  The signals are assumed to have been inserted in capture
+    time order.
+
+    Each result structure must contain the address and size of the buffer
+    that the data of a signal is to be copied into just as it does for
+    vsi_get_newest_signal.
+
+    @param[in]  domain - The domain value of the signal to be read.
+    @param[in]  signal - The signal value of the signal to be read.
+    @param[in]  beginTime - The capture time of the oldest signal wanted.
+    @param[in]  endTime - The capture time of the newest signal wanted.
+    @param[out] results - The array of result structures to fill in.
+    @param[in/out] count - The number of result structures on input and
+                           the number that were filled in on output.
+
+    @return 0 if successful.
+            ENODATA - The signal list could not be found or created.
+            EOPNOTSUPP - The signal is not stored in a ring.
+
+------------------------------------------------------------------------*/
+int sm_fetch_range ( domain_t domain, signal_t signal, unsigned long beginTime,
+                     unsigned long endTime, vsi_result* results, size_t* count )
+{
+    signal_stamp stamp;
+    size_t       found = 0;
+
+    SM_TRACE ( te_fetch_range, domain, signal, *count );
+
+    //
+    //  Go find the signal list control block for this domain and signal.
+    //
+    signal_list* signalList = findSignalList ( domain, signal );
+
+    if ( signalList == NULL )
+    {
+        *count = 0;
+        return ENODATA;
+    }
+    //
+    //  Only rings can be searched by time.
+    //
+    if ( signalList->ringCapacity == 0 )
+    {
+        *count = 0;
+        return EOPNOTSUPP;
+    }
+    //
+    //  Find the first signal in the time range and then copy signals until
+    //  we get past the end of the range, run out of published signals or
+    //  fill the caller's results.
+    //
+    unsigned long head = __atomic_load_n ( &signalList->ringHead,
+                                           __ATOMIC_ACQUIRE );
+    unsigned long tail = __atomic_load_n ( &signalList->ringTail,
+                                           __ATOMIC_ACQUIRE );
+
+    unsigned long position = sm_ring_find_time ( signalList, head, tail,
+                                                 beginTime );
+    for ( ; position != tail && found < *count; ++position )
+    {
+        int status = sm_ring_read ( signalList, position, &stamp, NULL );
+
+        if ( status < 0 || ( status == 0 && stamp.timestamp > endTime ) )
+        {
+            break;
+        }
+        //
+        //  Copy the slot into the next result.  If it was consumed before we
+        //  could copy it, just move on to the next one.
+        //
+        if ( status == 0 &&
+             sm_ring_read ( signalList, position, &stamp,
+                            &results[found] ) == 0 )
+        {
+            results[found].timestamp = stamp.timestamp;
+            results[found].sequence  = stamp.sequence;
+            ++found;
+        }
+    }
+    *count = found;
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ c u r s o r _ s t a r t
+
+    @brief Position a cursor at the oldest signal in a signal list.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] cursor - The address of the cursor to be positioned.
+
+------------------------------------------------------------------------*/
+static void sm_cursor_start ( signal_list* signalList, signal_cursor* cursor )
+{
+    cursor->record   = END_OF_LIST_MARKER;
+    cursor->position = 0;
+
+    if ( signalList->ringCapacity != 0 )
+    {
+        cursor->position = __atomic_load_n ( &signalList->ringHead,
+                                             __ATOMIC_ACQUIRE );
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    c u r s o r R e o p e n
+
+    @brief Reactivate a cursor that has been deleted.
+
+    The cursor is claimed by storing SIGNAL_CURSOR_REOPENING and our process
+    ID in it's "active" field, positioned at the oldest signal in the list
+    and then made active.  If someone else is reopening it at the same time,
+    we yield until they are done since that only takes a few stores.  If the
+    process that claimed it died before it was done, the claim is taken back
+    and the cursor is reopened by us instead so that it is never stuck.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] cursor - The address of the cursor to reopen.
+
+------------------------------------------------------------------------*/
+static void cursorReopen ( signal_list* signalList, signal_cursor* cursor )
+{
+    unsigned long reopening = SIGNAL_CURSOR_REOPENING | (unsigned long)getpid();
+    unsigned long active    = __atomic_load_n ( &cursor->active,
+                                                __ATOMIC_ACQUIRE );
+    while ( active != 1 )
+    {
+        //
+        //  If the cursor is deleted, claim it and start it over at the
+        //  oldest signal.  If the claim fails, the compare and swap reloads
+        //  the active field and we look at it again.
+        //
+        if ( active == 0 )
+        {
+            if ( __atomic_compare_exchange_n ( &cursor->active, &active,
+                                               reopening, false,
+                                               __ATOMIC_ACQUIRE,
+                                               __ATOMIC_ACQUIRE ) )
+            {
+                sm_cursor_start ( signalList, cursor );
+                __atomic_store_n ( &cursor->active, 1, __ATOMIC_RELEASE );
+                return;
+            }
+            continue;
+        }
+        //
+        //  Someone else is reopening the cursor.  If they died before they
+        //  finished, put the cursor back to the deleted state.
+        //
+        pid_t owner = (pid_t)( active & ~SIGNAL_CURSOR_REOPENING );
+
+        if ( kill ( owner, 0 ) != 0 && errno == ESRCH )
+        {
+            LOG ( "Reclaiming cursor %s from dead process %d\n", cursor->name,
+                  owner );
+
+            __atomic_compare_exchange_n ( &cursor->active, &active, 0, false,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE );
+            continue;
+        }
+        sched_yield();
+
+        active = __atomic_load_n ( &cursor->active, __ATOMIC_ACQUIRE );
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ o p e n _ c u r s o r
+
+    @brief Find or create a named cursor on a signal list.
+
+    The cursors of the signal list are searched for one with the specified
+    name.  If none is found, a new cursor positioned at the oldest signal in
+    the list is pushed onto the front of the list of cursors.  If another
+    process pushes a cursor at the same time, the compare and swap fails and
+    the search is repeated so that two cursors with the same name can never
+    be created.
+
+    A cursor that was found but has been deleted is reactivated and
+    positioned at the oldest signal in the list just like a new one (see
+    cursorReopen).
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] name - The name of the cursor (shorter than
+                      SIGNAL_CURSOR_NAME_SIZE).
+
+    @return The address of the cursor or NULL if it could not be allocated.
+
+------------------------------------------------------------------------*/
+signal_cursor* sm_open_cursor ( signal_list* signalList, const char* name )
+{
+    signal_cursor* cursor;
+    signal_cursor* newCursor = NULL;
+
+    offset_t first = __atomic_load_n ( &signalList->cursors, __ATOMIC_ACQUIRE );
+
+    while ( true )
+    {
+        //
+        //  Look for an existing cursor with this name.  The "next" offset of
+        //  a cursor never changes once it is on the list.
+        //
+        offset_t offset = first;
+
+        while ( offset != END_OF_LIST_MARKER )
+        {
+            cursor = toAddress ( offset );
+
+            if ( strncmp ( cursor->name, name, SIGNAL_CURSOR_NAME_SIZE ) == 0 )
+            {
+                if ( newCursor != NULL )
+                {
+                    sm_free ( newCursor );
+                }
+                //
+                //  If the cursor was deleted, start it over at the oldest
+                //  signal.
+                //
+                cursorReopen ( signalList, cursor );
+
+                return cursor;
+            }
+            offset = cursor->next;
+        }
+        //
+        //  Allocate and initialize a new cursor the first time through.
+        //
+        if ( newCursor == NULL )
+        {
+            newCursor = sm_malloc ( sizeof(signal_cursor) );
+            if ( newCursor == NULL )
+            {
+                printf ( "Error: Unable to allocate a signal cursor - "
+                         "Shared memory segment is full!\n" );
+                return NULL;
+            }
+            memset ( newCursor->name, 0, SIGNAL_CURSOR_NAME_SIZE );
+            strncpy ( newCursor->name, name, SIGNAL_CURSOR_NAME_SIZE - 1 );
+
+            newCursor->active = 1;
+            sm_cursor_start ( signalList, newCursor );
+        }
+        //
+        //  Try to push the new cursor onto the front of the list.  If the
+        //  list changed, the compare and swap reloads the first offset and
+        //  we search the list again.
+        //
+        newCursor->next = first;
+
+        if ( __atomic_compare_exchange_n ( &signalList->cursors, &first,
+                                           toOffset ( newCursor ), false,
+                                           __ATOMIC_RELEASE,
+                                           __ATOMIC_ACQUIRE ) )
+        {
+            return newCursor;
+        }
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ c u r s o r _ r e c l a i m
+
+    @brief Remove the signals that every cursor has read past.
+
+    The oldest position of all of the active cursors on the signal list is
+    found and every signal before it is removed from the list.  Nothing is
+    removed if there are no active cursors on the list.
+
+    @param[in] signalList - The address of the signal list to operate on.
+
+------------------------------------------------------------------------*/
+static void sm_cursor_reclaim ( signal_list* signalList )
+{
+    unsigned long oldest = ULONG_MAX;
+    bool          found  = false;
+
+    offset_t offset = __atomic_load_n ( &signalList->cursors,
+                                        __ATOMIC_ACQUIRE );
+
+    while ( offset != END_OF_LIST_MARKER )
+    {
+        signal_cursor* cursor = toAddress ( offset );
+
+        if ( __atomic_load_n ( &cursor->active, __ATOMIC_ACQUIRE ) == 1 )
+        {
+            unsigned long position = __atomic_load_n ( &cursor->position,
+                                                       __ATOMIC_ACQUIRE );
+            if ( position < oldest )
+            {
+                oldest = position;
+            }
+            found = true;
+        }
+        offset = cursor->next;
+    }
+    if ( ! found )
+    {
+        return;
+    }
+    //
+    //  In a ring, the cursor positions are the positions of the next
+    //  signals to be read so every position before the oldest one can go.
+    //
+    //  Other cursors can be reclaiming the same signals at the same time so
+    //  only the position or signal that we looked at is removed.  If someone
+    //  else removed it first, we look at the new oldest one.
+    //
+    if ( signalList->ringCapacity != 0 )
+    {
+        unsigned long head = __atomic_load_n ( &signalList->ringHead,
+                                               __ATOMIC_ACQUIRE );
+
+        while ( (long)( head - oldest ) < 0 )
+        {
+            if ( sm_ring_remove_if ( signalList, head ) )
+            {
+                __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                                     __ATOMIC_RELAXED );
+            }
+            //
+            //  If the head did not move, the slot at the head has not been
+            //  published yet so there is nothing more to remove.
+            //
+            unsigned long newHead = __atomic_load_n ( &signalList->ringHead,
+                                                      __ATOMIC_ACQUIRE );
+            if ( newHead == head )
+            {
+                break;
+            }
+            head = newHead;
+        }
+        return;
+    }
+    //
+    //  In a linked list, the cursor positions are the sequence numbers of
+    //  the last signals read so every signal up to and including the oldest
+    //  one can go.  We stay inside an epoch protected section between looking
+    //  at the head and removing it so that it can't be recycled in between.
+    //
+    sm_epoch_enter();
+
+    while ( true )
+    {
+        offset_t head = __atomic_load_n ( &signalList->head, __ATOMIC_ACQUIRE );
+
+        if ( head == END_OF_LIST_MARKER ||
+             ((signal_data*)toAddress ( head ))->stamp.sequence > oldest )
+        {
+            break;
+        }
+        if ( sm_removeSignalIf ( signalList, head ) )
+        {
+            __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                                 __ATOMIC_RELAXED );
+        }
+    }
+    sm_epoch_exit();
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ c u r s o r _ n e x t
+
+    @brief Read the next signal after a cursor's position.
+
+    If a result is supplied, the signal is copied into it and the cursor is
+    advanced past it, otherwise only the stamp of the next signal is
+    returned and the cursor is not changed.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] cursor - The address of the cursor.
+    @param[out] result - The result to copy the signal into (may be NULL).
+    @param[out] stamp - The stamp of the signal.
+
+    @return 0 if successful
+            ENODATA - There is no signal after the cursor's position.
+
+------------------------------------------------------------------------*/
+static int sm_cursor_next ( signal_list*   signalList,
+                            signal_cursor* cursor,
+                            vsi_result*    result,
+                            signal_stamp*  stamp )
+{
+    //
+    //  If this signal list is stored in a ring, read the slot at the
+    //  cursor's position.  If that slot has already been consumed or
+    //  overwritten, skip forward to the oldest slot still in the ring.
+    //
+    if ( signalList->ringCapacity != 0 )
+    {
+        unsigned long position = cursor->position;
+
+        while ( true )
+        {
+            unsigned long head = __atomic_load_n ( &signalList->ringHead,
+                                                   __ATOMIC_ACQUIRE );
+            if ( (long)( position - head ) < 0 )
+            {
+                position = head;
+            }
+            int status = sm_ring_read ( signalList, position, stamp, result );
+
+            if ( status == 0 )
+            {
+                break;
+            }
+            if ( status < 0 )
+            {
+                return ENODATA;
+            }
+        }
+        if ( result != NULL )
+        {
+            __atomic_store_n ( &cursor->position, position + 1,
+                               __ATOMIC_RELEASE );
+        }
+        return 0;
+    }
+    //
+    //  Otherwise the next signal is the one after the last one that was read
+    //  if that one is still in the list.  If it isn't (or nothing has been
+    //  read yet), the next signal is the oldest one in the list.  This is
+    //  done inside an epoch protected section so that the records can't be
+    //  freed while we are looking at them.
+    //
+    sm_epoch_enter();
+
+    offset_t next = __atomic_load_n ( &signalList->head, __ATOMIC_ACQUIRE );
+
+    if ( next != END_OF_LIST_MARKER && cursor->record != END_OF_LIST_MARKER &&
+         ((signal_data*)toAddress ( next ))->stamp.sequence <= cursor->position )
+    {
+        signal_data* last = toAddress ( cursor->record );
+
+        next = __atomic_load_n ( &last->nextMessageOffset, __ATOMIC_ACQUIRE );
+    }
+    if ( next == END_OF_LIST_MARKER )
+    {
+        sm_epoch_exit();
+        return ENODATA;
+    }
+    signal_data* signalData = toAddress ( next );
+
+    *stamp = signalData->stamp;
+
+    if ( result != NULL )
+    {
+        unsigned long size = signalData->messageSize;
+
+        if ( size > result->dataLength )
+        {
+            size = result->dataLength;
+        }
+        memcpy ( result->data, signalData->data, size );
+        result->dataLength = size;
+
+        cursor->record = next;
+        __atomic_store_n ( &cursor->position, signalData->stamp.sequence,
+                           __ATOMIC_RELEASE );
+    }
+    sm_epoch_exit();
+
+    return 0;
+}
+
+
+//
+//  Define the context passed to sm_cursor_ready while waiting on a cursor.
+//
+typedef struct cursor_wait
+{
+    signal_list*   signalList;
+    signal_cursor* cursor;
+
+}   cursor_wait;
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ c u r s o r _ r e a d y
+
+    @brief Determine if a cursor has a signal to read.
+
+    This is the predicate passed to semaphoreWaitUntil by sm_read_cursor.
+
+    @param[in] context - The address of a cursor_wait structure.
+
+    @return true if there is a signal to be read.
+
+------------------------------------------------------------------------*/
+static bool sm_cursor_ready ( void* context )
+{
+    cursor_wait* cursorWait = context;
+    signal_stamp stamp;
+
+    return sm_cursor_next ( cursorWait->signalList, cursorWait->cursor, NULL,
+                            &stamp ) == 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ r e a d _ c u r s o r
+
+    @brief Read the next signal through a cursor.
+
+    The next signal after the cursor's position is copied into the caller's
+    result and the cursor is advanced past it.  Any signals that every
+    cursor on the signal list has now read past are then removed from the
+    list.
+
+    If a result is not supplied, this just checks for a signal to read
+    without advancing the cursor.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] cursor - The address of the cursor.
+    @param[out] result - The result to copy the signal into (may be NULL).
+    @param[out] stamp - The stamp of the signal.
+    @param[in] wait - If true, wait until there is a signal to read.
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                          waiting or NULL to wait forever.
+
+    @return 0 if successful
+            ENODATA - There is no signal to read and wait was false.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+
+------------------------------------------------------------------------*/
+int sm_read_cursor ( signal_list* signalList, signal_cursor* cursor,
+                     vsi_result* result, signal_stamp* stamp, bool wait,
+                     const struct timespec* deadline )
+{
+    cursor_wait cursorWait = { signalList, cursor };
+
+    while ( sm_cursor_next ( signalList, cursor, result, stamp ) != 0 )
+    {
+        if ( ! wait )
+        {
+            return ENODATA;
+        }
+        if ( semaphoreWaitUntil ( &signalList->semaphore, sm_cursor_ready,
+                                  &cursorWait, deadline ) != 0 )
+        {
+            return ETIMEDOUT;
+        }
+    }
+    if ( result != NULL )
+    {
+        sm_cursor_reclaim ( signalList );
+    }
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ d e l e t e _ c u r s o r
+
+    @brief Delete a named cursor from a signal list.
+
+    The cursor is marked inactive so that it no longer holds on to the
+    signals it has not read and those signals are removed if all of the
+    other cursors are done with them.  The cursor itself stays on the list
+    so that it can be reused if it is opened again.  Nothing is done if
+    there is no cursor with the specified name.
+
+    @param[in] signalList - The address of the signal list to operate on.
+    @param[in] name - The name of the cursor.
+
+------------------------------------------------------------------------*/
+void sm_delete_cursor ( signal_list* signalList, const char* name )
+{
+    offset_t offset = __atomic_load_n ( &signalList->cursors,
+                                        __ATOMIC_ACQUIRE );
+
+    while ( offset != END_OF_LIST_MARKER )
+    {
+        signal_cursor* cursor = toAddress ( offset );
+
+        if ( strncmp ( cursor->name, name, SIGNAL_CURSOR_NAME_SIZE ) == 0 )
+        {
+            __atomic_store_n ( &cursor->active, 0, __ATOMIC_RELEASE );
+
+            sm_cursor_reclaim ( signalList );
+            return;
+        }
+        offset = cursor->next;
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ f l u s h _ s i g n a l
+
+    @brief Flush all specified signals from the data store.
+
+    This function will find all signals in the data store with the specified
+    domain and signal value and remove them from the data store.
+
+    @param[in]  domain - The domain value of the message to be removed.
+    @param[in]  signal - The signal value of the message to be removed.
+
+    @return 0 if successful.
+            any other value is an errno value.
+
+------------------------------------------------------------------------*/
+int sm_flush_signal ( domain_t domain, signal_t signal )
+{
+    unsigned long count;
+    int           status = 0;
+
+    LOG ( "Flushing signal domain[%d], signal[%d]\n", domain, signal );
+
+    SM_TRACE ( te_flush, domain, signal, 0 );
+
+    //
+    //  Go find the signal list control block for this domain and signal.
+    //
+    signal_list* signalList = findSignalList ( domain, signal );
+
+    //
+    //  If this signal list doesn't exist or is empty then we don't need to do
+    //  anything.  In this case, just return a good completion code.
+    //
+    if ( signalList == NULL || signalList->currentSignalCount == 0 )
+    {
+        return 0;
+    }
+    //
+    //  Remove the oldest signal one at a time so that each of them is
+    //  claimed exactly the same way as when it is consumed or discarded by
+    //  the retention policy of the list, since consumers, cursors and
+    //  producers enforcing retention can be removing signals at the same
+    //  time.  No more signals are removed than were in the list when the
+    //  flush started so that a steady stream of new signals can't keep us
+    //  here forever.  Each signal we remove will never be consumed so it is
+    //  taken out of the semaphore's message count.
+    //
+    //  This works the same way whether the signals are stored in a ring or
+    //  in the linked list.
+    //
+    count = __atomic_load_n ( &signalList->currentSignalCount,
+                              __ATOMIC_ACQUIRE );
+
+    while ( count-- > 0 && sm_removeSignal ( signalList ) == 0 )
+    {
+        __atomic_sub_fetch ( &signalList->semaphore.messageCount, 1,
+                             __ATOMIC_RELAXED );
+    }
+    //
+    //  If anyone is waiting for this signal, go release them to search the
+    //  signal list again.
+    //
+    //  Note that this call may not return immediately if executing the post
+    //  resulted in another thread/process running.
+    //
+    semaphorePost ( &signalList->semaphore );
+
+    //
+    //  Return the completion code to the caller.
+    //
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    V S I   S i g n a l   G r o u p   F u n c t i o n s
+    ===================================================
+
+    g r o u p E x i s t s
+
+    This is a helper function that determines if the specified group currently
+    exists in the group btree.  This function is only used by the internal VSI
+    API functions.
+
+------------------------------------------------------------------------*/
+static bool groupExists ( const group_t groupId )
+{
+    vsi_signal_group  requestedSignalGroup = { 0 };
+    vsi_signal_group* signalGroup;
+
+    CHECK_AND_RETURN_IF_ERROR ( groupId );
+
+    requestedSignalGroup.groupId = groupId;
+
+    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedSignalGroup );
+
+    if ( signalGroup != NULL )
+    {
+        return true;
+    }
+    return false;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ a d d _ m e m b e r s h i p
+
+    @brief Record that a signal list is a member of a group.
+
+    A membership record of the signal list that is no longer in use is
+    reused if there is one, otherwise a new record is pushed onto the front
+    of the signal list's list of groups.
+
+    @param[in] signalList - The address of the signal list.
+    @param[in] signalGroup - The address of the group.
+
+    @return 0 if successful
+            ENOMEM - The membership record could not be allocated.
+
+------------------------------------------------------------------------*/
+static int sm_add_membership ( signal_list*      signalList,
+                               vsi_signal_group* signalGroup )
+{
+    offset_t group = toOffset ( signalGroup );
+
+    offset_t first = __atomic_load_n ( &signalList->groups, __ATOMIC_ACQUIRE );
+
+    //
+    //  Try to claim an unused membership record first.
+    //
+    for ( offset_t offset = first; offset != END_OF_LIST_MARKER; )
+    {
+        signal_membership* membership = toAddress ( offset );
+        offset_t           unused     = END_OF_LIST_MARKER;
+
+        if ( __atomic_compare_exchange_n ( &membership->group, &unused, group,
+                                           false, __ATOMIC_RELEASE,
+                                           __ATOMIC_RELAXED ) )
+        {
+            return 0;
+        }
+        offset = membership->next;
+    }
+    //
+    //  Otherwise push a new one onto the front of the list.
+    //
+    signal_membership* membership = sm_malloc ( sizeof(signal_membership) );
+    if ( membership == NULL )
+    {
+        printf ( "Error: Unable to allocate shared memory for a new signal "
+                 "membership record\n" );
+        return ENOMEM;
+    }
+    membership->group = group;
+
+    do
+    {
+        membership->next = first;
+
+    }   while ( ! __atomic_compare_exchange_n ( &signalList->groups, &first,
+                                                toOffset ( membership ), false,
+                                                __ATOMIC_RELEASE,
+                                                __ATOMIC_ACQUIRE ) );
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    s m _ r e m o v e _ m e m b e r s h i p
+
+    @brief Record that a signal list is no longer a member of a group.
+
+    @param[in] signalList - The address of the signal list.
+    @param[in] signalGroup - The address of the group.
+
+------------------------------------------------------------------------*/
+static void sm_remove_membership ( signal_list*      signalList,
+                                   vsi_signal_group* signalGroup )
+{
+    offset_t group  = toOffset ( signalGroup );
+    offset_t offset = __atomic_load_n ( &signalList->groups,
+                                        __ATOMIC_ACQUIRE );
+
+    while ( offset != END_OF_LIST_MARKER )
+    {
+        signal_membership* membership = toAddress ( offset );
+
+        if ( __atomic_load_n ( &membership->group, __ATOMIC_RELAXED ) == group )
+        {
+            __atomic_store_n ( &membership->group, END_OF_LIST_MARKER,
+                               __ATOMIC_RELEASE );
+            return;
+        }
+        offset = membership->next;
+    }
+}
+
+
+//
+//  Return true if a group has been deleted.
+//
+static inline bool groupDeleted ( vsi_signal_group* signalGroup )
+{
+    return ( __atomic_load_n ( &signalGroup->listenerCount,
+                               __ATOMIC_ACQUIRE ) & SIGNAL_GROUP_DELETED ) != 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    g r o u p M e m b e r s
+
+    @brief Get the member array of a group.
+
+    The count comes from the same member array that is returned so it always
+    matches it.  Unless the caller holds the group's mutex, it must be inside
+    an epoch protected section for as long as it looks at the array since
+    the array is retired when the members of the group change.
+
+    @param[in] signalGroup - The address of the group.
+    @param[out] count - The address of where to store the number of members.
+
+    @return The address of the array of signal list offsets of the members
+
+------------------------------------------------------------------------*/
+static offset_t* groupMembers ( vsi_signal_group* signalGroup, int* count )
+{
+    offset_t offset = __atomic_load_n ( &signalGroup->members,
+                                        __ATOMIC_ACQUIRE );
+    if ( offset == 0 )
+    {
+        *count = 0;
+        return NULL;
+    }
+    signal_group_members* array = toAddress ( offset );
+
+    *count = array->count;
+
+    return array->member;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    n e w G r o u p M e m b e r s
+
+    @brief Allocate a new member array for a group.
+
+    @param[in] count - The number of members the array holds.
+
+    @return The address of the new array or NULL if it could not be
+            allocated.
+
+------------------------------------------------------------------------*/
+static signal_group_members* newGroupMembers ( int count )
+{
+    signal_group_members* array =
+        sm_malloc ( sizeof(signal_group_members) + count * sizeof(offset_t) );
+
+    if ( array == NULL )
+    {
+        printf ( "Error: Unable to allocate shared memory for a group member "
+                 "array of %d members\n", count );
+        return NULL;
+    }
+    array->count = count;
+
+    return array;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    p u b l i s h G r o u p M e m b e r s
+
+    @brief Replace the member array of a group.
+
+    The new array is published with a release store so that a reader that
+    loads it sees all of it's members, and the old array is retired rather
+    than freed because other tasks may still be scanning it.  The caller
+    must hold the group's mutex.
+
+    @param[in] signalGroup - The address of the group.
+    @param[in] array - The address of the new member array.
+
+------------------------------------------------------------------------*/
+static void publishGroupMembers ( vsi_signal_group*     signalGroup,
+                                  signal_group_members* array )
+{
+    offset_t old = signalGroup->members;
+
+    __atomic_store_n ( &signalGroup->members, toOffset ( array ),
+                       __ATOMIC_RELEASE );
+    __atomic_store_n ( &signalGroup->count, array->count, __ATOMIC_RELEASE );
+
+    if ( old != 0 )
+    {
+        sm_retire ( toAddress ( old ) );
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    g r o u p L o c k
+
+    @brief Acquire the mutex of a group.
+
+    The mutex serializes the tasks that change the members of the group.
+    Readers of the member array never take it.
+
+    @param[in] signalGroup - The address of the group to lock.
+
+------------------------------------------------------------------------*/
+static void groupLock ( vsi_signal_group* signalGroup )
+{
+    int status = pthread_mutex_lock ( &signalGroup->mutex );
+
+    if ( status != 0 )
+    {
+        printf ( "Error: Unable to acquire the lock of group %u - %d[%s]\n",
+                 signalGroup->groupId, status, strerror(status) );
+    }
+}
+
+
+//
+//  Release the mutex of a group.
+//
+static inline void groupUnlock ( vsi_signal_group* signalGroup )
+{
+    pthread_mutex_unlock ( &signalGroup->mutex );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c r e a t e _ s i g n a l _ g r o u p
+
+    @brief Create a new signal group.
+
+------------------------------------------------------------------------*/
+int vsi_create_signal_group ( const group_t groupId )
+{
+    int status = 0;
+
+    LOG ( "Creating group %d\n", groupId );
+
+    CHECK_AND_RETURN_IF_ERROR ( groupId );
+
+    if ( groupExists ( groupId ) )
+    {
+        LOG ( "Error: group[%d] already exists\n", groupId );
+        return EINVAL;
+    }
+    vsi_signal_group* signalGroup = sm_malloc ( sizeof(vsi_signal_group) );
+
+    if ( signalGroup == NULL )
+    {
+        printf ( "ERROR: Unable to allocate shared memory for group\n" );
+        return ENOMEM;
+    }
+    //
+    //  Initialize the rest of the fields in the signal group data structure.
+    //
+    signalGroup->groupId       = groupId;
+    signalGroup->count         = 0;
+    signalGroup->members       = 0;
+    signalGroup->insertCount   = 0;
+    signalGroup->listenerCount = 0;
+
+    signalGroup->semaphore.messageCount = 0;
+    signalGroup->semaphore.waiterCount  = 0;
+    signalGroup->semaphore.futex        = 0;
+    signalGroup->semaphore.sleeperCount = 0;
+
+	//
+	//  Initialize the group record mutex.
+	//
+	status = pthread_mutex_init ( &signalGroup->mutex,
+								  &smControl->masterMutexAttributes );
+	if ( status != 0 )
+	{
+		printf ( "Unable to initialize the group mutex - errno: %u[%m].\n",
+				 status );
+		sm_free ( signalGroup );
+		return status;
+	}
+
+    LOG ( "  inserting into btree\n" );
+
+    status = btree_insert ( &vsiContext->groupIdIndex, signalGroup );
+
+    LOG ( "  returning %d\n", status );
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e l e t e _ s i g n a l _ g r o u p
+
+    @brief Delete an existing signal group.
+
+    Delete a signal group.  This function will delete the specified signal
+    group and release any shared memory occupied by it's members.  If there
+    are any signal lists associated with the group, they will not be deleted.
+
+------------------------------------------------------------------------*/
+int vsi_delete_signal_group ( const group_t groupId )
+{
+    int status = 0;
+
+    CHECK_AND_RETURN_IF_ERROR ( groupId );
+
+    //
+    //  Get the group object that the user specified.
+    //
+    vsi_signal_group  requestedGroup = { 0 };
+    vsi_signal_group* signalGroup;
+
+    requestedGroup.groupId = groupId;
+
+    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedGroup );
+
+    //
+    //  If the specified group does not exist, return an error code to the
+    //  caller.
+    //
+    if ( signalGroup == NULL )
+    {
+        return EINVAL;
+    }
+    //
+    //  Get the address of the member array of this group.  The group is
+    //  locked so that it's members can't change while we take them out of
+    //  the group.
+    //
+    groupLock ( signalGroup );
+
+    int       count;
+    offset_t* members = groupMembers ( signalGroup, &count );
+
+    //
+    //  Get the mask of any notifiers watching this group.
+    //
+    unsigned long mask = groupNotifierMask ( groupId );
+
+    //
+    //  For each of the signals in this group...
+    //
+	signal_list* signalList;
+
+    for ( int i = 0; i < count; ++i )
+    {
+        //
+        //  Get the address of the signal list structure.
+        //
+        signalList = toAddress ( members[i] );
+
+        //
+        //  Stop notifying anyone watching this group about this signal.
+        //
+        if ( mask != 0 )
+        {
+            __atomic_and_fetch ( &signalList->notifyMask, ~mask,
+                                 __ATOMIC_RELEASE );
+        }
+        sm_remove_membership ( signalList, signalGroup );
+
+#ifdef VSI_DEBUG
+        //
+        //  Go print the contents of the current signal structure.
+        //
+        LOG ( "%s      Removing... Domain: %d, Signal: %d, Name: %s\n", "",
+              signalList->domainId, signalList->signalId,
+              (char*)toAddress ( signalList->name ) );
+#endif
+    }
+    //
+    //  Go remove this signal group object from the group definition btree.
+    //
+    status = btree_delete ( &vsiContext->groupIdIndex, signalGroup );
+
+    //
+    //  Mark the group as deleted and wake up anyone listening to it so that
+    //  they give up on it.  Listeners check the flag before they look at the
+    //  member array so it can be retired now.
+    //
+    unsigned int listeners = __atomic_fetch_or ( &signalGroup->listenerCount,
+                                                 SIGNAL_GROUP_DELETED,
+                                                 __ATOMIC_SEQ_CST );
+
+    __atomic_add_fetch ( &signalGroup->insertCount, 1, __ATOMIC_RELEASE );
+
+    semaphorePost ( &signalGroup->semaphore );
+
+    //
+    //  Give the member array back to the memory manager once nobody can still
+    //  be scanning it.
+    //
+    if ( signalGroup->members != 0 )
+    {
+        sm_retire ( toAddress ( signalGroup->members ) );
+    }
+    groupUnlock ( signalGroup );
+
+    //
+    //  Give the signal group object back to the memory manager once no
+    //  inserts can still be notifying it (see sm_post_groups).  If anyone is
+    //  still listening to it, the last listener to leave does this.
+    //
+    if ( listeners == 0 )
+    {
+        sm_retire ( signalGroup );
+    }
+
+    //
+    //  Return the completion status back to the caller.
+    //
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ f e t c h _ s i g n a l _ g r o u p
+
+    @brief Find and return an existing signal group.
+
+    Fetch a signal group definition structure.  This function will find and
+    return the specified signal group structure.
+
+------------------------------------------------------------------------*/
+vsi_signal_group* vsi_fetch_signal_group ( const group_t groupId )
+{
+    LOG ( "vsi_fetch_signal_group called with group: %u\n", groupId );
+
+    //
+    //  Get the group object that the user specified.
+    //
+    vsi_signal_group  requestedGroup = { 0 };
+    vsi_signal_group* signalGroup;
+
+    requestedGroup.groupId = groupId;
+
+    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedGroup );
+
+    LOG ( "  vsi_fetch_signal_group returning signal group: %p\n", signalGroup );
+
+    if ( signalGroup )
+    {
+        printSignalGroup ( "   ", signalGroup );
+    }
+    else
+    {
+        LOG ( "Warning: groupId[%u] was NOT found! (in vsi_fetch_signal_group)\n",
+              groupId );
+    }
+    //
+    //  Return the address of the signal group structure.  Note that this will
+    //  return a NULL pointer if the group could not be found.
+    //
+    return signalGroup;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ a d d _ s i g n a l _ t o _ g r o u p
+
+    @brief Add a new signal to the specified group.
+
+    This function will add a new signal to the specified group.  New signals
+    will be added to the end of the group's member array.
+
+    The member array is replaced with a copy that holds the new member while
+    the group's mutex is held (see vsi_signal_group).  All of this is done
+    inside an epoch protected section so that the group record can't be
+    reclaimed if the group is deleted while we are looking at it.
+
+------------------------------------------------------------------------*/
+static int addSignalToGroup ( const domain_t domainId,
+                              const signal_t signalId,
+                              const group_t  groupId )
+{
+    vsi_signal_group* signalGroup = 0;
+
+    //
+    //  Go find the group record for this groupId.
+    //
+    signalGroup = vsi_fetch_signal_group ( groupId );
+
+    //
+    //  If the group record was not found, return an error code to the caller
+    //  and quit.
+    //
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+    //
+    //  Go find the signal list for this domain/signal.
+    //
+    signal_list* signalList = findSignalList ( domainId, signalId );
+
+    //
+    //  If the could not be found or created, return an error code to the
+    //  caller.
+    //
+    if ( signalList == NULL )
+    {
+        return ENOMEM;
+    }
+    //
+    //  Lock the group so that no one else changes it's members while we
+    //  build the new member array.  If the group was deleted while we were
+    //  looking it up, there is nothing to add the signal to.
+    //
+    groupLock ( signalGroup );
+
+    if ( groupDeleted ( signalGroup ) )
+    {
+        groupUnlock ( signalGroup );
+        return ENOENT;
+    }
+	//
+    //	Make sure that the new signal is not already a member of the group.
+	//
+    int       count;
+    offset_t  newMember = toOffset ( signalList );
+    offset_t* members   = groupMembers ( signalGroup, &count );
+
+    for ( int i = 0; i < count; ++i )
+    {
+        //
+        //  If this member is the signal list we are trying to add, then we
+        //  have run into a duplicate signal.  In this case, just output an
+        //  error message and return an error code to the caller.
+        //
+        if ( members[i] == newMember )
+        {
+            groupUnlock ( signalGroup );
+
+            printf ( "WARNING: Attempting to add domain[%d], signal[%d] to "
+                     "group[%d] which already exists - Ignored\n",
+                     domainId, signalId, groupId );
+            return EINVAL;
+        }
+    }
+    //
+    //  Build a new member array with the new member at the end of it.  The
+    //  current array is never modified since other tasks may be scanning it.
+    //
+    signal_group_members* newMembers = newGroupMembers ( count + 1 );
+
+    if ( newMembers == NULL )
+    {
+        groupUnlock ( signalGroup );
+        return ENOMEM;
+    }
+    if ( count != 0 )
+    {
+        memcpy ( newMembers->member, members, count * sizeof(offset_t) );
+    }
+    newMembers->member[count] = newMember;
+
+    //
+    //  Add this group to the list of groups the signal is a member of so
+    //  that inserts into the signal notify the group.
+    //
+    if ( sm_add_membership ( signalList, signalGroup ) != 0 )
+    {
+        groupUnlock ( signalGroup );
+        sm_free ( newMembers );
+        return ENOMEM;
+    }
+    //
+    //  Replace the member array of the group with the new one.
+    //
+    publishGroupMembers ( signalGroup, newMembers );
+
+    //
+    //  If anyone is watching this group with a notifier, they need to be
+    //  notified when this signal is inserted as well.
+    //
+    unsigned long mask = groupNotifierMask ( groupId );
+    if ( mask != 0 )
+    {
+        __atomic_or_fetch ( &signalList->notifyMask, mask, __ATOMIC_RELEASE );
+    }
+    groupUnlock ( signalGroup );
+
+    //
+    //  Return a good completion code to the caller.
+    //
+    printSignalGroup ( "", signalGroup );
+    return 0;
+}
+
+
+int vsi_add_signal_to_group ( const domain_t domainId,
+                              const signal_t signalId,
+                              const group_t  groupId )
+{
+    LOG ( "vsi_add_signal_to_group called with: %d,%d group %d\n", domainId,
+          signalId, groupId );
+
+    sm_epoch_enter();
+
+    int status = addSignalToGroup ( domainId, signalId, groupId );
+
+    sm_epoch_exit();
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ a d d _ s i g n a l _ t o _ g r o u p _ b y _ n a m e
+
+    @brief Add a new signal to the specified group by name.
+
+    This function will add a new signal to the specified group.
+
+------------------------------------------------------------------------*/
+int vsi_add_signal_to_group_by_name ( const domain_t domainId,
+                                      const char*    name,
+                                      const group_t  groupId )
+{
+    signal_t signalId;
+
+    vsi_name_string_to_id ( domainId, name, &signalId );
+
+    return vsi_add_signal_to_group ( domainId, signalId, groupId );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ r e m o v e _ s i g n a l _ f r o m _ g r o u p
+
+    @brief Remove a signal from the specified group.
+
+    This function will remove a signal from the specified group.  The member
+    array is replaced with a copy that leaves out the signal while the
+    group's mutex is held (see vsi_signal_group) so the members that follow
+    it stay in the order they were added.  All of this is done inside an
+    epoch protected section so that the group record can't be reclaimed if
+    the group is deleted while we are looking at it.
+
+------------------------------------------------------------------------*/
+static int removeSignalFromGroup ( const domain_t domainId,
+                                   const signal_t signalId,
+                                   const group_t  groupId )
+{
+    vsi_signal_group* signalGroup;
+    signal_list*      signalList;
+
+    //
+    //  Go find the group record for this groupId.
+    //
+    signalGroup = vsi_fetch_signal_group ( groupId );
+
+    //
+    //  If the group record was not found, return an error code to the caller
+    //  and quit.
+    //
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+    //
+    //  Lock the group so that no one else changes it's members while we
+    //  build the new member array.
+    //
+    groupLock ( signalGroup );
+
+    if ( groupDeleted ( signalGroup ) )
+    {
+        groupUnlock ( signalGroup );
+        return ENOENT;
+    }
+    //
+    //  For each of the signals in the group...
+    //
+    int       count;
+    offset_t* members = groupMembers ( signalGroup, &count );
+
+    for ( int i = 0; i < count; ++i )
+    {
+        //
+        //  Get the pointer to the signal list of this member.
+        //
+        signalList = toAddress ( members[i] );
+
+        //
+        //  If this is not the signal that we are looking for, keep looking.
+        //
+        if ( signalList->domainId != domainId ||
+             signalList->signalId != signalId )
+        {
+            continue;
+        }
+        //
+        //  Build a new member array without this member.  The current array
+        //  is never modified since other tasks may be scanning it.
+        //
+        signal_group_members* newMembers = newGroupMembers ( count - 1 );
+
+        if ( newMembers == NULL )
+        {
+            groupUnlock ( signalGroup );
+            return ENOMEM;
+        }
+        memcpy ( newMembers->member, members, i * sizeof(offset_t) );
+        memcpy ( &newMembers->member[i], &members[i + 1],
+                 ( count - i - 1 ) * sizeof(offset_t) );
+
+        //
+        //  Replace the member array of the group with the new one.
+        //
+        publishGroupMembers ( signalGroup, newMembers );
+
+        //
+        //  Stop notifying anyone watching this group about this signal.
+        //
+        __atomic_and_fetch ( &signalList->notifyMask,
+                             ~groupNotifierMask ( groupId ),
+                             __ATOMIC_RELEASE );
+
+        sm_remove_membership ( signalList, signalGroup );
+
+        groupUnlock ( signalGroup );
+
+        //
+        //  Wake up anyone listening to the group since they may have been
+        //  waiting only for this signal.
+        //
+        __atomic_add_fetch ( &signalGroup->insertCount, 1, __ATOMIC_RELEASE );
+        semaphorePost ( &signalGroup->semaphore );
+
+        //
+        //  Return a good completion code to the caller.
+        //
+        return 0;
+    }
+    groupUnlock ( signalGroup );
+
+    //
+    //  If we get here, the specified domain/signal were not found in any of
+    //  the signal structures associated with this group.  In this case,
+    //  return a "not found" error to the caller.
+    //
+    return ENOENT;
+}
+
+
+int vsi_remove_signal_from_group ( const domain_t domainId,
+                                   const signal_t signalId,
+                                   const group_t  groupId )
+{
+    sm_epoch_enter();
+
+    int status = removeSignalFromGroup ( domainId, signalId, groupId );
+
+    sm_epoch_exit();
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ r e m o v e _ s i g n a l _ f r o m _ g r o u p _ b y _ n a m e
+
+    @brief Remove a signal from the specified group by name.
+
+    This function will add a new signal to the specified group.
+
+------------------------------------------------------------------------*/
+int vsi_remove_signal_from_group_by_name ( const domain_t domainId,
+                                           const char*    name,
+                                           const group_t  groupId )
+{
+    signal_t signalId;
+
+    vsi_name_string_to_id ( domainId, name, &signalId );
+
+    return vsi_remove_signal_from_group ( domainId, signalId, groupId );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    V S I   S i g n a l   P r o c e s s i n g
+    =========================================
+
+    TODO: Note that the code in all of the functions below that operate on
+    everything in a group is similar.  It would be a good idea to abstract
+    these operations and use a callback function to specify the specific
+    operation to be performed by a generic iterator.
+
+
+    v s i _ g e t _ n e w e s t _ i n _ g r o u p
+
+    @brief Get the newest signal available for all signals in a group.
+
+    This function will fetch the newest (the one with the most recent
+    timestamp) signal available for each member signal in the specified group.
+
+    Note that the result pointer in this case MUST be a pointer to an array of
+    result structures sufficiently large to contain one structure for each
+    member of the group.  The newest signal information for each member of the
+    group will be returned in one of the result structures.  Each result
+    structure will also contain the completion code for the signal fetch
+    operation that it represents so it is entirely possible for some signals
+    to have good completion codes and some to have errors (if a signal does
+    not have any data for instance).
+
+    All of the results are retrieved in the "no wait" mode so any signals that
+    do not contain any data will have an error code returned for them
+    indicating that there was no data available for that signal.
+
+    Also note that none of the signal information will be removed from the
+    database during this operation.  Fetches of the "newest" signal data do
+    not automatically delete that information from the database.
+
+    The values returned are a consistent snapshot of the group.  The latest
+    value cache of every member is copied without taking any locks and the
+    copy is repeated if the sequence lock of any member changed while it was
+    being made, so all of the values were the newest values of their signals
+    at the same instant.
+
+    The copy is only repeated SIGNAL_SNAPSHOT_ATTEMPTS times so that a group
+    whose members are being written faster than they can be copied can't
+    keep us here forever.  Taking the group mutex would not help since
+    inserts never take it.  If every attempt was disturbed, the values of
+    the last attempt are left in the results and EAGAIN is returned.  Each
+    of those values was the newest value of it's signal when it was copied
+    but they may not all be from the same instant, so the caller can decide
+    whether to use them or to try again.
+
+------------------------------------------------------------------------*/
+//
+//  Define the sequence used for the members of a group snapshot that do not
+//  have to be checked for changes.
+//
+#define SIGNAL_SNAPSHOT_UNUSED ( ~0UL )
+
+//
+//  Define the number of times a group snapshot is attempted before giving up
+//  on getting a consistent one.
+//
+#define SIGNAL_SNAPSHOT_ATTEMPTS ( 16 )
+
+int vsi_get_newest_in_group ( const group_t groupId,
+                              vsi_result*   results )
+{
+    vsi_signal_group* signalGroup = 0;
+    signal_list*      signalList = 0;
+    vsi_result*       result = 0;
+    int               groupCount = 0;
+    int               i = 0;
+    int               attempts = 0;
+    bool              changed = false;
+
+    LOG ( "Called vsi_get_newest_in_group with group: %u\n", groupId );
+
+    //
+    //  Make sure the inputs are all present.
+    //
+    CHECK_AND_RETURN_IF_ERROR ( ( groupId && results ) );
+
+    //
+    //  Go get the signal group structure for the specified group id.
+    //
+    signalGroup = vsi_fetch_signal_group ( groupId );
+
+    //
+    //  If the group id specified does not exist, return an error code to the
+    //  caller.
+    //
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+    if ( groupCount == 0 )
+    {
+        sm_epoch_exit();
+        return 0;
+    }
+    //
+    //  Allocate the arrays that hold the signal list of each member, the size
+    //  of the buffer the caller supplied for it and the latest value sequence
+    //  it's data was copied at.
+    //
+    signal_list**  signalLists = malloc ( groupCount * sizeof(signal_list*) );
+    unsigned long* bufferSizes = malloc ( groupCount * sizeof(unsigned long) );
+    unsigned long* sequences   = malloc ( groupCount * sizeof(unsigned long) );
+
+    if ( signalLists == NULL || bufferSizes == NULL || sequences == NULL )
+    {
+        free ( signalLists );
+        free ( bufferSizes );
+        free ( sequences );
+        sm_epoch_exit();
+        return ENOMEM;
+    }
+    //
+    //  Get the signal list of every member of the group from the member
+    //  array rather than looking each one up in the signal B-tree.
+    //
+    for ( i = 0; i < groupCount; ++i )
+    {
+        signalList = toAddress ( members[i] );
+
+        signalLists[i] = signalList;
+        bufferSizes[i] = results[i].dataLength;
+
+        results[i].domainId = signalList->domainId;
+        results[i].signalId = signalList->signalId;
+    }
+    sm_epoch_exit();
+
+    //
+    //  Copy the latest value cache of every member and then check that none
+    //  of the caches changed while we were doing that.  If none of them did,
+    //  all of the values were the newest values of their signals at the same
+    //  instant (the end of the copy) so the set is consistent.  If any of
+    //  them changed, we copy all of them again unless we have run out of
+    //  attempts.
+    //
+    do
+    {
+        for ( i = 0; i < groupCount; ++i )
+        {
+            result = &results[i];
+            signalList = signalLists[i];
+            sequences[i] = SIGNAL_SNAPSHOT_UNUSED;
+
+            if ( result->data == NULL || bufferSizes[i] == 0 )
+            {
+                result->status = EINVAL;
+                continue;
+            }
+            if ( __atomic_load_n ( &signalList->currentSignalCount,
+                                   __ATOMIC_ACQUIRE ) == 0 )
+            {
+                sequences[i] = __atomic_load_n ( &signalList->latestSequence,
+                                                 __ATOMIC_ACQUIRE );
+                result->status = ENODATA;
+                continue;
+            }
+            signal_stamp stamp = { 0 };
+
+            result->dataLength = bufferSizes[i];
+            result->status = sm_load_latest ( signalList, &result->dataLength,
+                                              result->data, &stamp,
+                                              &sequences[i] );
+            //
+            //  If the newest signal is not available from the cache, get it
+            //  from the signal list itself.  The cache sequence still tells
+            //  us if another signal was stored while we were getting it.
+            //
+            if ( result->status == EAGAIN )
+            {
+                sequences[i] = __atomic_load_n ( &signalList->latestSequence,
+                                                 __ATOMIC_ACQUIRE );
+
+                result->status = sm_fetch_latest ( result->domainId,
+                                                   result->signalId,
+                                                   &result->dataLength,
+                                                   result->data, false, NULL,
+                                                   &stamp );
+            }
+            result->timestamp = stamp.timestamp;
+            result->sequence  = stamp.sequence;
+        }
+        //
+        //  Make sure all of the copies are complete before we look at the
+        //  sequences again.
+        //
+        __atomic_thread_fence ( __ATOMIC_ACQUIRE );
+
+        changed = false;
+        for ( i = 0; i < groupCount && ! changed; ++i )
+        {
+            changed = sequences[i] != SIGNAL_SNAPSHOT_UNUSED &&
+                      __atomic_load_n ( &signalLists[i]->latestSequence,
+                                        __ATOMIC_RELAXED ) != sequences[i];
+        }
+    }   while ( changed && ++attempts < SIGNAL_SNAPSHOT_ATTEMPTS );
+
+    free ( signalLists );
+    free ( bufferSizes );
+    free ( sequences );
+
+    //
+    //  If the last attempt was still disturbed, tell the caller that the
+    //  results are not a consistent snapshot.
+    //
+    if ( changed )
+    {
+        LOG ( "Warning: No consistent snapshot of group %u after %d "
+              "attempts\n", groupId, attempts );
+        return EAGAIN;
+    }
+    //
+    //  Return a good completion code to the caller.
+    //
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ n e w e s t _ i n _ g r o u p _ w a i t
+
+    @brief Retrieve the newest signal for every member of the specified group.
+
+    TODO: WARNING: Unimplemented!
+
+    The newest member of each signal in the specified group will be retrieved
+    and stored in the result array.  If any of the signals in the group do not
+    contain any members, execution will be suspended for the current thread
+    until some data is received for that member.  When execution resumes, the
+    next signal will be fetched and so forth until all of the signals have
+    been retrieved.  At that point this function will return to the caller.
+
+    The groupId is the numeric group ID previously assigned to the group being
+    operated on.
+
+    In the case of this group fetch function, the result pointer is not a
+    pointer to a single vsi_result structure instance, it is a pointer to an
+    array of vsi_result structure instances.  The number of data structures
+    must be at least as large as the number of signals defined in the
+    specified group.  Failure to allocate enough space for the return data
+    will result in memory corruption and undefined behavior (almost always
+    very bad!).
+
+    The signal data that is retrieved and returned to the caller will NOT be
+    removed from the VSI core database once it is copied into the result
+    structures.
+
+    @param[in] - groupId - The ID value of the group to be modified.
+    @param[in/out] - result - The array of structures that will hold the data.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_get_newest_in_group_wait ( const group_t groupId,
+                                   vsi_result*   result )
+{
+    printf ( "Warning: Unimplemented function \"vsi_get_newest_in_group_wait\" "
+             "called - Call ignored!\n" );
+
+    return ENOSYS;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ o l d e s t _ i n _ g r o u p
+
+    @brief Get the oldest signal available for all signals in a group.
+
+    This function will fetch the oldest (the one with the least recent
+    timestamp) signal available for each member signal in the specified group.
+
+    Note that the result pointer in this case MUST be a pointer to an array of
+    result structures sufficiently large to contain one structure for each
+    member of the group.  The oldest signal information for each member of the
+    group will be returned in one of the result structures.  Each result
+    structure will also contain the completion code for the signal fetch
+    operation that it represents so it is entirely possible for some signals
+    to have good completion codes and some to have errors (if a signal does
+    not have any data for instance).
+
+    All of the results are retrieved in the "no wait" mode so any signals that
+    do not contain any data will have an error code returned for them
+    indicating that there was no data available for that signal.
+
+    Also note that the signal information retrieved will be removed from the
+    database during this operation.  Fetches of the "oldest" signal data
+    automatically delete that information from the database.
+
+------------------------------------------------------------------------*/
+int vsi_get_oldest_in_group ( const group_t groupId,
+                              vsi_result*   results )
+{
+    int               groupCount = 0;
+    vsi_signal_group* signalGroup = 0;
+    signal_list*      signalList = 0;
+    vsi_result*       result = 0;
+
+    LOG ( "Called vsi_get_oldest_in_group with group: %u, results: %p\n",
+          groupId, results );
+    //
+    //  Make sure the inputs are all present.
+    //
+    CHECK_AND_RETURN_IF_ERROR ( groupId && results );
+
+    //
+    //  Go get the signal group structure for the specified group id.
+    //
+    signalGroup = vsi_fetch_signal_group ( groupId );
+
+    LOG ( "  Signal group found: %p\n", signalGroup );
+
+    //
+    //  If the group id specified does not exist, return an error code to the
+    //  caller.
+    //
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+    //
+    //  For each of the signals in the group...
+    //
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    for ( int i = 0; i < groupCount; ++i )
+    {
+        //
+        //  Get the pointer to the signal list of this member.
+        //
+        signalList = toAddress ( members[i] );
+
+        LOG ( "  Found signal %u, %u\n", signalList->domainId,
+              signalList->signalId );
+		//
+		//  Populate the current result structure with the signal
+		//  identification information.
+		//
+        result = &results[i];
+
+		result->domainId    = signalList->domainId;
+		result->signalId    = signalList->signalId;
+		result->name        = toAddress ( signalList->name );
+		result->data        = NULL;
+		result->literalData = 0;
+        result->dataLength  = 0;
+
+        //
+        //  Go get the oldest entry in the database for this signal.
+        //
+        //  Note that the return information will be populated in the result
+        //  object that is passed in.
+        //
+        vsi_get_oldest_signal ( result );
+
+        //
+        //  Display the result that was found.
+        //
+        PRINT_RESULT ( result, NULL );
+    }
+    sm_epoch_exit();
+
+    //
+    //  Return a good completion code to the caller.
+    //
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ o l d e s t _ i n _ g r o u p _ w a i t
+
+    @brief Retrieve the oldest signal for every member of the specified group.
+
+    The groupId is the numeric group ID previously assigned to the group being
+    operated on.
+
+    In the case of this group fetch function, the result pointer is not a
+    pointer to a single vsi_result structure instance, it is a pointer to an
+    array of vsi_result structure instances.  The number of data structures
+    must be at least as large as the number of signals defined in the
+    specified group.  Failure to allocate enough space for the return data
+    will result in memory corruption and undefined behavior (almost always
+    very bad!).
+
+    The signal data that is retrieved and returned to the caller will be
+    removed from the VSI core database once it is copied into the result
+    structures.
+
+    @param[in] - groupId - The ID value of the group to be modified.
+    @param[in/out] - result - The array of structures that will hold the data.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_get_oldest_in_group_wait ( const group_t groupId,
+                                   vsi_result*   results )
+{
+    return vsi_get_oldest_in_group_wait_until ( groupId, results, NULL );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ o l d e s t _ i n _ g r o u p _ w a i t _ u n t i l
+
+    @brief Wait for a signal in the specified group with a deadline.
+
+    @param[in] - groupId - The ID value of the group to be modified.
+    @param[in/out] - result - The array of structures that will hold the data.
+    @param[in] - deadline - The absolute CLOCK_MONOTONIC time at which to
+                            stop waiting or NULL to wait forever.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_get_oldest_in_group_wait_until ( const group_t          groupId,
+                                         vsi_result*            results,
+                                         const struct timespec* deadline )
+{
+    int status = 0;
+
+    LOG ( "Called vsi_get_oldest_in_group_wait_until with group: %u, "
+          "results: %p\n", groupId, results );
+
+    //
+    //  Go wait for a signal on any of the signals in the specified group.
+    //
+    status = vsi_listen_any_in_group_until ( groupId, deadline, results );
+
+    if ( status != 0 )
+    {
+        LOG ( "Warning: Error[%d-%s] returned by "
+              "vsi_listen_any_in_group_until.\n", status, strerror(status) );
+
+        return status;
+    }
+
+    LOG ( "  Signal seen for domain[%u], signal[%u]\n", results->domainId,
+          results->signalId );
+    //
+    //  Return the oldest value in all of the signals of the group.
+    //
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    d e a d l i n e A f t e r
+
+    @brief Compute the deadline that is a relative timeout from now.
+
+    @param[out] deadline - The absolute CLOCK_MONOTONIC deadline.
+    @param[in] timeout - The timeout value in nanoseconds.
+
+------------------------------------------------------------------------*/
+static void deadlineAfter ( struct timespec* deadline, unsigned long timeout )
+{
+    clock_gettime ( CLOCK_MONOTONIC, deadline );
+
+    deadline->tv_sec  += timeout / 1000000000;
+    deadline->tv_nsec += timeout % 1000000000;
+
+    if ( deadline->tv_nsec >= 1000000000 )
+    {
+        deadline->tv_sec  += 1;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    d e a d l i n e T i m e o u t
+
+    @brief Compute the poll timeout that ends at a deadline.
+
+    @param[in] deadline - The absolute CLOCK_MONOTONIC deadline or NULL.
+
+    @return The number of milliseconds until the deadline (rounded up), 0 if
+            it has passed or -1 if there is no deadline.
+
+------------------------------------------------------------------------*/
+static int deadlineTimeout ( const struct timespec* deadline )
+{
+    struct timespec now;
+
+    if ( deadline == NULL )
+    {
+        return -1;
+    }
+    clock_gettime ( CLOCK_MONOTONIC, &now );
+
+    long milliseconds = ( deadline->tv_sec - now.tv_sec ) * 1000 +
+                        ( deadline->tv_nsec - now.tv_nsec + 999999 ) / 1000000;
+
+    if ( milliseconds <= 0 )
+    {
+        return 0;
+    }
+    return milliseconds > INT_MAX ? INT_MAX : (int)milliseconds;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    g r o u p L i s t e n e r E n t e r
+
+    @brief Register the caller as a listener of a group.
+
+    The caller must be in an epoch protected section that started before it
+    found the group so that the group record can't have been freed yet.
+
+    @param[in] signalGroup - The address of the group.
+
+    @return true if the caller is now a listener of the group
+            false if the group has been deleted
+
+------------------------------------------------------------------------*/
+static bool groupListenerEnter ( vsi_signal_group* signalGroup )
+{
+    unsigned int listeners = __atomic_load_n ( &signalGroup->listenerCount,
+                                               __ATOMIC_ACQUIRE );
+    do
+    {
+        if ( listeners & SIGNAL_GROUP_DELETED )
+        {
+            return false;
+        }
+    }   while ( ! __atomic_compare_exchange_n ( &signalGroup->listenerCount,
+                                                &listeners, listeners + 1,
+                                                false, __ATOMIC_SEQ_CST,
+                                                __ATOMIC_ACQUIRE ) );
+    return true;
+}
+
+
+//
+//  Stop listening to a group.  If the group was deleted while we were
+//  listening and we are the last listener, it is up to us to retire it.
+//
+static void groupListenerLeave ( vsi_signal_group* signalGroup )
+{
+    if ( __atomic_sub_fetch ( &signalGroup->listenerCount, 1,
+                              __ATOMIC_SEQ_CST ) == SIGNAL_GROUP_DELETED )
+    {
+        sm_retire ( signalGroup );
+    }
+}
+
+
+//
+//  Find the result that belongs to a member of a group.  The member array is
+//  compacted when a member is removed so the result is usually in the same
+//  slot as the member but has to be searched for after a removal.  Returns
+//  -1 if the member was added after the results were set up.
+//
+static int groupResult ( vsi_result*  results,
+                         int          resultCount,
+                         int          slot,
+                         signal_list* signalList )
+{
+    if ( slot < resultCount &&
+         results[slot].domainId == signalList->domainId &&
+         results[slot].signalId == signalList->signalId )
+    {
+        return slot;
+    }
+    for ( int i = 0; i < resultCount; ++i )
+    {
+        if ( results[i].domainId == signalList->domainId &&
+             results[i].signalId == signalList->signalId )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    l i s t e n I n G r o u p
+
+    @brief Wait for signals on the members of a group.
+
+    Instead of waiting on each member of the group separately, the listener
+    waits once on the group's semaphore for the group's insert count to
+    change (see sm_post_groups).  It then only looks at the members whose
+    latest value sequence has changed since it last looked at them, so the
+    cost of a wakeup depends on how many members received signals rather
+    than on the size of the group.  The first time through every member is
+    looked at so that signals that are already waiting are returned at once.
+
+    The oldest signal of each member that has one is removed from the member
+    and copied into the data buffer of the result for that member (in the
+    same order as the members of the group) with a status of 0.  As with
+    vsi_get_newest_in_group, each result must supply a data buffer with it's
+    size in dataLength and dataLength is set to the number of bytes copied.
+    The results of the members that did not get a signal are left with a
+    status of ENOENT, or ETIMEDOUT if the deadline passed.
+
+    If the group is deleted while we are listening to it, we stop listening
+    and return ENOENT.  A member that is removed from the group while we are
+    listening is no longer waited for and it's result is left with a status
+    of ENOENT.
+
+    @param[in] groupId - The ID of the group to listen for
+    @param[in/out] results - The address of where to store the results
+    @param[in] resultsSize - The size of the results array being supplied
+    @param[in] all - If true, wait for a signal on every member, otherwise
+                     only wait for the first one.
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                          waiting or NULL to wait forever
+
+    @return 0 if the signals were received
+            ENOENT - The group does not exist.
+            EINVAL - The group does not have any members or a result does not
+                     have a data buffer.
+            ENOMEM - The results array is too small or memory could not be
+                     allocated.
+            ETIMEDOUT - The deadline passed first.
+
+------------------------------------------------------------------------*/
+//
+//  Define the context passed to groupChanged while listening to a group.
+//
+typedef struct group_wait
+{
+    vsi_signal_group* signalGroup;
+    unsigned long     insertCount;
+
+}   group_wait;
+
+static bool groupChanged ( void* context )
+{
+    group_wait* groupWait = context;
+
+    return __atomic_load_n ( &groupWait->signalGroup->insertCount,
+                             __ATOMIC_ACQUIRE ) != groupWait->insertCount ||
+           groupDeleted ( groupWait->signalGroup );
+}
+
+static int listenInGroup ( const group_t          groupId,
+                           vsi_result*            results,
+                           unsigned int           resultsSize,
+                           bool                   all,
+                           const struct timespec* deadline )
+{
+    static const struct timespec noWait = { 0, 0 };
+
+    signal_list* signalList;
+    int          groupCount;
+    int          i;
+    int          j;
+    int          status = 0;
+
+    //
+    //  Go get the signal group structure for the specified group id and
+    //  register as one of it's listeners so that it is not freed while we are
+    //  listening to it.
+    //
+    sm_epoch_enter();
+
+    vsi_signal_group* signalGroup = vsi_fetch_signal_group ( groupId );
+    if ( signalGroup == NULL || ! groupListenerEnter ( signalGroup ) )
+    {
+        sm_epoch_exit();
+        return ENOENT;
+    }
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    if ( groupCount <= 0 )
+    {
+        groupListenerLeave ( signalGroup );
+        sm_epoch_exit();
+        return EINVAL;
+    }
+    if ( resultsSize < (unsigned int)groupCount )
+    {
+        groupListenerLeave ( signalGroup );
+        sm_epoch_exit();
+        return ENOMEM;
+    }
+    //
+    //  Make sure that every result has a buffer to copy the signal data into.
+    //
+    for ( i = 0; i < groupCount; ++i )
+    {
+        if ( results[i].data == NULL || results[i].dataLength == 0 )
+        {
+            groupListenerLeave ( signalGroup );
+            sm_epoch_exit();
+            return EINVAL;
+        }
+    }
+    //
+    //  Allocate the arrays of the member sequences we have already looked at
+    //  and of the sizes of the buffers the caller supplied.
+    //
+    unsigned long* sequences   = malloc ( groupCount * sizeof(unsigned long) );
+    unsigned long* bufferSizes = malloc ( groupCount * sizeof(unsigned long) );
+
+    if ( sequences == NULL || bufferSizes == NULL )
+    {
+        free ( sequences );
+        free ( bufferSizes );
+        groupListenerLeave ( signalGroup );
+        sm_epoch_exit();
+        return ENOMEM;
+    }
+    //
+    //  Initialize the result for each member of the group.  The sequences
+    //  start out with a value that no member can have so that every member
+    //  is looked at the first time through.
+    //
+    for ( i = 0; i < groupCount; ++i )
+    {
+        signalList = toAddress ( members[i] );
+
+        bufferSizes[i] = results[i].dataLength;
+
+        results[i].domainId    = signalList->domainId;
+        results[i].signalId    = signalList->signalId;
+        results[i].literalData = 0;
+        results[i].dataLength  = 0;
+        results[i].status      = ENOENT;
+
+        sequences[i] = ~0UL;
+    }
+    sm_epoch_exit();
+
+    int received = 0;
+
+    group_wait groupWait = { signalGroup, 0 };
+
+    while ( true )
+    {
+        //
+        //  Get the insert count of the group before we look at the members
+        //  so that any signal inserted after this point will wake us up.
+        //
+        groupWait.insertCount = __atomic_load_n ( &signalGroup->insertCount,
+                                                  __ATOMIC_ACQUIRE );
+        //
+        //  Take the oldest signal from each member that changed and that we
+        //  don't have a signal for yet.  The message count of a signal list
+        //  is incremented before it's latest value sequence so if the fetch
+        //  finds no message, it was taken by someone else.
+        //
+        //  The member array is reloaded on every pass since it is replaced
+        //  when members are added or removed.  If the group has been
+        //  deleted, it's member array may already have been retired.
+        //
+        sm_epoch_enter();
+
+        if ( groupDeleted ( signalGroup ) )
+        {
+            sm_epoch_exit();
+
+            for ( i = 0; i < groupCount; ++i )
+            {
+                if ( results[i].status != 0 )
+                {
+                    results[i].status = ENOENT;
+                }
+            }
+            status = ENOENT;
+            break;
+        }
+        //
+        //  Members are matched to their results by signal rather than by
+        //  position since removing a member moves the ones after it down.
+        //
+        int count;
+        int waiting = 0;
+
+        members = groupMembers ( signalGroup, &count );
+
+        for ( j = 0; j < count && ( all || received == 0 ); ++j )
+        {
+            signalList = toAddress ( members[j] );
+
+            i = groupResult ( results, groupCount, j, signalList );
+            if ( i < 0 || results[i].status == 0 )
+            {
+                continue;
+            }
+            unsigned long sequence =
+                __atomic_load_n ( &signalList->latestSequence,
+                                  __ATOMIC_ACQUIRE );
+
+            //
+            //  A member whose latest value cache is disabled no longer
+            //  changes its sequence so it is always looked at.
+            //
+            if ( sequence != sequences[i] ||
+                 sequence == SIGNAL_LATEST_DISABLED )
+            {
+                signal_stamp stamp = { 0 };
+
+                sequences[i] = sequence;
+
+                results[i].dataLength = bufferSizes[i];
+
+                if ( sm_fetch ( signalList->domainId, signalList->signalId,
+                                &results[i].dataLength, results[i].data,
+                                false, &noWait, &stamp ) == 0 )
+                {
+                    results[i].timestamp = stamp.timestamp;
+                    results[i].sequence  = stamp.sequence;
+                    results[i].status    = 0;
+                    ++received;
+                    continue;
+                }
+                results[i].dataLength = 0;
+            }
+            ++waiting;
+        }
+        sm_epoch_exit();
+
+        if ( all ? waiting == 0 : received > 0 )
+        {
+            break;
+        }
+        //
+        //  Wait for a signal to be inserted into any member of the group.
+        //
+        status = semaphoreWaitUntil ( &signalGroup->semaphore, groupChanged,
+                                      &groupWait, deadline );
+        if ( status != 0 )
+        {
+            for ( i = 0; i < groupCount; ++i )
+            {
+                if ( results[i].status != 0 )
+                {
+                    results[i].status = status;
+                }
+            }
+            break;
+        }
+    }
+    free ( sequences );
+    free ( bufferSizes );
+
+    groupListenerLeave ( signalGroup );
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l i s t e n _ a n y _ i n _ g r o u p
+
+    @brief Listen for any signal in the signal list
+
+    This function will listen for any signal in the specified group.  The
+    signal list must have been previously built by adding the desired signals
+    to the group before making this call.  The first signal received after
+    this call is made will return it's value and the function will return to
+    the caller.
+
+    Upon return, the caller can check the array of result structures passed in
+    for on with a status of 0 to determine which signal was received.
+
+    @param[in] groupId - The group ID to listen for
+    @param[in] timeout - The optional timeout value in nanoseconds (0 waits
+                         forever)
+    @param[in/out] results - The array of results structures to fill in
+
+    @return 0 if no errors occurred
+              Otherwise the negative errno value will be returned.
+
+            -EINVAL - There are no signals or groups to listen to.
+            -ENOMEM - Memory could not be allocated.
+            ETIMEDOUT - The timeout expired before a signal arrived.
+            ENOENT - The group does not exist or was deleted.
+
+------------------------------------------------------------------------*/
+int vsi_listen_any_in_group ( const group_t groupId,
+                              unsigned int  timeout,
+                              vsi_result*   results )
+{
+    struct timespec deadline;
+
+    if ( timeout == 0 )
+    {
+        return vsi_listen_any_in_group_until ( groupId, NULL, results );
+    }
+    deadlineAfter ( &deadline, timeout );
+
+    return vsi_listen_any_in_group_until ( groupId, &deadline, results );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l i s t e n _ a n y _ i n _ g r o u p _ u n t i l
+
+    @brief Listen for any signal in the group until a deadline.
+
+    @param[in] groupId - The group ID to listen for
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                          waiting or NULL to wait forever
+    @param[in/out] results - The array of results structures to fill in
+
+    @return 0 if a signal was received
+            ETIMEDOUT - The deadline passed before a signal arrived.
+
+------------------------------------------------------------------------*/
+int vsi_listen_any_in_group_until ( const group_t          groupId,
+                                    const struct timespec* deadline,
+                                    vsi_result*            results )
+{
+    LOG ( "Called vsi_listen_any_in_group_until with group: %u\n", groupId );
+
+    CHECK_AND_RETURN_IF_ERROR ( ( groupId && results ) );
+
+    return listenInGroup ( groupId, results, UINT_MAX, false, deadline );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l i s t e n _ a l l _ i n _ g r o u p
+
+    @brief Listen for all signals in the specified group
+
+    This function will listen for all signals in the specified group.  The
+    signal list must have been previously built by adding the desired signals
+    to the group before making this call.  When all of the signals defined in
+    the specified group have received a signal, this call will return to the
+    caller.  This function will hang until all of the specified signals have
+    been received.
+
+    Note that the results pointer argument here MUST be a pointer to an array
+    of vsi_result structures and that array must be at least as large as the
+    number of signals that are expected.  The resultsSize argument is the
+    number of structures being supplied (NOT the total size of the results
+    array in bytes!).  If the resultsSize is not large enough to hold all of
+    the results required, an error will be returned to the caller.
+
+    @param[in] groupId - The ID of the group to listen for
+    @param[out] resultsPtr - The address of where to store the results
+    @param[in] resultsSize - The size of the results array being supplied
+    @param[in] timeout - The optional timeout value in nanoseconds (0 waits
+                         forever)
+
+    @return 0 if no errors occurred
+              Otherwise the negative errno value will be returned.
+
+            EINVAL - There are no signals or groups to listen to.
+            ENOMEM - Memory could not be allocated.
+            ETIMEDOUT - The timeout expired before every signal arrived.
+            ENOENT - The group does not exist or was deleted.
+
+------------------------------------------------------------------------*/
+int vsi_listen_all_in_group ( const group_t groupId,
+                              vsi_result*   results,
+                              unsigned int  resultsSize,
+                              unsigned int  timeout )
+{
+    struct timespec deadline;
+
+    if ( timeout == 0 )
+    {
+        return vsi_listen_all_in_group_until ( groupId, results, resultsSize,
+                                               NULL );
+    }
+    deadlineAfter ( &deadline, timeout );
+
+    return vsi_listen_all_in_group_until ( groupId, results, resultsSize,
+                                           &deadline );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l i s t e n _ a l l _ i n _ g r o u p _ u n t i l
+
+    @brief Listen for all signals in the group until a deadline.
+
+    @param[in] groupId - The ID of the group to listen for
+    @param[out] results - The address of where to store the results
+    @param[in] resultsSize - The size of the results array being supplied
+    @param[in] deadline - The absolute CLOCK_MONOTONIC time at which to stop
+                          waiting or NULL to wait forever
+
+    @return 0 if every signal was received
+            ETIMEDOUT - The deadline passed before every signal arrived.
+
+------------------------------------------------------------------------*/
+int vsi_listen_all_in_group_until ( const group_t          groupId,
+                                    vsi_result*            results,
+                                    unsigned int           resultsSize,
+                                    const struct timespec* deadline )
+{
+    LOG ( "Called vsi_listen_all_in_group_until with group: %u\n", groupId );
+
+    CHECK_AND_RETURN_IF_ERROR ( ( groupId && results && resultsSize ) );
+
+    return listenInGroup ( groupId, results, resultsSize, true, deadline );
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ f l u s h _ g r o u p
+
+    @brief Flush all of the signals available for all signals in a group.
+
+    This function will flush all of the signals available for each member
+    signal in the specified group.
+
+    If an application is no longer interested in any of the pending signals to
+    be read or simply wants to synchronize with the latest information, it may
+    call this function to flush all pending messages from the queues of every
+    signal in the group.
+
+------------------------------------------------------------------------*/
+int vsi_flush_group ( const group_t groupId )
+{
+    vsi_signal_group  requestedSignalGroup = { 0 };
+    vsi_signal_group* signalGroup = 0;
+    signal_list*      signalList = 0;
+    int               groupCount = 0;
+
+    //
+    //  Make sure the inputs are all present.
+    //
+    CHECK_AND_RETURN_IF_ERROR ( groupId );
+
+    //
+    //  Go get the signal group structure for the specified group id.
+    //
+    requestedSignalGroup.groupId = groupId;
+
+    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedSignalGroup );
+
+    //
+    //  If the group id specified does not exist, return an error code to the
+    //  caller.
+    //
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+	//
+    //  Get the member array of the group.
+    //
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    //
+    //  If the group has no members, return an error code to the caller.
+    //
+    if ( groupCount == 0 )
+    {
+        sm_epoch_exit();
+        return ENOENT;
+    }
+    //
+    //  For each of the signals in the group...
+    //
+    for ( int i = 0; i < groupCount; ++i )
+    {
+        //
+        //  Get the pointer to the signal list of this member.
+        //
+        signalList = toAddress ( members[i] );
+
+        //
+        //  Go flush all of the signal data for this signal.
+        //
+        vsi_flush_signal ( signalList->domainId, signalList->signalId );
+    }
+    sm_epoch_exit();
+
+    //
+    //  Return a good completion code to the caller.
+    //
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    V S I   S i g n a l   N o t i f i e r   F u n c t i o n s
+    =========================================================
+
+    The notifier table itself lives in the VSI context in shared memory but
+    the file descriptors are only meaningful in the process that opened them
+    so each process keeps it's own map of notifier index to file descriptor.
+
+------------------------------------------------------------------------*/
+static int notifierDescriptors[VSI_NOTIFIER_COUNT] =
+    { [ 0 ... VSI_NOTIFIER_COUNT - 1 ] = -1 };
+
+static pthread_mutex_t notifierMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*!-----------------------------------------------------------------------
+
+    n o t i f i e r C l e a r M a s k
+
+    @brief Remove a notifier's bit from all of the signals it is watching.
+
+    @param[in] - index - The index of the notifier
+
+------------------------------------------------------------------------*/
+static void notifierClearMask ( int index )
+{
+    vsi_notifier* notifier = &vsiContext->notifiers[index];
+    unsigned long mask     = ~( 1UL << index );
+    signal_list*  signalList;
+
+    //
+    //  If this is a single signal notifier, just remove the bit from that
+    //  signal.
+    //
+    if ( ! notifier->isGroup )
+    {
+        signalList = findSignalList ( notifier->domainId, notifier->signalId );
+        if ( signalList != NULL )
+        {
+            __atomic_and_fetch ( &signalList->notifyMask, mask,
+                                 __ATOMIC_RELEASE );
+        }
+        return;
+    }
+    //
+    //  This is a group notifier so remove the bit from every signal in the
+    //  group.  If the group has already been deleted, the bits were removed
+    //  at that time.
+    //
+    vsi_signal_group  requestedGroup = { 0 };
+    vsi_signal_group* signalGroup;
+
+    requestedGroup.groupId = notifier->groupId;
+
+    signalGroup = btree_search ( &vsiContext->groupIdIndex, &requestedGroup );
+    if ( signalGroup == NULL )
+    {
+        return;
+    }
+    int groupCount;
+
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    for ( int i = 0; i < groupCount; ++i )
+    {
+        signalList = toAddress ( members[i] );
+
+        __atomic_and_fetch ( &signalList->notifyMask, mask, __ATOMIC_RELEASE );
+    }
+    sm_epoch_exit();
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    n o t i f i e r R e c l a i m
+
+    @brief Reclaim all of the notifiers owned by processes that have died.
+
+    A notifier being reclaimed is marked with a process ID of -1 so that only
+    one process will reclaim it and so that no one else will try to open it
+    until it has been completely cleaned up.
+
+------------------------------------------------------------------------*/
+static void notifierReclaim ( void )
+{
+    for ( int i = 0; i < VSI_NOTIFIER_COUNT; ++i )
+    {
+        vsi_notifier* notifier  = &vsiContext->notifiers[i];
+        int           processId = __atomic_load_n ( &notifier->processId,
+                                                    __ATOMIC_ACQUIRE );
+        //
+        //  If this notifier is in use by a process that no longer exists,
+        //  take it over, remove it's bits from the signals it was watching
+        //  and make it available again.
+        //
+        if ( processId > 0 && kill ( processId, 0 ) != 0 && errno == ESRCH &&
+             __atomic_compare_exchange_n ( &notifier->processId, &processId,
+                                           -1, false, __ATOMIC_ACQ_REL,
+                                           __ATOMIC_RELAXED ) )
+        {
+            LOG ( "Reclaiming notifier %d from dead process %d\n", i,
+                  processId );
+
+            notifierClearMask ( i );
+
+            __atomic_store_n ( &notifier->processId, 0, __ATOMIC_RELEASE );
+        }
+    }
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    n o t i f i e r O p e n
+
+    @brief Open a new notifier.
+
+    This function claims an available notifier, creates the socket for it
+    and fills in what the notifier is watching.  The notifier's bit is not
+    set in any signal lists yet - That is up to the caller.
+
+    @param[in] - isGroup - True if this is a group notifier
+    @param[in] - groupId - The group being watched
+    @param[in] - domainId - The domain of the signal being watched
+    @param[in] - signalId - The signal being watched
+    @param[out] - fd - The file descriptor of the new notifier
+
+    @return The index of the new notifier or the negative errno value
+
+------------------------------------------------------------------------*/
+static int notifierOpen ( bool     isGroup,
+                          group_t  groupId,
+                          domain_t domainId,
+                          signal_t signalId,
+                          int*     fd )
+{
+    struct sockaddr_un address;
+    vsi_notifier*      notifier = NULL;
+    int                index;
+
+    //
+    //  Go make any notifiers owned by dead processes available again.
+    //
+    notifierReclaim();
+
+    //
+    //  Find an available notifier and claim it.  It is marked as being
+    //  reclaimed until it is completely set up so that no one will look at
+    //  it's fields yet.
+    //
+    for ( index = 0; index < VSI_NOTIFIER_COUNT; ++index )
+    {
+        int available = 0;
+
+        notifier = &vsiContext->notifiers[index];
+
+        if ( __atomic_compare_exchange_n ( &notifier->processId, &available,
+                                           -1, false, __ATOMIC_ACQ_REL,
+                                           __ATOMIC_RELAXED ) )
+        {
+            break;
+        }
+    }
+    if ( index == VSI_NOTIFIER_COUNT )
+    {
+        printf ( "Error: All %d signal notifiers are in use\n",
+                 VSI_NOTIFIER_COUNT );
+        return -ENOSPC;
+    }
+    //
+    //  Fill in what this notifier is watching and give it a new generation
+    //  so that no notifications meant for it's previous owner are delivered
+    //  to us.
+    //
+    notifier->isGroup  = isGroup;
+    notifier->groupId  = groupId;
+    notifier->domainId = domainId;
+    notifier->signalId = signalId;
+
+    unsigned long generation = __atomic_add_fetch ( &notifier->generation, 1,
+                                                    __ATOMIC_ACQ_REL );
+    //
+    //  Create the socket for this notifier and bind it to the notifier's
+    //  address.
+    //
+    *fd = socket ( AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0 );
+    if ( *fd < 0 )
+    {
+        int status = errno;
+        printf ( "Error: Unable to create a notifier socket - errno: %u[%m].\n",
+                 status );
+        __atomic_store_n ( &notifier->processId, 0, __ATOMIC_RELEASE );
+        return -status;
+    }
+    socklen_t length = notifierAddress ( index, generation, &address );
+
+    if ( bind ( *fd, (struct sockaddr*)&address, length ) != 0 )
+    {
+        int status = errno;
+        printf ( "Error: Unable to bind a notifier socket - errno: %u[%m].\n",
+                 status );
+        close ( *fd );
+        __atomic_store_n ( &notifier->processId, 0, __ATOMIC_RELEASE );
+        return -status;
+    }
+    //
+    //  Record the file descriptor for this notifier in this process.
+    //
+    pthread_mutex_lock ( &notifierMutex );
+    notifierDescriptors[index] = *fd;
+    pthread_mutex_unlock ( &notifierMutex );
+
+    //
+    //  The notifier is now ready so mark it as being owned by us.
+    //
+    __atomic_store_n ( &notifier->processId, getpid(), __ATOMIC_RELEASE );
+
+    return index;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ o p e n _ s i g n a l _ n o t i f i e r
+
+    @brief Open a pollable notifier for a single signal.
+
+    See the description in signals.h.
+
+    @param[in] - domainId - The domain ID of the signal to watch.
+    @param[in] - signalId - The signal ID of the signal to watch.
+
+    @return The notifier file descriptor or the negative errno value
+
+------------------------------------------------------------------------*/
+int vsi_open_signal_notifier ( const domain_t domainId,
+                               const signal_t signalId )
+{
+    int fd;
+
+    LOG ( "vsi_open_signal_notifier called with: %d,%d\n", domainId,
+          signalId );
+    //
+    //  Go find the signal list for this domain/signal.
+    //
+    signal_list* signalList = findSignalList ( domainId, signalId );
+    if ( signalList == NULL )
+    {
+        return -ENOMEM;
+    }
+    //
+    //  Go open a new notifier for this signal.
+    //
+    int index = notifierOpen ( false, 0, domainId, signalId, &fd );
+    if ( index < 0 )
+    {
+        return index;
+    }
+    //
+    //  Start notifying this notifier when this signal is inserted.
+    //
+    __atomic_or_fetch ( &signalList->notifyMask, 1UL << index,
+                        __ATOMIC_RELEASE );
+
+    return fd;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ o p e n _ g r o u p _ n o t i f i e r
+
+    @brief Open a pollable notifier for all of the signals in a group.
+
+    See the description in signals.h.
+
+    @param[in] - groupId - The ID value of the group to watch.
+
+    @return The notifier file descriptor or the negative errno value
+
+------------------------------------------------------------------------*/
+int vsi_open_group_notifier ( const group_t groupId )
+{
+    int fd;
+
+    LOG ( "vsi_open_group_notifier called with group: %d\n", groupId );
+
+    //
+    //  Go find the group record for this groupId.
+    //
+    vsi_signal_group* signalGroup = vsi_fetch_signal_group ( groupId );
+    if ( signalGroup == NULL )
+    {
+        return -ENOENT;
+    }
+    //
+    //  Go open a new notifier for this group.
+    //
+    int index = notifierOpen ( true, groupId, 0, 0, &fd );
+    if ( index < 0 )
+    {
+        return index;
+    }
+    //
+    //  Start notifying this notifier when any signal in the group is
+    //  inserted.  Any signals added to the group from now on will pick up
+    //  this notifier's bit in vsi_add_signal_to_group.
+    //
+    int groupCount;
+
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    for ( int i = 0; i < groupCount; ++i )
+    {
+        signal_list* signalList = toAddress ( members[i] );
+
+        __atomic_or_fetch ( &signalList->notifyMask, 1UL << index,
+                            __ATOMIC_RELEASE );
+    }
+    sm_epoch_exit();
+
+    return fd;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c l e a r _ n o t i f i e r
+
+    @brief Discard all of the pending notifications on a notifier.
+
+    @param[in] - fd - The notifier file descriptor.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_clear_notifier ( int fd )
+{
+    char buffer[64];
+
+    //
+    //  Read notifications until there are no more left.
+    //
+    while ( recv ( fd, buffer, sizeof(buffer), MSG_DONTWAIT ) >= 0 )
+    {
+        // Empty
+    }
+    //
+    //  Running out of notifications is the normal way out of the loop above.
+    //
+    if ( errno == EAGAIN || errno == EWOULDBLOCK )
+    {
+        return 0;
+    }
+    return errno;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c l o s e _ n o t i f i e r
+
+    @brief Close a notifier.
+
+    @param[in] - fd - The notifier file descriptor.
+
+    @return 0 if no errors occurred
+            EBADF - The file descriptor is not an open notifier.
+
+------------------------------------------------------------------------*/
+int vsi_close_notifier ( int fd )
+{
+    int index;
+
+    //
+    //  Find the notifier that this file descriptor belongs to and remove it
+    //  from this process' map.
+    //
+    pthread_mutex_lock ( &notifierMutex );
+
+    for ( index = 0; index < VSI_NOTIFIER_COUNT; ++index )
+    {
+        if ( fd >= 0 && notifierDescriptors[index] == fd )
+        {
+            notifierDescriptors[index] = -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock ( &notifierMutex );
+
+    if ( index == VSI_NOTIFIER_COUNT )
+    {
+        return EBADF;
+    }
+    //
+    //  Stop notifying this notifier, make it available again and close it's
+    //  socket.
+    //
+    notifierClearMask ( index );
+
+    __atomic_store_n ( &vsiContext->notifiers[index].processId, 0,
+                       __ATOMIC_RELEASE );
+    close ( fd );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    C o n s u m e r   C u r s o r   F u n c t i o n s
+    ===================================================
+
+
+    v s i _ o p e n _ c u r s o r
+
+    @brief Open a named consumer cursor on a signal.
+
+    @param[in] - domainId - The domain ID of the signal.
+    @param[in] - signalId - The signal ID of the signal.
+    @param[in] - name - The name of the cursor.
+    @param[out] - cursor - The cursor handle to be filled in.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_open_cursor ( const domain_t domainId,
+                      const signal_t signalId,
+                      const char*    name,
+                      vsi_cursor*    cursor )
+{
+    LOG ( "vsi_open_cursor called with %d,%d[%s]\n", domainId, signalId,
+          name );
+
+    CHECK_AND_RETURN_IF_ERROR ( ( name && cursor ) );
+
+    if ( name[0] == 0 || strlen ( name ) >= SIGNAL_CURSOR_NAME_SIZE )
+    {
+        return EINVAL;
+    }
+    //
+    //  Go find the signal list for this signal and the cursor on it.
+    //
+    signal_list* signalList = findSignalList ( domainId, signalId );
+    if ( signalList == NULL )
+    {
+        return ENOMEM;
+    }
+    signal_cursor* signalCursor = sm_open_cursor ( signalList, name );
+    if ( signalCursor == NULL )
+    {
+        return ENOMEM;
+    }
+    //
+    //  Fill in the caller's cursor handle.
+    //
+    cursor->isGroup  = false;
+    cursor->groupId  = 0;
+    cursor->domainId = domainId;
+    cursor->signalId = signalId;
+    cursor->cursor   = toOffset ( signalCursor );
+    cursor->notifier = -1;
+    strcpy ( cursor->name, name );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ o p e n _ g r o u p _ c u r s o r
+
+    @brief Open a named consumer cursor on every signal in a group.
+
+    @param[in] - groupId - The ID of the group.
+    @param[in] - name - The name of the cursor.
+    @param[out] - cursor - The cursor handle to be filled in.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_open_group_cursor ( const group_t groupId,
+                            const char*   name,
+                            vsi_cursor*   cursor )
+{
+    LOG ( "vsi_open_group_cursor called with group %d[%s]\n", groupId, name );
+
+    CHECK_AND_RETURN_IF_ERROR ( ( name && cursor ) );
+
+    if ( name[0] == 0 || strlen ( name ) >= SIGNAL_CURSOR_NAME_SIZE )
+    {
+        return EINVAL;
+    }
+    //
+    //  Go find the group record for this groupId.
+    //
+    vsi_signal_group* signalGroup = vsi_fetch_signal_group ( groupId );
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+    //
+    //  Open the cursor on each signal that is in the group now.  Signals
+    //  added to the group later get their cursor when it is first read.
+    //
+    int groupCount;
+
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    for ( int i = 0; i < groupCount; ++i )
+    {
+        signal_list* signalList = toAddress ( members[i] );
+
+        if ( sm_open_cursor ( signalList, name ) == NULL )
+        {
+            sm_epoch_exit();
+            return ENOMEM;
+        }
+    }
+    sm_epoch_exit();
+
+    //
+    //  Fill in the caller's cursor handle.
+    //
+    cursor->isGroup  = true;
+    cursor->groupId  = groupId;
+    cursor->domainId = 0;
+    cursor->signalId = 0;
+    cursor->cursor   = END_OF_LIST_MARKER;
+    cursor->notifier = -1;
+    strcpy ( cursor->name, name );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    g r o u p C u r s o r N e x t
+
+    @brief Read the oldest unread signal in a group through a cursor.
+
+    Each signal in the group is checked for a signal that has not been read
+    through the cursor yet and the one with the oldest capture time is read.
+
+    @param[in] - cursor - The cursor handle.
+    @param[in/out] - result - The result structure.
+    @param[out] - stamp - The stamp of the signal read.
+
+    @return 0 if a signal was read
+            ENODATA - There is no signal to read.
+            ENOENT - The group does not exist.
+
+------------------------------------------------------------------------*/
+static int groupCursorNext ( vsi_cursor*   cursor,
+                             vsi_result*   result,
+                             signal_stamp* stamp )
+{
+    signal_list*   oldestList   = NULL;
+    signal_cursor* oldestCursor = NULL;
+    signal_stamp   oldestStamp  = { 0 };
+
+    vsi_signal_group* signalGroup = vsi_fetch_signal_group ( cursor->groupId );
+    if ( signalGroup == NULL )
+    {
+        return ENOENT;
+    }
+    //
+    //  Find the signal in the group whose next unread signal is the oldest.
+    //
+    int groupCount;
+
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+    for ( int i = 0; i < groupCount; ++i )
+    {
+        signal_list* signalList = toAddress ( members[i] );
+
+        signal_cursor* signalCursor = sm_open_cursor ( signalList,
+                                                       cursor->name );
+        if ( signalCursor != NULL &&
+             sm_read_cursor ( signalList, signalCursor, NULL, stamp,
+                              false, NULL ) == 0 &&
+             ( oldestList == NULL ||
+               stamp->timestamp < oldestStamp.timestamp ) )
+        {
+            oldestList   = signalList;
+            oldestCursor = signalCursor;
+            oldestStamp  = *stamp;
+        }
+    }
+    sm_epoch_exit();
+
+    if ( oldestList == NULL )
+    {
+        return ENODATA;
+    }
+    //
+    //  Go read that signal.
+    //
+    int status = sm_read_cursor ( oldestList, oldestCursor, result, stamp,
+                                  false, NULL );
+    if ( status == 0 )
+    {
+        result->domainId = oldestList->domainId;
+        result->signalId = oldestList->signalId;
+    }
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ r e a d _ c u r s o r
+
+    @brief Read the next signal through a named consumer cursor.
+
+    @param[in/out] - cursor - The cursor handle.
+    @param[in/out] - result - The result structure.
+    @param[in] - wait - If true, wait for a signal if there is none to read.
+    @param[in] - deadline - The absolute CLOCK_MONOTONIC time at which to
+                            stop waiting or NULL to wait forever.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_read_cursor ( vsi_cursor*            cursor,
+                      vsi_result*            result,
+                      bool                   wait,
+                      const struct timespec* deadline )
+{
+    signal_stamp stamp = { 0 };
+    int          status;
+
+    CHECK_AND_RETURN_IF_ERROR ( ( cursor && result && result->data ) );
+    CHECK_AND_RETURN_IF_ERROR ( cursor->name[0] );
+
+    //
+    //  If this is a cursor on a single signal, just go read it.
+    //
+    if ( ! cursor->isGroup )
+    {
+        signal_list* signalList = findSignalList ( cursor->domainId,
+                                                   cursor->signalId );
+        if ( signalList == NULL )
+        {
+            return ENODATA;
+        }
+        status = sm_read_cursor ( signalList, toAddress ( cursor->cursor ),
+                                  result, &stamp, wait, deadline );
+        if ( status == 0 )
+        {
+            result->domainId = cursor->domainId;
+            result->signalId = cursor->signalId;
+        }
+    }
+    //
+    //  Otherwise read the oldest unread signal in the group.  If there isn't
+    //  one, wait on the cursor's group notifier until a signal is inserted
+    //  into the group and try again.
+    //
+    else
+    {
+        while ( ( status = groupCursorNext ( cursor, result,
+                                                &stamp ) ) == ENODATA &&
+                wait )
+        {
+            //
+            //  Open the notifier the first time we need to wait and then
+            //  look again since a signal may have arrived before it was open.
+            //
+            if ( cursor->notifier < 0 )
+            {
+                int fd = vsi_open_group_notifier ( cursor->groupId );
+                if ( fd < 0 )
+                {
+                    return -fd;
+                }
+                cursor->notifier = fd;
+                continue;
+            }
+            //
+            //  Give up if the deadline has passed, otherwise wait for a
+            //  notification until it does.
+            //
+            int timeout = deadlineTimeout ( deadline );
+            if ( timeout == 0 )
+            {
+                status = ETIMEDOUT;
+                break;
+            }
+            struct pollfd pollFd = { cursor->notifier, POLLIN, 0 };
+
+            poll ( &pollFd, 1, timeout );
+
+            vsi_clear_notifier ( cursor->notifier );
+        }
+    }
+    if ( status == 0 )
+    {
+        result->timestamp = stamp.timestamp;
+        result->sequence  = stamp.sequence;
+    }
+    result->status = status;
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c l o s e _ c u r s o r
+
+    @brief Close a cursor handle.
+
+    @param[in/out] - cursor - The cursor handle.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_close_cursor ( vsi_cursor* cursor )
+{
+    CHECK_AND_RETURN_IF_ERROR ( cursor );
+
+    if ( cursor->notifier >= 0 )
+    {
+        vsi_close_notifier ( cursor->notifier );
+    }
+    cursor->notifier = -1;
+    cursor->cursor   = END_OF_LIST_MARKER;
+    cursor->name[0]  = 0;
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e l e t e _ c u r s o r
+
+    @brief Delete a named cursor.
+
+    @param[in/out] - cursor - The cursor handle.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_delete_cursor ( vsi_cursor* cursor )
+{
+    int status = 0;
+
+    CHECK_AND_RETURN_IF_ERROR ( cursor );
+    CHECK_AND_RETURN_IF_ERROR ( cursor->name[0] );
+
+    //
+    //  Delete the cursor on the signal or on every signal in the group.
+    //
+    if ( ! cursor->isGroup )
+    {
+        signal_list* signalList = findSignalList ( cursor->domainId,
+                                                   cursor->signalId );
+        if ( signalList != NULL )
+        {
+            sm_delete_cursor ( signalList, cursor->name );
+        }
+    }
+    else
+    {
+        vsi_signal_group* signalGroup = vsi_fetch_signal_group ( cursor->groupId );
+        if ( signalGroup == NULL )
+        {
+            status = ENOENT;
+        }
+        else
+        {
+            int groupCount;
+
+            sm_epoch_enter();
+
+            offset_t* members = groupMembers ( signalGroup, &groupCount );
+
+            for ( int i = 0; i < groupCount; ++i )
+            {
+                sm_delete_cursor ( toAddress ( members[i] ), cursor->name );
+            }
+            sm_epoch_exit();
+        }
+    }
+    vsi_close_cursor ( cursor );
+
+    return status;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    N a m e / I D   M a n i u p l a t i o n   F u n c t i o n s
+    ===========================================================
+
+
+    v s i _ n a m e _ s t r i n g _ t o _ i d
+
+    @brief Convert a domain and signal name to it's signal ID.
+
+    The name is an ASCII character string that has been defined in the VSS and
+    associated with a domain.
+
+    The domainId is the ID of the domain in which the name is defined.
+
+    The signalId is a pointer to an identifier in which the signal ID will
+    be stored.
+
+    @param[in] - name - The name of the signal to be converted.
+    @param[in] - domainId - The domain of the name to look up.
+    @param[out] - signalId - A pointer in which the signal ID will be stored.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
 int vsi_name_string_to_id ( domain_t    domainId,
                             const char* name,
                             signal_t*   signalId )
 {
     signal_list* signalList = 0;
 
-    LOG ( "vsi_name_string_to_id called with domain %d, name[%s]\n", domainId, name );
-
+    LOG ( "vsi_name_string_to_id called with domain %d, name[%s]\n", domainId, name );
+
+    //
+    //  Make sure all of the required input arguments are supplied.
+    //
+    CHECK_AND_RETURN_IF_ERROR ( name && domainId && signalId );
+
+	//
+	//	Allocate a scratch signal list to use for the name lookup in the btrees.
+	//
+    signal_list* requestedSignalList = sm_malloc ( sizeof(signal_list) );
+
+    //
+    //  Allocate a shared memory buffer for the target name string and a
+    //  pointer to that buffer.
+    //
+    int nameLen = strlen(name) + 1;
+
+    char* tempName = sm_malloc ( nameLen );
+
+    requestedSignalList->name = toOffset ( tempName );
+    requestedSignalList->domainId = domainId;
+
+    //
+    //  Copy the target signal name into the shared memory buffer area.
+    //
+    strncpy ( tempName, name, nameLen - 1 );
+    tempName[nameLen-1] = 0;
+
+    //
+    //  Go find the record that has this name.
+    //
+    signalList = btree_search ( &vsiContext->signalNameIndex, requestedSignalList );
+
+    //
+    //  Deallocate the temporary target name string buffer and request structure.
+    //
+    sm_free ( tempName );
+    sm_free ( requestedSignalList );
+
+    //
+    //  If the search failed, return an error code to the caller.  The name
+    //  that was specified does not exist in our indices.
+    //
+    if ( signalList == NULL )
+    {
+        return EINVAL;
+    }
+    //
+    //  Copy the signal id from the returned data structure into the caller's
+    //  return value pointer.
+    //
+    *signalId = signalList->signalId;
+
+    LOG ( "vsi_name_string_to_id returning domain: %d, signal: %d\n",
+          signalList->domainId, signalList->signalId );
+    //
+    //  Return a good completion code to the caller.
+    //
+    return 0;
+}
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ s i g n a l _ i d _ t o _ s t r i n g
+
+    @brief Convert a signal domain and ID to it's ASCII string name.
+
+    The domainId is the domain ID to be converted.
+
+    The signalId is the signal ID to be converted.
+
+    The name is an ASCII character string that has been defined in the VSS and
+    associated with a domain and a numeric signal ID value.
+
+    The name pointer must be a preallocated memory area that is large enough
+    to contain the name of the signal being asked for.  The name of the signal
+    will be copied into that buffer and null terminated.
+
+    The nameLength is the maximum number of bytes of data that will be copied
+    into the supplied buffer by the API code.  This value should be set to the
+    maximum size of the name buffer being supplied.  If the name buffer
+    supplied is not large enough to contain the entire name, the data will be
+    truncated to fit into the buffer.
+
+    @param[in] - domainId - The signal domain ID to be converted.
+    @param[in] - signalId - The signal ID to be converted.
+    @param[in/out] - name - A pointer to a buffer in which to store the name.
+    @param[in] - nameLength - The size of the name buffer being supplied.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_signal_id_to_string ( const domain_t domainId,
+                              const signal_t signalId,
+                              char**         name,
+                              int            nameLength )
+{
+    signal_list* signalList = 0;
+
     //
     //  Make sure all of the required input arguments are supplied.
     //
-    CHECK_AND_RETURN_IF_ERROR ( name && domainId && signalId );
+    CHECK_AND_RETURN_IF_ERROR ( name );
 
-	//
-	//	Allocate a scratch signal list to use for the name lookup in the btrees.
-	//
+    //
+    //  Allocate a scratch signal list to use for the lookup in the btrees.
+    //
     signal_list* requestedSignalList = sm_malloc ( sizeof(signal_list) );
 
     //
-    //  Allocate a shared memory buffer for the target name string and a
-    //  pointer to that buffer.
+    //  Initialize the id fields for the lookup operation.
     //
-    int nameLen = strlen(name) + 1;
+    requestedSignalList->domainId = domainId;
+    requestedSignalList->signalId = signalId;
 
-    char* tempName = sm_malloc ( nameLen );
+    //
+    //  Go find the record that has this name.
+    //
+    signalList = btree_search ( &vsiContext->signalIdIndex, requestedSignalList );
 
-    requestedSignalList->name = toOffset ( tempName );
-    requestedSignalList->domainId = domainId;
+    //
+    //  Deallocate the request structure.
+    //
+    sm_free ( requestedSignalList );
 
     //
-    //  Copy the target signal name into the shared memory buffer area.
+    //  If the search failed, return an error code to the caller.  The ids
+    //  that were specified do not exist in our indices.
     //
-    strncpy ( tempName, name, nameLen - 1 );
-    tempName[nameLen-1] = 0;
+    if ( signalList == NULL )
+    {
+        return EINVAL;
+    }
+    //
+    //  Copy the domain and signal ids from the returned data structure into
+    //  the caller's return value pointers.
+    //
+    strncpy ( *name, toAddress ( signalList->name ), nameLength );
 
     //
-    //  Go find the record that has this name.
+    //  Return a good completion code to the caller.
     //
-    signalList = btree_search ( &vsiContext->signalNameIndex, requestedSignalList );
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e f i n e _ s i g n a l
+
+    @brief Define a new signal list definition record.
+
+    This function will define a new signal list definition record.  This
+    record will be inserted into the signal Id and signal Name btree indices
+    to allow conversions between the Id and Name of a signal and vice versa.
+    Afer this function has been called, the structure that was created can be
+    found in the btrees using the normal btree lookup functions.
+
+    The privateId will only be inserted into it's btree if the input value is
+    not zero.
+
+    The name string will only be inserted into it's btree if the input value
+    is not null.
+
+    Use this function to create an empty signal list structure in the btrees.
+    This is useful when reading in a vechicle signal specification file for
+    instance.
+
+    @param[in] domainId - The signal domain ID to be defined.
+    @param[in] signalId - The signal ID to be defined.
+    @param[in] privateId - The private ID to be defined.
+    @param[in] name - The ASCII name of the signal to be defined.
+
+    @return status - The return status of the function (0 = Good)
+
+------------------------------------------------------------------------*/
+int vsi_define_signal ( const domain_t domainId,
+                        const signal_t signalId,
+                        const signal_t privateId,
+                        const char*    name )
+{
+    LOG ( "Defining: domainId: %d, signalId: %d, privateId: %d, name[%s]\n",
+          domainId, signalId, privateId, name );
+    //
+    //  Go find the signal list control block for this domain and signal.  Note
+    //  that if the signal list does not exist yet, a new one will be created
+    //  and initialized.
+    //
+    signal_list* signalList = findSignalList ( domainId, signalId );
 
     //
-    //  Deallocate the temporary target name string buffer and request structure.
+    //  If there is a private ID for this signal, store it in the signal list
+    //  and add it's definition to the private index as well.
     //
-    sm_free ( tempName );
-    sm_free ( requestedSignalList );
+    if ( privateId != 0 )
+    {
+        signalList->privateId = privateId;
+        btree_insert ( &vsiContext->privateIdIndex, signalList );
+    }
+    //
+    //  If a name was specified, allocate a buffer for the name string and
+    //  store it in the new structure.
+    //
+    if ( name != NULL )
+    {
+        //
+        //  Get the length of the name (with the terminating null byte).
+        //
+        int nameLen = strlen(name) + 1;
+
+        //
+        //  Allocate a shared memory buffer to hold the name.
+        //
+        char* tempName = sm_malloc ( nameLen );
+        memset ( tempName, 0, nameLen );
+
+        //
+        //  Store the offset to the new name buffer in the signal list
+        //  structure.
+        //
+        signalList->name = toOffset ( tempName );
+
+        //
+        //  Copy the input name string into the new buffer.
+        //
+        strncpy ( tempName, name, nameLen - 1 );
+
+        //
+        //  Go add this signal list structure to the signal-name btree index.
+        //
+        btree_insert ( &vsiContext->signalNameIndex, signalList );
+    }
+    //
+    //  Return a good completion code to the caller.
+    //
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e f i n e _ s i g n a l _ r i n g
+
+    @brief Define a new signal that is stored in a fixed size ring buffer.
+
+    This function will define the signal exactly as vsi_define_signal does
+    and then convert the signal list to the ring buffer storage mode.
+
+    @param[in] domainId - The signal domain ID to be defined.
+    @param[in] signalId - The signal ID to be defined.
+    @param[in] privateId - The private ID to be defined.
+    @param[in] name - The ASCII name of the signal to be defined.
+    @param[in] capacity - The number of signals the ring can hold.
+    @param[in] maxDataSize - The largest signal data size to be stored.
+
+    @return status - The return status of the function (0 = Good)
+
+------------------------------------------------------------------------*/
+int vsi_define_signal_ring ( const domain_t domainId,
+                             const signal_t signalId,
+                             const signal_t privateId,
+                             const char*    name,
+                             unsigned long  capacity,
+                             unsigned long  maxDataSize )
+{
+    int status = 0;
+
+    LOG ( "Defining ring: domainId: %d, signalId: %d, capacity: %lu, "
+          "maxDataSize: %lu\n", domainId, signalId, capacity, maxDataSize );
+    //
+    //  Go define the signal in the normal way.
+    //
+    status = vsi_define_signal ( domainId, signalId, privateId, name );
+    if ( status != 0 )
+    {
+        return status;
+    }
+    //
+    //  Get the signal list that was just defined.
+    //
+    signal_list* signalList = findSignalList ( domainId, signalId );
+    if ( signalList == NULL )
+    {
+        return ENOMEM;
+    }
+    //
+    //  Go allocate the ring for this signal list.
+    //
+    return sm_create_ring ( signalList, capacity, maxDataSize );
+}
+
+
+//
+//  Define the comparison functions used to sort signal lists into the order
+//  of the signal ID, signal name and private ID indices.  These must order
+//  the signal lists exactly the way the key definitions of those indices do
+//  (see vsi_initialize) or btree_bulk_load will reject them.
+//
+#define COMPARE_IDS( id1, id2 ) ( ( (id1) > (id2) ) - ( (id1) < (id2) ) )
+
+static int compareSignalIds ( const void* entry1, const void* entry2 )
+{
+    const signal_list* list1 = *(signal_list* const*)entry1;
+    const signal_list* list2 = *(signal_list* const*)entry2;
+
+    int diff = COMPARE_IDS ( list1->domainId, list2->domainId );
+
+    return diff != 0 ? diff : COMPARE_IDS ( list1->signalId, list2->signalId );
+}
+
+static int compareSignalNames ( const void* entry1, const void* entry2 )
+{
+    const signal_list* list1 = *(signal_list* const*)entry1;
+    const signal_list* list2 = *(signal_list* const*)entry2;
+
+    int diff = COMPARE_IDS ( list1->domainId, list2->domainId );
+    if ( diff != 0 )
+    {
+        return diff;
+    }
+    diff = strncmp ( toAddress ( list1->name ), toAddress ( list2->name ), 256 );
+
+    return COMPARE_IDS ( diff, 0 );
+}
+
+static int comparePrivateIds ( const void* entry1, const void* entry2 )
+{
+    const signal_list* list1 = *(signal_list* const*)entry1;
+    const signal_list* list2 = *(signal_list* const*)entry2;
+
+    int diff = COMPARE_IDS ( list1->domainId, list2->domainId );
+
+    return diff != 0 ? diff : COMPARE_IDS ( list1->privateId, list2->privateId );
+}
+
+
+//
+//  Sort an array of signal lists and return true if any 2 of them have the
+//  same key.
+//
+static bool sortSignalLists ( signal_list** lists,
+                              unsigned int  count,
+                              int ( *compare ) ( const void*, const void* ) )
+{
+    unsigned int i;
+
+    qsort ( lists, count, sizeof(signal_list*), compare );
+
+    for ( i = 1; i < count; ++i )
+    {
+        if ( compare ( &lists[i - 1], &lists[i] ) == 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//
+//  Give back the signal lists (and their names) created for a batch of
+//  signal definitions that could not be defined.
+//
+static void freeSignalLists ( signal_list** lists, unsigned int count )
+{
+    unsigned int i;
 
-    //
-    //  If the search failed, return an error code to the caller.  The name
-    //  that was specified does not exist in our indices.
-    //
-    if ( signalList == NULL )
+    for ( i = 0; i < count; ++i )
     {
-        return EINVAL;
+        if ( lists[i]->name != 0 )
+        {
+            sm_free ( toAddress ( lists[i]->name ) );
+        }
+        sm_free ( lists[i] );
     }
-    //
-    //  Copy the signal id from the returned data structure into the caller's
-    //  return value pointer.
-    //
-    *signalId = signalList->signalId;
+}
 
-    LOG ( "vsi_name_string_to_id returning domain: %d, signal: %d\n",
-          signalList->domainId, signalList->signalId );
-    //
-    //  Return a good completion code to the caller.
-    //
-    return 0;
+
+//
+//  Remove the signal lists that were bulk loaded into an index.
+//
+static void unloadSignalIndex ( btree_t*      index,
+                                signal_list** lists,
+                                unsigned int  count )
+{
+    unsigned int i;
+
+    for ( i = 0; i < count; ++i )
+    {
+        btree_delete ( index, lists[i] );
+    }
 }
 
-/*!-----------------------------------------------------------------------
 
-    v s i _ s i g n a l _ i d _ t o _ s t r i n g
+//
+//  Define each of the signals in a batch of signal definitions with the
+//  normal single signal function.
+//
+static int defineEachSignal ( const domain_t     domainId,
+                              signal_definition* definitions,
+                              unsigned int       count )
+{
+    unsigned int i;
+    int          status = 0;
 
-    @brief Convert a signal domain and ID to it's ASCII string name.
+    for ( i = 0; i < count && status == 0; ++i )
+    {
+        status = vsi_define_signal ( domainId, definitions[i].signalId,
+                                     definitions[i].privateId,
+                                     definitions[i].name );
+    }
+    return status;
+}
 
-    The domainId is the domain ID to be converted.
 
-    The signalId is the signal ID to be converted.
+/*!-----------------------------------------------------------------------
 
-    The name is an ASCII character string that has been defined in the VSS and
-    associated with a domain and a numeric signal ID value.
+    v s i _ d e f i n e _ s i g n a l s
 
-    The name pointer must be a preallocated memory area that is large enough
-    to contain the name of the signal being asked for.  The name of the signal
-    will be copied into that buffer and null terminated.
+    @brief Define a batch of new signal list definition records.
 
-    The nameLength is the maximum number of bytes of data that will be copied
-    into the supplied buffer by the API code.  This value should be set to the
-    maximum size of the name buffer being supplied.  If the name buffer
-    supplied is not large enough to contain the entire name, the data will be
-    truncated to fit into the buffer.
+    This function has the same result as calling vsi_define_signal for each
+    of the definitions in the array.  If the signal ID, signal name and
+    private ID indices are all empty (as they are when a fresh shared memory
+    segment is being populated) and the definitions don't contain any
+    duplicate keys, the definitions are sorted once for each index and the
+    indices are built with btree_bulk_load instead of inserting each signal
+    into them individually.  Otherwise the signals are defined one at a time
+    with vsi_define_signal.
 
-    @param[in] - domainId - The signal domain ID to be converted.
-    @param[in] - signalId - The signal ID to be converted.
-    @param[in/out] - name - A pointer to a buffer in which to store the name.
-    @param[in] - nameLength - The size of the name buffer being supplied.
+    If the indices are bulk loaded and any of them can't be built, the ones
+    that were already built are emptied again and none of the signals are
+    defined.
 
-    @return - status - The return status of the function
+    @param[in] domainId - The signal domain ID of the signals to be defined.
+    @param[in] definitions - The array of signal definitions.
+    @param[in] count - The number of definitions in the array.
+
+    @return 0 on success
+            ENOMEM - The signal lists or indices could not be allocated
 
 ------------------------------------------------------------------------*/
-int vsi_signal_id_to_string ( const domain_t domainId,
-                              const signal_t signalId,
-                              char**         name,
-                              int            nameLength )
+int vsi_define_signals ( const domain_t     domainId,
+                         signal_definition* definitions,
+                         unsigned int       count )
 {
-    signal_list* signalList = 0;
-
+    signal_list** byId         = NULL;
+    signal_list** byName       = NULL;
+    signal_list** byPrivateId  = NULL;
+    signal_list*  signalList;
+    char*         tempName;
+    unsigned int  created      = 0;
+    unsigned int  nameCount    = 0;
+    unsigned int  privateCount = 0;
+    unsigned int  i;
+    int           nameLen;
+    int           status       = 0;
+    bool          duplicates   = false;
+
+    LOG ( "Defining %u signals in domain %d\n", count, domainId );
+
+    //
+    //  If any of the indices already have signals in them, they can't be
+    //  bulk loaded so just define the signals one at a time.
+    //
+    if ( count == 0 ||
+         vsiContext->signalIdIndex.count != 0 ||
+         vsiContext->signalNameIndex.count != 0 ||
+         vsiContext->privateIdIndex.count != 0 )
+    {
+        return defineEachSignal ( domainId, definitions, count );
+    }
     //
-    //  Make sure all of the required input arguments are supplied.
+    //  Allocate the arrays that will hold the signal lists in the order of
+    //  each of the indices.
     //
-    CHECK_AND_RETURN_IF_ERROR ( name );
+    byId        = malloc ( count * sizeof(signal_list*) );
+    byName      = malloc ( count * sizeof(signal_list*) );
+    byPrivateId = malloc ( count * sizeof(signal_list*) );
 
+    if ( byId == NULL || byName == NULL || byPrivateId == NULL )
+    {
+        status = ENOMEM;
+        goto defineExit;
+    }
     //
-    //  Allocate a scratch signal list to use for the lookup in the btrees.
+    //  Create a new signal list for each definition and populate it just as
+    //  vsi_define_signal would.
     //
-    signal_list* requestedSignalList = sm_malloc ( sizeof(signal_list) );
+    for ( created = 0; created < count; ++created )
+    {
+        signalList = newSignalList ( domainId, definitions[created].signalId );
+        if ( signalList == NULL )
+        {
+            status = ENOMEM;
+            break;
+        }
+        byId[created] = signalList;
 
-    //
-    //  Initialize the id fields for the lookup operation.
-    //
-    requestedSignalList->domainId = domainId;
-    requestedSignalList->signalId = signalId;
+        if ( definitions[created].privateId != 0 )
+        {
+            signalList->privateId = definitions[created].privateId;
+            byPrivateId[privateCount++] = signalList;
+        }
+        if ( definitions[created].name != NULL )
+        {
+            nameLen  = strlen ( definitions[created].name ) + 1;
+            tempName = sm_malloc ( nameLen );
+            if ( tempName == NULL )
+            {
+                sm_free ( signalList );
+                status = ENOMEM;
+                break;
+            }
+            memset ( tempName, 0, nameLen );
+            strncpy ( tempName, definitions[created].name, nameLen - 1 );
 
+            signalList->name = toOffset ( tempName );
+            byName[nameCount++] = signalList;
+        }
+    }
     //
-    //  Go find the record that has this name.
+    //  Sort the signal lists into the order of each index.  If any of the
+    //  keys are duplicated, the indices can't be bulk loaded.
     //
-    signalList = btree_search ( &vsiContext->signalIdIndex, requestedSignalList );
-
+    if ( status == 0 )
+    {
+        duplicates = sortSignalLists ( byId, count, compareSignalIds ) ||
+                     sortSignalLists ( byName, nameCount, compareSignalNames ) ||
+                     sortSignalLists ( byPrivateId, privateCount,
+                                       comparePrivateIds );
+    }
     //
-    //  Deallocate the request structure.
+    //  If we could not create all of the signal lists or there are duplicate
+    //  keys, give back the signal lists we created.
     //
-    sm_free ( requestedSignalList );
+    if ( status != 0 || duplicates )
+    {
+        freeSignalLists ( byId, created );
+
+        if ( status != 0 )
+        {
+            goto defineExit;
+        }
+        free ( byId );
+        free ( byName );
+        free ( byPrivateId );
 
+        return defineEachSignal ( domainId, definitions, count );
+    }
     //
-    //  If the search failed, return an error code to the caller.  The ids
-    //  that were specified do not exist in our indices.
+    //  Go build each of the indices from the sorted signal lists.
     //
-    if ( signalList == NULL )
+    status = btree_bulk_load ( &vsiContext->signalIdIndex, (void**)byId, count );
+    if ( status == 0 )
     {
-        return EINVAL;
+        status = btree_bulk_load ( &vsiContext->signalNameIndex,
+                                   (void**)byName, nameCount );
+    }
+    if ( status == 0 )
+    {
+        status = btree_bulk_load ( &vsiContext->privateIdIndex,
+                                   (void**)byPrivateId, privateCount );
     }
     //
-    //  Copy the domain and signal ids from the returned data structure into
-    //  the caller's return value pointers.
+    //  If any of the indices could not be built, take the signal lists back
+    //  out of the ones that were so that none of the signals are defined.
+    //  An index that failed to load is left empty by btree_bulk_load.
     //
-    strncpy ( *name, toAddress ( signalList->name ), nameLength );
+    if ( status != 0 )
+    {
+        printf ( "Error: Unable to load the signal indices: %d[%s]\n",
+                 status, strerror(status) );
+
+        if ( vsiContext->signalNameIndex.count != 0 )
+        {
+            unloadSignalIndex ( &vsiContext->signalNameIndex, byName,
+                                nameCount );
+        }
+        if ( vsiContext->signalIdIndex.count != 0 )
+        {
+            unloadSignalIndex ( &vsiContext->signalIdIndex, byId, count );
+        }
+        freeSignalLists ( byId, count );
 
+        goto defineExit;
+    }
     //
-    //  Return a good completion code to the caller.
+    //  Enter all of the new signal lists into the dense signal index.
     //
-    return 0;
-}
-
+    for ( i = 0; i < count; ++i )
+    {
+        denseSignalStore ( byId[i] );
+    }
 
-/*!-----------------------------------------------------------------------
+defineExit:
 
-    v s i _ d e f i n e _ s i g n a l
+    //
+    //  Go free the working storage we used.
+    //
+    free ( byId );
+    free ( byName );
+    free ( byPrivateId );
 
-    @brief Define a new signal list definition record.
+    return status;
+}
 
-    This function will define a new signal list definition record.  This
-    record will be inserted into the signal Id and signal Name btree indices
-    to allow conversions between the Id and Name of a signal and vice versa.
-    Afer this function has been called, the structure that was created can be
-    found in the btrees using the normal btree lookup functions.
 
-    The privateId will only be inserted into it's btree if the input value is
-    not zero.
+/*!-----------------------------------------------------------------------
 
-    The name string will only be inserted into it's btree if the input value
-    is not null.
+    v s i _ s e t _ s i g n a l _ r e t e n t i o n
 
-    Use this function to create an empty signal list structure in the btrees.
-    This is useful when reading in a vechicle signal specification file for
-    instance.
+    @brief Set the retention policy of a signal.
 
-    @param[in] domainId - The signal domain ID to be defined.
-    @param[in] signalId - The signal ID to be defined.
-    @param[in] privateId - The private ID to be defined.
-    @param[in] name - The ASCII name of the signal to be defined.
+    @param[in] domainId - The domain ID of the signal.
+    @param[in] signalId - The signal ID of the signal.
+    @param[in] retention - The new retention policy.
 
     @return status - The return status of the function (0 = Good)
 
 ------------------------------------------------------------------------*/
-int vsi_define_signal ( const domain_t domainId,
-                        const signal_t signalId,
-                        const signal_t privateId,
-                        const char*    name )
+int vsi_set_signal_retention ( const domain_t       domainId,
+                               const signal_t       signalId,
+                               const vsi_retention* retention )
 {
-    LOG ( "Defining: domainId: %d, signalId: %d, privateId: %d, name[%s]\n",
-          domainId, signalId, privateId, name );
-    //
-    //  Go find the signal list control block for this domain and signal.  Note
-    //  that if the signal list does not exist yet, a new one will be created
-    //  and initialized.
-    //
-    signal_list* signalList = findSignalList ( domainId, signalId );
+    CHECK_AND_RETURN_IF_ERROR ( retention );
 
-    //
-    //  If there is a private ID for this signal, add it's definition to the
-    //  private index as well.
-    //
-    if ( privateId != 0 )
+    signal_list* signalList = findSignalList ( domainId, signalId );
+    if ( signalList == NULL )
     {
-        btree_insert ( &vsiContext->privateIdIndex, signalList );
+        return ENOMEM;
     }
     //
-    //  If a name was specified, allocate a buffer for the name string and
-    //  store it in the new structure.
+    //  Each limit is stored atomically since the producers of the signal
+    //  may be enforcing the old policy while we change it.
     //
-    if ( name != NULL )
-    {
-        //
-        //  Get the length of the name (with the terminating null byte).
-        //
-        int nameLen = strlen(name) + 1;
+    __atomic_store_n ( &signalList->retention.maxCount, retention->maxCount,
+                       __ATOMIC_RELAXED );
+    __atomic_store_n ( &signalList->retention.maxBytes, retention->maxBytes,
+                       __ATOMIC_RELAXED );
+    __atomic_store_n ( &signalList->retention.maxAge, retention->maxAge,
+                       __ATOMIC_RELAXED );
+    return 0;
+}
 
-        //
-        //  Allocate a shared memory buffer to hold the name.
-        //
-        char* tempName = sm_malloc ( nameLen );
-        memset ( tempName, 0, nameLen );
 
-        //
-        //  Store the offset to the new name buffer in the signal list
-        //  structure.
-        //
-        signalList->name = toOffset ( tempName );
+/*!-----------------------------------------------------------------------
 
-        //
-        //  Copy the input name string into the new buffer.
-        //
-        strncpy ( tempName, name, nameLen - 1 );
+    v s i _ s e t _ d o m a i n _ r e t e n t i o n
 
-        //
-        //  Go add this signal list structure to the signal-name btree index.
-        //
-        btree_insert ( &vsiContext->signalNameIndex, signalList );
+    @brief Set the default retention policy of a domain.
+
+    @param[in] domainId - The domain ID.
+    @param[in] retention - The new retention policy.
+
+    @return status - The return status of the function (0 = Good)
+
+------------------------------------------------------------------------*/
+int vsi_set_domain_retention ( const domain_t       domainId,
+                               const vsi_retention* retention )
+{
+    CHECK_AND_RETURN_IF_ERROR ( retention );
+
+    if ( domainId < 0 || domainId >= VSI_DENSE_DOMAIN_COUNT )
+    {
+        printf ( "Error: Domain %d cannot have a retention policy\n",
+                 domainId );
+        return EINVAL;
     }
-    //
-    //  Return a good completion code to the caller.
-    //
+    vsi_retention* domainRetention = &vsiContext->domainRetention[domainId];
+
+    __atomic_store_n ( &domainRetention->maxCount, retention->maxCount,
+                       __ATOMIC_RELAXED );
+    __atomic_store_n ( &domainRetention->maxBytes, retention->maxBytes,
+                       __ATOMIC_RELAXED );
+    __atomic_store_n ( &domainRetention->maxAge, retention->maxAge,
+                       __ATOMIC_RELAXED );
     return 0;
 }
 
@@ -2918,7 +7924,27 @@ void printSignalList ( signal_list* signalList, int maxSignals )
     //
     //  If there are some signals in this signal list...
     //
-    if ( signalList->currentSignalCount > 0 )
+    //
+    //  If this signal list is stored in a ring, display the ring parameters.
+    //
+    if ( signalList->ringCapacity != 0 )
+    {
+        printf ( "  Ring offset......: 0x%lx[%lu]\n", signalList->ring,
+                 signalList->ring );
+        printf ( "  Ring capacity....: %'lu\n", signalList->ringCapacity );
+        printf ( "  Ring slot size...: %'lu\n", signalList->ringSlotSize );
+        printf ( "  Ring head........: %'lu\n", signalList->ringHead );
+        printf ( "  Ring tail........: %'lu\n", signalList->ringTail );
+    }
+    if ( signalList->currentSignalCount > 0 && signalList->ringCapacity != 0 )
+    {
+        printf ( "  Signal count.....: %'lu\n", signalList->currentSignalCount );
+        printf ( "  Total signal size: %lu[0x%lx]\n", signalList->totalSignalSize,
+              signalList->totalSignalSize );
+
+        printSignalData ( signalList, maxSignals );
+    }
+    else if ( signalList->currentSignalCount > 0 )
     {
         //
         //  If the head offset indicates that this is the end of the signal
@@ -3030,6 +8056,33 @@ void printSignalData ( signal_list* signalList, int maxSignals )
         return;
     }
     //
+    //  If this signal list is stored in a ring, display each of the slots
+    //  between the head and the tail of the ring.
+    //
+    if ( signalList->ringCapacity != 0 )
+    {
+        unsigned long position;
+
+        printf ( "  Signal ring [%p:0x%lx]:\n", signalList, signalList->ring );
+
+        for ( position = signalList->ringHead;
+              position != signalList->ringTail; ++position )
+        {
+            signal_ring_slot* slot = ringSlot ( signalList, position );
+
+            printf ( "    %'d - %'lu Signal data size...: %'lu\n", ++i,
+                     position, slot->messageSize );
+
+            HexDump ( slot->data, slot->messageSize, "Signal Data", 10 );
+
+            if ( --maxSignals == 0 )
+            {
+                break;
+            }
+        }
+        return;
+    }
+    //
     //  Get an actual pointer to the first signal in this list.  This is
     //  the signal that is pointed to by the "head" offset.
     //
@@ -3048,7 +8101,7 @@ void printSignalData ( signal_list* signalList, int maxSignals )
         //
         //  Display the size of this signal in bytes.
         //
-        printf ( "    %'d - 0x%lx Signal data size...: %'lu\n", ++i,
+        printf ( "    %'d - 0x%lx Signal data size...: %'u\n", ++i,
                  signalOffset, signal->messageSize );
         //
         //  Go dump the contents of the data field for this signal.
@@ -3147,8 +8200,7 @@ void groupTraverseFunction ( char* leader, void* dataPtr )
 void printSignalGroup ( char* leader, void* data )
 {
 #ifdef VSI_DEBUG
-    vsi_signal_group_data* groupData;
-    signal_list*           signalList;
+    signal_list* signalList;
 
     if ( data == NULL )
     {
@@ -3163,61 +8215,44 @@ void printSignalGroup ( char* leader, void* data )
     printf ( "%sSignal Group:    %d\n", leader, signalGroup->groupId );
 
     //
-    //  Print the number of signals defined in this group.
+    //  Get the member array of this group.  We stay inside an epoch protected
+    //  section while we print it in case the members are changed meanwhile.
     //
-    printf ( "%s   Signal Count: %d\n", leader, signalGroup->count );
+    int count;
 
-    //
-    //  Get the offset of the beginning of the signal list.
-    //
-    offset_t groupDataOffset = signalGroup->head;
+    sm_epoch_enter();
+
+    offset_t* members = groupMembers ( signalGroup, &count );
 
     //
-    //  Print the offset of the beginning of the signal list.
+    //  Print the number of signals defined in this group.
     //
-    if ( groupDataOffset == END_OF_LIST_MARKER )
-	{
-        printf ( "%s   Head Offset.: End of List Marker\n", leader );
-	}
-	else
-	{
-        printf ( "%s   Head Offset.: 0x%lx[%lu]\n", leader, groupDataOffset,
-                 groupDataOffset );
-	}
+    printf ( "%s   Signal Count: %d\n", leader, count );
+
     //
-    //  Print the offset of the end of the signal list.
+    //  Print the offset of the member array.
     //
-    if ( signalGroup->tail == END_OF_LIST_MARKER )
-	{
-        printf ( "%s   Tail Offset.: End of List Marker\n", leader );
-	}
-	else
-	{
-        printf ( "%s   Tail Offset.: 0x%lx[%lu]\n", leader, signalGroup->tail,
-                 signalGroup->tail );
-	}
+    printf ( "%s   Members.....: 0x%lx[%lu]\n", leader,
+             signalGroup->members, signalGroup->members );
+
     //
-    //  If the list is empty, tell the caller that and quit.
+    //  If the group is empty, tell the caller that and quit.
     //
-    if ( groupDataOffset == END_OF_LIST_MARKER )
+    if ( count == 0 )
     {
+        sm_epoch_exit();
         printf ( "%s   Group has no signals defined.\n", leader );
         return;
     }
     //
-    //  While we have not reached the end of the signal list...
+    //  For each of the signals in the group...
     //
-    while ( groupDataOffset != END_OF_LIST_MARKER )
+    for ( int i = 0; i < count; ++i )
     {
-		//
-        //  Get an actual pointer to this signal in this list.
-		//
-        groupData = toAddress ( groupDataOffset );
-
         //
-        //  Now get the address of the signal list structure.
+        //  Get the address of the signal list structure.
         //
-        signalList = toAddress ( groupData->signalList );
+        signalList = toAddress ( members[i] );
 
         //
         //  Go print the contents of the current signal structure.
@@ -3225,11 +8260,9 @@ void printSignalGroup ( char* leader, void* data )
         printf ( "%s      Domain: %d, Signal: %d, Name:[%s]\n", leader,
                  signalList->domainId, signalList->signalId,
                  (char*)toAddress ( signalList->name ) );
-        //
-        //  Get the next signal definition object in the list for this group.
-        //
-        groupDataOffset = groupData->nextMessageOffset;
     }
+    sm_epoch_exit();
+
     return;
 #endif
 }
@@ -69,6 +69,30 @@ void HexDump ( const char *data, int length, const char *title,
 #define HEX_DUMP_L( data, length, spaces ) HexDump ( data, length, "", spaces )
 
 
+/*!-----------------------------------------------------------------------
+
+    s i g n a l _ s t a m p
+
+    @brief Define the capture time and sequence number of a signal sample.
+
+    Every signal that is stored carries one of these.  The "timestamp" is the
+    time the signal was captured in nanoseconds of CLOCK_MONOTONIC.  It is
+    normally taken when the signal is inserted but the producer may supply
+    it's own capture time (from a hardware or kernel receive timestamp for
+    instance) as long as it is in the same clock.  The "sequence" is the
+    number of signals that had been inserted into the signal list when this
+    one was, starting at 1, so gaps in the sequence seen by a consumer show
+    how many signals it missed.
+
+------------------------------------------------------------------------*/
+typedef struct signal_stamp
+{
+    unsigned long timestamp;
+    unsigned long sequence;
+
+}   signal_stamp;
+
+
 /*!-----------------------------------------------------------------------
 
     s i g n a l _ l i s t
@@ -86,6 +110,26 @@ void HexDump ( const char *data, int length, const char *title,
     combinations to be stored in the system.
 
 ------------------------------------------------------------------------*/
+
+//
+//  Define the largest signal data size that will be kept in the "latest
+//  value" cache of a signal list.  Signals that are larger than this will be
+//  read from the signal list itself.  The "uncached" size marks a cache whose
+//  latest signal was too large to be stored in it.
+//
+#define SIGNAL_LATEST_VALUE_SIZE ( 64 )
+#define SIGNAL_LATEST_UNCACHED   ( (unsigned long)-1 )
+
+//
+//  Define how many times the latest value cache will be retried while a
+//  writer holds it before giving up on it.  A writer that dies while it
+//  holds the cache leaves the sequence odd forever, so the next writer that
+//  gives up waiting for it marks the cache as "disabled".  Readers and
+//  writers of a disabled cache use the signal list itself.
+//
+#define SIGNAL_LATEST_SPIN_LIMIT ( 100000 )
+#define SIGNAL_LATEST_DISABLED   ( (unsigned long)-1 )
+
 typedef struct signal_list
 {
     //
@@ -109,8 +153,15 @@ typedef struct signal_list
     //  message to the list and we can't back up in the list (it's a singly
     //  linked list).
     //
-    offset_t head;
-    offset_t tail;
+    //  The "listLock" serializes everything that changes the head or tail:
+    //  appending a signal, claiming the oldest signal for removal and
+    //  switching the list to the ring storage mode.  Readers walk the list
+    //  without it.  It is a robust process shared mutex so that the list is
+    //  repaired rather than wedged if the process holding it dies.
+    //
+    offset_t        head;
+    offset_t        tail;
+    pthread_mutex_t listLock;
 
     //
     //  The following fields are just for informational use.  We probably
@@ -121,6 +172,61 @@ typedef struct signal_list
     unsigned long currentSignalCount;
     unsigned long totalSignalSize;
 
+    //
+    //  Define the ring buffer storage mode fields.  If the ring capacity is
+    //  zero, the signals in this list are stored in the linked list described
+    //  above.  Otherwise, the signals are stored in a preallocated array of
+    //  "ringCapacity" fixed size slots located at the "ring" offset and the
+    //  head and tail offsets above are not used.
+    //
+    //  The ring head and tail are free running sequence numbers that are only
+    //  ever manipulated with atomic operations.  The head is the sequence
+    //  number of the oldest signal in the ring and the tail is the sequence
+    //  number that the next inserted signal will get.  The slot index of a
+    //  sequence number is "sequence & ( ringCapacity - 1 )".
+    //
+    unsigned long ringCapacity;     // Number of slots (power of 2) or 0
+    unsigned long ringSlotSize;     // Maximum data bytes in each slot
+    unsigned long ringSlotStride;   // Total bytes occupied by each slot
+    offset_t      ring;             // Offset to the first signal_ring_slot
+    unsigned long ringHead;
+    unsigned long ringTail;
+
+    //
+    //  Define the "latest value" cache for this signal list.  Every insert
+    //  copies the new signal data into this cache (if it fits) so that the
+    //  newest value of a signal can be read without taking any locks.
+    //
+    //  The cache is protected by a sequence lock.  A writer makes the
+    //  sequence odd while it is updating the cache and even again when it is
+    //  done.  A reader copies the cache and then checks that the sequence was
+    //  even and did not change during the copy, retrying if it did.  A
+    //  sequence of zero means no signal has been cached yet and a sequence of
+    //  SIGNAL_LATEST_DISABLED means the cache is no longer used.
+    //
+    unsigned long latestSequence;
+    unsigned long latestSize;
+    signal_stamp  latestStamp;
+    char          latestValue[SIGNAL_LATEST_VALUE_SIZE] __attribute__ ((aligned (8)));
+
+    //
+    //  Define the sequence number of the last signal inserted into this
+    //  signal list (see signal_stamp).  This is only ever manipulated with
+    //  atomic operations.
+    //
+    unsigned long sampleSequence;
+
+    //
+    //  Define the retention policy of this signal list (see vsi_retention).
+    //
+    vsi_retention retention;
+
+    //
+    //  Define the offset of the first named consumer cursor registered on
+    //  this signal list (see signal_cursor).
+    //
+    offset_t cursors;
+
     //
     //  Define the semaphore that will be used to manage the processes waiting
     //  for signals on the message queue.  Each signal that is received will
@@ -132,6 +238,21 @@ typedef struct signal_list
     //
     semaphore_t semaphore;
 
+    //
+    //  Define the notification mask for this signal list.  Each bit that is
+    //  set is the index of a notifier (see vsi_notifier) that must be
+    //  notified every time a signal is inserted into this list.  This is
+    //  only ever manipulated with atomic operations.
+    //
+    unsigned long notifyMask;
+
+    //
+    //  Define the offset of the first record in the list of groups that this
+    //  signal is a member of (see signal_membership).  Every insert into
+    //  this signal list notifies each of those groups.
+    //
+    offset_t groups;
+
 }   signal_list;
 
 #define SIGNAL_LIST_SIZE   ( sizeof(signal_list) )
@@ -185,6 +306,15 @@ TODO: REDO!
     this message have gotten a copy of the message before the message is
     removed from the message list.
 
+    The "referenceCount" is the number of references to this record.  The
+    signal list holds one reference while the record is linked into it and
+    every read lease (see vsi_lease_oldest_signal) holds another one.  The
+    record is only given back to the memory manager when the last reference
+    is released so a leased record can safely be read in place even after it
+    has been removed from it's signal list.
+
+    The "stamp" is the capture time and sequence number of the signal.
+
     The "data" field is where the actual data that the user has asked us to
     store will be copied.  This is an array of bytes whose size depends on the
     "messageSize" that the caller has specified.
@@ -192,9 +322,11 @@ TODO: REDO!
 ------------------------------------------------------------------------*/
 typedef struct signal_data
 {
-    offset_t nextMessageOffset;
-    offset_t messageSize;
-    char     data[0];
+    offset_t     nextMessageOffset;
+    unsigned int messageSize;
+    unsigned int referenceCount;
+    signal_stamp stamp;
+    char         data[0];
 
 }   signal_data;
 
@@ -210,6 +342,182 @@ typedef struct signal_data
 #define SIGNAL_DATA_HEADER_SIZE ( sizeof(signal_data) )
 
 
+/*!-----------------------------------------------------------------------
+
+    s i g n a l _ c u r s o r
+
+    @brief Define a named consumer cursor on a signal list.
+
+    A cursor is the read position of one consumer in the stream of signals
+    of a signal list.  Every cursor on a signal list sees every signal
+    inserted into it, independently of the other cursors and of how fast they
+    are read, and a signal is only removed from the signal list once every
+    cursor on it has read past it.
+
+    The cursors of a signal list are kept on a singly linked list starting at
+    the "cursors" offset of the signal list.  Cursors are pushed onto that
+    list with a compare and swap and are never unlinked or freed so that the
+    list can be walked without any locks.  A cursor that is deleted is just
+    marked inactive and is reused if a cursor with the same name is opened
+    again.
+
+    The "active" field is 1 while the cursor is registered, 0 once it has
+    been deleted and SIGNAL_CURSOR_REOPENING plus the process ID of the
+    process reopening it while it is being reopened.  The process ID lets a
+    cursor whose reopener died be reclaimed by the next process to open it.
+
+    For a signal list stored in a linked list, the "position" is the
+    sequence number of the last signal read through the cursor (0 if none
+    has been read yet) and the "record" is the offset of that signal's data
+    record.  For a signal list stored in a ring, the "position" is the ring
+    position of the next signal to be read and the "record" is not used.
+
+------------------------------------------------------------------------*/
+#define SIGNAL_CURSOR_NAME_SIZE ( 32 )
+
+//
+//  Define the flag in the "active" field of a cursor that is being reopened.
+//
+#define SIGNAL_CURSOR_REOPENING ( 1UL << 32 )
+
+typedef struct signal_cursor
+{
+    offset_t      next;
+    unsigned long active;
+    unsigned long position;
+    offset_t      record;
+    char          name[SIGNAL_CURSOR_NAME_SIZE];
+
+}   signal_cursor;
+
+
+/*!-----------------------------------------------------------------------
+
+    s t r u c t   v s i _ l e a s e
+
+    @brief Define a read lease on a signal.
+
+    A lease is a pinned, read only view of a single signal record in the
+    shared memory segment.  The record will not be recycled until the lease
+    is released with vsi_release_lease, even if it is removed from it's
+    signal list (or the signal list is flushed) in the meantime, so the data
+    can be consumed in place without being copied.
+
+    The domainId and signalId must be set by the caller before the lease is
+    acquired.  The data, dataLength, timestamp and sequence fields are filled
+    in when the lease is acquired and the data must not be used after the
+    lease is released.  The record field is private to the VSI.
+
+------------------------------------------------------------------------*/
+typedef struct vsi_lease
+{
+    domain_t      domainId;
+    signal_t      signalId;
+    const char*   data;
+    unsigned long dataLength;
+    unsigned long timestamp;
+    unsigned long sequence;
+    offset_t      record;
+
+}   vsi_lease;
+
+
+/*!-----------------------------------------------------------------------
+
+    s t r u c t   v s i _ c u r s o r
+
+    @brief Define a process handle to a named consumer cursor.
+
+    A cursor handle is filled in by vsi_open_cursor or vsi_open_group_cursor
+    and then passed to vsi_read_cursor to read the signals through the
+    cursor.  All of the fields are private to the VSI.
+
+    The named cursor itself lives in the shared memory segment so it keeps
+    it's position after the handle is closed and can be opened again by the
+    same or a different process to continue reading where it left off.  A
+    cursor must only be read by one thread at a time.
+
+    A group cursor is a cursor with the same name on every signal in the
+    group.  The "notifier" is the group notifier that is used to wait for
+    signals on a group cursor or -1 if it has not been opened yet.
+
+------------------------------------------------------------------------*/
+typedef struct vsi_cursor
+{
+    bool     isGroup;
+    group_t  groupId;
+    domain_t domainId;
+    signal_t signalId;
+    offset_t cursor;
+    int      notifier;
+    char     name[SIGNAL_CURSOR_NAME_SIZE];
+
+}   vsi_cursor;
+
+
+/*!-----------------------------------------------------------------------
+
+    s i g n a l _ r i n g _ s l o t
+
+    @brief Define the structure of each slot in a signal ring buffer.
+
+    A signal list that has been defined in the ring buffer storage mode has
+    all of it's slots allocated in one contiguous block when the signal is
+    defined so that inserting and fetching signals never needs to call the
+    shared memory allocator.
+
+    The "sequence" field is used to coordinate the producers and consumers of
+    the ring without a lock.  A slot whose sequence is equal to a ring
+    position is free for a producer to claim for that position.  A slot whose
+    sequence is one greater than a ring position holds a published signal for
+    that position that can be consumed.  When a consumer removes a signal, the
+    sequence is advanced by the capacity of the ring to make the slot
+    available to the producer of the next lap.
+
+    The "messageSize" field is the number of bytes of data stored in the
+    "data" field of the slot which can be at most the "ringSlotSize" defined
+    in the signal list.
+
+    The "stamp" is the capture time and sequence number of the signal.
+
+------------------------------------------------------------------------*/
+typedef struct signal_ring_slot
+{
+    unsigned long sequence;
+    unsigned long messageSize;
+    signal_stamp  stamp;
+    char          data[0] __attribute__ ((aligned (8)));
+
+}   signal_ring_slot;
+
+#define SIGNAL_RING_SLOT_HEADER_SIZE ( sizeof(signal_ring_slot) )
+
+
+/*!-----------------------------------------------------------------------
+
+    s i g n a l _ d e f i n i t i o n
+
+    @brief Define one entry of a batch of signal definitions.
+
+    An array of these structures is passed to vsi_define_signals to define
+    a whole set of signals (such as the contents of a VSS file) at once.  The
+    fields have the same meaning as the arguments of vsi_define_signal.
+
+------------------------------------------------------------------------*/
+typedef struct signal_definition
+{
+    signal_t    signalId;
+    signal_t    privateId;
+    const char* name;
+
+}   signal_definition;
+
+//
+//  Define the largest ring that can be created for a single signal.
+//
+#define SIGNAL_RING_MAX_CAPACITY ( 1UL << 20 )
+
+
 /*!-----------------------------------------------------------------------
 
     V S I   S i g n a l   G e n e r a t i o n
@@ -302,6 +610,34 @@ int vsi_insert_signal ( vsi_result* result );
 int vsi_insert_signal_by_name ( vsi_result* result );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ i n s e r t _ s i g n a l s
+
+    @brief Fire several vehicle signals at once.
+
+    This function is equivalent to calling vsi_insert_signal for each of the
+    results in the array, in order, but it is considerably cheaper when
+    several signals are produced at the same time (such as all of the
+    signals decoded from a single CAN frame).  All of the signal lists are
+    looked up first, the memory for all of the signals is allocated at once
+    and each waiting consumer is only released once, after all of the
+    signals in the batch have been stored.
+
+    The domainId, signalId, data and dataLength fields must be set in each
+    of the result structures.  The status field of each result structure is
+    set to the completion status of that signal.
+
+    @param[in/out] - results - The array of vsi_result objects to insert.
+    @param[in] - count - The number of vsi_result objects in the array.
+
+    @return 0 if all of the signals were inserted
+            Otherwise the status of the first signal that failed
+
+------------------------------------------------------------------------*/
+int vsi_insert_signals ( vsi_result* results, size_t count );
+
+
 /*!-----------------------------------------------------------------------
 
     V S I   S i g n a l   R e t r i e v a l
@@ -466,6 +802,275 @@ int vsi_get_newest_signal ( vsi_result* result );
 int vsi_get_newest_signal_by_name ( vsi_result* result );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ s i g n a l _ r a n g e
+
+    @brief Fetch the history of a signal within a time range.
+
+    This function copies every stored signal of the specified domain and ID
+    whose capture time is within the (inclusive) range from beginTime to
+    endTime into the caller's result structures, oldest first.  Unlike the
+    vsi_get_oldest_signal function, this call does not remove any signals
+    from the core database and it never waits for signals to arrive.
+
+    Each result structure must contain a pointer to a valid data buffer and
+    the length of the buffer just as it does for vsi_get_newest_signal.  The
+    data, dataLength, timestamp and sequence fields of the results that are
+    filled in are replaced with the signal information.
+
+    If the range contains more signals than there are result structures,
+    the oldest ones are returned.  The rest of the range can be fetched by
+    calling this function again with a beginTime one greater than the
+    timestamp of the last signal returned.
+
+    History queries are only supported on signals stored in a ring (see
+    vsi_define_signal_ring), which use a binary search to find the start of
+    the range.  Signals stored in a linked list can only be walked from the
+    oldest one so they are rejected.
+
+    @param[in] - domainId - The domain ID of the signal.
+    @param[in] - signalId - The signal ID of the signal.
+    @param[in] - beginTime - The earliest capture time (CLOCK_MONOTONIC ns).
+    @param[in] - endTime - The latest capture time (CLOCK_MONOTONIC ns).
+    @param[in/out] - results - The array of result structures.
+    @param[in/out] - count - The number of result structures on input and
+                             the number that were filled in on output.
+
+    @return 0 if successful (even if no signals were in the range)
+            EINVAL - An argument was not valid.
+            ENODATA - The signal list could not be found or created.
+            EOPNOTSUPP - The signal is not stored in a ring.
+
+------------------------------------------------------------------------*/
+int vsi_get_signal_range ( const domain_t domainId,
+                           const signal_t signalId,
+                           unsigned long  beginTime,
+                           unsigned long  endTime,
+                           vsi_result*    results,
+                           size_t*        count );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l e a s e _ o l d e s t _ s i g n a l
+
+    @brief Lease the oldest entry in the core database for a signal.
+
+    This function is identical to vsi_get_oldest_signal except that instead
+    of copying the data into a buffer supplied by the caller, the record in
+    the shared memory segment is pinned and it's address is returned in the
+    lease.  The signal is removed from the signal list just as it is by
+    vsi_get_oldest_signal but the memory it occupies is not recycled until
+    the lease is released.
+
+    Signals stored in a ring (see vsi_define_signal_ring) can be overwritten
+    by the producer at any time so they are copied into a new record in the
+    shared memory segment which is then leased.
+
+    Every successful call must be followed by a call to vsi_release_lease.
+
+    @param[in/out] - lease - The lease object.
+    @param[in] - wait - If true, wait for data if the signal list is empty.
+    @param[in] - deadline - The absolute CLOCK_MONOTONIC time at which to
+                            stop waiting or NULL to wait forever.
+
+    @return 0 if a lease was acquired
+            ENODATA - The signal list is empty and wait was false.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            ENOMEM - The memory for a ring signal copy was not available.
+
+------------------------------------------------------------------------*/
+int vsi_lease_oldest_signal ( vsi_lease*             lease,
+                              bool                   wait,
+                              const struct timespec* deadline );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ l e a s e _ n e w e s t _ s i g n a l
+
+    @brief Lease the newest entry in the core database for a signal.
+
+    This function is identical to vsi_lease_oldest_signal except that the
+    newest signal is leased and it is not removed from the signal list.
+
+    @param[in/out] - lease - The lease object.
+    @param[in] - wait - If true, wait for data if the signal list is empty.
+    @param[in] - deadline - The absolute CLOCK_MONOTONIC time at which to
+                            stop waiting or NULL to wait forever.
+
+    @return 0 if a lease was acquired
+            ENODATA - The signal list is empty and wait was false.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            ENOMEM - The memory for a ring signal copy was not available.
+
+------------------------------------------------------------------------*/
+int vsi_lease_newest_signal ( vsi_lease*             lease,
+                              bool                   wait,
+                              const struct timespec* deadline );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ r e l e a s e _ l e a s e
+
+    @brief Release a signal lease.
+
+    Once the lease is released the data it referred to may be recycled at
+    any time.
+
+    @param[in/out] - lease - The lease object.
+
+    @return 0 if the lease was released
+            EINVAL - The lease is not currently held.
+
+------------------------------------------------------------------------*/
+int vsi_release_lease ( vsi_lease* lease );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ o p e n _ c u r s o r
+
+    @brief Open a named consumer cursor on a signal.
+
+    Named cursors allow any number of consumers to read every signal of a
+    signal list, each at it's own pace, without removing signals that the
+    other consumers have not read yet.  Each signal is removed from the
+    signal list once every cursor on the list has read past it (or it is
+    discarded by the retention policy of the signal).
+
+    If a cursor with the specified name already exists on the signal, the
+    handle refers to it and reading continues at it's current position.
+    Otherwise a new cursor is created that starts at the oldest signal
+    currently stored.
+
+    Signals that are consumed with vsi_get_oldest_signal are removed for all
+    of the cursors so a signal should be consumed either through cursors or
+    with the "oldest" functions but not both.
+
+    @param[in] - domainId - The domain ID of the signal.
+    @param[in] - signalId - The signal ID of the signal.
+    @param[in] - name - The name of the cursor.
+    @param[out] - cursor - The cursor handle to be filled in.
+
+    @return 0 if successful
+            EINVAL - The name is missing or too long.
+            ENOMEM - The cursor could not be allocated.
+
+------------------------------------------------------------------------*/
+int vsi_open_cursor ( const domain_t domainId,
+                      const signal_t signalId,
+                      const char*    name,
+                      vsi_cursor*    cursor );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ o p e n _ g r o u p _ c u r s o r
+
+    @brief Open a named consumer cursor on every signal in a group.
+
+    This function is identical to vsi_open_cursor except that a cursor with
+    the specified name is opened on every signal in the group (including
+    signals added to the group later) and vsi_read_cursor returns the oldest
+    unread signal of all of them.
+
+    A group cursor waits for signals with a group notifier (see
+    vsi_open_group_notifier).  The notifier is only opened the first time
+    vsi_read_cursor has to wait on the cursor and it then occupies one of the
+    VSI_NOTIFIER_COUNT notifiers of the whole system until the cursor handle
+    is closed with vsi_close_cursor.  Group cursors that are never waited on
+    do not use a notifier.
+
+    @param[in] - groupId - The ID of the group.
+    @param[in] - name - The name of the cursor.
+    @param[out] - cursor - The cursor handle to be filled in.
+
+    @return 0 if successful
+            EINVAL - The name is missing or too long.
+            ENOENT - The group does not exist.
+            ENOMEM - The cursor could not be allocated.
+
+------------------------------------------------------------------------*/
+int vsi_open_group_cursor ( const group_t groupId,
+                            const char*   name,
+                            vsi_cursor*   cursor );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ r e a d _ c u r s o r
+
+    @brief Read the next signal through a named consumer cursor.
+
+    The next signal that has not been read through the cursor is copied into
+    the caller's buffer and the cursor is advanced past it.  The data and
+    dataLength fields of the result must describe the caller's buffer as
+    they do for vsi_get_newest_signal.  The domainId, signalId, timestamp and
+    sequence fields are set to those of the signal read.
+
+    If signals were discarded by the retention policy of the signal before
+    they could be read, the cursor skips them and the gap can be seen in
+    the sequence numbers of the signals returned.
+
+    @param[in/out] - cursor - The cursor handle.
+    @param[in/out] - result - The result structure.
+    @param[in] - wait - If true, wait for a signal if there is none to read.
+    @param[in] - deadline - The absolute CLOCK_MONOTONIC time at which to
+                            stop waiting or NULL to wait forever.
+
+    @return 0 if a signal was read
+            ENODATA - There is no signal to read and wait was false.
+            ETIMEDOUT - The deadline passed before a signal arrived.
+            ENOENT - The group of a group cursor no longer exists.
+            ENOSPC - A group cursor had to wait but all of the notifiers
+                     are in use.
+
+------------------------------------------------------------------------*/
+int vsi_read_cursor ( vsi_cursor*            cursor,
+                      vsi_result*            result,
+                      bool                   wait,
+                      const struct timespec* deadline );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c l o s e _ c u r s o r
+
+    @brief Close a cursor handle.
+
+    The resources used by the handle in this process are released.  The
+    named cursor remains registered and keeps it's position.
+
+    @param[in/out] - cursor - The cursor handle.
+
+    @return 0 if successful
+
+------------------------------------------------------------------------*/
+int vsi_close_cursor ( vsi_cursor* cursor );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e l e t e _ c u r s o r
+
+    @brief Delete a named cursor.
+
+    The named cursor (or all of the cursors of a group cursor) is removed so
+    that the signals it has not read yet are no longer kept for it and the
+    handle is closed.
+
+    @param[in/out] - cursor - The cursor handle.
+
+    @return 0 if successful
+            ENOENT - The group of a group cursor no longer exists.
+
+------------------------------------------------------------------------*/
+int vsi_delete_cursor ( vsi_cursor* cursor );
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ f l u s h _ s i g n a l
@@ -525,25 +1130,28 @@ int vsi_flush_signal_by_name ( const domain_t domain, const char* name );
 
 /*!-----------------------------------------------------------------------
 
-    s t r u c t   v s i _ i d _ n a m e _ d e f i n i t i o n
+    s t r u c t   s i g n a l _ m e m b e r s h i p
 
-    @brief This data structure is designed to hold the Id and name of each
-    signal defined in the system.
+    @brief Define one entry in the list of groups that a signal belongs to.
 
-    This defines the "user data" structure that will be used to build the
-    btree Id and name indices.  Those indices will be used to lookup the name
-    of a signal given it's domain and signals ids and vice versa.
+    This is the reverse of the member array of a group.  Each signal list
+    keeps a singly linked list of these records starting at it's "groups"
+    offset so that an insert can notify every group the signal is a member of
+    without searching the groups.
 
-    We also define some constants and macros related to the btrees that will
-    be created from this data.
+    The records are pushed onto the list with a compare and swap and are
+    never unlinked so that inserts can walk the list without any locks.
+    When a signal is removed from a group, the "group" offset of it's record
+    is set to END_OF_LIST_MARKER and the record is reused the next time the
+    signal is added to a group.
 
 ------------------------------------------------------------------------*/
-typedef struct vsi_signal_group_data
+typedef struct signal_membership
 {
-    offset_t nextMessageOffset;
-    offset_t signalList;
+    offset_t next;
+    offset_t group;
 
-}   vsi_signal_group_data;
+}   signal_membership;
 
 
 /*!-----------------------------------------------------------------------
@@ -557,16 +1165,53 @@ typedef struct vsi_signal_group_data
     another btree that is indexed by the group Id.  Each group then contains a
     list of all of the signals that have been registered for that group.
 
-    TODO: Add mutex locks to group manipulation functions.
+    The members of a group are kept in a contiguous array of signal list
+    offsets in the order they were added so that the group operations can
+    scan them without chasing a pointer for each member.  The array is never
+    changed once it has been published.  Adding or removing a member builds a
+    new array under the group's mutex, publishes it with a release store and
+    retires the old one, so readers scanning the old array inside an epoch
+    protected section are not disturbed.  The number of members is kept in
+    the array itself so that a reader always gets a count that matches the
+    array it loaded.  The "count" field of the group is only a copy of it for
+    callers sizing their result arrays.
+
+    The "insertCount" is incremented and the "semaphore" is posted every time
+    a signal is inserted into any member of the group.  A listener waits for
+    the count to change and then only has to look at the members whose latest
+    value sequence changed rather than waiting on every member separately.
+
+    The "listenerCount" is the number of threads currently listening to the
+    group.  When the group is deleted, SIGNAL_GROUP_DELETED is set in it and
+    the semaphore is posted so that the listeners wake up and return ENOENT.
+    The group record is only retired by whoever leaves it with no listeners
+    and the deleted flag set, so a listener never looks at a freed group.
 
 ------------------------------------------------------------------------*/
+//
+//  Define the flag in the listener count of a group that has been deleted.
+//
+#define SIGNAL_GROUP_DELETED ( 0x80000000U )
+
+//
+//  Define the member array of a group.
+//
+typedef struct signal_group_members
+{
+    int      count;
+    offset_t member[0];  // The signal_list offsets of the members
+
+}   signal_group_members;
+
 typedef struct vsi_signal_group
 {
     group_t         groupId;
     int             count;
-    offset_t        head;      // Offset to a vsi_signal_group_data record
-    offset_t        tail;      // Offset to a vsi_signal_group_data record
+    offset_t        members;   // Offset to the signal_group_members array
     pthread_mutex_t mutex;
+    unsigned long   insertCount;
+    semaphore_t     semaphore;
+    unsigned int    listenerCount;
 
 }   vsi_signal_group;
 
@@ -746,6 +1391,18 @@ int vsi_remove_signal_from_group_by_name ( const domain_t domain,
     result structure for that particular signal.  Once all of the signals have
     been checked, this function returns to the caller without waiting.
 
+    The values returned are a consistent snapshot of the group, that is, they
+    were all the newest values of their signals at the same instant even if
+    other tasks are inserting signals into the members at the same time.  As
+    with vsi_get_newest_signal, each result structure must contain the address
+    and size of the buffer that the data of it's signal is to be copied into.
+
+    Getting a consistent snapshot is only attempted a limited number of
+    times.  If the members are written so often that every attempt is
+    disturbed, EAGAIN is returned.  The results then hold the newest value of
+    each signal at the time it was copied but those values may not all be
+    from the same instant.
+
     The groupId is the numeric group ID previously assigned to the group being
     operated on.
 
@@ -763,7 +1420,10 @@ int vsi_remove_signal_from_group_by_name ( const domain_t domain,
     @param[in] - groupId - The ID value of the group to be modified.
     @param[in/out] - result - The array of structures that will hold the data.
 
-    @return - status - The return status of the function
+    @return 0 if successful
+            ENOENT - The group does not exist.
+            ENOMEM - Memory could not be allocated.
+            EAGAIN - The results are not a consistent snapshot.
 
 ------------------------------------------------------------------------*/
 int vsi_get_newest_in_group ( const group_t groupId,
@@ -820,6 +1480,12 @@ int vsi_get_newest_in_group_wait ( const group_t groupId,
     result structure for that particular signal.  Once all of the signals have
     been checked, this function returns to the caller without waiting.
 
+    The values returned are a consistent snapshot of the group, that is, they
+    were all the newest values of their signals at the same instant even if
+    other tasks are inserting signals into the members at the same time.  As
+    with vsi_get_newest_signal, each result structure must contain the address
+    and size of the buffer that the data of it's signal is to be copied into.
+
     The groupId is the numeric group ID previously assigned to the group being
     operated on.
 
@@ -881,6 +1547,29 @@ int vsi_get_oldest_in_group_wait ( const group_t groupId,
                                    vsi_result*   result );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ g e t _ o l d e s t _ i n _ g r o u p _ w a i t _ u n t i l
+
+    @brief Wait for a signal in the specified group with a deadline.
+
+    This function is identical to vsi_get_oldest_in_group_wait except that
+    it gives up waiting when the deadline passes.
+
+    @param[in] - groupId - The ID value of the group to be modified.
+    @param[in/out] - result - The array of structures that will hold the data.
+    @param[in] - deadline - The absolute CLOCK_MONOTONIC time at which to
+                            stop waiting or NULL to wait forever.
+
+    @return 0 if a signal was received
+            ETIMEDOUT - The deadline passed before a signal arrived.
+
+------------------------------------------------------------------------*/
+int vsi_get_oldest_in_group_wait_until ( const group_t          groupId,
+                                         vsi_result*            result,
+                                         const struct timespec* deadline );
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ l i s t e n _ a n y _ i n _ g r o u p
@@ -893,21 +1582,24 @@ int vsi_get_oldest_in_group_wait ( const group_t groupId,
     this call is made will return it's value and the function will return to
     the caller.
 
-    Unlike many of the other functions which return data for a group, this
-    function does not expect (nor returns) an array of result structures.  It
-    only returns a single result for the first signal in the group that
-    contains data.
+    The results argument is an array with a result structure for every
+    member of the group.  Each result must supply a data buffer with it's
+    size in dataLength.  The oldest signal of the member that received one is
+    removed from it and copied into that buffer, dataLength is set to the
+    number of bytes copied and the status of that result is set to 0.
 
-    @param[in] groupId - The address of where to store the group ID
-    @param[in] timeout - The optional timeout value in nanoseconds
-    @param[out] domainId - The address of where to store the domain ID
-    @param[out] signalId - The address of where to store the signal ID
+    @param[in] groupId - The group ID to listen for
+    @param[in] timeout - The optional timeout value in nanoseconds (0 waits
+                         forever)
+    @param[in/out] result - The array of results structures to fill in
 
     @return 0 if no errors occurred
               Otherwise the negative errno value will be returned.
 
             -EINVAL - There are no signals or groups to listen to.
             -ENOMEM - Memory could not be allocated.
+            ETIMEDOUT - The timeout expired before a signal arrived.
+            ENOENT - The group does not exist or was deleted.
 
 ------------------------------------------------------------------------*/
 int vsi_listen_any_in_group ( const group_t groupId,
@@ -915,6 +1607,30 @@ int vsi_listen_any_in_group ( const group_t groupId,
                               vsi_result*   result );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ l i s t e n _ a n y _ i n _ g r o u p _ u n t i l
+
+    @brief Listen for any signal in the specified group with a deadline.
+
+    This function is identical to vsi_listen_any_in_group except that the
+    wait ends at an absolute CLOCK_MONOTONIC time (as returned by
+    clock_gettime) rather than after a relative timeout.
+
+    @param[in] groupId - The group ID to listen for
+    @param[in] deadline - The time at which to stop waiting or NULL to wait
+                          forever
+    @param[in/out] results - The array of results structures to fill in
+
+    @return 0 if a signal was received
+            ETIMEDOUT - The deadline passed before a signal arrived.
+
+------------------------------------------------------------------------*/
+int vsi_listen_any_in_group_until ( const group_t          groupId,
+                                    const struct timespec* deadline,
+                                    vsi_result*            results );
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ l i s t e n _ a l l _ i n _ g r o u p
@@ -935,16 +1651,23 @@ int vsi_listen_any_in_group ( const group_t groupId,
     array in bytes!).  If the resultsSize is not large enough to hold all of
     the results required, an error will be returned to the caller.
 
-    @param[out] resultsPtr - The address of where to store the results
+    Each result must supply a data buffer with it's size in dataLength.  The
+    oldest signal of each member is removed from it and copied into that
+    buffer and dataLength is set to the number of bytes copied.
+
+    @param[in/out] resultsPtr - The address of where to store the results
     @param[in] resultsSize - The size of the results array being supplied
                              The number of results expected.
-    @param[in] timeout - The optional timeout value in nanoseconds
+    @param[in] timeout - The optional timeout value in nanoseconds (0 waits
+                         forever)
 
     @return 0 if no errors occurred
               Otherwise the negative errno value will be returned.
 
             EINVAL - There are no signals or groups to listen to.
             ENOMEM - Memory could not be allocated.
+            ETIMEDOUT - The timeout expired before every signal arrived.
+            ENOENT - The group does not exist or was deleted.
 
 ------------------------------------------------------------------------*/
 int vsi_listen_all_in_group ( const group_t groupId,
@@ -953,6 +1676,33 @@ int vsi_listen_all_in_group ( const group_t groupId,
                               unsigned int  timeout );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ l i s t e n _ a l l _ i n _ g r o u p _ u n t i l
+
+    @brief Listen for all signals in the specified group with a deadline.
+
+    This function is identical to vsi_listen_all_in_group except that the
+    wait ends at an absolute CLOCK_MONOTONIC time (as returned by
+    clock_gettime) rather than after a relative timeout.  The results of the
+    signals that did arrive before the deadline have a status of 0.
+
+    @param[in] groupId - The ID of the group to listen for
+    @param[out] results - The address of where to store the results
+    @param[in] resultsSize - The size of the results array being supplied
+    @param[in] deadline - The time at which to stop waiting or NULL to wait
+                          forever
+
+    @return 0 if every signal was received
+            ETIMEDOUT - The deadline passed before every signal arrived.
+
+------------------------------------------------------------------------*/
+int vsi_listen_all_in_group_until ( const group_t          groupId,
+                                    vsi_result*            results,
+                                    unsigned int           resultsSize,
+                                    const struct timespec* deadline );
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ f l u s h _ g r o u p
@@ -976,6 +1726,103 @@ int vsi_listen_all_in_group ( const group_t groupId,
 int vsi_flush_group ( const group_t groupId );
 
 
+/*!-----------------------------------------------------------------------
+
+    V S I   S i g n a l   N o t i f i e r s
+    =======================================
+
+
+    v s i _ o p e n _ s i g n a l _ n o t i f i e r
+
+    @brief Open a pollable notifier for a single signal.
+
+    This function returns a file descriptor that becomes readable every time
+    the specified signal is inserted by any thread or process.  The file
+    descriptor can be used with poll, select or epoll alongside any other
+    file descriptors the application is waiting on.
+
+    Once the descriptor becomes readable, the application should call
+    vsi_clear_notifier and then fetch the signal until no more data is
+    available.  Notifications are coalesced so a single readable event may
+    represent any number of inserted signals.
+
+    There can be at most VSI_NOTIFIER_COUNT notifiers open in the whole system
+    at once.  Notifiers left open by processes that have died are reclaimed
+    automatically when new notifiers are opened.
+
+    @param[in] - domainId - The domain ID of the signal to watch.
+    @param[in] - signalId - The signal ID of the signal to watch.
+
+    @return The notifier file descriptor if no errors occurred
+              Otherwise the negative errno value will be returned.
+
+            -ENOMEM - The signal list could not be created.
+            -ENOSPC - All of the notifiers are in use.
+
+------------------------------------------------------------------------*/
+int vsi_open_signal_notifier ( const domain_t domainId,
+                               const signal_t signalId );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ o p e n _ g r o u p _ n o t i f i e r
+
+    @brief Open a pollable notifier for all of the signals in a group.
+
+    This function is identical to vsi_open_signal_notifier except that the
+    file descriptor becomes readable when any signal in the specified group
+    is inserted.  Signals that are added to or removed from the group while
+    the notifier is open are added to or removed from the notifier as well.
+
+    @param[in] - groupId - The ID value of the group to watch.
+
+    @return The notifier file descriptor if no errors occurred
+              Otherwise the negative errno value will be returned.
+
+            -ENOENT - The group does not exist.
+            -ENOSPC - All of the notifiers are in use.
+
+------------------------------------------------------------------------*/
+int vsi_open_group_notifier ( const group_t groupId );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c l e a r _ n o t i f i e r
+
+    @brief Discard all of the pending notifications on a notifier.
+
+    This should be called after the notifier file descriptor has been
+    reported as readable and before the signals are fetched so that no
+    notification can be lost.
+
+    @param[in] - fd - The notifier file descriptor.
+
+    @return - status - The return status of the function
+
+------------------------------------------------------------------------*/
+int vsi_clear_notifier ( int fd );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c l o s e _ n o t i f i e r
+
+    @brief Close a notifier.
+
+    This function stops all notifications to the specified notifier and
+    closes it's file descriptor.
+
+    @param[in] - fd - The notifier file descriptor.
+
+    @return 0 if no errors occurred
+            EBADF - The file descriptor is not an open notifier.
+
+------------------------------------------------------------------------*/
+int vsi_close_notifier ( int fd );
+
+
 /*!-----------------------------------------------------------------------
 
     N a m e / I D   M a n i u p l a t i o n   F u n c t i o n s
@@ -1067,6 +1914,130 @@ int vsi_define_signal ( const domain_t domainId,
                         const signal_t privateId,
                         const char*    name );
 
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e f i n e _ s i g n a l _ r i n g
+
+    @brief Define a new signal that is stored in a fixed size ring buffer.
+
+    This function is identical to vsi_define_signal except that the signal
+    list that is created will store it's signals in a preallocated ring of
+    "capacity" slots, each of which can hold up to "maxDataSize" bytes of
+    signal data.  Signals inserted into a ring never call the shared memory
+    allocator so producers do not contend on the global shared memory lock.
+
+    The capacity will be rounded up to the next power of 2.  When the ring is
+    full, inserting a new signal will discard the oldest signal in the ring.
+    Inserting a signal larger than "maxDataSize" will fail with EMSGSIZE.
+
+    The fetch functions copy the data of a ring signal out of it's slot
+    before the slot can be reused, so the data they return stays valid even
+    after the producers have wrapped around the ring.
+
+    The capacity may not be larger than SIGNAL_RING_MAX_CAPACITY and a ring
+    whose total size can't be represented is rejected with EINVAL.
+
+    The storage mode can only be selected while the signal list is empty.  If
+    the signal is already defined as a ring, this call has no effect.
+
+    @param[in] domainId - The signal domain ID to be defined.
+    @param[in] signalId - The signal ID to be defined.
+    @param[in] privateId - The private signal ID associated with this signal
+    @param[in] name - The ASCII name of the signal to be defined.
+    @param[in] capacity - The number of signals the ring can hold.
+    @param[in] maxDataSize - The largest signal data size to be stored.
+
+    @return 0 on success
+            EINVAL - The capacity or data size is not valid
+            EBUSY - The signal list already contains signals
+            ENOMEM - The ring could not be allocated
+
+------------------------------------------------------------------------*/
+int vsi_define_signal_ring ( const domain_t domainId,
+                             const signal_t signalId,
+                             const signal_t privateId,
+                             const char*    name,
+                             unsigned long  capacity,
+                             unsigned long  maxDataSize );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ d e f i n e _ s i g n a l s
+
+    @brief Define a batch of new signal list definition records.
+
+    This function has the same result as calling vsi_define_signal for each
+    of the definitions in the array.  If the signal ID, signal name and
+    private ID indices are all empty (as they are when a fresh shared memory
+    segment is being populated) and the definitions don't contain any
+    duplicate keys, the definitions are sorted once for each index and the
+    indices are built with btree_bulk_load instead of inserting each signal
+    into them individually.  If any of the indices can't be built, none of
+    the signals are defined.
+
+    @param[in] domainId - The signal domain ID of the signals to be defined.
+    @param[in] definitions - The array of signal definitions.
+    @param[in] count - The number of definitions in the array.
+
+    @return 0 on success
+            ENOMEM - The signal lists or indices could not be allocated
+
+------------------------------------------------------------------------*/
+int vsi_define_signals ( const domain_t     domainId,
+                         signal_definition* definitions,
+                         unsigned int       count );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ s e t _ s i g n a l _ r e t e n t i o n
+
+    @brief Set the retention policy of a signal.
+
+    The retention policy bounds the number of signals, the total size of
+    their data and the age of the signals that are kept for a signal that no
+    one is consuming.  The oldest signals that exceed the policy are
+    discarded whenever a new signal is inserted so the policy takes effect
+    with the next insert.  Zero limits in the policy fall back to the limits
+    of the signal's domain (see vsi_retention).
+
+    @param[in] domainId - The domain ID of the signal.
+    @param[in] signalId - The signal ID of the signal.
+    @param[in] retention - The new retention policy.
+
+    @return 0 if successful
+            EINVAL - The retention policy was not supplied.
+            ENOMEM - The signal list could not be created.
+
+------------------------------------------------------------------------*/
+int vsi_set_signal_retention ( const domain_t       domainId,
+                               const signal_t       signalId,
+                               const vsi_retention* retention );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ s e t _ d o m a i n _ r e t e n t i o n
+
+    @brief Set the default retention policy of a domain.
+
+    This policy applies to every signal in the domain, including signals
+    that have not been defined yet, except for the limits that a signal
+    overrides with it's own policy (see vsi_set_signal_retention).  Only the
+    domains below VSI_DENSE_DOMAIN_COUNT can have a retention policy.
+
+    @param[in] domainId - The domain ID.
+    @param[in] retention - The new retention policy.
+
+    @return 0 if successful
+            EINVAL - The domain or retention policy is not valid.
+
+------------------------------------------------------------------------*/
+int vsi_set_domain_retention ( const domain_t       domainId,
+                               const vsi_retention* retention );
+
 //
 //  Declare the signal dump functions.
 //
@@ -1087,19 +2058,70 @@ extern void printSignalGroup      ( char* leader, void* data );
 //
 //  Declare the old shared memory utility functions.
 //
+//  The "stamp" arguments may be NULL.  On an insert, a non-zero timestamp in
+//  the stamp is used as the capture time of the new signal and the stamp
+//  that was stored is returned in it.  On a fetch, the stamp of the signal
+//  that was found is returned in it.
+//
+//  The "deadline" arguments are absolute CLOCK_MONOTONIC times at which a
+//  waiting fetch gives up and returns ETIMEDOUT (or NULL to wait forever).
+//
+//  sm_fetch and sm_fetch_newest copy the signal data into the caller's
+//  buffer.  On input, "bodySize" is the size of that buffer and on output it
+//  is the number of bytes copied.  sm_fetch_in_place returns the address of
+//  the data instead and keeps it leased until it is passed to
+//  sm_release_in_place.
+//
 int sm_insert ( domain_t domain, signal_t signal, unsigned long
-                newMessageSize, void* body );
+                newMessageSize, void* body, signal_stamp* stamp );
+
+int sm_insert_batch ( vsi_result* results, size_t count );
+
+signal_list* findSignalList ( domain_t domain, signal_t signal );
 
 int sm_removeSignal ( signal_list* signalList );
 
+bool sm_removeSignalIf ( signal_list* signalList, offset_t expectedHead );
+
+int sm_fetch_lease ( domain_t domain, signal_t signal, bool newest, bool wait,
+                     const struct timespec* deadline, signal_data** record );
+
+void sm_release_signal_data ( signal_data* signalData );
+
+int sm_fetch_in_place ( domain_t domain, signal_t signal, bool newest,
+                        unsigned long* bodySize, void** body, bool wait,
+                        const struct timespec* deadline, signal_stamp* stamp );
+
+void sm_release_in_place ( void* body );
+
 int sm_fetch ( domain_t domain, signal_t signal, unsigned long* bodySize,
-               void** body, bool wait );
+               void* body, bool wait, const struct timespec* deadline,
+               signal_stamp* stamp );
 
 int sm_fetch_newest ( domain_t domain, signal_t signal, unsigned long*
-                      bodySize, void** body, bool wait );
+                      bodySize, void* body, bool wait,
+                      const struct timespec* deadline, signal_stamp* stamp );
+
+int sm_fetch_latest ( domain_t domain, signal_t signal, unsigned long*
+                      bodySize, void* body, bool wait,
+                      const struct timespec* deadline, signal_stamp* stamp );
+
+int sm_fetch_range ( domain_t domain, signal_t signal, unsigned long beginTime,
+                     unsigned long endTime, vsi_result* results, size_t* count );
+
+signal_cursor* sm_open_cursor ( signal_list* signalList, const char* name );
+
+int sm_read_cursor ( signal_list* signalList, signal_cursor* cursor,
+                     vsi_result* result, signal_stamp* stamp, bool wait,
+                     const struct timespec* deadline );
+
+void sm_delete_cursor ( signal_list* signalList, const char* name );
 
 int sm_flush_signal ( domain_t domain, signal_t signal );
 
+int sm_create_ring ( signal_list* signalList, unsigned long capacity,
+                     unsigned long maxDataSize );
+
 
 #endif  //  _SIGNALS_H_
 
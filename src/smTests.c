@@ -21,14 +21,2555 @@
 #include <unistd.h>
 #include <string.h>
 #include <locale.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/wait.h>
 
+#include "vsi.h"
 #include "vsi_core_api.h"
+#include "signals.h"
 // #include "sharedMemoryManager.h"
 
 
 /*! @{ */
 
 
+//
+//  Define the barrier that the detach test worker thread and the main thread
+//  use to step through the test together.
+//
+static pthread_barrier_t detachBarrier;
+
+
+//
+//  The worker thread of the detach test claims a magazine with one
+//  allocation, lets the main thread close the data store and then exits,
+//  which runs the magazine thread exit handler after the segment is gone.
+//
+static void* detachWorker ( void* arg )
+{
+    sm_free ( sm_malloc ( 16 ) );
+
+    pthread_barrier_wait ( &detachBarrier );
+    pthread_barrier_wait ( &detachBarrier );
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t D e t a c h W i t h L i v e T h r e a d
+
+    @brief Close the data store while another thread still has a magazine.
+
+    The data store is closed by this function.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testDetachWithLiveThread ( void )
+{
+    pthread_t worker;
+
+    printf ( "\nClosing the data store while a thread has a magazine...\n" );
+
+    pthread_barrier_init ( &detachBarrier, NULL, 2 );
+
+    if ( pthread_create ( &worker, NULL, detachWorker, NULL ) != 0 )
+    {
+        printf ( "Error: Unable to create the detach test thread\n" );
+        return 1;
+    }
+    pthread_barrier_wait ( &detachBarrier );
+
+    vsi_core_close();
+
+    pthread_barrier_wait ( &detachBarrier );
+    pthread_join ( worker, NULL );
+
+    pthread_barrier_destroy ( &detachBarrier );
+
+    printf ( "  The thread exited cleanly after the data store was closed\n" );
+
+    return 0;
+}
+
+
+//
+//  Define the number of signals and cursors used by the cursor test.
+//
+#define CURSOR_TEST_SIGNALS ( 20000 )
+#define CURSOR_TEST_READERS ( 4 )
+
+//
+//  Define what each reader thread of the cursor test is given.
+//
+typedef struct cursorReader
+{
+    domain_t      domainId;
+    signal_t      signalId;
+    vsi_cursor    cursor;
+    unsigned long missed;
+
+}   cursorReader;
+
+
+//
+//  Each reader of the cursor test reads every signal through it's own
+//  cursor and counts the signals that it did not see.
+//
+static void* cursorReaderThread ( void* arg )
+{
+    cursorReader*   reader   = arg;
+    unsigned long   expected = 1;
+    unsigned long   value;
+    vsi_result      result;
+    struct timespec deadline;
+
+    clock_gettime ( CLOCK_MONOTONIC, &deadline );
+    deadline.tv_sec += 10;
+
+    while ( expected <= CURSOR_TEST_SIGNALS )
+    {
+        memset ( &result, 0, sizeof(result) );
+        result.data       = (char*)&value;
+        result.dataLength = sizeof(value);
+
+        if ( vsi_read_cursor ( &reader->cursor, &result, true,
+                               &deadline ) != 0 )
+        {
+            reader->missed += CURSOR_TEST_SIGNALS - expected + 1;
+            break;
+        }
+        if ( value != expected )
+        {
+            reader->missed += value - expected;
+        }
+        expected = value + 1;
+    }
+    return NULL;
+}
+
+
+//
+//  The producer of the cursor test inserts the values 1 through the signal
+//  count.
+//
+static void* cursorProducerThread ( void* arg )
+{
+    cursorReader* reader = arg;
+
+    for ( unsigned long value = 1; value <= CURSOR_TEST_SIGNALS; ++value )
+    {
+        sm_insert ( reader->domainId, reader->signalId, sizeof(value), &value,
+                    NULL );
+    }
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t C u r s o r s
+
+    @brief Read the same signals through several cursors at once.
+
+    Every cursor reclaims the signals that all of the cursors have read so
+    the readers are all removing signals from the same list at the same
+    time.  Each of them must still see every signal.
+
+    @param[in] signalId - The signal to use.
+    @param[in] ring - If true, store the signal in a ring.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testCursors ( signal_t signalId, bool ring )
+{
+    cursorReader readers[CURSOR_TEST_READERS];
+    pthread_t    threads[CURSOR_TEST_READERS + 1];
+    char         name[SIGNAL_CURSOR_NAME_SIZE];
+    int          failed = 0;
+    int          i;
+
+    printf ( "\nReading %d %s signals through %d cursors...\n",
+             CURSOR_TEST_SIGNALS, ring ? "ring" : "list", CURSOR_TEST_READERS );
+
+    if ( ring )
+    {
+        vsi_define_signal_ring ( 1, signalId, 0, "cursorTest",
+                                 CURSOR_TEST_SIGNALS * 2,
+                                 sizeof(unsigned long) );
+    }
+    for ( i = 0; i < CURSOR_TEST_READERS; ++i )
+    {
+        memset ( &readers[i], 0, sizeof(readers[i]) );
+        readers[i].domainId = 1;
+        readers[i].signalId = signalId;
+
+        snprintf ( name, sizeof(name), "reader%d", i );
+        if ( vsi_open_cursor ( 1, signalId, name, &readers[i].cursor ) != 0 )
+        {
+            printf ( "Error: Unable to open cursor %s\n", name );
+            return 1;
+        }
+    }
+    for ( i = 0; i < CURSOR_TEST_READERS; ++i )
+    {
+        pthread_create ( &threads[i], NULL, cursorReaderThread, &readers[i] );
+    }
+    pthread_create ( &threads[i], NULL, cursorProducerThread, &readers[0] );
+
+    for ( i = 0; i <= CURSOR_TEST_READERS; ++i )
+    {
+        pthread_join ( threads[i], NULL );
+    }
+    for ( i = 0; i < CURSOR_TEST_READERS; ++i )
+    {
+        if ( readers[i].missed != 0 )
+        {
+            printf ( "Error: Cursor %d missed %lu signals\n", i,
+                     readers[i].missed );
+            failed = 1;
+        }
+        vsi_delete_cursor ( &readers[i].cursor );
+    }
+    if ( ! failed )
+    {
+        printf ( "  Every cursor read every signal\n" );
+    }
+    return failed;
+}
+
+
+//
+//  Define the number of producers and the number of signals each of them
+//  inserts in the list stress tests and the largest number of signals that
+//  the retention policy keeps in the retention test.
+//
+#define STRESS_TEST_PRODUCERS    ( 4 )
+#define STRESS_TEST_CONSUMERS    ( 2 )
+#define STRESS_TEST_SIGNALS      ( 20000 )
+#define RETENTION_TEST_MAX_COUNT ( 2 )
+
+//
+//  Define what the threads of a list stress test share.
+//
+static signal_t      stressSignal;
+static bool          stressFlush;
+static volatile bool stressProducing;
+
+//
+//  Each producer of a list stress test inserts it's own number in the upper
+//  half of the value and a counter in the lower half.
+//
+static void* stressProducerThread ( void* arg )
+{
+    unsigned long producer = (unsigned long)arg;
+
+    for ( unsigned long i = 1; i <= STRESS_TEST_SIGNALS; ++i )
+    {
+        unsigned long value = producer << 32 | i;
+
+        sm_insert ( 1, stressSignal, sizeof(value), &value, NULL );
+    }
+    return NULL;
+}
+
+
+//
+//  The consumers of a list stress test take whatever signals are there
+//  (or flush them) without waiting until the producers are done, so they
+//  are often taking the only signal in the list while a producer is
+//  appending to it.
+//
+static void* stressConsumerThread ( void* arg )
+{
+    unsigned long value;
+    unsigned long size;
+
+    while ( stressProducing )
+    {
+        if ( stressFlush )
+        {
+            sm_flush_signal ( 1, stressSignal );
+        }
+        else
+        {
+            size = sizeof(value);
+            sm_fetch ( 1, stressSignal, &size, &value, false, NULL, NULL );
+        }
+    }
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t L i s t S t r e s s
+
+    @brief Insert into a list from several producers while it is emptied.
+
+    The consumers either fetch or flush the signals while the producers are
+    inserting them, and if there is a retention limit every producer also
+    removes the oldest signals while the other producers are appending new
+    ones, so the list is very often going from having one signal to none
+    and back.  When they are all done, every signal left must be reachable
+    from the head of the list, the tail must be the last of them and the
+    counters must match.
+
+    @param[in] signalId - The signal to use.
+    @param[in] maxCount - The retention limit of the signal or 0.
+    @param[in] flush - If true, the consumers flush the signal.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testListStress ( signal_t signalId, unsigned long maxCount,
+                            bool flush )
+{
+    vsi_retention retention = { maxCount, 0, 0 };
+    pthread_t     threads[STRESS_TEST_PRODUCERS + STRESS_TEST_CONSUMERS];
+    unsigned long last[STRESS_TEST_PRODUCERS + 1] = { 0 };
+    unsigned long sequence = 0;
+    unsigned long count    = 0;
+    offset_t      offset;
+    offset_t      tail     = END_OF_LIST_MARKER;
+    int           failed   = 0;
+    int           i;
+
+    printf ( "\nInserting %d signals from %d producers while %s them with a "
+             "retention limit of %lu...\n", STRESS_TEST_SIGNALS,
+             STRESS_TEST_PRODUCERS, flush ? "flushing" : "fetching",
+             maxCount );
+
+    if ( maxCount != 0 )
+    {
+        vsi_set_signal_retention ( 1, signalId, &retention );
+    }
+    stressSignal    = signalId;
+    stressFlush     = flush;
+    stressProducing = true;
+
+    for ( i = 0; i < STRESS_TEST_PRODUCERS; ++i )
+    {
+        pthread_create ( &threads[i], NULL, stressProducerThread,
+                         (void*)(unsigned long)( i + 1 ) );
+    }
+    for ( ; i < STRESS_TEST_PRODUCERS + STRESS_TEST_CONSUMERS; ++i )
+    {
+        pthread_create ( &threads[i], NULL, stressConsumerThread, NULL );
+    }
+    for ( i = 0; i < STRESS_TEST_PRODUCERS; ++i )
+    {
+        pthread_join ( threads[i], NULL );
+    }
+    stressProducing = false;
+
+    for ( ; i < STRESS_TEST_PRODUCERS + STRESS_TEST_CONSUMERS; ++i )
+    {
+        pthread_join ( threads[i], NULL );
+    }
+    signal_list* signalList = findSignalList ( 1, signalId );
+
+    //
+    //  Walk the list and make sure the sequence numbers are in order and
+    //  that the values of each producer are in the order they were inserted.
+    //
+    for ( offset = signalList->head; offset != END_OF_LIST_MARKER;
+          offset = ((signal_data*)toAddress ( offset ))->nextMessageOffset )
+    {
+        signal_data*  signalData = toAddress ( offset );
+        unsigned long value      = *(unsigned long*)signalData->data;
+        unsigned long producer   = value >> 32;
+
+        if ( signalData->stamp.sequence <= sequence ||
+             producer > STRESS_TEST_PRODUCERS ||
+             ( value & 0xffffffff ) <= last[producer] )
+        {
+            printf ( "Error: Signal %lu of the list is out of order\n",
+                     count );
+            failed = 1;
+        }
+        sequence        = signalData->stamp.sequence;
+        last[producer]  = value & 0xffffffff;
+        tail            = offset;
+        ++count;
+    }
+    if ( tail != signalList->tail ||
+         count != signalList->currentSignalCount ||
+         count * sizeof(unsigned long) != signalList->totalSignalSize ||
+         ( maxCount != 0 && count > maxCount ) )
+    {
+        printf ( "Error: The list has %lu reachable signals but counts %lu "
+                 "signals and it's tail is %s\n", count,
+                 signalList->currentSignalCount,
+                 tail == signalList->tail ? "correct" : "wrong" );
+        failed = 1;
+    }
+    if ( signalList->sampleSequence !=
+         STRESS_TEST_PRODUCERS * STRESS_TEST_SIGNALS )
+    {
+        printf ( "Error: The newest signal has sequence %lu\n",
+                 signalList->sampleSequence );
+        failed = 1;
+    }
+    //
+    //  A final flush must leave the list empty.
+    //
+    sm_flush_signal ( 1, signalId );
+
+    if ( signalList->head != END_OF_LIST_MARKER ||
+         signalList->tail != END_OF_LIST_MARKER ||
+         signalList->currentSignalCount != 0 ||
+         signalList->totalSignalSize != 0 )
+    {
+        printf ( "Error: The list is not empty after it was flushed\n" );
+        failed = 1;
+    }
+    if ( ! failed )
+    {
+        printf ( "  The list is intact with %lu signals\n", count );
+    }
+    return failed;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t G r o u p L i s t e n
+
+    @brief Listen to a group and check that the results are copies.
+
+    The signals received by a group listen are copied into the buffers of
+    the results, so they must still hold the values that were received after
+    those signals have been flushed and their memory reused.  A result
+    without a buffer is rejected.
+
+    @param[in] groupId - The group to use.
+    @param[in] signalId - The first of the two member signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testGroupListen ( group_t groupId, signal_t signalId )
+{
+    vsi_result      results[2];
+    unsigned long   values[2];
+    unsigned long   value;
+    struct timespec deadline;
+    int             failed = 0;
+    int             i;
+
+    printf ( "\nListening to a group whose signals are then flushed...\n" );
+
+    vsi_create_signal_group ( groupId );
+
+    for ( i = 0; i < 2; ++i )
+    {
+        value = signalId + i;
+
+        vsi_add_signal_to_group ( 1, signalId + i, groupId );
+        sm_insert ( 1, signalId + i, sizeof(value), &value, NULL );
+
+        memset ( &results[i], 0, sizeof(results[i]) );
+        results[i].data       = (char*)&values[i];
+        results[i].dataLength = sizeof(values[i]);
+    }
+    clock_gettime ( CLOCK_MONOTONIC, &deadline );
+    deadline.tv_sec += 5;
+
+    if ( vsi_listen_all_in_group_until ( groupId, results, 2, &deadline ) != 0 )
+    {
+        printf ( "Error: Unable to listen to group %u\n", groupId );
+        return 1;
+    }
+    //
+    //  Reuse the memory of the signals that were received.
+    //
+    for ( value = 0; value < 1000; ++value )
+    {
+        sm_insert ( 1, signalId, sizeof(value), &value, NULL );
+        sm_flush_signal ( 1, signalId );
+    }
+    for ( i = 0; i < 2; ++i )
+    {
+        if ( results[i].status != 0 ||
+             results[i].dataLength != sizeof(values[i]) ||
+             results[i].sequence == 0 || values[i] != signalId + i )
+        {
+            printf ( "Error: Result %d of the group listen is wrong\n", i );
+            failed = 1;
+        }
+    }
+    //
+    //  A result without a buffer to copy into is rejected.
+    //
+    value = signalId;
+    sm_insert ( 1, signalId, sizeof(value), &value, NULL );
+
+    results[1].data = NULL;
+    if ( vsi_listen_any_in_group_until ( groupId, &deadline,
+                                         results ) != EINVAL )
+    {
+        printf ( "Error: A group listen without a buffer was accepted\n" );
+        failed = 1;
+    }
+    vsi_delete_signal_group ( groupId );
+
+    if ( ! failed )
+    {
+        printf ( "  The group listen results are intact\n" );
+    }
+    return failed;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t F e t c h I n P l a c e
+
+    @brief Check that data fetched in place stays put until it is released.
+
+    The oldest signal is fetched in place and removed from the list.  Its
+    data must still hold the value that was fetched after the memory of the
+    signals that follow it has been reused, until it is released.
+
+    @param[in] signalId - The signal to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testFetchInPlace ( signal_t signalId )
+{
+    unsigned long  value = signalId;
+    unsigned long  size;
+    unsigned long* data;
+    int            failed = 0;
+
+    printf ( "\nFetching a signal in place while it's memory is reused...\n" );
+
+    sm_insert ( 1, signalId, sizeof(value), &value, NULL );
+
+    if ( vsi_core_fetch ( 1, signalId, &size, (void**)&data ) != 0 )
+    {
+        printf ( "Error: Unable to fetch signal %u in place\n", signalId );
+        return 1;
+    }
+    for ( value = 0; value < 1000; ++value )
+    {
+        sm_insert ( 1, signalId, sizeof(value), &value, NULL );
+        sm_flush_signal ( 1, signalId );
+    }
+    if ( size != sizeof(value) || *data != signalId )
+    {
+        printf ( "Error: The data fetched in place was reclaimed\n" );
+        failed = 1;
+    }
+    vsi_core_release ( data );
+
+    if ( ! failed )
+    {
+        printf ( "  The data fetched in place is intact\n" );
+    }
+    return failed;
+}
+
+
+//
+//  Define the number of member signals and the number of times each of them
+//  is added to and removed from the group in the group churn test.
+//
+#define CHURN_TEST_MEMBERS ( 8 )
+#define CHURN_TEST_ROUNDS  ( 2000 )
+
+//
+//  Define what the threads of the group churn test share.
+//
+static group_t       churnGroup;
+static signal_t      churnSignal;
+static volatile bool churning;
+
+//
+//  The churn thread keeps adding the member signals to the group and
+//  removing them again.
+//
+static void* churnThread ( void* arg )
+{
+    for ( int round = 0; round < CHURN_TEST_ROUNDS; ++round )
+    {
+        for ( int i = 0; i < CHURN_TEST_MEMBERS; ++i )
+        {
+            vsi_add_signal_to_group ( 1, churnSignal + i, churnGroup );
+        }
+        for ( int i = 0; i < CHURN_TEST_MEMBERS; ++i )
+        {
+            vsi_remove_signal_from_group ( 1, churnSignal + i, churnGroup );
+        }
+    }
+    churning = false;
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t G r o u p C h u r n
+
+    @brief Read the members of a group while they are added and removed.
+
+    Every snapshot of the group must only hold member signals with the
+    values that were inserted into them, no matter how the members of the
+    group change while it is being read.
+
+    @param[in] groupId - The group to use.
+    @param[in] signalId - The first of the member signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testGroupChurn ( group_t groupId, signal_t signalId )
+{
+    vsi_result    results[CHURN_TEST_MEMBERS];
+    unsigned long values[CHURN_TEST_MEMBERS];
+    unsigned long value;
+    unsigned long reads  = 0;
+    pthread_t     thread;
+    int           failed = 0;
+    int           i;
+
+    printf ( "\nReading a group while it's members are added and "
+             "removed...\n" );
+
+    vsi_create_signal_group ( groupId );
+
+    for ( i = 0; i < CHURN_TEST_MEMBERS; ++i )
+    {
+        value = signalId + i;
+        sm_insert ( 1, signalId + i, sizeof(value), &value, NULL );
+    }
+    churnGroup  = groupId;
+    churnSignal = signalId;
+    churning    = true;
+
+    pthread_create ( &thread, NULL, churnThread, NULL );
+
+    while ( churning && ! failed )
+    {
+        for ( i = 0; i < CHURN_TEST_MEMBERS; ++i )
+        {
+            memset ( &results[i], 0, sizeof(results[i]) );
+            results[i].data       = (char*)&values[i];
+            results[i].dataLength = sizeof(values[i]);
+            results[i].status     = ENOENT;
+        }
+        if ( vsi_get_newest_in_group ( groupId, results ) != 0 )
+        {
+            continue;
+        }
+        for ( i = 0; i < CHURN_TEST_MEMBERS; ++i )
+        {
+            if ( results[i].status == 0 &&
+                 ( results[i].signalId < signalId ||
+                   results[i].signalId >= signalId + CHURN_TEST_MEMBERS ||
+                   values[i] != results[i].signalId ) )
+            {
+                printf ( "Error: Group result %d is for signal %u with value "
+                         "%lu\n", i, results[i].signalId, values[i] );
+                failed = 1;
+            }
+        }
+        ++reads;
+    }
+    pthread_join ( thread, NULL );
+
+    vsi_signal_group* signalGroup = vsi_fetch_signal_group ( groupId );
+
+    if ( signalGroup->count != 0 )
+    {
+        printf ( "Error: The group still has %d members\n",
+                 signalGroup->count );
+        failed = 1;
+    }
+    vsi_delete_signal_group ( groupId );
+
+    if ( ! failed )
+    {
+        printf ( "  The group was read intact %lu times\n", reads );
+    }
+    return failed;
+}
+
+
+//
+//  Define the number of slots in the ring of the ring wraparound test.
+//
+#define RING_TEST_CAPACITY ( 4 )
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t R i n g W r a p
+
+    @brief Overfill a ring and read it back as it wraps around.
+
+    A full ring must keep the newest signals in the order they were
+    inserted.  Signals are then inserted and fetched one at a time for many
+    laps of the ring.  A list that already has signals can't be converted
+    to a ring, and rings that are too large or have oversized signals are
+    rejected.
+
+    @param[in] signalId - The first of the two signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testRingWrap ( signal_t signalId )
+{
+    unsigned long value;
+    unsigned long size;
+    int           failed = 0;
+
+    printf ( "\nWrapping around a ring of %d slots...\n", RING_TEST_CAPACITY );
+
+    //
+    //  A list that already has signals can't be converted to a ring.
+    //
+    value = 0;
+    sm_insert ( 1, signalId + 1, sizeof(value), &value, NULL );
+
+    if ( sm_create_ring ( findSignalList ( 1, signalId + 1 ),
+                          RING_TEST_CAPACITY, sizeof(value) ) != EBUSY )
+    {
+        printf ( "Error: A list with signals was converted to a ring\n" );
+        failed = 1;
+    }
+    sm_flush_signal ( 1, signalId + 1 );
+
+    signal_list* signalList = findSignalList ( 1, signalId );
+
+    if ( sm_create_ring ( signalList, SIGNAL_RING_MAX_CAPACITY + 1,
+                          sizeof(value) ) != EINVAL ||
+         sm_create_ring ( signalList, RING_TEST_CAPACITY, ~0UL ) != EINVAL )
+    {
+        printf ( "Error: A ring that is too large was accepted\n" );
+        failed = 1;
+    }
+    if ( sm_create_ring ( signalList, RING_TEST_CAPACITY,
+                          sizeof(value) ) != 0 )
+    {
+        printf ( "Error: Unable to convert signal %u to a ring\n", signalId );
+        return 1;
+    }
+    //
+    //  Overfill the ring and check that it holds the newest signals.
+    //
+    for ( value = 1; value <= RING_TEST_CAPACITY * 2 + 1; ++value )
+    {
+        sm_insert ( 1, signalId, sizeof(value), &value, NULL );
+    }
+    if ( signalList->currentSignalCount != RING_TEST_CAPACITY )
+    {
+        printf ( "Error: The full ring counts %lu signals\n",
+                 signalList->currentSignalCount );
+        failed = 1;
+    }
+    for ( unsigned long expected = RING_TEST_CAPACITY + 2;
+          expected <= RING_TEST_CAPACITY * 2 + 1; ++expected )
+    {
+        size = sizeof(value);
+        if ( sm_fetch ( 1, signalId, &size, &value, false, NULL, NULL ) != 0 ||
+             value != expected )
+        {
+            printf ( "Error: Expected %lu from the full ring but got %lu\n",
+                     expected, value );
+            failed = 1;
+        }
+    }
+    //
+    //  Go around the ring many times one signal at a time.
+    //
+    for ( unsigned long i = 0; i < RING_TEST_CAPACITY * 1000; ++i )
+    {
+        sm_insert ( 1, signalId, sizeof(i), &i, NULL );
+
+        size = sizeof(value);
+        if ( sm_fetch ( 1, signalId, &size, &value, false, NULL, NULL ) != 0 ||
+             value != i )
+        {
+            printf ( "Error: Expected %lu from the ring but got %lu\n", i,
+                     value );
+            failed = 1;
+            break;
+        }
+    }
+    //
+    //  A signal larger than the slots is rejected.
+    //
+    char big[sizeof(value) * 2] = { 0 };
+
+    if ( sm_insert ( 1, signalId, sizeof(big), big, NULL ) != EMSGSIZE )
+    {
+        printf ( "Error: An oversized signal was inserted into the ring\n" );
+        failed = 1;
+    }
+    if ( ! failed )
+    {
+        printf ( "  The ring kept the newest signals in order\n" );
+    }
+    return failed;
+}
+
+
+//
+//  Define the number of values the writer of the group snapshot test
+//  inserts into each member.
+//
+#define SNAPSHOT_TEST_SIGNALS ( 200000 )
+
+//
+//  Define what the threads of the group snapshot test share.
+//
+static signal_t      snapshotSignal;
+static volatile bool snapshotWriting;
+
+//
+//  The writer of the group snapshot test inserts each value into the first
+//  member and then into the second one, so at any instant the first member
+//  holds either the same value as the second one or the next one.
+//
+static void* snapshotWriterThread ( void* arg )
+{
+    for ( unsigned long i = 1; i <= SNAPSHOT_TEST_SIGNALS; ++i )
+    {
+        sm_insert ( 1, snapshotSignal, sizeof(i), &i, NULL );
+        sm_insert ( 1, snapshotSignal + 1, sizeof(i), &i, NULL );
+    }
+    snapshotWriting = false;
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t G r o u p S n a p s h o t
+
+    @brief Take snapshots of a group while it's members are written.
+
+    Every snapshot that is reported as consistent must hold values of the
+    two members that they had at the same instant.  Snapshots that could
+    not be made consistent are reported with EAGAIN instead of retrying
+    forever.
+
+    @param[in] groupId - The group to use.
+    @param[in] signalId - The first of the two member signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testGroupSnapshot ( group_t groupId, signal_t signalId )
+{
+    vsi_result    results[2];
+    unsigned long values[2];
+    unsigned long consistent = 0;
+    unsigned long busy       = 0;
+    pthread_t     thread;
+    int           failed     = 0;
+    int           status;
+
+    printf ( "\nTaking snapshots of a group while it is written...\n" );
+
+    vsi_create_signal_group ( groupId );
+    vsi_add_signal_to_group ( 1, signalId, groupId );
+    vsi_add_signal_to_group ( 1, signalId + 1, groupId );
+
+    snapshotSignal  = signalId;
+    snapshotWriting = true;
+
+    pthread_create ( &thread, NULL, snapshotWriterThread, NULL );
+
+    while ( snapshotWriting && ! failed )
+    {
+        for ( int i = 0; i < 2; ++i )
+        {
+            memset ( &results[i], 0, sizeof(results[i]) );
+            results[i].data       = (char*)&values[i];
+            results[i].dataLength = sizeof(values[i]);
+        }
+        status = vsi_get_newest_in_group ( groupId, results );
+
+        if ( status == EAGAIN )
+        {
+            ++busy;
+            continue;
+        }
+        if ( status != 0 )
+        {
+            printf ( "Error: Group snapshot failed with %d\n", status );
+            failed = 1;
+        }
+        else if ( results[0].status == 0 && results[1].status == 0 &&
+                  values[0] != values[1] && values[0] != values[1] + 1 )
+        {
+            printf ( "Error: Inconsistent group snapshot %lu, %lu\n",
+                     values[0], values[1] );
+            failed = 1;
+        }
+        ++consistent;
+    }
+    pthread_join ( thread, NULL );
+
+    vsi_delete_signal_group ( groupId );
+    sm_flush_signal ( 1, signalId );
+    sm_flush_signal ( 1, signalId + 1 );
+
+    if ( ! failed )
+    {
+        printf ( "  %lu snapshots were consistent and %lu were busy\n",
+                 consistent, busy );
+    }
+    return failed;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t C u r s o r R e o p e n
+
+    @brief Reopen a deleted cursor whose last reopener died.
+
+    The cursor is marked as being reopened by a process that has already
+    exited, as if it had died in the middle of reopening it.  Opening the
+    cursor again must take it back instead of waiting forever.
+
+    @param[in] signalId - The signal to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testCursorReopen ( signal_t signalId )
+{
+    vsi_cursor cursor;
+    pid_t      child;
+
+    printf ( "\nReopening a cursor abandoned by a dead process...\n" );
+
+    if ( vsi_open_cursor ( 1, signalId, "abandoned", &cursor ) != 0 )
+    {
+        printf ( "Error: Unable to open the abandoned cursor\n" );
+        return 1;
+    }
+    signal_cursor* signalCursor = toAddress ( cursor.cursor );
+
+    vsi_delete_cursor ( &cursor );
+
+    //
+    //  Get the process ID of a process that no longer exists.
+    //
+    child = fork();
+    if ( child == 0 )
+    {
+        _exit ( 0 );
+    }
+    waitpid ( child, NULL, 0 );
+
+    signalCursor->active = SIGNAL_CURSOR_REOPENING | (unsigned long)child;
+
+    if ( vsi_open_cursor ( 1, signalId, "abandoned", &cursor ) != 0 ||
+         toAddress ( cursor.cursor ) != signalCursor ||
+         signalCursor->active != 1 )
+    {
+        printf ( "Error: The abandoned cursor was not reopened\n" );
+        return 1;
+    }
+    vsi_delete_cursor ( &cursor );
+
+    printf ( "  The abandoned cursor was reopened\n" );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t D e n s e I n d e x
+
+    @brief Look up signals at the edges of the dense signal index.
+
+    Signals just inside the dense index must be entered into it and signals
+    just outside of it must be found through the signal ID btree.  A
+    signal must still be found through the same signal list after all of
+    it's signals have been deleted and after it's dense index entry has been
+    lost.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testDenseIndex ( void )
+{
+    struct
+    {
+        domain_t domainId;
+        signal_t signalId;
+        bool     dense;
+    }   edges[] =
+    {
+        { VSI_DENSE_DOMAIN_COUNT - 1, VSI_DENSE_SIGNAL_COUNT - 1, true  },
+        { VSI_DENSE_DOMAIN_COUNT - 1, 0,                          true  },
+        { 1,                          VSI_DENSE_SIGNAL_COUNT,     false },
+        { VSI_DENSE_DOMAIN_COUNT,     1,                          false }
+    };
+    signal_list   key;
+    unsigned long value;
+    unsigned long size;
+    offset_t*     denseIndex = NULL;
+
+    printf ( "\nLooking up signals at the edges of the dense index...\n" );
+
+    for ( unsigned int i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i )
+    {
+        domain_t domainId = edges[i].domainId;
+        signal_t signalId = edges[i].signalId;
+
+        signal_list* signalList = findSignalList ( domainId, signalId );
+
+        memset ( &key, 0, sizeof(key) );
+        key.domainId = domainId;
+        key.signalId = signalId;
+
+        if ( signalList == NULL ||
+             btree_search ( &vsiContext->signalIdIndex, &key ) != signalList ||
+             findSignalList ( domainId, signalId ) != signalList )
+        {
+            printf ( "Error: Signal %d,%d was not found consistently\n",
+                     domainId, signalId );
+            return 1;
+        }
+        if ( edges[i].dense )
+        {
+            denseIndex = toAddress ( vsiContext->denseSignalIndex[domainId] );
+            if ( denseIndex[signalId] != toOffset ( signalList ) )
+            {
+                printf ( "Error: Signal %d,%d is not in the dense index\n",
+                         domainId, signalId );
+                return 1;
+            }
+        }
+        //
+        //  Delete the signals and then lose the dense index entry.  The
+        //  signal must be found through the same signal list each time.
+        //
+        for ( int pass = 0; pass < 2; ++pass )
+        {
+            value = i + pass;
+            sm_insert ( domainId, signalId, sizeof(value), &value, NULL );
+            sm_flush_signal ( domainId, signalId );
+
+            size = sizeof(value);
+            if ( sm_fetch ( domainId, signalId, &size, &value, false, NULL,
+                            NULL ) != ENODATA )
+            {
+                printf ( "Error: Signal %d,%d was not deleted\n", domainId,
+                         signalId );
+                return 1;
+            }
+            if ( pass == 0 && edges[i].dense )
+            {
+                denseIndex[signalId] = 0;
+            }
+            if ( findSignalList ( domainId, signalId ) != signalList )
+            {
+                printf ( "Error: Signal %d,%d moved to another signal list\n",
+                         domainId, signalId );
+                return 1;
+            }
+            value = i * 10 + pass;
+            sm_insert ( domainId, signalId, sizeof(value), &value, NULL );
+
+            size = sizeof(value);
+            if ( sm_fetch ( domainId, signalId, &size, &value, false, NULL,
+                            NULL ) != 0 || value != i * 10 + pass )
+            {
+                printf ( "Error: Signal %d,%d read back %lu\n", domainId,
+                         signalId, value );
+                return 1;
+            }
+        }
+        if ( edges[i].dense &&
+             denseIndex[signalId] != toOffset ( signalList ) )
+        {
+            printf ( "Error: Signal %d,%d was not put back into the dense "
+                     "index\n", domainId, signalId );
+            return 1;
+        }
+    }
+    printf ( "  The signals were found in the right indices\n" );
+
+    return 0;
+}
+
+
+//
+//  Define the number of values the writer of the latest value cache test
+//  inserts.  Every word of a value holds the same number so that a value
+//  made from two different signals can be recognized.
+//
+#define LATEST_TEST_SIGNALS ( 200000 )
+#define LATEST_TEST_WORDS   ( SIGNAL_LATEST_VALUE_SIZE / sizeof(unsigned long) )
+
+//
+//  Define what the threads of the latest value cache test share.
+//
+static signal_t      latestSignal;
+static volatile bool latestWriting;
+
+//
+//  The writer of the latest value cache test inserts the values 1 through
+//  LATEST_TEST_SIGNALS in order.
+//
+static void* latestWriterThread ( void* arg )
+{
+    unsigned long value[LATEST_TEST_WORDS];
+
+    for ( unsigned long i = 1; i <= LATEST_TEST_SIGNALS; ++i )
+    {
+        for ( unsigned int j = 0; j < LATEST_TEST_WORDS; ++j )
+        {
+            value[j] = i;
+        }
+        sm_insert ( 1, latestSignal, sizeof(value), value, NULL );
+    }
+    latestWriting = false;
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t L a t e s t C a c h e
+
+    @brief Read the latest value cache of a signal while it is written.
+
+    Every value read must be a complete signal that is no older than the
+    one read before it and it's stamp must be the stamp of that same signal.
+    When the writer is done, the cache must hold the last signal written and
+    still be in use.
+
+    @param[in] signalId - The signal to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testLatestCache ( signal_t signalId )
+{
+    unsigned long value[LATEST_TEST_WORDS];
+    unsigned long size;
+    unsigned long previous = 0;
+    unsigned long offset   = 0;
+    unsigned long reads    = 0;
+    signal_stamp  stamp;
+    pthread_t     thread;
+    int           failed   = 0;
+    int           status;
+
+    printf ( "\nReading the latest value cache while it is written...\n" );
+
+    //
+    //  Keep the signals in a small ring so that the writer never runs out
+    //  of memory.
+    //
+    signal_list* signalList = findSignalList ( 1, signalId );
+
+    if ( sm_create_ring ( signalList, 16, sizeof(value) ) != 0 )
+    {
+        printf ( "Error: Unable to convert signal %u to a ring\n", signalId );
+        return 1;
+    }
+    latestSignal  = signalId;
+    latestWriting = true;
+
+    pthread_create ( &thread, NULL, latestWriterThread, NULL );
+
+    while ( latestWriting && ! failed )
+    {
+        size = sizeof(value);
+        status = sm_fetch_latest ( 1, signalId, &size, value, false, NULL,
+                                   &stamp );
+        if ( status == ENODATA )
+        {
+            continue;
+        }
+        if ( status != 0 || size != sizeof(value) )
+        {
+            printf ( "Error: Latest value fetch failed with %d\n", status );
+            failed = 1;
+            break;
+        }
+        for ( unsigned int j = 1; j < LATEST_TEST_WORDS; ++j )
+        {
+            if ( value[j] != value[0] )
+            {
+                printf ( "Error: Torn latest value %lu, %lu\n", value[0],
+                         value[j] );
+                failed = 1;
+            }
+        }
+        //
+        //  The sequence numbers of a new signal list start with the first
+        //  value so the difference between them never changes.
+        //
+        if ( reads++ == 0 )
+        {
+            offset = stamp.sequence - value[0];
+        }
+        if ( value[0] < previous || stamp.sequence - value[0] != offset )
+        {
+            printf ( "Error: Latest value %lu with sequence %lu after %lu\n",
+                     value[0], stamp.sequence, previous );
+            failed = 1;
+        }
+        previous = value[0];
+    }
+    pthread_join ( thread, NULL );
+
+    size = sizeof(value);
+    if ( ! failed &&
+         ( sm_fetch_latest ( 1, signalId, &size, value, false, NULL,
+                             NULL ) != 0 ||
+           value[0] != LATEST_TEST_SIGNALS ||
+           signalList->latestSequence == SIGNAL_LATEST_DISABLED ||
+           ( signalList->latestSequence & 1 ) != 0 ) )
+    {
+        printf ( "Error: The latest value cache holds %lu after the writer "
+                 "finished\n", value[0] );
+        failed = 1;
+    }
+    sm_flush_signal ( 1, signalId );
+
+    if ( ! failed )
+    {
+        printf ( "  %lu latest values were read intact\n", reads );
+    }
+    return failed;
+}
+
+
+//
+//  Define the number of signals defined by the batch definition test.
+//
+#define DEFINE_TEST_SIGNALS ( 40 )
+
+
+//
+//  Make sure that each of a batch of signal definitions can be looked up by
+//  it's signal ID, name and private ID.
+//
+static int checkDefinitions ( const signal_definition* definitions,
+                              unsigned int count )
+{
+    char         buffer[64];
+    char*        name = buffer;
+    signal_t     signalId;
+    signal_list  key;
+    signal_list* signalList;
+
+    for ( unsigned int i = 0; i < count; ++i )
+    {
+        memset ( buffer, 0, sizeof(buffer) );
+
+        if ( vsi_signal_id_to_string ( 1, definitions[i].signalId, &name,
+                                       sizeof(buffer) - 1 ) != 0 ||
+             strcmp ( buffer, definitions[i].name ) != 0 ||
+             vsi_name_string_to_id ( 1, definitions[i].name,
+                                     &signalId ) != 0 ||
+             signalId != definitions[i].signalId )
+        {
+            printf ( "Error: Signal %u was not defined as \"%s\"\n",
+                     definitions[i].signalId, definitions[i].name );
+            return 1;
+        }
+        if ( definitions[i].privateId == 0 )
+        {
+            continue;
+        }
+        memset ( &key, 0, sizeof(key) );
+        key.domainId  = 1;
+        key.privateId = definitions[i].privateId;
+
+        signalList = btree_search ( &vsiContext->privateIdIndex, &key );
+        if ( signalList == NULL ||
+             signalList->signalId != definitions[i].signalId )
+        {
+            printf ( "Error: Private ID %u of signal %u was not defined\n",
+                     definitions[i].privateId, definitions[i].signalId );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t D e f i n e S i g n a l s
+
+    @brief Define batches of signals.
+
+    This must be run while the signal indices are still empty.  A batch
+    with a duplicate signal ID must fall back to defining the signals one at
+    a time.  Those signals are then taken back out of the indices so that the
+    next batch, which is not in any particular order, is bulk loaded.  A
+    batch defined once the indices have signals in them is inserted one
+    signal at a time.  Every signal must end up in each of the indices that
+    apply to it exactly once.
+
+    @param[in] signalId - The first of the signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testDefineSignals ( signal_t signalId )
+{
+    signal_definition definitions[DEFINE_TEST_SIGNALS];
+    char              names[DEFINE_TEST_SIGNALS][32];
+    unsigned int      bulkCount     = DEFINE_TEST_SIGNALS - 10;
+    unsigned int      privateCount  = 0;
+
+    printf ( "\nDefining batches of signals...\n" );
+
+    if ( vsiContext->signalIdIndex.count != 0 ||
+         vsiContext->signalNameIndex.count != 0 ||
+         vsiContext->privateIdIndex.count != 0 )
+    {
+        printf ( "Error: The signal indices are not empty\n" );
+        return 1;
+    }
+    //
+    //  A batch with a duplicate signal ID can't be bulk loaded.
+    //
+    signal_definition duplicates[3] =
+    {
+        { signalId, 0, NULL }, { signalId + 1, 0, NULL }, { signalId, 0, NULL }
+    };
+    if ( vsi_define_signals ( 1, duplicates, 3 ) != 0 ||
+         vsiContext->signalIdIndex.count != 2 )
+    {
+        printf ( "Error: The batch with a duplicate signal ID defined %u "
+                 "signals\n", vsiContext->signalIdIndex.count );
+        return 1;
+    }
+    btree_delete ( &vsiContext->signalIdIndex,
+                   findSignalList ( 1, signalId ) );
+    btree_delete ( &vsiContext->signalIdIndex,
+                   findSignalList ( 1, signalId + 1 ) );
+
+    //
+    //  Build the definitions in a scrambled order.  Every other signal has a
+    //  private ID.
+    //
+    for ( unsigned int i = 0; i < DEFINE_TEST_SIGNALS; ++i )
+    {
+        unsigned int n = ( i * 7 ) % DEFINE_TEST_SIGNALS;
+
+        sprintf ( names[i], "define.test.%02u", n );
+
+        definitions[i].signalId  = signalId + 10 + n;
+        definitions[i].privateId = n % 2 != 0 ? signalId + 1000 + n : 0;
+        definitions[i].name      = names[i];
+
+        if ( i < bulkCount && definitions[i].privateId != 0 )
+        {
+            ++privateCount;
+        }
+    }
+    if ( vsi_define_signals ( 1, definitions, bulkCount ) != 0 ||
+         vsiContext->signalIdIndex.count != bulkCount ||
+         vsiContext->signalNameIndex.count != bulkCount ||
+         vsiContext->privateIdIndex.count != privateCount )
+    {
+        printf ( "Error: The bulk loaded indices hold %u, %u and %u "
+                 "signals\n", vsiContext->signalIdIndex.count,
+                 vsiContext->signalNameIndex.count,
+                 vsiContext->privateIdIndex.count );
+        return 1;
+    }
+    if ( checkDefinitions ( definitions, bulkCount ) != 0 )
+    {
+        return 1;
+    }
+    //
+    //  The rest of the signals go into indices that already have signals.
+    //
+    if ( vsi_define_signals ( 1, &definitions[bulkCount],
+                              DEFINE_TEST_SIGNALS - bulkCount ) != 0 ||
+         vsiContext->signalIdIndex.count != DEFINE_TEST_SIGNALS ||
+         vsiContext->signalNameIndex.count != DEFINE_TEST_SIGNALS )
+    {
+        printf ( "Error: The indices hold %u and %u signals after the last "
+                 "batch\n", vsiContext->signalIdIndex.count,
+                 vsiContext->signalNameIndex.count );
+        return 1;
+    }
+    if ( checkDefinitions ( definitions, DEFINE_TEST_SIGNALS ) != 0 )
+    {
+        return 1;
+    }
+    printf ( "  All of the batches were defined\n" );
+
+    return 0;
+}
+
+
+//
+//  Return the total size of the available chunks of the user segment.
+//
+static unsigned long availableMemory ( void )
+{
+    unsigned long total = 0;
+
+    btree_iter iter = btree_iter_begin ( &sysControl->availableMemoryByOffset );
+
+    while ( ! btree_iter_at_end ( iter ) )
+    {
+        total += ((memoryChunk_t*)btree_iter_data ( iter ))->segmentSize;
+        btree_iter_next ( iter );
+    }
+    btree_iter_cleanup ( iter );
+
+    return total;
+}
+
+
+//
+//  The locker thread of the batch allocation test checks that the shared
+//  memory manager lock is not held by anyone.
+//
+static void* batchLockerThread ( void* arg )
+{
+    int* status = arg;
+
+    *status = pthread_mutex_trylock ( &smControl->smLock );
+    if ( *status == 0 )
+    {
+        pthread_mutex_unlock ( &smControl->smLock );
+    }
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t M a l l o c B a t c h
+
+    @brief Allocate batches of chunks that can and can't be satisfied.
+
+    A batch whose last chunk can't be allocated must fail with ENOMEM, give
+    back all of the chunks it had already allocated and release the shared
+    memory manager lock.  A batch of small chunks must succeed.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testMallocBatch ( void )
+{
+    size_t        sizes[] = { 24, 1000, 5000, MAXIMUM_SHARED_MEMORY_SIZE };
+    size_t        small[] = { 8, 24, 100 };
+    void*         blocks[4];
+    pthread_t     thread;
+    int           lockStatus = -1;
+    unsigned long before;
+
+    printf ( "\nAllocating batches of chunks...\n" );
+
+    //
+    //  Make sure the small chunk comes from a slab page that already exists
+    //  so that the batch does not keep a new slab page when it fails.
+    //
+    sm_free ( sm_malloc ( sizes[0] ) );
+
+    before = availableMemory();
+
+    if ( sm_malloc_batch ( 4, sizes, blocks ) != ENOMEM )
+    {
+        printf ( "Error: A batch that can't be allocated succeeded\n" );
+        return 1;
+    }
+    if ( availableMemory() != before )
+    {
+        printf ( "Error: The failed batch kept %lu bytes\n",
+                 before - availableMemory() );
+        return 1;
+    }
+    pthread_create ( &thread, NULL, batchLockerThread, &lockStatus );
+    pthread_join ( thread, NULL );
+
+    if ( lockStatus != 0 )
+    {
+        printf ( "Error: The failed batch left the shared memory manager "
+                 "lock held (%d)\n", lockStatus );
+        return 1;
+    }
+    //
+    //  A batch that fits is allocated in full.
+    //
+    if ( sm_malloc_batch ( 3, small, blocks ) != 0 ||
+         blocks[0] == NULL || blocks[1] == NULL || blocks[2] == NULL ||
+         blocks[0] == blocks[1] || blocks[1] == blocks[2] )
+    {
+        printf ( "Error: A batch of small chunks was not allocated\n" );
+        return 1;
+    }
+    for ( int i = 0; i < 3; ++i )
+    {
+        memset ( blocks[i], 0xa5, small[i] );
+        sm_free ( blocks[i] );
+    }
+    printf ( "  The failed batch gave back all of it's chunks\n" );
+
+    return 0;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t C h u n k A l l o c a t o r
+
+    @brief Allocate and free the chunk of memory at the end of the segment.
+
+    The free chunk at the end of the user segment is allocated with a little
+    less than it's size, which is too little to split off a chunk of it's
+    own, and then freed again.  The memory past the end of the segment is
+    not accessible so reading or writing a chunk header there would crash.
+    A request that is larger than the segment can ever grow must fail
+    cleanly.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testChunkAllocator ( void )
+{
+    printf ( "\nAllocating the last chunk of the segment...\n" );
+
+    if ( sm_malloc ( MAXIMUM_SHARED_MEMORY_SIZE ) != NULL )
+    {
+        printf ( "Error: An allocation larger than the segment succeeded\n" );
+        return 1;
+    }
+    memoryChunk_t* last = btree_get_max ( &sysControl->availableMemoryByOffset );
+
+    if ( last == NULL || last->offset + last->segmentSize !=
+                         smControl->sharedMemorySegmentSize )
+    {
+        printf ( "Error: The end of the segment is not available\n" );
+        return 1;
+    }
+    unsigned long lastOffset = last->offset;
+    unsigned long lastSize   = last->segmentSize;
+
+    //
+    //  Leave just less than the split threshold at the end of the chunk so
+    //  that the whole chunk is allocated.
+    //
+    void* memory = sm_malloc ( lastSize - SPLIT_THRESHOLD );
+
+    if ( memory == NULL ||
+         ((memoryChunk_t*)( memory - CHUNK_HEADER_SIZE ))->offset !=
+             lastOffset ||
+         ((memoryChunk_t*)( memory - CHUNK_HEADER_SIZE ))->segmentSize !=
+             lastSize )
+    {
+        printf ( "Error: The last chunk of %lu bytes was not allocated whole\n",
+                 lastSize );
+        return 1;
+    }
+    sm_free ( memory );
+
+    last = btree_get_max ( &sysControl->availableMemoryByOffset );
+    if ( last == NULL || last->offset != lastOffset ||
+         last->segmentSize != lastSize )
+    {
+        printf ( "Error: The last chunk was not made available again\n" );
+        return 1;
+    }
+    printf ( "  The last chunk of %lu bytes was allocated and freed\n",
+             lastSize );
+
+    return 0;
+}
+
+
+//
+//  Define the number of signals inserted by the range test.
+//
+#define RANGE_TEST_SIGNALS ( 10 )
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t S i g n a l R a n g e
+
+    @brief Fetch a time range of the signals in a ring.
+
+    The signals whose capture times are within the range must be returned
+    oldest first, a full result array must return the oldest of them and a
+    signal stored in a linked list must be rejected.
+
+    @param[in] signalId - The first of the two signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testSignalRange ( signal_t signalId )
+{
+    signal_stamp  stamps[RANGE_TEST_SIGNALS];
+    unsigned long values[RANGE_TEST_SIGNALS];
+    vsi_result    results[RANGE_TEST_SIGNALS];
+    unsigned long value;
+    size_t        count;
+
+    printf ( "\nFetching a time range of a ring...\n" );
+
+    if ( sm_create_ring ( findSignalList ( 1, signalId ), RANGE_TEST_SIGNALS,
+                          sizeof(value) ) != 0 )
+    {
+        printf ( "Error: Unable to convert signal %u to a ring\n", signalId );
+        return 1;
+    }
+    memset ( stamps, 0, sizeof(stamps) );
+    for ( value = 0; value < RANGE_TEST_SIGNALS; ++value )
+    {
+        sm_insert ( 1, signalId, sizeof(value), &value, &stamps[value] );
+    }
+    memset ( results, 0, sizeof(results) );
+    for ( int i = 0; i < RANGE_TEST_SIGNALS; ++i )
+    {
+        results[i].data       = (char*)&values[i];
+        results[i].dataLength = sizeof(values[i]);
+    }
+    //
+    //  Fetch the signals from the fourth through the seventh.
+    //
+    count = RANGE_TEST_SIGNALS;
+    if ( vsi_get_signal_range ( 1, signalId, stamps[3].timestamp,
+                                stamps[6].timestamp, results, &count ) != 0 ||
+         count != 4 || values[0] != 3 || values[3] != 6 ||
+         results[0].sequence != stamps[3].sequence )
+    {
+        printf ( "Error: The range fetch returned %zu signals\n", count );
+        return 1;
+    }
+    //
+    //  Only the oldest signals of the range fit into a short result array.
+    //
+    count = 2;
+    if ( vsi_get_signal_range ( 1, signalId, stamps[0].timestamp,
+                                stamps[RANGE_TEST_SIGNALS - 1].timestamp,
+                                results, &count ) != 0 ||
+         count != 2 || values[0] != 0 || values[1] != 1 )
+    {
+        printf ( "Error: The short range fetch returned %zu signals\n",
+                 count );
+        return 1;
+    }
+    //
+    //  A signal stored in a linked list can't be searched by time.
+    //
+    value = 0;
+    sm_insert ( 1, signalId + 1, sizeof(value), &value, NULL );
+
+    count = RANGE_TEST_SIGNALS;
+    if ( vsi_get_signal_range ( 1, signalId + 1, 0, ~0UL, results,
+                                &count ) != EOPNOTSUPP || count != 0 )
+    {
+        printf ( "Error: A range fetch from a linked list was accepted\n" );
+        return 1;
+    }
+    sm_flush_signal ( 1, signalId + 1 );
+
+    printf ( "  The signals in the range were returned in order\n" );
+
+    return 0;
+}
+
+
+//
+//  Set a deadline the given number of milliseconds from now (which may be
+//  negative to get one that has already passed).
+//
+static void deadlineAfter ( struct timespec* deadline, long milliseconds )
+{
+    clock_gettime ( CLOCK_MONOTONIC, deadline );
+
+    long nanoseconds = deadline->tv_nsec + milliseconds * 1000000L;
+
+    deadline->tv_sec  += nanoseconds / 1000000000L;
+    deadline->tv_nsec  = nanoseconds % 1000000000L;
+    if ( deadline->tv_nsec < 0 )
+    {
+        deadline->tv_sec  -= 1;
+        deadline->tv_nsec += 1000000000L;
+    }
+}
+
+
+//
+//  Return the number of milliseconds that have passed since a time.
+//
+static long millisecondsSince ( const struct timespec* start )
+{
+    struct timespec now;
+
+    clock_gettime ( CLOCK_MONOTONIC, &now );
+
+    return ( now.tv_sec - start->tv_sec ) * 1000L +
+           ( now.tv_nsec - start->tv_nsec ) / 1000000L;
+}
+
+
+//
+//  Define how long the semaphore timeout test waits for a semaphore that is
+//  never posted, in milliseconds.
+//
+#define SEMAPHORE_TEST_TIMEOUT ( 50 )
+
+//
+//  Define what the threads of the semaphore timeout test share.
+//
+static semaphore_p   testSemaphore;
+static volatile bool semaphoreReady;
+static int           semaphoreStatus;
+
+//
+//  The waiter of the semaphore timeout test waits for a semaphore that will
+//  be posted long before it's deadline.
+//
+static void* semaphoreWaiterThread ( void* arg )
+{
+    struct timespec deadline;
+
+    deadlineAfter ( &deadline, 10000 );
+
+    semaphoreStatus = semaphoreWait ( testSemaphore, &deadline );
+
+    return NULL;
+}
+
+
+//
+//  The ready function of the semaphore timeout test.
+//
+static bool semaphoreIsReady ( void* context )
+{
+    return semaphoreReady;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t S e m a p h o r e T i m e o u t
+
+    @brief Wait for a semaphore with a deadline.
+
+    A wait for a semaphore that is never posted must time out at it's
+    deadline and not before.  A deadline that has already passed does not
+    keep a wait from succeeding if the semaphore is available.  A post must
+    wake a waiter long before it's deadline.  Every wait must leave the
+    sleeper count as it found it.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testSemaphoreTimeout ( void )
+{
+    struct timespec deadline;
+    struct timespec start;
+    pthread_t       thread;
+    long            elapsed = 0;
+    int             failed  = 0;
+
+    printf ( "\nWaiting for a semaphore with a deadline...\n" );
+
+    testSemaphore = sm_malloc ( sizeof(semaphore_t) );
+    memset ( testSemaphore, 0, sizeof(semaphore_t) );
+
+    //
+    //  A deadline that has passed fails at once unless the semaphore is
+    //  available.
+    //
+    deadlineAfter ( &deadline, -SEMAPHORE_TEST_TIMEOUT );
+    if ( semaphoreWait ( testSemaphore, &deadline ) != ETIMEDOUT )
+    {
+        printf ( "Error: A wait with a past deadline did not time out\n" );
+        failed = 1;
+    }
+    testSemaphore->messageCount = 1;
+    if ( semaphoreWait ( testSemaphore, &deadline ) != 0 )
+    {
+        printf ( "Error: A wait for an available semaphore timed out\n" );
+        failed = 1;
+    }
+    testSemaphore->messageCount = 0;
+
+    //
+    //  Both kinds of wait time out at their deadlines.
+    //
+    clock_gettime ( CLOCK_MONOTONIC, &start );
+    deadlineAfter ( &deadline, SEMAPHORE_TEST_TIMEOUT );
+
+    if ( semaphoreWait ( testSemaphore, &deadline ) != ETIMEDOUT ||
+         ( elapsed = millisecondsSince ( &start ) ) < SEMAPHORE_TEST_TIMEOUT )
+    {
+        printf ( "Error: The semaphore wait did not time out at it's "
+                 "deadline\n" );
+        failed = 1;
+    }
+    semaphoreReady = false;
+    clock_gettime ( CLOCK_MONOTONIC, &start );
+    deadlineAfter ( &deadline, SEMAPHORE_TEST_TIMEOUT );
+
+    if ( semaphoreWaitUntil ( testSemaphore, semaphoreIsReady, NULL,
+                              &deadline ) != ETIMEDOUT ||
+         millisecondsSince ( &start ) < SEMAPHORE_TEST_TIMEOUT )
+    {
+        printf ( "Error: The conditional semaphore wait did not time out at "
+                 "it's deadline\n" );
+        failed = 1;
+    }
+    //
+    //  A post wakes up a waiter that has a long way to go to it's deadline.
+    //
+    semaphoreStatus = -1;
+    clock_gettime ( CLOCK_MONOTONIC, &start );
+    pthread_create ( &thread, NULL, semaphoreWaiterThread, NULL );
+
+    while ( __atomic_load_n ( &testSemaphore->sleeperCount,
+                              __ATOMIC_ACQUIRE ) == 0 )
+    {
+        usleep ( 1000 );
+    }
+    __atomic_add_fetch ( &testSemaphore->messageCount, 1, __ATOMIC_RELEASE );
+    semaphorePost ( testSemaphore );
+
+    pthread_join ( thread, NULL );
+
+    if ( semaphoreStatus != 0 || millisecondsSince ( &start ) >= 5000 )
+    {
+        printf ( "Error: The posted semaphore wait returned %d\n",
+                 semaphoreStatus );
+        failed = 1;
+    }
+    if ( testSemaphore->sleeperCount != 0 )
+    {
+        printf ( "Error: The semaphore was left with %d sleepers\n",
+                 testSemaphore->sleeperCount );
+        failed = 1;
+    }
+    sm_free ( testSemaphore );
+
+    if ( ! failed )
+    {
+        printf ( "  The semaphore waits timed out after %ld ms\n", elapsed );
+    }
+    return failed;
+}
+
+
+//
+//  Define how long each wait of the deadline test lasts, in milliseconds.
+//
+#define DEADLINE_TEST_TIMEOUT ( 50 )
+
+//
+//  Define the signal that the writer of the deadline test inserts into.
+//
+static signal_t deadlineSignal;
+
+//
+//  The writer of the deadline test waits until the main thread is asleep
+//  waiting for the signal and then inserts it.
+//
+static void* deadlineWriterThread ( void* arg )
+{
+    signal_list*  signalList = findSignalList ( 1, deadlineSignal );
+    unsigned long value      = deadlineSignal;
+
+    while ( __atomic_load_n ( &signalList->semaphore.sleeperCount,
+                              __ATOMIC_ACQUIRE ) == 0 )
+    {
+        usleep ( 1000 );
+    }
+    sm_insert ( 1, deadlineSignal, sizeof(value), &value, NULL );
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t D e a d l i n e s
+
+    @brief Let the blocking fetches and group waits reach their deadlines.
+
+    Each of the waits must return ETIMEDOUT once it's deadline has passed
+    and not before, and must leave no waiters or sleepers behind.  A
+    deadline that has already passed does not keep a signal that is present
+    from being fetched and a signal that arrives before the deadline ends
+    the wait.
+
+    @param[in] groupId - The group to use.
+    @param[in] signalId - The first of the three signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testDeadlines ( group_t groupId, signal_t signalId )
+{
+    vsi_result      results[2];
+    unsigned long   values[2];
+    unsigned long   value;
+    unsigned long   size;
+    struct timespec deadline;
+    struct timespec start;
+    pthread_t       thread;
+    int             status[5];
+    int             failed = 0;
+
+    printf ( "\nWaiting for signals until their deadlines...\n" );
+
+    signal_list* signalList = findSignalList ( 1, signalId );
+
+    vsi_create_signal_group ( groupId );
+    vsi_add_signal_to_group ( 1, signalId + 1, groupId );
+    vsi_add_signal_to_group ( 1, signalId + 2, groupId );
+
+    //
+    //  Wait for signals that never arrive in each of the ways that take a
+    //  deadline.
+    //
+    for ( int i = 0; i < 5; ++i )
+    {
+        for ( int j = 0; j < 2; ++j )
+        {
+            memset ( &results[j], 0, sizeof(results[j]) );
+            results[j].data       = (char*)&values[j];
+            results[j].dataLength = sizeof(values[j]);
+        }
+        clock_gettime ( CLOCK_MONOTONIC, &start );
+        deadlineAfter ( &deadline, DEADLINE_TEST_TIMEOUT );
+        size = sizeof(value);
+
+        switch ( i )
+        {
+            case 0:
+                status[i] = sm_fetch ( 1, signalId, &size, &value, true,
+                                       &deadline, NULL );
+                break;
+            case 1:
+                status[i] = sm_fetch_newest ( 1, signalId, &size, &value,
+                                              true, &deadline, NULL );
+                break;
+            case 2:
+                status[i] = sm_fetch_latest ( 1, signalId, &size, &value,
+                                              true, &deadline, NULL );
+                break;
+            case 3:
+                status[i] = vsi_listen_any_in_group_until ( groupId,
+                                                            &deadline,
+                                                            results );
+                break;
+            default:
+                status[i] = vsi_get_oldest_in_group_wait_until ( groupId,
+                                                                 results,
+                                                                 &deadline );
+                break;
+        }
+        if ( status[i] != ETIMEDOUT ||
+             millisecondsSince ( &start ) < DEADLINE_TEST_TIMEOUT )
+        {
+            printf ( "Error: Wait %d returned %d after %ld ms\n", i,
+                     status[i], millisecondsSince ( &start ) );
+            failed = 1;
+        }
+    }
+    if ( signalList->semaphore.waiterCount != 0 ||
+         signalList->semaphore.sleeperCount != 0 )
+    {
+        printf ( "Error: The timed out waits left %d waiters and %d "
+                 "sleepers\n", signalList->semaphore.waiterCount,
+                 signalList->semaphore.sleeperCount );
+        failed = 1;
+    }
+    //
+    //  A signal that is already there is fetched even though the deadline
+    //  has passed.
+    //
+    value = signalId;
+    sm_insert ( 1, signalId, sizeof(value), &value, NULL );
+
+    deadlineAfter ( &deadline, -DEADLINE_TEST_TIMEOUT );
+    size  = sizeof(value);
+    value = 0;
+
+    if ( sm_fetch ( 1, signalId, &size, &value, true, &deadline,
+                    NULL ) != 0 || value != (unsigned long)signalId )
+    {
+        printf ( "Error: A present signal was not fetched after it's "
+                 "deadline\n" );
+        failed = 1;
+    }
+    //
+    //  A signal that arrives in time ends the wait.
+    //
+    deadlineSignal = signalId;
+    pthread_create ( &thread, NULL, deadlineWriterThread, NULL );
+
+    clock_gettime ( CLOCK_MONOTONIC, &start );
+    deadlineAfter ( &deadline, 10000 );
+    size  = sizeof(value);
+    value = 0;
+
+    status[0] = sm_fetch ( 1, signalId, &size, &value, true, &deadline,
+                           NULL );
+    pthread_join ( thread, NULL );
+
+    if ( status[0] != 0 || value != (unsigned long)signalId ||
+         millisecondsSince ( &start ) >= 5000 )
+    {
+        printf ( "Error: The wait for a signal that arrived returned %d\n",
+                 status[0] );
+        failed = 1;
+    }
+    vsi_delete_signal_group ( groupId );
+
+    if ( ! failed )
+    {
+        printf ( "  The waits ended at their deadlines\n" );
+    }
+    return failed;
+}
+
+
+//
+//  Define the dimensions of the signal stamp test.
+//
+#define STAMP_TEST_THREADS ( 4 )
+#define STAMP_TEST_SIGNALS ( 2000 )
+
+//
+//  Define the signal that the writers of the signal stamp test insert into.
+//
+static signal_t stampSignal;
+
+//
+//  Each writer of the signal stamp test inserts it's own numbered values
+//  with it's ID in the upper half of each value.
+//
+static void* stampWriterThread ( void* arg )
+{
+    unsigned long writer = (unsigned long)arg;
+
+    for ( unsigned long i = 0; i < STAMP_TEST_SIGNALS; ++i )
+    {
+        unsigned long value = ( writer << 32 ) | i;
+
+        sm_insert ( 1, stampSignal, sizeof(value), &value, NULL );
+    }
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t S i g n a l S t a m p s
+
+    @brief Check the order of the stamps of signals from several writers.
+
+    The signals of a list written by several threads at once must be stamped
+    with consecutive sequence numbers starting at 1 in the order that they
+    are stored and with capture times that never go backwards.  A capture
+    time given by the writer must be kept and a signal that could not be
+    stored must not use up a sequence number.
+
+    @param[in] signalId - The first of the two signals to use.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testSignalStamps ( signal_t signalId )
+{
+    pthread_t     threads[STAMP_TEST_THREADS];
+    unsigned long next[STAMP_TEST_THREADS] = { 0 };
+    unsigned long value;
+    unsigned long size;
+    unsigned long lastTime = 0;
+    signal_stamp  stamp;
+    int           failed   = 0;
+
+    printf ( "\nStamping signals from %d writers...\n", STAMP_TEST_THREADS );
+
+    stampSignal = signalId;
+
+    for ( unsigned long i = 0; i < STAMP_TEST_THREADS; ++i )
+    {
+        pthread_create ( &threads[i], NULL, stampWriterThread, (void*)i );
+    }
+    for ( int i = 0; i < STAMP_TEST_THREADS; ++i )
+    {
+        pthread_join ( threads[i], NULL );
+    }
+    //
+    //  Read the signals back in the order they were stored.
+    //
+    for ( unsigned long i = 1;
+          i <= STAMP_TEST_THREADS * STAMP_TEST_SIGNALS && ! failed; ++i )
+    {
+        size = sizeof(value);
+        if ( sm_fetch ( 1, signalId, &size, &value, false, NULL,
+                        &stamp ) != 0 )
+        {
+            printf ( "Error: Signal %lu of %d is missing\n", i,
+                     STAMP_TEST_THREADS * STAMP_TEST_SIGNALS );
+            failed = 1;
+        }
+        else if ( stamp.sequence != i || stamp.timestamp < lastTime )
+        {
+            printf ( "Error: Signal %lu was stamped %lu at %lu after %lu\n",
+                     i, stamp.sequence, stamp.timestamp, lastTime );
+            failed = 1;
+        }
+        else if ( ( value >> 32 ) >= STAMP_TEST_THREADS ||
+                  ( value & 0xffffffffUL ) != next[value >> 32]++ )
+        {
+            printf ( "Error: Signal %lu holds %lx out of order\n", i, value );
+            failed = 1;
+        }
+        lastTime = stamp.timestamp;
+    }
+    sm_flush_signal ( 1, signalId );
+
+    //
+    //  A ring keeps the writer's capture time and a rejected signal does not
+    //  leave a gap in the sequence numbers.
+    //
+    char big[sizeof(value) * 2] = { 0 };
+
+    sm_create_ring ( findSignalList ( 1, signalId + 1 ), 4, sizeof(value) );
+
+    memset ( &stamp, 0, sizeof(stamp) );
+    stamp.timestamp = 12345;
+    value = 1;
+
+    if ( sm_insert ( 1, signalId + 1, sizeof(value), &value, &stamp ) != 0 ||
+         stamp.timestamp != 12345 || stamp.sequence != 1 ||
+         sm_insert ( 1, signalId + 1, sizeof(big), big, NULL ) != EMSGSIZE )
+    {
+        printf ( "Error: The first ring signal was stamped %lu at %lu\n",
+                 stamp.sequence, stamp.timestamp );
+        failed = 1;
+    }
+    memset ( &stamp, 0, sizeof(stamp) );
+    if ( sm_insert ( 1, signalId + 1, sizeof(value), &value, &stamp ) != 0 ||
+         stamp.sequence != 2 || stamp.timestamp == 0 )
+    {
+        printf ( "Error: The ring signal after a rejected one was stamped "
+                 "%lu\n", stamp.sequence );
+        failed = 1;
+    }
+    sm_flush_signal ( 1, signalId + 1 );
+
+    if ( ! failed )
+    {
+        printf ( "  %d signals were stamped in order\n",
+                 STAMP_TEST_THREADS * STAMP_TEST_SIGNALS );
+    }
+    return failed;
+}
+
+
+//
+//  Define the dimensions of the slab free list test.  Each worker keeps a
+//  few blocks allocated at a time and frees the oldest one before every new
+//  allocation.
+//
+#define SLAB_TEST_THREADS ( 4 )
+#define SLAB_TEST_HELD    ( 8 )
+#define SLAB_TEST_ROUNDS  ( 200000 )
+
+//
+//  Define what each worker of the slab free list test is given.
+//
+typedef struct slabWorker
+{
+    unsigned long id;
+    void*         blocks[SLAB_TEST_HELD];
+    unsigned long tags[SLAB_TEST_HELD];
+    unsigned long errors;
+
+}   slabWorker;
+
+
+//
+//  The workers of the slab free list test have no magazines so every
+//  allocation and free is a compare-and-swap on the same free list.  Each
+//  block is tagged with it's owner and allocation number so a block that
+//  was handed out to two workers at once is found when it is freed.
+//
+static void* slabWorkerThread ( void* arg )
+{
+    slabWorker* worker = arg;
+
+    for ( unsigned long i = 0; i < SLAB_TEST_ROUNDS; ++i )
+    {
+        unsigned int   j     = i % SLAB_TEST_HELD;
+        unsigned long* block = worker->blocks[j];
+
+        if ( block != NULL )
+        {
+            slabBlock_t* header = (slabBlock_t*)( (char*)block -
+                                                  SLAB_HEADER_SIZE );
+            if ( *block != worker->tags[j] ||
+                 header->type != TYPE_SLAB_IN_USE )
+            {
+                ++worker->errors;
+            }
+            sm_free ( block );
+        }
+        block = sm_malloc ( sizeof(unsigned long) );
+        if ( block == NULL )
+        {
+            ++worker->errors;
+            worker->blocks[j] = NULL;
+            continue;
+        }
+        worker->tags[j]   = ( worker->id << 32 ) | i;
+        worker->blocks[j] = block;
+        *block            = worker->tags[j];
+    }
+    for ( unsigned int j = 0; j < SLAB_TEST_HELD; ++j )
+    {
+        sm_free ( worker->blocks[j] );
+    }
+    return NULL;
+}
+
+
+//
+//  Define what the reuse thread of the slab free list test records.
+//
+typedef struct slabReuse
+{
+    unsigned long headBefore;
+    unsigned long headAfter;
+    void*         first;
+
+}   slabReuse;
+
+
+//
+//  The reuse thread of the slab free list test has no magazine.  It pops
+//  the first two blocks off of the smallest size class free list and then
+//  pushes the first one back, which puts the same block back at the head of
+//  the list.  This is what a thread that was delayed in the middle of a pop
+//  would see as the "ABA" case.
+//
+static void* slabReuseThread ( void* arg )
+{
+    slabReuse* reuse = arg;
+
+    sm_free ( sm_malloc ( sizeof(unsigned long) ) );
+
+    reuse->headBefore = __atomic_load_n ( &smControl->slabFreeList[0],
+                                          __ATOMIC_ACQUIRE );
+    reuse->first = sm_malloc ( sizeof(unsigned long) );
+    void* second = sm_malloc ( sizeof(unsigned long) );
+
+    sm_free ( reuse->first );
+
+    reuse->headAfter = __atomic_load_n ( &smControl->slabFreeList[0],
+                                         __ATOMIC_ACQUIRE );
+    sm_free ( second );
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t S l a b F r e e L i s t
+
+    @brief Allocate and free small blocks from several threads at once.
+
+    The workers are kept from getting magazines so that they all pop and
+    push the same slab free list.  No block may ever be handed out to two
+    workers at the same time.  A block that is popped and pushed back onto
+    the head of the list must change the head so that a pop that was
+    started before then can't succeed.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testSlabFreeList ( void )
+{
+    slabWorker    workers[SLAB_TEST_THREADS];
+    pthread_t     threads[SLAB_TEST_THREADS];
+    bool          taken[SM_MAGAZINE_COUNT] = { false };
+    unsigned long errors = 0;
+    int           started;
+
+    printf ( "\nSharing a slab free list between %d threads...\n",
+             SLAB_TEST_THREADS );
+
+    //
+    //  Take all of the available magazines so that the workers can't get
+    //  one.
+    //
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        pid_t available = 0;
+
+        taken[i] = __atomic_compare_exchange_n (
+                       &smControl->magazines[i].processId, &available,
+                       getpid(), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED );
+    }
+    memset ( workers, 0, sizeof(workers) );
+
+    for ( started = 0; started < SLAB_TEST_THREADS; ++started )
+    {
+        workers[started].id = started + 1;
+        if ( pthread_create ( &threads[started], NULL, slabWorkerThread,
+                              &workers[started] ) != 0 )
+        {
+            printf ( "Error: Unable to create slab worker %d\n", started );
+            ++errors;
+            break;
+        }
+    }
+    for ( int i = 0; i < started; ++i )
+    {
+        pthread_join ( threads[i], NULL );
+        errors += workers[i].errors;
+    }
+    //
+    //  A free list whose first block was popped and pushed back must not
+    //  have the same head value that it had before.  Only the low 32 bits of
+    //  the head hold the (scaled) offset of the first block.
+    //
+    slabReuse reuse;
+
+    memset ( &reuse, 0, sizeof(reuse) );
+    if ( errors == 0 &&
+         pthread_create ( &threads[0], NULL, slabReuseThread, &reuse ) == 0 )
+    {
+        pthread_join ( threads[0], NULL );
+
+        if ( ( reuse.headBefore & 0xffffffffUL ) << 3 !=
+                 toOffset ( reuse.first ) - SLAB_HEADER_SIZE ||
+             ( reuse.headAfter & 0xffffffffUL ) !=
+                 ( reuse.headBefore & 0xffffffffUL ) ||
+             reuse.headAfter == reuse.headBefore )
+        {
+            printf ( "Error: Reusing a slab block left the free list head at "
+                     "%lx (was %lx)\n", reuse.headAfter, reuse.headBefore );
+            ++errors;
+        }
+    }
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        if ( taken[i] )
+        {
+            __atomic_store_n ( &smControl->magazines[i].processId, 0,
+                               __ATOMIC_RELEASE );
+        }
+    }
+    if ( errors != 0 )
+    {
+        printf ( "Error: The slab free list had %lu errors\n", errors );
+        return 1;
+    }
+    printf ( "  No slab block was handed out twice\n" );
+
+    return 0;
+}
+
+
+//
+//  Define the number of blocks retired by the anonymous reader test.
+//
+#define ANONYMOUS_TEST_BLOCKS ( 3 * SM_EPOCH_LIMBO_SIZE )
+
+//
+//  Define what the worker thread of the anonymous reader test is given.
+//
+typedef struct anonymousWorker
+{
+    void*         blocks[ANONYMOUS_TEST_BLOCKS];
+    unsigned long pagesAdded;
+    bool          counted;
+
+}   anonymousWorker;
+
+
+//
+//  The worker of the anonymous reader test has no magazine so it retires
+//  all of it's blocks to the shared limbo list while it is in an epoch
+//  protected section (so none of them can be freed yet).
+//
+static void* anonymousWorkerThread ( void* arg )
+{
+    anonymousWorker* worker = arg;
+    unsigned long    pages  = smControl->limboPageCount;
+
+    sm_epoch_enter();
+
+    for ( int i = 0; i < SM_ANONYMOUS_READER_COUNT; ++i )
+    {
+        if ( smControl->anonymousReaders[i].processId == getpid() &&
+             smControl->anonymousReaders[i].count != 0 )
+        {
+            worker->counted = true;
+        }
+    }
+    for ( int i = 0; i < ANONYMOUS_TEST_BLOCKS; ++i )
+    {
+        sm_retire ( worker->blocks[i] );
+    }
+    worker->pagesAdded = smControl->limboPageCount - pages;
+
+    sm_epoch_exit();
+
+    return NULL;
+}
+
+
+/*!-----------------------------------------------------------------------
+
+    t e s t A n o n y m o u s R e a d e r s
+
+    @brief Retire blocks from a thread without a magazine and reap the
+           anonymous readers of a dead process.
+
+    The blocks retired one at a time must share limbo pages and the count
+    left behind by a process that died inside an epoch protected section
+    must be written off by sm_reclaim_magazines.
+
+    @return 0 if the test passed, 1 if it failed
+
+------------------------------------------------------------------------*/
+static int testAnonymousReaders ( void )
+{
+    anonymousWorker worker;
+    pthread_t       thread;
+    bool            taken[SM_MAGAZINE_COUNT] = { false };
+    pid_t           child;
+    int             failures = 0;
+
+    printf ( "\nRetiring blocks from a thread without a magazine...\n" );
+
+    memset ( &worker, 0, sizeof(worker) );
+    for ( int i = 0; i < ANONYMOUS_TEST_BLOCKS; ++i )
+    {
+        worker.blocks[i] = sm_malloc ( 16 );
+    }
+    //
+    //  Take all of the available magazines so that the worker can't get one.
+    //
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        pid_t available = 0;
+
+        taken[i] = __atomic_compare_exchange_n (
+                       &smControl->magazines[i].processId, &available,
+                       getpid(), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED );
+    }
+    if ( pthread_create ( &thread, NULL, anonymousWorkerThread,
+                          &worker ) != 0 )
+    {
+        printf ( "Error: Unable to create the anonymous reader thread\n" );
+        failures = 1;
+    }
+    else
+    {
+        pthread_join ( thread, NULL );
+    }
+    for ( int i = 0; i < SM_MAGAZINE_COUNT; ++i )
+    {
+        if ( taken[i] )
+        {
+            __atomic_store_n ( &smControl->magazines[i].processId, 0,
+                               __ATOMIC_RELEASE );
+        }
+    }
+    if ( failures != 0 )
+    {
+        return failures;
+    }
+    if ( ! worker.counted )
+    {
+        printf ( "Error: The thread was not counted as an anonymous "
+                 "reader\n" );
+        return 1;
+    }
+    if ( worker.pagesAdded > ANONYMOUS_TEST_BLOCKS / SM_EPOCH_LIMBO_SIZE )
+    {
+        printf ( "Error: Retiring %d blocks started %lu limbo pages\n",
+                 ANONYMOUS_TEST_BLOCKS, worker.pagesAdded );
+        return 1;
+    }
+    printf ( "  %d blocks were retired into %lu new limbo pages\n",
+             ANONYMOUS_TEST_BLOCKS, worker.pagesAdded );
+
+    //
+    //  Leave an anonymous reader behind for a process that no longer exists
+    //  and make sure that it is written off.
+    //
+    printf ( "\nReaping the anonymous readers of a dead process...\n" );
+
+    child = fork();
+    if ( child == 0 )
+    {
+        _exit ( 0 );
+    }
+    waitpid ( child, NULL, 0 );
+
+    anonymousReader_t* reader = NULL;
+
+    for ( int i = 0; i < SM_ANONYMOUS_READER_COUNT && reader == NULL; ++i )
+    {
+        pid_t available = 0;
+
+        if ( __atomic_compare_exchange_n (
+                 &smControl->anonymousReaders[i].processId, &available,
+                 child, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+        {
+            reader = &smControl->anonymousReaders[i];
+        }
+    }
+    if ( reader == NULL )
+    {
+        printf ( "Error: No anonymous reader record is available\n" );
+        return 1;
+    }
+    reader->count = 1;
+
+    sm_reclaim_magazines();
+
+    if ( reader->processId != 0 || reader->count != 0 )
+    {
+        printf ( "Error: The anonymous reader of process %d was not "
+                 "reaped\n", child );
+        return 1;
+    }
+    printf ( "  The anonymous reader of the dead process was reaped\n" );
+
+    return 0;
+}
+
+
 //
 //  Define the usage message function.
 //
@@ -216,12 +2757,35 @@ int main ( int argc, char* const argv[] )
     printf ( "\nAfter all of the frees...\n" );
     dumpSM();
 
-    vsi_core_close();
+    int failures = 0;
+
+    failures += testDefineSignals ( 9100 );
+    failures += testChunkAllocator();
+    failures += testMallocBatch();
+    failures += testCursors ( 9016, false );
+    failures += testCursors ( 9017, true );
+    failures += testListStress ( 9018, RETENTION_TEST_MAX_COUNT, false );
+    failures += testListStress ( 9019, 0, true );
+    failures += testGroupListen ( 9020, 9020 );
+    failures += testFetchInPlace ( 9022 );
+    failures += testGroupChurn ( 9030, 9030 );
+    failures += testRingWrap ( 9040 );
+    failures += testGroupSnapshot ( 9050, 9050 );
+    failures += testCursorReopen ( 9060 );
+    failures += testSignalRange ( 9070 );
+    failures += testAnonymousReaders();
+    failures += testLatestCache ( 9080 );
+    failures += testDenseIndex();
+    failures += testSlabFreeList();
+    failures += testSemaphoreTimeout();
+    failures += testSignalStamps ( 9090 );
+    failures += testDeadlines ( 9160, 9160 );
+    failures += testDetachWithLiveThread();
 
     //
-    //  Return a good completion code to the caller.
+    //  Return the number of failed tests to the caller.
     //
-    return 0;
+    return failures;
 }
 
 
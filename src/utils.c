@@ -48,9 +48,7 @@
 
     @brief Dump the fields of a semaphore.
 
-    This function will dump all of the fields of the specified semaphore that
-    make sense.  The mutex and condition variable are not dumped as we have no
-    explicit information about what is inside them.
+    This function will dump all of the fields of the specified semaphore.
 
     @param[in] semaphore - The address of the semaphore to be dumped.
 
@@ -61,9 +59,9 @@ void dumpSemaphore ( semaphore_p semaphore )
 #ifdef SEM_DUMP
 #if VSI_DEBUG > 2
     LOG ( "\n%'lu semaphore: %p[%4p]\n", getIntervalTime(), semaphore,
-          (void*)((long)&semaphore->mutex % 0x10000 ) );
+          (void*)((long)semaphore % 0x10000 ) );
 #else
-    LOG ( "\nsemaphore: %p[%4p]\n", semaphore, (void*)((long)&semaphore->mutex % 0x10000 ) );
+    LOG ( "\nsemaphore: %p[%4p]\n", semaphore, (void*)((long)semaphore % 0x10000 ) );
 #endif
 
 #if VSI_DEBUG > 3
@@ -71,53 +69,9 @@ void dumpSemaphore ( semaphore_p semaphore )
     //  Display our count values.
     //
     LOG ( "   message count.........: %'d\n", semaphore->messageCount );
-    LOG ( "   waiter count..........: %'d\n\n", semaphore->waiterCount );
-
-    //
-    //  Display the semaphore data...
-    //
-    LOG ( "   mutex address........: %p\n", &semaphore->mutex );
-    LOG ( "   mutex.data.lock......: %d\n", semaphore->mutex.__data.__lock );
-    LOG ( "   mutex.data.count.....: %d\n", semaphore->mutex.__data.__count );
-    LOG ( "   mutex.data.owner.....: %d\n", semaphore->mutex.__data.__owner );
-    LOG ( "   mutex.data.nusers....: %d\n", semaphore->mutex.__data.__nusers );
-    LOG ( "   mutex.data.kind......: %d\n", semaphore->mutex.__data.__kind );
-    LOG ( "   mutex.data.spins.....: %d\n", semaphore->mutex.__data.__spins );
-    LOG ( "   mutex.data.elision...: %d\n", semaphore->mutex.__data.__elision );
-    LOG ( "   mutex.data.list.prev.: %p\n", semaphore->mutex.__data.__list.__prev );
-    LOG ( "   mutex.data.list.next.: %p\n", semaphore->mutex.__data.__list.__next );
-    LOG ( "   mutex.size...........: 0x%llx\n", (long long)semaphore->mutex.__size );
-    LOG ( "   mutex.align..........: %ld\n\n", semaphore->mutex.__align );
-
-
-    //
-    //  Contitional variable has been reimplemented in GLIBC 2.25.
-    //  More info: https://sourceware.org/git/?p=glibc.git;a=commit;h=ed19993b5b0d
-    //
-    LOG ( "   conditionVariable address............: %p\n", &semaphore->conditionVariable );
-#if __GLIBC__ == 2 && __GLIBC_MINOR__ < 25
-    LOG ( "   conditionVariable.data.lock..........: %d\n", semaphore->conditionVariable.__data.__lock );
-    LOG ( "   conditionVariable.data.futex.........: %d\n", semaphore->conditionVariable.__data.__futex );
-    LOG ( "   conditionVariable.data.total_seq.....: %llu\n", semaphore->conditionVariable.__data.__total_seq );
-    LOG ( "   conditionVariable.data.wakeup_seq....: %llu\n", semaphore->conditionVariable.__data.__wakeup_seq );
-    LOG ( "   conditionVariable.data.woken_seq.....: %llu\n", semaphore->conditionVariable.__data.__woken_seq );
-    LOG ( "   conditionVariable.data.mutex.........: %p\n", semaphore->conditionVariable.__data.__mutex );
-    LOG ( "   conditionVariable.data.nwaiters......: %d\n", semaphore->conditionVariable.__data.__nwaiters );
-    LOG ( "   conditionVariable.data.broadcast_seq.: %d\n", semaphore->conditionVariable.__data.__broadcast_seq );
-#else
-    LOG ( "   conditionVariable.data.wseq..........: %llu\n", semaphore->conditionVariable.__data.__wseq );
-    LOG ( "   conditionVariable.data.g1_start......: %llu\n", semaphore->conditionVariable.__data.__g1_start );
-    LOG ( "   conditionVariable.data.g1_refs[0]....: %u\n", semaphore->conditionVariable.__data.__g_refs[0] );
-    LOG ( "   conditionVariable.data.g1_refs[1]....: %u\n", semaphore->conditionVariable.__data.__g_refs[1] );
-    LOG ( "   conditionVariable.data.g1_size[0]....: %u\n", semaphore->conditionVariable.__data.__g_size[0] );
-    LOG ( "   conditionVariable.data.g1_size[1]....: %u\n", semaphore->conditionVariable.__data.__g_size[1] );
-    LOG ( "   conditionVariable.data.g1_orig_size..: %u\n", semaphore->conditionVariable.__data.__g1_orig_size );
-    LOG ( "   conditionVariable.data.wrefs.........: %u\n", semaphore->conditionVariable.__data.__wrefs );
-    LOG ( "   conditionVariable.data.g_signals[0]..: %u\n", semaphore->conditionVariable.__data.__g_signals[0] );
-    LOG ( "   conditionVariable.data.g_signals[1]..: %u\n", semaphore->conditionVariable.__data.__g_signals[1] );
-#endif
-    LOG ( "   conditionVariable.size...............: 0x%llx\n", (long long)semaphore->conditionVariable.__size );
-    LOG ( "   conditionVariable.align..............: %llx\n", semaphore->conditionVariable.__align );
+    LOG ( "   waiter count..........: %'d\n", semaphore->waiterCount );
+    LOG ( "   sleeper count.........: %'d\n", semaphore->sleeperCount );
+    LOG ( "   futex sequence........: %'u\n\n", semaphore->futex );
 
     fflush ( stdout );
 #endif
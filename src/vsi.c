@@ -113,7 +113,8 @@ void vsi_initialize ( bool createNew )
         //
         //  Go initialize the signal name btree index.
         //
-        btree_create_in_place ( &vsiContext->signalNameIndex, 21, keyDef );
+        btree_create_in_place ( &vsiContext->signalNameIndex,
+                                SM_SIGNALS_RECORD_COUNT, keyDef );
     }
     //
     //  S i g n a l   I D   I n d e x
@@ -153,7 +154,8 @@ void vsi_initialize ( bool createNew )
         //
         //  Go initialize the signal ID btree index.
         //
-        btree_create_in_place ( &vsiContext->signalIdIndex, 21, keyDef );
+        btree_create_in_place ( &vsiContext->signalIdIndex,
+                                SM_SIGNALS_RECORD_COUNT, keyDef );
     }
     //
     //  P r i v a t e   I D   I n d e x
@@ -193,7 +195,8 @@ void vsi_initialize ( bool createNew )
         //
         //  Go initialize the private ID btree index.
         //
-        btree_create_in_place ( &vsiContext->privateIdIndex, 21, keyDef );
+        btree_create_in_place ( &vsiContext->privateIdIndex,
+                                SM_SIGNALS_RECORD_COUNT, keyDef );
     }
     //
     //  G r o u p   I D   I n d e x
@@ -231,7 +234,8 @@ void vsi_initialize ( bool createNew )
         //
         //  Go initialize the btree index for the group ids.
         //
-        btree_create_in_place ( &vsiContext->groupIdIndex, 21, keyDef );
+        btree_create_in_place ( &vsiContext->groupIdIndex,
+                                SM_SIGNALS_RECORD_COUNT, keyDef );
     }
     //
     //  Return to the caller.
@@ -249,6 +253,11 @@ void vsi_initialize ( bool createNew )
     This function will read the specified file and import the contents of it
     into the specified VSI environment.
 
+    All of the signal definitions in the file are collected first and then
+    defined with a single call to vsi_define_signals so that the signal
+    indices of a fresh shared memory segment can be bulk loaded rather than
+    built up one insert at a time.
+
     @param[in] - fileName - The pathname to the VSS definition file to be read
 
     @return - Completion code - 0 = Succesful
@@ -259,16 +268,19 @@ void vsi_initialize ( bool createNew )
 
 int vsi_VSS_import ( const char* fileName, int domain )
 {
-    FILE*    inputFile;
-    char     name[MAX_VSS_LINE] = { 0 };
-    char     line[MAX_VSS_LINE] = { 0 };
-    signal_t id = 0;
-    signal_t privateId = 0;
-    int      tokenCount = 0;
-    int      signalCount = 0;
-    int      lineCount = 0;
-    int      status = 0;
-    bool     versionLineSeen = false;
+    FILE*              inputFile;
+    char               name[MAX_VSS_LINE] = { 0 };
+    char               line[MAX_VSS_LINE] = { 0 };
+    signal_t           id = 0;
+    signal_t           privateId = 0;
+    int                tokenCount = 0;
+    int                signalCount = 0;
+    int                lineCount = 0;
+    int                status = 0;
+    bool               versionLineSeen = false;
+    signal_definition* definitions = NULL;
+    signal_definition* newDefinitions;
+    int                capacity = 0;
 
     //
     //  If the user did not supply a valid file name, complain and quit.
@@ -346,30 +358,44 @@ int vsi_VSS_import ( const char* fileName, int domain )
         else if ( tokenCount >= 2 )
         {
             //
-            //  Go define this signal in the VSI database.
+            //  If the array of signal definitions is full, double its size.
             //
-            status = vsi_define_signal ( domain, (signal_t)id,
-                                         (signal_t)privateId, name );
+            if ( signalCount == capacity )
+            {
+                capacity = capacity == 0 ? 256 : capacity * 2;
+                newDefinitions = realloc ( definitions, capacity *
+                                           sizeof(signal_definition) );
+                if ( newDefinitions == NULL )
+                {
+                    printf ( "ERROR: Unable to allocate memory for %d signal "
+                             "definitions\n", capacity );
+                    status = ENOMEM;
+                    break;
+                }
+                definitions = newDefinitions;
+            }
             //
-            //  Increment the number of signals that we've defined.
+            //  Save the definition of this signal until we have read the
+            //  whole file.
             //
-            signalCount++;
+            definitions[signalCount].signalId  = (signal_t)id;
+            definitions[signalCount].privateId = (signal_t)privateId;
+            definitions[signalCount].name      = strdup ( name );
 
-            //
-            //  If the above call generated an error, let the user know about
-            //  it.
-            //
-            if ( status != 0 )
+            if ( definitions[signalCount].name == NULL )
             {
-                printf ( "ERROR: Inserting data into the VSI: %d[%s]\n",
-                         status, strerror(status) );
+                printf ( "ERROR: Unable to allocate memory for signal name "
+                         "[%s]\n", name );
+                status = ENOMEM;
+                break;
             }
+            //
+            //  Increment the number of signals that we've read.
+            //
+            signalCount++;
+
             printf ( "Importing signal %d at line %d: %u - %s\n",
                      signalCount, lineCount, id, name );
-
-#ifdef VSI_DEBUG
-            btree_print ( &vsiContext->signalNameIndex, NULL );
-#endif
         }
         //
         //  If there are more than 2 tokens on the input line, it is an error
@@ -383,9 +409,38 @@ int vsi_VSS_import ( const char* fileName, int domain )
     //
     //  We are finished reading the input file so close it.
     //
-    printf ( "%d signal names defined for domain %d\n", signalCount, domain );
     fclose ( inputFile );
 
+    //
+    //  Go define all of the signals that we read in the VSI database.
+    //
+    if ( status == 0 )
+    {
+        status = vsi_define_signals ( domain, definitions, signalCount );
+
+        //
+        //  If the above call generated an error, let the user know about it.
+        //
+        if ( status != 0 )
+        {
+            printf ( "ERROR: Inserting data into the VSI: %d[%s]\n",
+                     status, strerror(status) );
+        }
+        else
+        {
+            printf ( "%d signal names defined for domain %d\n", signalCount,
+                     domain );
+        }
+    }
+    //
+    //  Free the signal definitions that we read.
+    //
+    for ( int i = 0; i < signalCount; ++i )
+    {
+        free ( (char*)definitions[i].name );
+    }
+    free ( definitions );
+
     //
     //  Go dump the resulting "name" Btree.
     //
@@ -36,7 +36,14 @@
 //      2       more verbose with semaphore dumps enabled
 //      3       high resolution timestamps enabled on semaphores
 //
-#define VSI_DEBUG 3
+//  Release builds (configured with the VSI_RELEASE CMake option) leave the
+//  debug symbol undefined so that all of the LOG, SEM_DUMP, HX_DUMP and
+//  PRINT_RESULT calls are compiled out of the code.  The binary trace ring
+//  (see SM_TRACE in sharedMemory.h) remains available in these builds.
+//
+#ifndef VSI_RELEASE
+#   define VSI_DEBUG 3
+#endif
 
 #include "btree.h"
 
@@ -91,6 +98,27 @@ typedef int group_t;
 
 typedef offset_t name_t;        // "pointer" to the name string in SM
 
+//
+//  Define the dimensions of the dense signal index.  Signals in domains at or
+//  above the domain count or with IDs at or above the signal count are only
+//  found through the signal ID btree.
+//
+#define VSI_DENSE_DOMAIN_COUNT ( 8 )
+#define VSI_DENSE_SIGNAL_COUNT ( 8192 )
+
+//
+//  Define the maximum number of signal notifiers that can be open at the
+//  same time in the whole system.  Each notifier is represented by one bit
+//  in the notification mask of every signal list it is watching.
+//
+#define VSI_NOTIFIER_COUNT ( 64 )
+
+
+//
+//  Define the retention limit value that means "no limit" even if the domain
+//  of the signal has a limit (see vsi_retention).
+//
+#define VSI_RETAIN_UNLIMITED ( ~0UL )
 
 //
 //  Declare the VSS import function.
@@ -98,6 +126,72 @@ typedef offset_t name_t;        // "pointer" to the name string in SM
 int vsi_VSS_import ( const char* fileName, int domain );
 
 
+/*!-----------------------------------------------------------------------
+
+    s t r u c t   v s i _ n o t i f i e r
+
+    @brief Define a signal notifier.
+
+    A notifier is a pollable file descriptor that becomes readable whenever
+    a signal it is watching is inserted by any process.  The notifier table
+    in the VSI context records which process owns each notifier and what it
+    is watching so that the notification bits can be removed from the signal
+    lists when the notifier is closed (or when it's owner dies).
+
+    The "processId" is the process that owns the notifier, 0 if the notifier
+    is available or -1 while a dead process' notifier is being reclaimed.
+
+    The "generation" is incremented every time the notifier is opened and is
+    part of the socket address so that notifications intended for a previous
+    owner of the notifier are never delivered to the current one.
+
+    A group notifier watches every signal in the group "groupId" and a signal
+    notifier watches the single signal "domainId", "signalId".
+
+------------------------------------------------------------------------*/
+typedef struct vsi_notifier
+{
+    int           processId;
+    bool          isGroup;
+    group_t       groupId;
+    domain_t      domainId;
+    signal_t      signalId;
+    unsigned long generation;
+
+}   vsi_notifier;
+
+
+/*!-----------------------------------------------------------------------
+
+    s t r u c t   v s i _ r e t e n t i o n
+
+    @brief Define the retention policy of a signal or a domain.
+
+    The retention policy limits the number of signals kept in a signal list
+    that no one is consuming.  Whenever a new signal is inserted, the oldest
+    signals in the list are discarded until the list is within all of the
+    limits again.  The newest signal is never discarded.
+
+    The "maxCount" is the largest number of signals kept, the "maxBytes" is
+    the largest total size of the data in the signals kept and the "maxAge"
+    is the largest difference (in nanoseconds) between the capture time of
+    the newest signal and the oldest one kept.
+
+    A limit of zero in the policy of a signal means that the limit of the
+    signal's domain is used instead.  A limit of zero in the policy of a
+    domain and a limit of VSI_RETAIN_UNLIMITED in either policy mean that
+    there is no limit.
+
+------------------------------------------------------------------------*/
+typedef struct vsi_retention
+{
+    unsigned long maxCount;
+    unsigned long maxBytes;
+    unsigned long maxAge;
+
+}   vsi_retention;
+
+
 /*!-----------------------------------------------------------------------
 
     s t r u c t   v s i _ c o n t e x t
@@ -135,6 +229,28 @@ typedef struct vsi_context
     //
     btree_t groupIdIndex;
 
+    //
+    //  Define the dense signal index.  Signal IDs in the low numbered domains
+    //  are usually small dense integers so each of these domains gets a
+    //  direct mapped array (allocated when the first signal in the domain is
+    //  defined) that maps a signal ID to the offset of it's signal list.
+    //  This index is checked before the signal ID btree which remains the
+    //  authoritative index for all signals.  Unused entries are zero.
+    //
+    offset_t denseSignalIndex[VSI_DENSE_DOMAIN_COUNT];
+
+    //
+    //  Define the table of signal notifiers.
+    //
+    vsi_notifier notifiers[VSI_NOTIFIER_COUNT];
+
+    //
+    //  Define the retention policies of the domains that are in the dense
+    //  signal index.  Signals in other domains can only have their own
+    //  retention policies.
+    //
+    vsi_retention domainRetention[VSI_DENSE_DOMAIN_COUNT];
+
 }   vsi_context;
 
 //
@@ -210,6 +326,14 @@ extern vsi_context* vsiContext;
     be at least as large as the maximum number of signals that could be
     returned by the call.
 
+    The timestamp and sequence fields are the capture time (in nanoseconds
+    of CLOCK_MONOTONIC) and the per-signal sequence number of the signal (see
+    signal_stamp).  They are returned by the functions that fetch signals and
+    by the insert functions.  When a signal is inserted, a non-zero timestamp
+    supplied by the caller is used as the capture time of the signal instead
+    of the time of the insert so callers that don't have their own capture
+    time must set it to zero.
+
     The status parameter will contain the return status of the function that
     was called.  For operations on more than one result structure, the status
     field is set individually for each result structure to reflect any errors
@@ -232,6 +356,9 @@ typedef struct vsi_result
     unsigned long   literalData;
     unsigned long   dataLength;
 
+    unsigned long   timestamp;
+    unsigned long   sequence;
+
     int             status;
 
     pthread_mutex_t lock;
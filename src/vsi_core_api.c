@@ -188,6 +188,12 @@ static sharedMemory_t* vsi_core_open_user ( bool createNew )
 					 "- Aborting!\n" );
 			return 0;
 		}
+		//
+		//  Clear the new context so that all of it's indices start out in
+		//  their uninitialized (empty) state.
+		//
+		memset ( toAddress ( smControl->vsiContextOffset ), 0,
+				 sizeof(vsi_context) );
     }
     //
     //  If the shared memory segment has already been initialized then just
@@ -198,12 +204,12 @@ static sharedMemory_t* vsi_core_open_user ( bool createNew )
         //
         //  Map the shared memory file into virtual memory.
         //
-        smControl = mmap ( NULL, stats.st_size, PROT_READ|PROT_WRITE,
-                           MAP_SHARED, fd, 0 );
-        if ( smControl == MAP_FAILED )
+        smControl = sm_attach ( fd, stats.st_size );
+        if ( smControl == 0 )
         {
             printf ( "Unable to map the VSI core data store. errno: %u[%m].\n",
                      errno );
+            (void) close ( fd );
             return 0;
         }
     }
@@ -215,9 +221,9 @@ static sharedMemory_t* vsi_core_open_user ( bool createNew )
     LOG ( "VSI user data store at %p for %'lu bytes has been mapped into "
           "memory\n", smControl, smControl->sharedMemorySegmentSize );
     //
-    //  Close the shared memory pseudo file as we don't need it any more.
+    //  Note that the shared memory pseudo file is left open (it will be
+    //  closed by sm_detach) so that the segment can be grown later.
     //
-    (void) close ( fd );
 
     //
     //  Return the address of the memory mapped shared memory segment to the
@@ -306,21 +312,21 @@ static sysMemory_t* vsi_core_open_sys ( bool createNew )
         //
         //  Map the shared memory file into virtual memory.
         //
-        sysControl = mmap ( NULL, stats.st_size, PROT_READ|PROT_WRITE,
-                           MAP_SHARED, fd, 0 );
-        if ( sysControl == MAP_FAILED )
+        sysControl = sm_attach_sys ( fd, stats.st_size );
+        if ( sysControl == 0 )
         {
             printf ( "Unable to map the VSI system data store. errno: %u[%m].\n",
                      errno );
+            (void) close ( fd );
             return 0;
         }
     }
     LOG ( "VSI system data store at %p for %'lu bytes has been mapped into "
           "memory\n", sysControl, sysControl->sharedMemorySegmentSize );
     //
-    //  Close the shared memory pseudo file as we don't need it any more.
+    //  Note that the shared memory pseudo file is left open (it will be
+    //  closed by sm_detach_sys) so that the segment can be grown later.
     //
-    (void) close ( fd );
 
     //
     //  Return the address of the memory mapped shared memory segment to the
@@ -365,13 +371,16 @@ static void vsi_core_close_user ( void )
     //
     //  Close the user shared memory segment.
     //
-    status = munmap ( smControl, smControl->sharedMemorySegmentSize );
+    void*         segment     = smControl;
+    unsigned long segmentSize = smControl->sharedMemorySegmentSize;
+
+    status = sm_detach();
 
     if ( status != 0 )
     {
         printf ( "Error: Cannot unmap user pages at %p for %lu bytes - "
-                 "%s[%d]\n", smControl, smControl->sharedMemorySegmentSize,
-                 strerror(errno), errno );
+                 "%s[%d]\n", segment, segmentSize, strerror(status),
+                 status );
     }
     return;
 }
@@ -386,13 +395,16 @@ static void vsi_core_close_sys ( void )
     //
     //  Close the system shared memory segment.
     //
-    status = munmap ( sysControl, sysControl->sharedMemorySegmentSize );
+    void*         segment     = sysControl;
+    unsigned long segmentSize = sysControl->sharedMemorySegmentSize;
+
+    status = sm_detach_sys();
 
     if ( status != 0 )
     {
         printf ( "Error: Cannot unmap system pages at %p for %lu bytes - "
-                 "%s[%d]\n", sysControl, sysControl->sharedMemorySegmentSize,
-                 strerror(errno), errno );
+                 "%s[%d]\n", segment, segmentSize, strerror(status),
+                 status );
     }
     return;
 }
@@ -454,7 +466,7 @@ void vsi_core_insert ( domain_t domain, offset_t key, unsigned long newMessageSi
     //
     //  Go insert this key into the core data store.
     //
-    sm_insert ( domain, key, newMessageSize, body );
+    sm_insert ( domain, key, newMessageSize, body, NULL );
 
     //
     //  Return to the caller.
@@ -463,6 +475,30 @@ void vsi_core_insert ( domain_t domain, offset_t key, unsigned long newMessageSi
 }
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ c o r e _ i n s e r t _ b a t c h
+
+    @brief Insert several messages into the VSI core data store.
+
+    @param[in/out] results - The array of messages to insert.
+    @param[in] count - The number of messages in the results array.
+
+    @return 0 if successful
+            Otherwise the status of the first message that failed
+
+------------------------------------------------------------------------*/
+int vsi_core_insert_batch ( vsi_result* results, size_t count )
+{
+    LOG ( "\nCalled vsi_core_insert_batch with %zu messages\n", count );
+
+    //
+    //  Go insert all of these messages into the core data store.
+    //
+    return sm_insert_batch ( results, count );
+}
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ c o r e _ f e t c h _ w a i t
@@ -476,11 +512,9 @@ void vsi_core_insert ( domain_t domain, offset_t key, unsigned long newMessageSi
     function will hang (on a semaphore) until an appropriate message is
     available before returning to the caller.
 
-    When calling this function, the messageSize should be the size of the data
-    buffer supplied as the "body" argument.  When we copy the data from the
-    shared memory segment to the "body" buffer, the smaller of either the body
-    buffer size or the number of bytes of data in the message found will be
-    copied into the body buffer.
+    The address of the message data in the shared memory segment is returned
+    to the caller rather than a copy of it (see sm_fetch_in_place).  The
+    caller must give it back with vsi_core_release when it is done with it.
 
     @param[in] handle - The base address of the shared memory segment.
     @param[in] key - The key value of the message to be removed.
@@ -500,7 +534,22 @@ int vsi_core_fetch_wait ( domain_t       domain,
     LOG ( "Called vsi_core_fetch_wait with domain[%u], key[%lu], bodySize[%p], "
           "body[%p]\n", domain, key, bodySize, body );
 
-    return sm_fetch ( domain, key, bodySize, body, true );
+    return sm_fetch_in_place ( domain, key, false, bodySize, body, true,
+                               NULL, NULL );
+}
+
+
+int vsi_core_fetch_wait_until ( domain_t               domain,
+                                offset_t               key,
+                                unsigned long*         bodySize,
+                                void**                 body,
+                                const struct timespec* deadline )
+{
+    LOG ( "Called vsi_core_fetch_wait_until with domain[%u], key[%lu], "
+          "bodySize[%p], body[%p]\n", domain, key, bodySize, body );
+
+    return sm_fetch_in_place ( domain, key, false, bodySize, body, true,
+                               deadline, NULL );
 }
 
 
@@ -512,7 +561,8 @@ int vsi_core_fetch ( domain_t       domain,
     LOG ( "Called vsi_core_fetch with domain[%u], key[%lu], bodySize[%p], "
           "body[%p]\n", domain, key, bodySize, body );
 
-    return sm_fetch ( domain, key, bodySize, body, false );
+    return sm_fetch_in_place ( domain, key, false, bodySize, body, false,
+                               NULL, NULL );
 }
 
 
@@ -521,7 +571,23 @@ int vsi_core_fetch_newest ( domain_t       domain,
                             unsigned long* bodySize,
                             void**         body )
 {
-    return sm_fetch_newest ( domain, key, bodySize, body, true );
+    return sm_fetch_in_place ( domain, key, true, bodySize, body, true,
+                               NULL, NULL );
+}
+
+
+void vsi_core_release ( void* body )
+{
+    sm_release_in_place ( body );
+}
+
+
+int vsi_core_fetch_newest_copy ( domain_t       domain,
+                                 offset_t       key,
+                                 unsigned long* bodySize,
+                                 void*          body )
+{
+    return sm_fetch_latest ( domain, key, bodySize, body, true, NULL, NULL );
 }
 
 
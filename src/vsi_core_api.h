@@ -18,6 +18,8 @@
 #ifndef VSI_CORE_API_H
 #define VSI_CORE_API_H
 
+#include <time.h>
+
 #include "vsi.h"
 #include "sharedMemory.h"
 
@@ -88,6 +90,32 @@ void vsi_core_insert ( domain_t domain,
                        offset_t key, unsigned long newMessageSize,
                        void* body );
 
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c o r e _ i n s e r t _ b a t c h
+
+    @brief Insert several messages into the VSI core data store.
+
+    This function is equivalent to calling vsi_core_insert for each of the
+    results supplied, in order, except that all of the memory needed is
+    allocated at once and each signal's waiters are released only once after
+    the whole batch has been stored.
+
+    The domainId, signalId, data and dataLength fields of each result are
+    used as the domain, key, body and newMessageSize respectively and the
+    status field of each result is set to the completion status of that
+    message.
+
+    @param[in/out] results - The array of messages to insert.
+    @param[in] count - The number of messages in the results array.
+
+    @return 0 if successful
+            Otherwise the status of the first message that failed
+
+------------------------------------------------------------------------*/
+int vsi_core_insert_batch ( vsi_result* results, size_t count );
+
 /*!-----------------------------------------------------------------------
 
     v s i _ c o r e _ f e t c h
@@ -100,6 +128,10 @@ void vsi_core_insert ( domain_t domain,
     not available in the data store, this function will return immediately
     with an error code.
 
+    The message data is not copied.  The address returned points into the
+    shared memory segment and the message is held there for the caller until
+    it passes the same address to vsi_core_release.
+
     @param[in] handle - The handle to the VSI core data store.
     @param[in] domain - The domain associated with this message.
     @param[in] key - The key value associated with this message.
@@ -129,13 +161,14 @@ int vsi_core_fetch ( domain_t domain,
     return when the data requested is available.
 
     This function is identical to the vsi_core_fetch function except for the
-    wait behavior.
+    wait behavior.  The caller must pass the returned body address to
+    vsi_core_release when it is done with the message data.
 
     @param[in] handle - The handle to the VSI core data store.
     @param[in] domain - The domain associated with this message.
     @param[in] key - The key value associated with this message.
-    @param[in/out] bodySize - The address of the body buffer size.
-    @param[out] body - The address of the user's message buffer.
+    @param[out] bodySize - The address of where to store the body size.
+    @param[out] body - The address of where to store the body address.
 
     @return 0 - Success
               - Anything else is an error code.
@@ -147,6 +180,36 @@ int vsi_core_fetch_wait ( domain_t       domain,
                           void**         body );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ c o r e _ f e t c h _ w a i t _ u n t i l
+
+    @brief Fetch and remove a message from the VSI data store with a deadline.
+
+    This function is identical to the vsi_core_fetch_wait function except
+    that it gives up waiting when the deadline passes.  The deadline is an
+    absolute CLOCK_MONOTONIC time (as returned by clock_gettime) so a caller
+    that retries after a spurious error does not extend the total wait.
+
+    @param[in] domain - The domain associated with this message.
+    @param[in] key - The key value associated with this message.
+    @param[out] bodySize - The address of where to store the body size.
+    @param[out] body - The address of where to store the body address.
+    @param[in] deadline - The time at which to give up waiting or NULL to
+                          wait forever.
+
+    @return 0 - Success
+            ETIMEDOUT - The deadline passed before a message arrived.
+              - Anything else is an error code.
+
+------------------------------------------------------------------------*/
+int vsi_core_fetch_wait_until ( domain_t               domain,
+                                offset_t               key,
+                                unsigned long*         bodySize,
+                                void**                 body,
+                                const struct timespec* deadline );
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ c o r e _ f e t c h _ n e w e s t
@@ -159,11 +222,15 @@ int vsi_core_fetch_wait ( domain_t       domain,
     function will wait indefinitely and only return when the data requested is
     available.
 
+    As with vsi_core_fetch, the message data is not copied and the caller
+    must pass the returned body address to vsi_core_release when it is done
+    with it.
+
     @param[in] handle - The handle to the VSI core data store.
     @param[in] domain - The domain associated with this message.
     @param[in] key - The key value associated with this message.
-    @param[in/out] bodySize - The address of the body buffer size.
-    @param[out] body - The address of the user's message buffer.
+    @param[out] bodySize - The address of where to store the body size.
+    @param[out] body - The address of where to store the body address.
 
     @return 0 - Success
               - Anything else is an error code.
@@ -174,6 +241,56 @@ int vsi_core_fetch_newest ( domain_t domain,
                             void**   body );
 
 
+/*!-----------------------------------------------------------------------
+
+    v s i _ c o r e _ r e l e a s e
+
+    @brief Release a message returned by one of the in place fetch functions.
+
+    The vsi_core_fetch, vsi_core_fetch_wait, vsi_core_fetch_wait_until and
+    vsi_core_fetch_newest functions return the address of the message data in
+    the shared memory segment and keep that message from being reclaimed
+    until this function is called with the same address.  The message data
+    must not be looked at after this call.
+
+    @param[in] body - The body address returned by the fetch function.
+
+------------------------------------------------------------------------*/
+void vsi_core_release ( void* body );
+
+
+/*!-----------------------------------------------------------------------
+
+    v s i _ c o r e _ f e t c h _ n e w e s t _ c o p y
+
+    @brief Copy the newest message from the VSI data store with wait.
+
+    This function will find the newest message with the specified domain and
+    key values in the VSI data store and copy the message data into the
+    caller's buffer.  If the data requested is not available in the data
+    store, this function will wait indefinitely and only return when the data
+    requested is available.
+
+    The smaller of the body buffer size or the size of the message will be
+    copied into the body buffer and the number of bytes copied will be
+    returned in bodySize.  Small messages are copied from a lock free cache
+    of the newest message so this call does not take any locks when the
+    signal already has data.
+
+    @param[in] domain - The domain associated with this message.
+    @param[in] key - The key value associated with this message.
+    @param[in/out] bodySize - The address of the body buffer size.
+    @param[out] body - The address of the user's message buffer.
+
+    @return 0 - Success
+              - Anything else is an error code.
+
+------------------------------------------------------------------------*/
+int vsi_core_fetch_newest_copy ( domain_t domain,
+                                 offset_t key, unsigned long* bodySize,
+                                 void*    body );
+
+
 /*!-----------------------------------------------------------------------
 
     v s i _ c o r e _ f l u s h _ s i g n a l